@@ -0,0 +1,71 @@
+#!/usr/bin/env python
+#
+# Compares two sets of runtime microbenchmark results (see nanox-bench-run.sh)
+# and flags the regressions: benchmarks whose median grows more than the
+# threshold and more than the noise, measured as the interquartile range of
+# the samples of both runs. Exits with status 1 when there are regressions.
+#
+# usage: nanox-bench-compare.py [-t threshold%] [-k noise factor] baseline.json current.json
+#
+
+from __future__ import print_function
+import json
+import sys
+from optparse import OptionParser
+
+def load(filename):
+	with open(filename) as f:
+		data = json.load(f)
+	runs = data.get('runs', [data])
+	results = {}
+	for run in runs:
+		config = run['config']
+		for r in run['results']:
+			results[(config['nx_args'].strip(), r['name'])] = r
+	return results
+
+def noise(r):
+	if r['median'] <= 0:
+		return 0.0
+	return (r['p75'] - r['p25']) / r['median']
+
+parser = OptionParser(usage="usage: %prog [options] baseline.json current.json")
+parser.add_option("-t", "--threshold", type='float', dest="threshold", default=5.0,
+                  help="Minimum change of the median, in percent, to report a benchmark (default 5)")
+parser.add_option("-k", "--noise-factor", type='float', dest="factor", default=2.0,
+                  help="The change must also exceed this many times the relative interquartile range (default 2)")
+parser.add_option("-a", "--all", action="store_true", dest="all", default=False,
+                  help="Show all the benchmarks, not only the changed ones")
+(options, args) = parser.parse_args()
+
+if len(args) != 2:
+	parser.error("Wrong arguments")
+
+baseline = load(args[0])
+current = load(args[1])
+
+regressions = 0
+improvements = 0
+print('%-50s %-30s %12s %12s %9s  %s' % ('NX_ARGS', 'benchmark', 'baseline', 'current', 'change', ''))
+for key in sorted(set(baseline) | set(current)):
+	nx_args, name = key
+	if key not in baseline or key not in current:
+		print('%-50s %-30s %s' % (nx_args, name, 'only in ' + (args[0] if key in baseline else args[1])))
+		continue
+	b = baseline[key]
+	c = current[key]
+	change = (c['median'] - b['median']) / b['median'] if b['median'] > 0 else 0.0
+	significant = abs(change) * 100 > options.threshold and abs(change) > options.factor * max(noise(b), noise(c))
+	status = ''
+	if significant and change > 0:
+		status = 'REGRESSION'
+		regressions += 1
+	elif significant:
+		status = 'improvement'
+		improvements += 1
+	if significant or options.all:
+		print('%-50s %-30s %12.4f %12.4f %+8.1f%%  %s' % (nx_args, name, b['median'], c['median'], change * 100, status))
+
+print('\n%d regressions, %d improvements (threshold %.1f%%, noise factor %.1f)' %
+      (regressions, improvements, options.threshold, options.factor))
+sys.exit(1 if regressions > 0 else 0)
@@ -0,0 +1,112 @@
+#!/bin/bash
+#
+# Runs the runtime microbenchmarks (tests/test/07_benchmarks/microbench.c)
+# sweeping thread counts, scheduler, dependences and barrier plugins,
+# condition wait modes and user lock kinds through NX_ARGS, and collects all the results in a single JSON file to be
+# compared with nanox-bench-compare.py.
+#
+# usage: nanox-bench-run.sh [options] benchmark [benchmark options]
+#
+#   -t "1 2 4"          Thread counts (default: powers of two up to the number of cpus)
+#   -s "bf dbf"         Schedulers (default: runtime default)
+#   -d "plain regions"  Dependences plugins (default: runtime default)
+#   -b "centralized tree dissem"  Barrier plugins (default: runtime default)
+#   -w "spin block"     Condition wait modes, see --sync-wait (default: runtime default)
+#   -l "default ticket mcs task"  User lock kinds, see --user-locks (default: runtime default)
+#   -O factor           Oversubscription: run factor times each thread count (default: 1)
+#   -a "args"           Additional NX_ARGS for every run
+#   -o file             Output file (default: standard output)
+#
+# The word "default" in a list leaves that option to the runtime.
+#
+# For instance, to see how waits behave with 2x oversubscription:
+#
+#   nanox-bench-run.sh -O 2 -w "spin block" microbench -f team_barrier
+#
+# or how user locks scale with the number of threads:
+#
+#   nanox-bench-run.sh -l "default ticket mcs task" microbench -f lock/contended
+#
+
+threads=""
+schedulers="default"
+deps="default"
+barriers="default"
+waits="default"
+locks="default"
+factor=1
+extra=""
+output=""
+
+usage()
+{
+   sed -n '/^# usage/,/^#$/p' $0 | sed 's/^# \?//'
+   exit 1
+}
+
+while getopts "t:s:d:b:w:l:O:a:o:h" opt; do
+   case $opt in
+      t) threads=$OPTARG ;;
+      s) schedulers=$OPTARG ;;
+      d) deps=$OPTARG ;;
+      b) barriers=$OPTARG ;;
+      w) waits=$OPTARG ;;
+      l) locks=$OPTARG ;;
+      O) factor=$OPTARG ;;
+      a) extra=$OPTARG ;;
+      o) output=$OPTARG ;;
+      *) usage ;;
+   esac
+done
+shift $((OPTIND-1))
+
+[ $# -ge 1 ] || usage
+benchmark=$1
+shift
+
+if [ -z "$threads" ]; then
+   cpus=$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1)
+   t=1
+   while [ $t -lt $cpus ]; do threads="$threads $t"; t=$((t*2)); done
+   threads="$threads $cpus"
+fi
+
+option()
+{
+   [ "$2" = "default" ] || echo -n " --$1=$2"
+}
+
+tmp=$(mktemp)
+trap "rm -f $tmp" EXIT
+
+{
+   echo "{"
+   echo "  \"benchmark\": \"nanox-microbench\","
+   echo "  \"host\": \"$(hostname)\","
+   echo "  \"date\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\","
+   echo "  \"runs\": ["
+   first=1
+   for t in $threads; do
+   for s in $schedulers; do
+   for d in $deps; do
+   for b in $barriers; do
+   for w in $waits; do
+   for l in $locks; do
+      nx_args="--smp-workers=$((t*factor))$(option schedule $s)$(option deps $d)$(option barrier $b)$(option sync-wait $w)$(option user-locks $l)${extra:+ $extra}"
+      echo "Running with NX_ARGS=\"$nx_args\"" >&2
+      if NX_ARGS="$nx_args" "$benchmark" "$@" -o $tmp; then
+         [ $first = 1 ] || echo ","
+         first=0
+         cat $tmp
+      else
+         echo "Failed with NX_ARGS=\"$nx_args\", results discarded" >&2
+      fi
+   done
+   done
+   done
+   done
+   done
+   done
+   echo "  ]"
+   echo "}"
+} > ${output:-/dev/stdout}
@@ -275,6 +275,21 @@ NANOS_API_DECL(nanos_err_t, nanos_task_fortran_array_reduction_register, ( void
 
 NANOS_API_DECL(nanos_err_t, nanos_task_reduction_get_thread_storage, ( void *orig, void **tpd ) );
 
+/* Built-in task reduction reducers: when one of them is registered as the
+ * reducer of an array, its private copies are reduced many elements at once */
+NANOS_API_DECL(void, nanos_task_reduction_add_int, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_add_float, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_add_double, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_mul_int, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_mul_float, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_mul_double, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_min_int, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_min_float, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_min_double, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_max_int, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_max_float, ( void *out, void *in ));
+NANOS_API_DECL(void, nanos_task_reduction_max_double, ( void *out, void *in ));
+
 NANOS_API_DECL(nanos_err_t, nanos_admit_current_thread, (void));
 NANOS_API_DECL(nanos_err_t, nanos_expel_current_thread, (void));
 
@@ -362,6 +377,11 @@ NANOS_API_DECL(nanos_err_t, nanos_instrument_enable,( void ));
 NANOS_API_DECL(nanos_err_t, nanos_instrument_disable,( void ));
 NANOS_API_DECL(nanos_err_t, nanos_get_node_num, ( unsigned int *num ));
 NANOS_API_DECL(int, nanos_get_num_nodes, ( ));
+NANOS_API_DECL(nanos_err_t, nanos_get_network_stats, ( unsigned int node, nanos_network_op_t op, nanos_network_op_stats_t *stats ));
+NANOS_API_DECL(nanos_err_t, nanos_get_task_types, ( unsigned int *num_types, const char **types ));
+NANOS_API_DECL(nanos_err_t, nanos_get_task_type_stats, ( const char *type, nanos_task_type_stats_t *stats ));
+NANOS_API_DECL(nanos_err_t, nanos_get_thread_time_stats, ( int thread, nanos_thread_time_stats_t *stats ));
+NANOS_API_DECL(nanos_err_t, nanos_get_network_retries, ( unsigned int node, unsigned long long *segment_retries, unsigned long long *recv_memory_retries ));
 NANOS_API_DECL(nanos_err_t, nanos_set_create_local_tasks, ( bool value ));
 
 #ifdef _MF03
@@ -73,3 +73,28 @@ NANOS_API_DEF(int, nanos_get_num_nodes, ())
 {
    return sys.getNetwork()->getNumNodes();
 }
+
+NANOS_API_DEF(nanos_err_t, nanos_get_network_stats, ( unsigned int node, nanos_network_op_t op, nanos_network_op_stats_t *stats ))
+{
+   try {
+      NetworkStats &netStats = sys.getNetwork()->getStats();
+      if ( stats == NULL || node >= netStats.getNumNodes() || (unsigned int) op >= NANOS_NETWORK_NUM_OPS ) return NANOS_INVALID_PARAM;
+      netStats.getOpStats( node, op, stats );
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+NANOS_API_DEF(nanos_err_t, nanos_get_network_retries, ( unsigned int node, unsigned long long *segment_retries, unsigned long long *recv_memory_retries ))
+{
+   try {
+      NetworkStats &netStats = sys.getNetwork()->getStats();
+      if ( segment_retries == NULL || recv_memory_retries == NULL || node >= netStats.getNumNodes() ) return NANOS_INVALID_PARAM;
+      *segment_retries = netStats.getSegmentRetries( node );
+      *recv_memory_retries = netStats.getRecvMemoryRetries();
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+   return NANOS_OK;
+}
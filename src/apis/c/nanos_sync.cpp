@@ -26,6 +26,7 @@
 #include "system.hpp"
 #include "atomic.hpp"
 #include "synchronizedcondition.hpp"
+#include "userlock.hpp"
 #include "instrumentationmodule_decl.hpp"
 #include "instrumentation.hpp"
 
@@ -228,8 +229,7 @@ NANOS_API_DEF(nanos_err_t, nanos_set_lock, ( nanos_lock_t *lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      Lock &l = *( Lock * ) lock;
-      l++;
+      UserLock::acquire( *lock );
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -248,8 +248,7 @@ NANOS_API_DEF(nanos_err_t, nanos_unset_lock, ( nanos_lock_t *lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      Lock &l = *( Lock * ) lock;
-      l--;
+      UserLock::release( *lock );
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -268,9 +267,7 @@ NANOS_API_DEF(nanos_err_t, nanos_try_lock, ( nanos_lock_t *lock, bool *result ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      Lock &l = *( Lock * ) lock;
-
-      *result = l.tryAcquire();
+      *result = UserLock::tryAcquire( *lock );
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -29,6 +29,7 @@
 
 // atexit
 #include <stdlib.h>
+#include <vector>
 
 using namespace nanos;
 
@@ -187,3 +188,42 @@ NANOS_API_DEF(void, nanos_disable_verbose_copies, (void))
    sys.setVerboseCopies(false);
    sys.setVerboseDevOps(false);
 }
+
+NANOS_API_DEF(nanos_err_t, nanos_get_task_types, ( unsigned int *num_types, const char **types ))
+{
+   try {
+      if ( num_types == NULL || ( *num_types > 0 && types == NULL ) ) return NANOS_INVALID_PARAM;
+      if ( !sys.getTaskStats().isEnabled() ) return NANOS_INVALID_REQUEST;
+      std::vector<const char *> names;
+      sys.getTaskStats().getTypes( names );
+      for ( unsigned int i = 0; i < *num_types && i < names.size(); i++ ) types[i] = names[i];
+      *num_types = names.size();
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+NANOS_API_DEF(nanos_err_t, nanos_get_task_type_stats, ( const char *type, nanos_task_type_stats_t *stats ))
+{
+   try {
+      if ( type == NULL || stats == NULL ) return NANOS_INVALID_PARAM;
+      if ( !sys.getTaskStats().isEnabled() ) return NANOS_INVALID_REQUEST;
+      sys.getTaskStats().getTypeStats( type, *stats );
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+NANOS_API_DEF(nanos_err_t, nanos_get_thread_time_stats, ( int thread, nanos_thread_time_stats_t *stats ))
+{
+   try {
+      if ( stats == NULL || thread < -1 ) return NANOS_INVALID_PARAM;
+      if ( !sys.getThreadTimeStats().isEnabled() ) return NANOS_INVALID_REQUEST;
+      if ( !sys.getThreadTimeStats().getStats( thread, *stats ) ) return NANOS_INVALID_PARAM;
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+   return NANOS_OK;
+}
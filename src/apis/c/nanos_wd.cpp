@@ -114,6 +114,7 @@ NANOS_API_DEF( nanos_err_t, nanos_create_wd_compact, ( nanos_wd_t *uwd, nanos_co
    try 
    {
       if ( !const_data->props.mandatory_creation && !sys.throttleTaskIn() ) {
+         sys.getLiveMetrics().taskThrottled();
          *uwd = 0;
          return NANOS_OK;
       }
@@ -160,6 +161,7 @@ NANOS_API_DEF(nanos_err_t, nanos_create_sliced_wd, ( nanos_wd_t *uwd, size_t num
    try 
    {
       if ( ( props == NULL  || ( props != NULL  && !props->mandatory_creation ) ) && !sys.throttleTaskIn() ) {
+         sys.getLiveMetrics().taskThrottled();
          *uwd = 0;
          return NANOS_OK;
       }
@@ -612,12 +614,68 @@ NANOS_API_DEF (nanos_err_t, nanos_task_fortran_array_reduction_register, ( void
 }
 
 
+namespace {
+   template <typename T> struct ReductionAdd { static T apply ( T a, T b ) { return a + b; } };
+   template <typename T> struct ReductionMul { static T apply ( T a, T b ) { return a * b; } };
+   template <typename T> struct ReductionMin { static T apply ( T a, T b ) { return b < a ? b : a; } };
+   template <typename T> struct ReductionMax { static T apply ( T a, T b ) { return b > a ? b : a; } };
+
+   //! \brief Element-wise loop without aliasing, that the compiler vectorizes
+   template <typename T, typename Op>
+   void reduceArray ( void *out, void *in, size_t n )
+   {
+      T * __restrict__ o = (T *) out;
+      const T * __restrict__ i = (const T *) in;
+      for ( size_t j = 0; j < n; j++ ) o[j] = Op::apply( o[j], i[j] );
+   }
+
+   typedef void (*element_reducer_t) ( void *, void * );
+   typedef void (*array_reducer_t) ( void *, void *, size_t );
+   typedef struct { element_reducer_t element; size_t size; array_reducer_t array; } builtin_reducer_t;
+}
+
+#define NANOS_TASK_REDUCTION_BUILTIN( op, Op, type ) \
+   NANOS_API_DEF(void, nanos_task_reduction_##op##_##type, ( void *out, void *in )) \
+   { \
+      *(type *) out = Reduction##Op<type>::apply( *(type *) out, *(type *) in ); \
+   }
+
+#define NANOS_TASK_REDUCTION_BUILTINS( op, Op ) \
+   NANOS_TASK_REDUCTION_BUILTIN( op, Op, int ) \
+   NANOS_TASK_REDUCTION_BUILTIN( op, Op, float ) \
+   NANOS_TASK_REDUCTION_BUILTIN( op, Op, double )
+
+NANOS_TASK_REDUCTION_BUILTINS( add, Add )
+NANOS_TASK_REDUCTION_BUILTINS( mul, Mul )
+NANOS_TASK_REDUCTION_BUILTINS( min, Min )
+NANOS_TASK_REDUCTION_BUILTINS( max, Max )
+
+#define NANOS_TASK_REDUCTION_ARRAY( op, Op, type ) \
+   { nanos_task_reduction_##op##_##type, sizeof( type ), reduceArray<type, Reduction##Op<type> > }
+
+static const builtin_reducer_t builtinReducers[] = {
+   NANOS_TASK_REDUCTION_ARRAY( add, Add, int ), NANOS_TASK_REDUCTION_ARRAY( add, Add, float ), NANOS_TASK_REDUCTION_ARRAY( add, Add, double ),
+   NANOS_TASK_REDUCTION_ARRAY( mul, Mul, int ), NANOS_TASK_REDUCTION_ARRAY( mul, Mul, float ), NANOS_TASK_REDUCTION_ARRAY( mul, Mul, double ),
+   NANOS_TASK_REDUCTION_ARRAY( min, Min, int ), NANOS_TASK_REDUCTION_ARRAY( min, Min, float ), NANOS_TASK_REDUCTION_ARRAY( min, Min, double ),
+   NANOS_TASK_REDUCTION_ARRAY( max, Max, int ), NANOS_TASK_REDUCTION_ARRAY( max, Max, float ), NANOS_TASK_REDUCTION_ARRAY( max, Max, double ),
+};
+
+//! \brief Array version of a built-in reducer, NULL for any other reducer
+static array_reducer_t findArrayReducer ( element_reducer_t reducer, size_t size_elem )
+{
+   for ( size_t i = 0; i < sizeof( builtinReducers ) / sizeof( builtinReducers[0] ); i++ ) {
+      if ( builtinReducers[i].element == reducer && builtinReducers[i].size == size_elem ) return builtinReducers[i].array;
+   }
+   return NULL;
+}
+
 NANOS_API_DEF (nanos_err_t, nanos_task_reduction_register, ( void *orig, size_t size_target, size_t size_elem,
          void (*init)( void *, void * ), void (*reducer)( void *, void * ) ) )
 {
    NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","task_reduction_register",NANOS_RUNTIME) );
    try {
-       myThread->getCurrentWD()->registerTaskReduction( orig, size_target, size_elem, init, reducer );
+       myThread->getCurrentWD()->registerTaskReduction( orig, size_target, size_elem, init, reducer,
+                                                        findArrayReducer( reducer, size_elem ) );
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -36,9 +36,12 @@ NANOS_API_DEF(nanos_err_t, nanos_worksharing_create, ( nanos_ws_desc_t **wsd, na
 {
    //NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","",NANOS_RUNTIME) ); //FIXME: To register new event
 
+   // The caller address identifies the loop, for policies that learn from previous executions
+   const void *site = __builtin_return_address( 0 );
+
    try {
-      if ( b ) *b = ((WorkSharing *) ws)->create( wsd, info );
-      else ((WorkSharing *) ws)->create( wsd, info );
+      if ( b ) *b = ((WorkSharing *) ws)->createAtSite( wsd, info, site );
+      else ((WorkSharing *) ws)->createAtSite( wsd, info, site );
    } catch ( nanos_err_t e) {
       return e;
    }
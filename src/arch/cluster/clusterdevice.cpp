@@ -67,19 +67,43 @@ void ClusterDevice::_copyIn( uint64_t devAddr, uint64_t hostAddr, std::size_t le
 
 void ClusterDevice::_copyOut( uint64_t hostAddr, uint64_t devAddr, std::size_t len, SeparateMemoryAddressSpace &mem, DeviceOps *ops, WD const *wd, void *hostObject, reg_t hostRegionId ) {
 
-   char *recvAddr = NULL;
-   do { 
-      recvAddr = (char *) sys.getNetwork()->allocateReceiveMemory( len );
-      if ( !recvAddr ) {
-         myThread->processTransfers();
+   if ( sys.getNetwork()->isPipelinedTransfer( len ) ) {
+      /* Issue one get per chunk, each one with its own receive buffer. ops
+       * will not be completed until all the chunks have arrived. */
+      std::size_t chunkSize = sys.getNetwork()->getTransferChunkSize();
+      for ( std::size_t offset = 0; offset < len; offset += chunkSize ) {
+         std::size_t thisLen = ( len - offset ) < chunkSize ? len - offset : chunkSize;
+         sys.getNetwork()->acquireTransferChunk();
+
+         char *recvAddr = NULL;
+         do {
+            recvAddr = (char *) sys.getNetwork()->allocateReceiveMemory( thisLen );
+            if ( !recvAddr ) {
+               myThread->processTransfers();
+            }
+         } while ( recvAddr == NULL );
+
+         GetRequest *newreq = NEW GetRequestChunk( (char *) hostAddr + offset, thisLen, recvAddr, ops );
+         myThread->_pendingRequests.insert( newreq );
+
+         ops->addOp();
+         sys.getNetwork()->get( ( void * ) recvAddr, mem.getNodeNumber(), devAddr + offset, thisLen, newreq, hostObject, hostRegionId );
       }
-   } while ( recvAddr == NULL );
+   } else {
+      char *recvAddr = NULL;
+      do { 
+         recvAddr = (char *) sys.getNetwork()->allocateReceiveMemory( len );
+         if ( !recvAddr ) {
+            myThread->processTransfers();
+         }
+      } while ( recvAddr == NULL );
 
-   GetRequest *newreq = NEW GetRequest( (char *) hostAddr, len, recvAddr, ops );
-   myThread->_pendingRequests.insert( newreq );
+      GetRequest *newreq = NEW GetRequest( (char *) hostAddr, len, recvAddr, ops );
+      myThread->_pendingRequests.insert( newreq );
 
-   ops->addOp();
-   sys.getNetwork()->get( ( void * ) recvAddr, mem.getNodeNumber(), devAddr, len, newreq, hostObject, hostRegionId );
+      ops->addOp();
+      sys.getNetwork()->get( ( void * ) recvAddr, mem.getNodeNumber(), devAddr, len, newreq, hostObject, hostRegionId );
+   }
 }
 
 bool ClusterDevice::_copyDevToDev( uint64_t devDestAddr, uint64_t devOrigAddr, std::size_t len, SeparateMemoryAddressSpace &memDest, SeparateMemoryAddressSpace &memOrig, DeviceOps *ops, WD const *wd, void *hostObject, reg_t hostRegionId ) {
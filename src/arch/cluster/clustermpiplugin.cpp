@@ -62,7 +62,8 @@ ClusterMPIPlugin::ClusterMPIPlugin() : ArchPlugin( "Cluster PE Plugin", 1 ),
    _nodeMem( DEFAULT_NODE_MEM ), _allocFit( false ), _allowSharedThd( false ),
    _unalignedNodeMem( false ), _gpuPresend( 1 ), _smpPresend( 1 ),
    _cachePolicy( System::DEFAULT ), _nodes( NULL ), _cpu( NULL ),
-   _clusterThread( NULL ), _gasnetSegmentSize( 0 ) {
+   _clusterThread( NULL ), _gasnetSegmentSize( 0 ), _transferChunkSize( 0 ),
+   _maxTransferChunks( 16 ) {
 }
 
 void ClusterMPIPlugin::config( Config& cfg )
@@ -97,6 +98,8 @@ int ClusterMPIPlugin::initNetwork(int *argc, char ***argv)
    sys.getNetwork()->initialize( _gasnetApi );
    sys.getNetwork()->setGpuPresend( this->getGpuPresend() );
    sys.getNetwork()->setSmpPresend( this->getSmpPresend() );
+   sys.getNetwork()->setTransferChunkSize( _transferChunkSize );
+   sys.getNetwork()->setMaxTransferChunks( _maxTransferChunks );
 
    unsigned int nodes = _gasnetApi->getNumNodes();
 
@@ -239,6 +242,14 @@ void ClusterMPIPlugin::prepare( Config& cfg ) {
    cfg.registerArgOption ( "gasnet-segment", "gasnet-segment-size" );
    cfg.registerEnvOption ( "gasnet-segment", "NX_GASNET_SEGMENT_SIZE" );
 
+   cfg.registerConfigOption ( "cluster-transfer-chunk-size", NEW Config::SizeVar ( _transferChunkSize ), "Pipeline data transfers larger than this size in chunks of this size (0 disables pipelining)." );
+   cfg.registerArgOption ( "cluster-transfer-chunk-size", "cluster-transfer-chunk-size" );
+   cfg.registerEnvOption ( "cluster-transfer-chunk-size", "NX_CLUSTER_TRANSFER_CHUNK_SIZE" );
+
+   cfg.registerConfigOption ( "cluster-transfer-max-chunks", NEW Config::PositiveVar ( _maxTransferChunks ), "Maximum number of pipelined transfer chunks in flight." );
+   cfg.registerArgOption ( "cluster-transfer-max-chunks", "cluster-transfer-max-chunks" );
+   cfg.registerEnvOption ( "cluster-transfer-max-chunks", "NX_CLUSTER_TRANSFER_MAX_CHUNKS" );
+
 }
 
 ProcessingElement * ClusterMPIPlugin::createPE( unsigned id, unsigned uid ){
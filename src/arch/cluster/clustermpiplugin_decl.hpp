@@ -49,6 +49,8 @@ class ClusterMPIPlugin : public ArchPlugin
       ext::SMPProcessor *_cpu;
       ext::SMPMultiThread *_clusterThread;
       std::size_t _gasnetSegmentSize;
+      std::size_t _transferChunkSize;
+      int _maxTransferChunks;
 
    public:
       ClusterMPIPlugin();
@@ -63,7 +63,8 @@ ClusterPlugin::ClusterPlugin() : ArchPlugin( "Cluster PE Plugin", 1 ),
    _nodeMem( DEFAULT_NODE_MEM ), _allocFit( false ), _allowSharedThd( false ),
    _unalignedNodeMem( false ), _gpuPresend( 1 ), _smpPresend( 1 ),
    _cachePolicy( System::DEFAULT ), _remoteNodes( NULL ), _cpu( NULL ),
-   _clusterThread( NULL ), _gasnetSegmentSize( 0 ) {
+   _clusterThread( NULL ), _gasnetSegmentSize( 0 ), _transferChunkSize( 0 ),
+   _maxTransferChunks( 16 ), _remoteStealing( false ) {
 }
 
 void ClusterPlugin::config( Config& cfg )
@@ -81,6 +82,9 @@ void ClusterPlugin::init()
    sys.getNetwork()->initialize( _gasnetApi );
    sys.getNetwork()->setGpuPresend(this->getGpuPresend() );
    sys.getNetwork()->setSmpPresend(this->getSmpPresend() );
+   sys.getNetwork()->setTransferChunkSize( _transferChunkSize );
+   sys.getNetwork()->setMaxTransferChunks( _maxTransferChunks );
+   sys.getNetwork()->setRemoteStealing( _remoteStealing );
 
    unsigned int nodes = _gasnetApi->getNumNodes();
 
@@ -226,6 +230,18 @@ void ClusterPlugin::prepare( Config& cfg ) {
    cfg.registerArgOption ( "gasnet-segment", "gasnet-segment-size" );
    cfg.registerEnvOption ( "gasnet-segment", "NX_GASNET_SEGMENT_SIZE" );
 
+   cfg.registerConfigOption ( "cluster-transfer-chunk-size", NEW Config::SizeVar ( _transferChunkSize ), "Pipeline data transfers larger than this size in chunks of this size (0 disables pipelining)." );
+   cfg.registerArgOption ( "cluster-transfer-chunk-size", "cluster-transfer-chunk-size" );
+   cfg.registerEnvOption ( "cluster-transfer-chunk-size", "NX_CLUSTER_TRANSFER_CHUNK_SIZE" );
+
+   cfg.registerConfigOption ( "cluster-transfer-max-chunks", NEW Config::PositiveVar ( _maxTransferChunks ), "Maximum number of pipelined transfer chunks in flight." );
+   cfg.registerArgOption ( "cluster-transfer-max-chunks", "cluster-transfer-max-chunks" );
+   cfg.registerEnvOption ( "cluster-transfer-max-chunks", "NX_CLUSTER_TRANSFER_MAX_CHUNKS" );
+
+   cfg.registerConfigOption ( "cluster-remote-steal", NEW Config::FlagOption ( _remoteStealing ), "Idle nodes steal tasks that are queued but not started in other nodes (only tasks without copies)." );
+   cfg.registerArgOption ( "cluster-remote-steal", "cluster-remote-steal" );
+   cfg.registerEnvOption ( "cluster-remote-steal", "NX_CLUSTER_REMOTE_STEAL" );
+
 }
 
 ProcessingElement * ClusterPlugin::createPE( unsigned id, unsigned uid ){
@@ -48,6 +48,9 @@ class ClusterPlugin : public ArchPlugin
       ext::SMPProcessor *_cpu;
       ext::SMPMultiThread *_clusterThread;
       std::size_t _gasnetSegmentSize;
+      std::size_t _transferChunkSize;
+      int _maxTransferChunks;
+      bool _remoteStealing;
 
    public:
       ClusterPlugin();
@@ -36,6 +36,7 @@
 #include "atomic.hpp"
 #include "netwd_decl.hpp"
 #include <cstddef>
+#include <algorithm>
 
 //#define HALF_PRESEND
 
@@ -118,6 +119,7 @@ GASNetAPI::GASNetAPI() : _net( 0 ),
    _packSegment( 0 ),
    _pinnedAllocators(),
    _pinnedAllocatorsLocks(),
+   _chunkBuffers(),
    _seqN( 0 ),
    _dataSendRequests(),
    _freeBufferReqs(),
@@ -822,7 +824,11 @@ void GASNetAPI::amFreeTmpBuffer( gasnet_token_t token,
    }
    getInstance()->_pinnedAllocatorsLocks[ src_node ]->acquire();
    getInstance()->_pinnedAllocators[ src_node ]->free( addr );
+   bool chunk = getInstance()->_chunkBuffers[ src_node ].erase( addr ) > 0;
    getInstance()->_pinnedAllocatorsLocks[ src_node ]->release();
+
+   // A pipelined put chunk is in flight until its staging buffer is free
+   if ( chunk ) getInstance()->_net->releaseTransferChunk();
    
    // XXX call notify copy wd->
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
@@ -867,6 +873,13 @@ void GASNetAPI::amRegionMetadata(gasnet_token_t token, void *arg, std::size_t ar
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
 }
 
+void GASNetAPI::amRegionMetadataBatch(gasnet_token_t token, void *arg, std::size_t argSize, gasnet_handlerarg_t numEntries, gasnet_handlerarg_t firstSeq ) {
+   DisableAM c;
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << std::endl; );
+   getInstance()->_net->notifyRegionMetaDataBatch( arg, (unsigned int) numEntries, (unsigned int) firstSeq );
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
+}
+
 void GASNetAPI::amSynchronizeDirectory(gasnet_token_t token, gasnet_handlerarg_t addrLo, gasnet_handlerarg_t addrHi ) {
    DisableAM c;
    WorkDescriptor *wds[4];
@@ -905,6 +918,21 @@ void GASNetAPI::amIdle( gasnet_token_t token ) {
    getInstance()->_net->notifyIdle( src_node );
 }
 
+void GASNetAPI::amStealRequest( gasnet_token_t token, gasnet_handlerarg_t thief, gasnet_handlerarg_t maxWDs ) {
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " thief " << thief << std::endl; );
+   getInstance()->_net->notifyStealRequest( (unsigned int) thief, (unsigned int) maxWDs );
+}
+
+void GASNetAPI::amStolenWork( gasnet_token_t token, void *buff, std::size_t nbytes, gasnet_handlerarg_t thief, gasnet_handlerarg_t numWDs ) {
+   gasnet_node_t src_node;
+   if (gasnet_AMGetMsgSource(token, &src_node) != GASNET_OK)
+   {
+      fprintf(stderr, "gasnet: Error obtaining node information.\n");
+   }
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " " << numWDs << " WDs from node " << src_node << std::endl; );
+   getInstance()->_net->notifyStolenWork( src_node, (unsigned int) thief, (unsigned int) numWDs, (void **) buff );
+}
+
 void GASNetAPI::initialize ( Network *net )
 {
    int my_argc = OS::getArgc();
@@ -937,7 +965,10 @@ void GASNetAPI::initialize ( Network *net )
       { 223, (void (*)()) amGetReplyStrided1D },
       { 224, (void (*)()) amRegionMetadata },
       { 225, (void (*)()) amSynchronizeDirectory },
-      { 226, (void (*)()) amIdle }
+      { 226, (void (*)()) amIdle },
+      { 227, (void (*)()) amRegionMetadataBatch },
+      { 228, (void (*)()) amStealRequest },
+      { 229, (void (*)()) amStolenWork }
    };
 
    gasnet_init( &my_argc, &my_argv );
@@ -992,6 +1023,7 @@ void GASNetAPI::initialize ( Network *net )
 
     _pinnedAllocators.reserve( nodes );
     _pinnedAllocatorsLocks.reserve( nodes );
+    _chunkBuffers.resize( nodes );
 
     for ( idx = 0; idx < nodes; idx += 1)
     {
@@ -1263,7 +1295,10 @@ void GASNetAPI::putStrided1D ( unsigned int remoteNode, uint64_t remoteAddr, voi
       _pinnedAllocatorsLocks[ remoteNode ]->acquire();
       tmp = _pinnedAllocators[ remoteNode ]->allocate( size * count );
       _pinnedAllocatorsLocks[ remoteNode ]->release();
-      if ( tmp == NULL ) _net->poll(0);
+      if ( tmp == NULL ) {
+         _net->getStats().addSegmentRetry( remoteNode );
+         _net->poll(0);
+      }
    }
    if ( tmp == NULL ) (myThread != NULL ? (*myThread->_file) : std::cerr) << "what... "<< tmp << std::endl; 
    _putStrided1D( gasnet_mynode(), remoteNode, remoteAddr, localAddr, localPack, size, count, ld, tmp, wdId, wd, hostObject, hostRegId, metaSeq );
@@ -1277,7 +1312,26 @@ void GASNetAPI::put ( unsigned int remoteNode, uint64_t remoteAddr, void *localA
       _pinnedAllocatorsLocks[ remoteNode ]->acquire();
       tmp = _pinnedAllocators[ remoteNode ]->allocate( size );
       _pinnedAllocatorsLocks[ remoteNode ]->release();
-      if ( tmp == NULL ) _net->poll(0);
+      if ( tmp == NULL ) {
+         _net->getStats().addSegmentRetry( remoteNode );
+         _net->poll(0);
+      }
+   }
+   _put( gasnet_mynode(), remoteNode, remoteAddr, localAddr, size, tmp, wdId, wd, hostObject, hostRegId, metaSeq );
+}
+
+void GASNetAPI::putChunk ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq )
+{
+   void *tmp = NULL;
+   while( tmp == NULL ) {
+      _pinnedAllocatorsLocks[ remoteNode ]->acquire();
+      tmp = _pinnedAllocators[ remoteNode ]->allocate( size );
+      if ( tmp != NULL ) _chunkBuffers[ remoteNode ].insert( tmp );
+      _pinnedAllocatorsLocks[ remoteNode ]->release();
+      if ( tmp == NULL ) {
+         _net->getStats().addSegmentRetry( remoteNode );
+         _net->poll(0);
+      }
    }
    _put( gasnet_mynode(), remoteNode, remoteAddr, localAddr, size, tmp, wdId, wd, hostObject, hostRegId, metaSeq );
 }
@@ -1427,7 +1481,10 @@ void GASNetAPI::sendRequestPut( unsigned int dest, uint64_t origAddr, unsigned i
       _pinnedAllocatorsLocks[ dataDest ]->acquire();
       tmpBuffer = _pinnedAllocators[ dataDest ]->allocate( len );
       _pinnedAllocatorsLocks[ dataDest ]->release();
-      if ( tmpBuffer == NULL ) _net->poll(0);
+      if ( tmpBuffer == NULL ) {
+         _net->getStats().addSegmentRetry( dataDest );
+         _net->poll(0);
+      }
    }
 
    SendDataPutRequestPayload msg( gasnet_mynode(), seq_number, (void *) origAddr, (void*) dstAddr, len, 1, 0, dataDest, wdId, tmpBuffer, wd, hostObject, hostRegId, metaSeq );
@@ -1462,7 +1519,10 @@ void GASNetAPI::sendRequestPutStrided1D( unsigned int dest, uint64_t origAddr, u
       _pinnedAllocatorsLocks[ dataDest ]->acquire();
       tmpBuffer = _pinnedAllocators[ dataDest ]->allocate( len * count );
       _pinnedAllocatorsLocks[ dataDest ]->release();
-      if ( tmpBuffer == NULL ) _net->poll(0);
+      if ( tmpBuffer == NULL ) {
+         _net->getStats().addSegmentRetry( dataDest );
+         _net->poll(0);
+      }
    }
    //NANOS_INSTRUMENT( inst1.close(); );
 
@@ -1545,6 +1605,38 @@ void GASNetAPI::sendRegionMetadata( unsigned int dest, CopyData *cd, unsigned in
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRegionMetadata done" << std::endl; );
 }
 
+void GASNetAPI::sendRegionMetadataBatch( unsigned int dest, void *buffer, std::size_t size, unsigned int numEntries, unsigned int firstSeq ) {
+   /* split the batch in as few medium messages as possible, entries are
+    * never split and keep their consecutive sequence numbers */
+   char *msgStart = (char *) buffer;
+   char *entry = msgStart;
+   char *end = msgStart + size;
+   unsigned int msgEntries = 0;
+   while ( entry != end ) {
+      std::size_t entrySize = sizeof(CopyData) + ( (CopyData *) entry )->getNumDimensions() * sizeof(nanos_region_dimension_internal_t);
+      if ( msgEntries > 0 && (std::size_t) ( entry + entrySize - msgStart ) > gasnet_AMMaxMedium() ) {
+         VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRegionMetadataBatch" << std::endl; );
+         if ( gasnet_AMRequestMedium2( dest, 227, (void *) msgStart, entry - msgStart, msgEntries, firstSeq ) != GASNET_OK )
+         {
+            fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
+         }
+         firstSeq += msgEntries;
+         msgStart = entry;
+         msgEntries = 0;
+      }
+      entry += entrySize;
+      msgEntries += 1;
+   }
+   if ( msgEntries > 0 ) {
+      VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRegionMetadataBatch" << std::endl; );
+      if ( gasnet_AMRequestMedium2( dest, 227, (void *) msgStart, entry - msgStart, msgEntries, firstSeq ) != GASNET_OK )
+      {
+         fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
+      }
+   }
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amRegionMetadataBatch done" << std::endl; );
+}
+
 void GASNetAPI::synchronizeDirectory(unsigned int dest, void *addr ) {
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amSynchronizeDirectory" << std::endl; );
    if ( gasnet_AMRequestShort2( dest, 225, ARG_LO( addr ), ARG_HI( addr ) ) != GASNET_OK )
@@ -1569,6 +1661,32 @@ void GASNetAPI::broadcastIdle() {
    }
 }
 
+void GASNetAPI::sendStealRequest( unsigned int dest, unsigned int thief, unsigned int maxWDs ) {
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amStealRequest to node " << dest << std::endl; );
+   if ( gasnet_AMRequestShort2( dest, 228, thief, maxWDs ) != GASNET_OK )
+   {
+      fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
+   }
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amStealRequest done to node " << dest << std::endl; );
+}
+
+void GASNetAPI::sendStolenWork( unsigned int dest, unsigned int thief, unsigned int numWDs, void **wdAddrs ) {
+   /* the reply is sent even if nothing could be stolen, so the master
+    * knows the steal request is over */
+   unsigned int maxPerMsg = gasnet_AMMaxMedium() / sizeof( void * );
+   unsigned int sent = 0;
+   do {
+      unsigned int count = std::min( numWDs - sent, maxPerMsg );
+      VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amStolenWork to node " << dest << std::endl; );
+      if ( gasnet_AMRequestMedium2( dest, 229, (void *) ( wdAddrs + sent ), count * sizeof( void * ), thief, count ) != GASNET_OK )
+      {
+         fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
+      }
+      VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amStolenWork done to node " << dest << std::endl; );
+      sent += count;
+   } while ( sent < numWDs );
+}
+
 std::size_t GASNetAPI::getRxBytes()
 {
    return _rxBytes;
@@ -1596,7 +1714,10 @@ void *GASNetAPI::allocateReceiveMemory( std::size_t len ) {
       getLockGlobal.acquire();
       addr = _thisNodeSegment->allocate( len );
       getLockGlobal.release();
-      if ( addr == NULL ) myThread->processTransfers();
+      if ( addr == NULL ) {
+         _net->getStats().addRecvMemoryRetry();
+         myThread->processTransfers();
+      }
    } while (addr == NULL);
    return addr;
 }
@@ -28,6 +28,7 @@
 #include "requestqueue_decl.hpp"
 #include "remoteworkdescriptor_decl.hpp"
 #include <vector>
+#include <set>
 
 extern "C" {
 #include <gasnet.h>
@@ -63,6 +64,7 @@ namespace ext {
          SimpleAllocator *_packSegment;
          std::vector< SimpleAllocator * > _pinnedAllocators;
          std::vector< Lock * > _pinnedAllocatorsLocks;
+         std::vector< std::set< void * > > _chunkBuffers;   //!< Staging buffers of pipelined put chunks, by node
          Atomic<unsigned int> *_seqN;
 
          class WorkBufferManager {
@@ -180,6 +182,7 @@ namespace ext {
          void sendWorkDoneMsg ( unsigned int dest, void const *remoteWdAddr );
          void _sendWorkDoneMsg ( unsigned int dest, void const *remoteWdAddr );
          void put ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
+         void putChunk ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
          void putStrided1D ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, void *localPack, std::size_t size, std::size_t count, std::size_t ld, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
          void get ( void *localAddr, unsigned int remoteNode, uint64_t remoteAddr, std::size_t size, GetRequest *req, CopyData const &cd );
          void getStrided1D ( void *packedAddr, unsigned int remoteNode, uint64_t remoteTag, uint64_t remoteAddr, std::size_t size, std::size_t count, std::size_t ld, GetRequestStrided *req, CopyData const &cd );
@@ -192,6 +195,7 @@ namespace ext {
          void sendRequestPut( unsigned int dest, uint64_t origAddr, unsigned int dataDest, uint64_t dstAddr, std::size_t len, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
          void sendRequestPutStrided1D( unsigned int dest, uint64_t origAddr, unsigned int dataDest, uint64_t dstAddr, std::size_t len, std::size_t count, std::size_t ld, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
          void sendRegionMetadata( unsigned int dest, CopyData *cd, unsigned int seq );
+         void sendRegionMetadataBatch( unsigned int dest, void *buffer, std::size_t size, unsigned int numEntries, unsigned int firstSeq );
 
          std::size_t getMaxGetStridedLen() const;
          std::size_t getTotalBytes();
@@ -205,6 +209,8 @@ namespace ext {
          unsigned int getNodeNum() const;
          void synchronizeDirectory( unsigned int dest, void *addr );
          void broadcastIdle();
+         void sendStealRequest( unsigned int dest, unsigned int thief, unsigned int maxWDs );
+         void sendStolenWork( unsigned int dest, unsigned int thief, unsigned int numWDs, void **wdAddrs );
 
 
          void setGASNetSegmentSize(std::size_t segmentSize);
@@ -311,8 +317,12 @@ namespace ext {
                gasnet_handlerarg_t waitObjHi);
          static void amRegionMetadata(gasnet_token_t token,
                void *arg, std::size_t argSize, gasnet_handlerarg_t seq );
+         static void amRegionMetadataBatch(gasnet_token_t token,
+               void *arg, std::size_t argSize, gasnet_handlerarg_t numEntries, gasnet_handlerarg_t firstSeq );
          static void amSynchronizeDirectory(gasnet_token_t token, gasnet_handlerarg_t addrLo, gasnet_handlerarg_t addrHi);
          static void amIdle(gasnet_token_t token);
+         static void amStealRequest(gasnet_token_t token, gasnet_handlerarg_t thief, gasnet_handlerarg_t maxWDs);
+         static void amStolenWork(gasnet_token_t token, void *buff, std::size_t nbytes, gasnet_handlerarg_t thief, gasnet_handlerarg_t numWDs);
    };
 } // namespace ext
 } // namespace nanos
@@ -45,6 +45,7 @@ size_t MPIProcessor::_cacheDefaultSize = (size_t) -1;
 size_t MPIProcessor::_alignThreshold = 128;
 size_t MPIProcessor::_alignment = 4096;
 size_t MPIProcessor::_maxWorkers = 1;
+size_t MPIProcessor::_inlineThreshold = 1024;
 std::string MPIProcessor::_mpiExecFile;
 std::string MPIProcessor::_mpiLauncherFile=NANOX_PREFIX"/bin/offload_slave_launch.sh";
 std::string MPIProcessor::_mpiNodeType;
@@ -71,6 +72,7 @@ MPIProcessor::MPIProcessor( MPI_Comm communicator, int rank, bool owner,
     _currExecutingDD(0),
     _pendingReqs(),
     _taskEndRequest(),
+    _commandFrame(),
     _commOfParents( communicatorOfParents ),
     _core(core),
     _peLock()
@@ -79,6 +81,9 @@ MPIProcessor::MPIProcessor( MPI_Comm communicator, int rank, bool owner,
     _busy.clear();
     MPI_Recv_init( &_currExecutingFunctionId, 1, MPI_INT, _rank, TAG_END_TASK, _communicator, _taskEndRequest );
 
+    // Create cache command frames persistent requests
+    _commandFrame.initialize( _rank, TAG_M2S_CACHE_COMMAND, _communicator );
+
     // Synchronize linker arrays
     if( owner ) {
         int arrSize = 0;
@@ -107,6 +112,8 @@ MPIProcessor::MPIProcessor( MPI_Comm communicator, int rank, bool owner,
 MPIProcessor::~MPIProcessor() {
     // Free taskEnd reception persistent request
     _taskEndRequest.free();
+    // Deliver pending cache commands and free frame requests
+    _commandFrame.free();
 }
 
 void MPIProcessor::prepareConfig(Config &config) {
@@ -175,6 +182,11 @@ void MPIProcessor::prepareConfig(Config &config) {
     config.registerArgOption("offl-workers", "offl-max-workers");
     config.registerEnvOption("offl-workers", "NX_OFFL_MAX_WORKERS");
 
+    config.registerConfigOption("offl-inline-threshold", NEW Config::SizeVar(_inlineThreshold), "Defines maximum size (bytes) of copy_in data that travels "
+        "together with the cache commands instead of using a separate message (default value: 1024)");
+    config.registerArgOption("offl-inline-threshold", "offl-inline-threshold");
+    config.registerEnvOption("offl-inline-threshold", "NX_OFFL_INLINE_THRESHOLD");
+
     config.registerConfigOption("offl-cache-threads", NEW Config::BoolVar(_useMultiThread), "Defines if offload processes will have an extra cache thread,"
         " this is good for applications which need data from other tasks so they don't have to wait until task in owner node finishes. "
         "(Default: False, but if this kind of behaviour is detected, the thread will be created)");
@@ -57,6 +57,10 @@ inline size_t MPIProcessor::getMaxWorkers() {
     return _maxWorkers;
 }
 
+inline size_t MPIProcessor::getInlineThreshold() {
+    return _inlineThreshold;
+}
+
 inline bool MPIProcessor::isUseMultiThread() {
     return _useMultiThread;
 }
@@ -125,6 +129,10 @@ inline mpi::persistent_request& MPIProcessor::getTaskEndRequest() {
     return _taskEndRequest;
 }
 
+inline mpi::command::CommandFrame& MPIProcessor::getCommandFrame() const {
+    return _commandFrame;
+}
+
 //Try to reserve this PE, if the one who reserves it is the same
 //which already has the PE, return true
 inline bool MPIProcessor::acquire( int dduid ) {
@@ -26,6 +26,8 @@
 #include "request.hpp"
 #include "system_decl.hpp"
 
+#include "commandframe.hpp"
+
 #include "mpithread_fwd.hpp"
 
 #include <mpi.h>
@@ -60,6 +62,7 @@ namespace ext {
             static size_t _alignThreshold;          
             static size_t _alignment;          
             static size_t _maxWorkers;
+            static size_t _inlineThreshold;
             
             MPI_Comm _communicator;
             int _rank;
@@ -75,6 +78,7 @@ namespace ext {
 
             std::list<mpi::request> _pendingReqs;
             mpi::persistent_request _taskEndRequest;
+            mutable mpi::command::CommandFrame _commandFrame;
 
             MPI_Comm _commOfParents;
 
@@ -116,6 +120,8 @@ namespace ext {
 
             static size_t getMaxWorkers();
 
+            static size_t getInlineThreshold();
+
             static bool isUseMultiThread();
             /* End config options*/           
             
@@ -189,6 +195,11 @@ namespace ext {
 
             mpi::persistent_request& getTaskEndRequest();
 
+            /**
+             * Cache commands for this remote process are batched here
+             */
+            mpi::command::CommandFrame& getCommandFrame() const;
+
             MPIThread& startMPIThread(WD* work);
             
             WD & getWorkerWD() const;
@@ -144,6 +144,7 @@ void MPIRemoteNode::nanosMPIInit(int *argc, char ***argv, int userRequired, int*
 
     nanos::mpi::command::CachePayload::initDataType();
     nanos::mpi::command::CommandPayload::initDataType();
+    nanos::mpi::command::FramePayload::initDataType();
 
     NANOS_MPI_CLOSE_IN_MPI_RUNTIME_EVENT;
 }
@@ -165,6 +166,7 @@ void MPIRemoteNode::nanosMPIFinalize() {
 
     nanos::mpi::command::CachePayload::freeDataType();
     nanos::mpi::command::CommandPayload::freeDataType();
+    nanos::mpi::command::FramePayload::freeDataType();
 
     int mpi_finalized;
     MPI_Finalized(&mpi_finalized);
@@ -164,6 +164,7 @@ class RemoteSpawn {
 				ext::MPIProcessor* remote = *itRemote;
 				//Only owner will send kill signal to the worker
 				if ( remote->isOwner() ) {
+					remote->getCommandFrame().flush();
 					mpi::command::Finish::Requestor finishCommand( *remote );
 					finishCommand.dispatch();
 				}
@@ -66,6 +66,10 @@ bool MPIThread::inlineWorkDependent(WD &wd) {
     remote.setCurrExecutingWd(&wd);
     remote.getTaskEndRequest().start();
 
+    // Cache commands batched for this task must reach
+    // the remote process before the task starts
+    remote.getCommandFrame().flush();
+
     (dd.getWorkFct())(wd.getData());
 
     //Check if any task finished
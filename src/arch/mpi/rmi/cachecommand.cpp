@@ -17,6 +17,7 @@ namespace mpi {
 namespace command {
 
 MPI_Datatype CachePayload::_type = 0;
+MPI_Datatype FramePayload::_type = 0;
 
 template <> 
 BaseServant* BaseServant::createSpecific( int source, int destination, MPI_Comm communicator, CachePayload const& data )
@@ -59,6 +60,18 @@ BaseServant* BaseServant::createSpecific( int source, int destination, MPI_Comm
 	return NULL;
 }
 
+BaseServant* BaseServant::createInline( int source, int destination, MPI_Comm communicator, CachePayload const& data, const char* inlineData )
+{
+	switch( data.getId() ) {
+		case CopyIn::id:
+			return new CopyInInlineServant( data, inlineData );
+		default:
+			fatal0( "Invalid nanos::mpi::CacheCommand id for inline data: " << data.getId() );
+	}
+	// This point should never be reached
+	return NULL;
+}
+
 } // namespace command
 } // namespace mpi
 } // namespace nanos
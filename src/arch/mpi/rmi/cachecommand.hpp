@@ -7,6 +7,7 @@
 #include "commandservant.hpp"
 #include "commandchannel.hpp"
 #include "cachepayload.hpp"
+#include "commandframe.hpp"
 
 #include "memoryaddress.hpp"
 
@@ -22,6 +23,8 @@ using namespace ext;
  * we can just forward all the arguments for CachePayload construction
  * directly as a template construction taking rvalues and/or lvalues as
  * arguments.
+ * Commands are sent through the destination's CommandFrame, which
+ * also delivers any command that was queued before.
  */
 template < int id, typename Channel >
 class CommandRequestor< id, CachePayload, Channel > {
@@ -34,14 +37,14 @@ class CommandRequestor< id, CachePayload, Channel > {
 			_data(), _channel( destination )
 		{
 			_data.initialize( id );
-			_channel.send( _data );
+			destination.getCommandFrame().send( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination, size_t size ) :
 			_data(), _channel( destination )
 		{
 			_data.initialize( id, size );
-			_channel.send( _data );
+			destination.getCommandFrame().send( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination,
@@ -50,13 +53,13 @@ class CommandRequestor< id, CachePayload, Channel > {
 			_data(), _channel( destination )
 		{
 			_data.initialize( id, hostAddr, deviceAddr, size );
-			_channel.send( _data );
+			destination.getCommandFrame().send( _data );
 		}
 
 		CommandRequestor( MPIProcessor const& destination, CachePayload const& data ) :
 			_data(data), _channel( destination )
 		{
-			_channel.send( _data );
+			destination.getCommandFrame().send( _data );
 		}
 
 		virtual ~CommandRequestor()
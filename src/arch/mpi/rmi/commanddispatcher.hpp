@@ -6,12 +6,14 @@
 
 #include "commandservant.hpp"
 #include "cachepayload.hpp"
+#include "commandframe.hpp"
 #include "commandpayload.hpp"
 
 #include "concurrent_queue.hpp"
 #include "lock.hpp"
 
 #include <mpi.h>
+#include <cstring>
 #include <list>
 #include <iostream>
 
@@ -78,6 +80,44 @@ inline iterator_range<Iterator> make_range( Iterator const& begin, size_t size )
 	return iterator_range<Iterator>(begin,size);
 }
 
+template < class Payload >
+inline void queueServants( ConcurrentQueue<BaseServant*>& queue, int source, int destination,
+                           MPI_Comm communicator, Payload const& order )
+{
+	queue.push( BaseServant::createSpecific( source, destination, communicator, order ) );
+}
+
+} // namespace detail
+
+// Defined in cachecommand.cpp
+template <>
+BaseServant* BaseServant::createSpecific( int source, int destination, MPI_Comm communicator, CachePayload const& data );
+
+namespace detail {
+
+/**
+ * Frames carry several cache commands. A servant is created
+ * for each of them, preserving the order they were issued.
+ */
+inline void queueServants( ConcurrentQueue<BaseServant*>& queue, int source, int destination,
+                           MPI_Comm communicator, FramePayload const& frame )
+{
+	const char* position = frame.data() + sizeof(FramePayload::header);
+	int numCommands = frame.getNumCommands();
+	for( int c = 0; c < numCommands; c++ ) {
+		FramePayload::entry e;
+		std::memcpy( &e, position, sizeof(e) );
+		position += sizeof(e);
+
+		if( e.inlineBytes > 0 ) {
+			queue.push( BaseServant::createInline( source, destination, communicator, e.payload, position ) );
+			position += FramePayload::alignedInlineSize( e.inlineBytes );
+		} else {
+			queue.push( BaseServant::createSpecific( source, destination, communicator, e.payload ) );
+		}
+	}
+}
+
 template < class CommandPayload, int tag >
 class SingleDispatcher {
 	private:
@@ -126,7 +166,7 @@ class SingleDispatcher {
 		void queueCommand( size_t commandIndex, MPI_Status const& status )
 		{
 			CommandPayload& order = _bufferedCommands.at( commandIndex );
-			_pendingCommands.push( BaseServant::createSpecific( status.MPI_SOURCE, _rank, _communicator, order ) );
+			queueServants( _pendingCommands, status.MPI_SOURCE, _rank, _communicator, order );
 		}
 
 		void servePendingCommands()
@@ -149,7 +189,7 @@ class Dispatcher {
 		typedef std::vector<int>                              index_storage;
 
 		typedef detail::SingleDispatcher<CommandPayload,TAG_M2S_COMMAND>     command_dispatcher;
-		typedef detail::SingleDispatcher<CachePayload,TAG_M2S_CACHE_COMMAND> cache_dispatcher;
+		typedef detail::SingleDispatcher<FramePayload,TAG_M2S_CACHE_COMMAND> cache_dispatcher;
 
 		MPI_Comm                         _communicator;
 		int                              _size;
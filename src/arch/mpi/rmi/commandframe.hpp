@@ -0,0 +1,273 @@
+
+#ifndef COMMAND_FRAME_HPP
+#define COMMAND_FRAME_HPP
+
+#include "cachepayload.hpp"
+#include "request.hpp"
+
+#include "lock.hpp"
+
+#include <cstring>
+#include <mpi.h>
+
+namespace nanos {
+namespace mpi {
+namespace command {
+
+/**
+ * Wire format of the cache command channel.
+ *
+ * Cache commands (allocate, free, copies...) are no longer sent one
+ * per message: they are packed into fixed size frames, so that
+ * several small commands only cost a single message. Each frame
+ * starts with a header and holds a sequence of entries:
+ *
+ *   | header | entry | [inline data] | entry | [inline data] | ...
+ *
+ * Each entry contains a CachePayload. Copy-in commands whose size
+ * does not exceed the inline threshold carry the data right after
+ * the entry, so they do not need a separate transfer. Bigger payloads
+ * keep using their own data channel (see CopyIn::transfer_channel_type).
+ *
+ * Frames have a constant size so that both ends can use persistent
+ * requests (MPI_Send_init/MPI_Recv_init) for the whole channel life.
+ */
+class FramePayload {
+	public:
+		static const size_t capacity = 4096;
+
+		struct header {
+			int numCommands;
+			int usedBytes;
+		};
+
+		struct entry {
+			int          inlineBytes;
+			int          reserved;
+			CachePayload payload;
+		};
+
+	private:
+		char _data[capacity];
+
+		static MPI_Datatype _type;
+
+	public:
+		char* data()
+		{
+			return _data;
+		}
+
+		const char* data() const
+		{
+			return _data;
+		}
+
+		int getNumCommands() const
+		{
+			header h;
+			std::memcpy( &h, _data, sizeof(header) );
+			return h.numCommands;
+		}
+
+		/**
+		 * Size taken by inline data inside the frame.
+		 * Keeps entries 8 byte aligned.
+		 */
+		static size_t alignedInlineSize( size_t size )
+		{
+			return (size + 7) & ~size_t(7);
+		}
+
+		/**
+		 * Biggest amount of data that can travel inline with
+		 * a single command
+		 */
+		static size_t maxInlineSize()
+		{
+			return capacity - sizeof(header) - sizeof(entry);
+		}
+
+		static MPI_Datatype getDataType()
+		{
+			return _type;
+		}
+
+		static void initDataType()
+		{
+			MPI_Type_contiguous( capacity, MPI_BYTE, &_type );
+			MPI_Type_commit( &_type );
+		}
+
+		static void freeDataType()
+		{
+			MPI_Type_free( &_type );
+		}
+};
+
+/**
+ * Sender side of the cache command channel for a remote process.
+ *
+ * Commands are accumulated in the current frame by post() and are
+ * only sent when the frame is full or flush() is called. Commands
+ * that require an immediate answer from the remote process use
+ * send(), which also delivers any command posted before them, so
+ * the remote process always serves them in the same order they were
+ * issued.
+ *
+ * Two frames are used alternatively: one can be filled while the
+ * previous is still being sent.
+ */
+class CommandFrame {
+	private:
+		static const int num_buffers = 2;
+
+		FramePayload       _buffers[num_buffers];
+		persistent_request _requests[num_buffers];
+		bool               _inFlight[num_buffers];
+		int                _current;
+		size_t             _used;
+		int                _numCommands;
+		bool               _initialized;
+
+		Lock               _lock;
+
+		// disable copy constructor and assignment operator
+		CommandFrame( CommandFrame const& );
+		CommandFrame& operator=( CommandFrame const& );
+
+		void prepareCurrent()
+		{
+			if( _inFlight[_current] ) {
+				_requests[_current].wait();
+				_inFlight[_current] = false;
+			}
+		}
+
+		void flushCurrent()
+		{
+			if( _numCommands == 0 )
+				return;
+
+			FramePayload::header h;
+			h.numCommands = _numCommands;
+			h.usedBytes = _used;
+			std::memcpy( _buffers[_current].data(), &h, sizeof(h) );
+
+			_requests[_current].start();
+			_inFlight[_current] = true;
+
+			_current = (_current + 1) % num_buffers;
+			_used = sizeof(FramePayload::header);
+			_numCommands = 0;
+		}
+
+		void append( CachePayload const& data, const void* inlineData, size_t inlineSize )
+		{
+			size_t entrySize = sizeof(FramePayload::entry) + FramePayload::alignedInlineSize( inlineSize );
+			if( _used + entrySize > FramePayload::capacity )
+				flushCurrent();
+
+			prepareCurrent();
+
+			FramePayload::entry e;
+			e.inlineBytes = inlineSize;
+			e.reserved = 0;
+			e.payload = data;
+
+			char* position = _buffers[_current].data() + _used;
+			std::memcpy( position, &e, sizeof(e) );
+			if( inlineSize > 0 )
+				std::memcpy( position + sizeof(e), inlineData, inlineSize );
+
+			_used += entrySize;
+			_numCommands++;
+		}
+
+	public:
+		CommandFrame() :
+			_current( 0 ), _used( sizeof(FramePayload::header) ),
+			_numCommands( 0 ), _initialized( false ), _lock()
+		{
+			for( int b = 0; b < num_buffers; b++ )
+				_inFlight[b] = false;
+		}
+
+		~CommandFrame()
+		{
+		}
+
+		void initialize( int destination, int tag, MPI_Comm communicator )
+		{
+			for( int b = 0; b < num_buffers; b++ ) {
+				MPI_Send_init( &_buffers[b], 1, FramePayload::getDataType(),
+				               destination, tag, communicator, _requests[b] );
+			}
+			_initialized = true;
+		}
+
+		/**
+		 * Sends the remaining commands and frees the persistent requests
+		 */
+		void free()
+		{
+			if( !_initialized )
+				return;
+
+			flush();
+			for( int b = 0; b < num_buffers; b++ ) {
+				if( _inFlight[b] ) {
+					_requests[b].wait();
+					_inFlight[b] = false;
+				}
+				_requests[b].free();
+			}
+			_initialized = false;
+		}
+
+		/**
+		 * Queues a command. It will be sent together with the
+		 * following ones.
+		 */
+		void post( CachePayload const& data )
+		{
+			LockBlock guard( _lock );
+			append( data, NULL, 0 );
+		}
+
+		/**
+		 * Queues a command together with its data. The data is copied,
+		 * so the buffer can be reused as soon as this function returns.
+		 * \pre size <= FramePayload::maxInlineSize()
+		 */
+		void post( CachePayload const& data, const void* inlineData, size_t size )
+		{
+			LockBlock guard( _lock );
+			append( data, inlineData, size );
+		}
+
+		/**
+		 * Sends a command and all the ones that were queued before it
+		 */
+		void send( CachePayload const& data )
+		{
+			LockBlock guard( _lock );
+			append( data, NULL, 0 );
+			flushCurrent();
+		}
+
+		/**
+		 * Sends all queued commands
+		 */
+		void flush()
+		{
+			LockBlock guard( _lock );
+			flushCurrent();
+		}
+};
+
+} // namespace command
+} // namespace mpi
+} // namespace nanos
+
+#endif // COMMAND_FRAME_HPP
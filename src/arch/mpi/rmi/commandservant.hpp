@@ -6,6 +6,8 @@ namespace nanos {
 namespace mpi {
 namespace command {
 
+class CachePayload;
+
 struct BaseServant {
 	/**
 	 * Perform action on the remote process
@@ -15,6 +17,12 @@ struct BaseServant {
 
 	template < typename Payload >
 	static BaseServant* createSpecific( int source, int destination, MPI_Comm communicator, Payload const& data );
+
+	/**
+	 * Creates the servant of a cache command whose data
+	 * was received inside the command frame.
+	 */
+	static BaseServant* createInline( int source, int destination, MPI_Comm communicator, CachePayload const& data, const char* inlineData );
 };
 
 template< int command_id, typename Payload, typename Channel >
@@ -5,6 +5,8 @@
 #include "cachecommand.hpp"
 #include "mpiremotenode.hpp"
 
+#include <cstring>
+#include <vector>
 #include <mpi.h>
 
 namespace nanos {
@@ -20,6 +22,8 @@ struct CopyIn : public CacheCommand<OPID_COPYIN> {
  * Specialization of the CommandRequestor for CopyIn operations, where
  * the MPIProcessor has to be saved for its dispatch, as we need to queue
  * the transfer into MPIProcessor's MPI_Request queue.
+ * Small transfers (up to MPIProcessor::getInlineThreshold() bytes) are
+ * copied inside the command frame instead, and travel with it.
  */
 template <>
 class CommandRequestor<CopyIn::id,CopyIn::payload_type,CopyIn::main_channel_type> {
@@ -27,15 +31,22 @@ class CommandRequestor<CopyIn::id,CopyIn::payload_type,CopyIn::main_channel_type
 		CopyIn::payload_type      _data;
 		CopyIn::main_channel_type _channel;
 		MPIProcessor             &_remoteProcess;
+		bool                      _inlined;
 
 	public:
 		CommandRequestor( MPIProcessor &destination, utils::Address hostAddress, utils::Address deviceAddress, size_t size ) :
 			_data(),
 			_channel( destination ),
-			_remoteProcess( destination )
+			_remoteProcess( destination ),
+			_inlined( size <= MPIProcessor::getInlineThreshold() &&
+			          size <= FramePayload::maxInlineSize() )
 		{
 			_data.initialize( CopyIn::id, MPI_ANY_SOURCE, destination.getRank(), hostAddress, deviceAddress, size );
-			_channel.send( _data );
+			if( _inlined ) {
+				destination.getCommandFrame().post( _data, hostAddress, size );
+			} else {
+				destination.getCommandFrame().send( _data );
+			}
 		}
 
 		virtual ~CommandRequestor()
@@ -63,6 +74,10 @@ class CommandRequestor<CopyIn::id,CopyIn::payload_type,CopyIn::main_channel_type
  */
 inline void CopyIn::Requestor::dispatch()
 {
+	// Data already travels with the command
+	if( _inlined )
+		return;
+
 	// We transfer the data through a different channel to avoid
 	// message collisions (uses a different tag)
 	// Source, destination and communicator remain the same
@@ -107,6 +122,37 @@ inline void CopyIn::Servant::serve()
 	NANOS_MPI_CLOSE_IN_MPI_RUNTIME_EVENT;
 }
 
+/**
+ * CopyInInlineServant
+ * Serves the CopyIn commands whose data was received inside
+ * the command frame.
+ */
+class CopyInInlineServant : public BaseServant {
+	private:
+		CopyIn::payload_type _data;
+		std::vector<char>    _buffer;
+
+	public:
+		CopyInInlineServant( CopyIn::payload_type const& data, const char* inlineData ) :
+			_data( data ), _buffer( inlineData, inlineData + data.size() )
+		{
+		}
+
+		virtual ~CopyInInlineServant()
+		{
+		}
+
+		virtual void serve()
+		{
+			NANOS_MPI_CREATE_IN_MPI_RUNTIME_EVENT(ext::NANOS_MPI_RNODE_COPYIN_EVENT);
+
+			if( !_buffer.empty() )
+				std::memcpy( _data.getDeviceAddress(), &_buffer[0], _buffer.size() );
+
+			NANOS_MPI_CLOSE_IN_MPI_RUNTIME_EVENT;
+		}
+};
+
 } // namespace command
 } // namespace mpi
 } // namespace nanos
@@ -11,10 +11,46 @@ namespace command {
 
 typedef CacheCommand<OPID_FREE> Free;
 
+/**
+ * Free::Requestor
+ * Specialization of the CommandRequestor for Free operations.
+ * The remote process does not answer to this command, so it is
+ * only queued in the MPIProcessor command frame and it will travel
+ * together with the next commands sent to that process.
+ */
+template <>
+class CommandRequestor<Free::id,Free::payload_type,Free::main_channel_type> {
+	private:
+		Free::payload_type _data;
+
+	public:
+		CommandRequestor( MPIProcessor const& destination, utils::Address deviceAddress ) :
+			_data()
+		{
+			_data.initialize( Free::id, 0, deviceAddress, 0 );
+			destination.getCommandFrame().post( _data );
+		}
+
+		virtual ~CommandRequestor()
+		{
+		}
+
+		Free::payload_type &getData()
+		{
+			return _data;
+		}
+
+		Free::payload_type const& getData() const
+		{
+			return _data;
+		}
+
+		void dispatch();
+};
+
 /**
  * No additional action required.
  */
-template<>
 inline void Free::Requestor::dispatch()
 {
 }
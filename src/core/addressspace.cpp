@@ -125,9 +125,23 @@ void SeparateAddressSpace::releaseRegions( MemCacheCopy *memCopies, unsigned int
 //}
 
 void SeparateAddressSpace::copyFromHost( TransferList &list, WD const *wd ) {
+   bool remoteNode = sys.usingCluster() && _nodeNumber != 0 && sys.getNetwork()->getNodeNum() == Network::MASTER_NODE_NUM;
+   if ( remoteNode ) {
+      /* send the metadata of all the regions in a single batch before the first transfer */
+      for ( TransferList::const_iterator it = list.begin(); it != list.end(); it++ ) {
+         AllocatedChunk *chunk = it->getDestinationChunk();
+         if ( chunk != NULL ) {
+            global_reg_t const &reg = it->getRegion();
+            sys.getNetwork()->queueRegionMetadata( _nodeNumber, reg, chunk->getAddress() + ( reg.getRealFirstAddress() - chunk->getHostAddress() ) );
+         }
+      }
+   }
    for ( TransferList::const_iterator it = list.begin(); it != list.end(); it++ ) {
       this->doOp( sys.getHostMemory(), it->getRegion(), it->getVersion(), wd, it->getCopyIndex(), it->getDeviceOps(), it->getDestinationChunk(), it->getSourceChunk(), false );
    }
+   if ( remoteNode ) {
+      sys.getNetwork()->flushRegionMetadata( _nodeNumber );
+   }
 }
 
 uint64_t SeparateAddressSpace::getDeviceAddress( global_reg_t const &reg, uint64_t baseAddress, AllocatedChunk *chunk ) const {
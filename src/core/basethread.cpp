@@ -23,6 +23,7 @@
 #include "synchronizedcondition.hpp"
 #include "wddeque.hpp"
 #include "smpthread.hpp"
+#include "mcslock.hpp"
 
 using namespace nanos;
 
@@ -38,6 +39,8 @@ void BaseThread::run ()
    /* Notify that the thread has finished all its initialization and it's ready to run */
    if ( sys.getSynchronizedStart() ) sys.threadReady();
    runDependent();
+   McsLock::releaseThreadNodes();
+   _times.stop();
    NANOS_INSTRUMENT ( sys.getInstrumentation()->threadFinish ( *this ) );
 }
 
@@ -81,6 +84,8 @@ void BaseThread::associate ( WD *wd )
    myThread = this;
    setCurrentWD( *current );
 
+   if ( sys.getThreadTimeStats().isEnabled() ) _times.start( NANOS_THREAD_EXECUTING );
+
    if ( sys.getSMPPlugin()->getBinding() ) bind();
 
    current->_mcontrol.preInit();
@@ -32,6 +32,7 @@
 #include "processingelement.hpp"
 #include "basethread_decl.hpp"
 #include "wddeque.hpp"
+#include "threadtimes.hpp"
 #include "smpthread.hpp"
 #include <stdio.h>
 
@@ -112,7 +113,7 @@ namespace nanos {
    inline BaseThread::BaseThread ( unsigned int osId, WD &wd, ProcessingElement *creator, ext::SMPMultiThread *parent ) :
       _id( sys.nextThreadId() ), _osId( osId ), _maxPrefetch( 1 ), _status( ), _parent( parent ), _pe( creator ), _mlock( ),
       _threadWD( wd ), _currentWD( NULL ), _heldWD( NULL ), _nextWDs( /* enableDeviceCounter */ false ), _teamData( NULL ), _nextTeamData( NULL ),
-      _name( "Thread" ), _description( "" ), _allocator( ), _steps(0), _bpCallBack( NULL ), _nextTeam( NULL ), _gasnetAllowAM( true ), _pendingRequests()
+      _name( "Thread" ), _description( "" ), _allocator( ), _steps(0), _bpCallBack( NULL ), _nextTeam( NULL ), _hotTeam( NULL ), _times(), _gasnetAllowAM( true ), _pendingRequests()
    {
          if ( sys.getSplitOutputForThreads() ) {
             if ( _parent != NULL ) {
@@ -305,6 +306,14 @@ namespace nanos {
 
    inline void BaseThread::setNextTeam( ThreadTeam *team ) { _nextTeam = team; }
 
+   inline ThreadTeam* BaseThread::getHotTeam() const { return _hotTeam; }
+
+   inline void BaseThread::setHotTeam( ThreadTeam *team ) { _hotTeam = team; }
+
+   inline ThreadTimes & BaseThread::getThreadTimes() { return _times; }
+
+   inline ThreadTimes const & BaseThread::getThreadTimes() const { return _times; }
+
 } // namespace nanos
 
 #endif
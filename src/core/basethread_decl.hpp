@@ -34,6 +34,7 @@
 #include "workdescriptor_decl.hpp"
 #include "allocator_decl.hpp"
 #include "wddeque_decl.hpp"
+#include "threadtimes_decl.hpp"
 
 namespace nanos {
 
@@ -200,6 +201,8 @@ namespace nanos {
          unsigned short          _steps;         //!< Number of scheduler steps (zero means infinite)
          callback_t              _bpCallBack;    //!< Break point callback. We call it after _steps scheduler ops
          ThreadTeam             *_nextTeam;      //!< If thread has no team, which team should it join
+         ThreadTeam             *_hotTeam;       //!< Last team created by this thread, kept for its next parallel region
+         ThreadTimes             _times;         //!< Wall time breakdown, when ThreadTimeStats are enabled
 
       private:
          virtual void initializeDependent () = 0;
@@ -424,6 +427,15 @@ namespace nanos {
          ThreadTeam* getNextTeam() const;
          //! \brief Set next Team to enter
          void setNextTeam( ThreadTeam *team );
+
+         //! \brief Get the team kept from the last parallel region this thread created, if any
+         ThreadTeam* getHotTeam() const;
+         //! \brief Keep a team for the next parallel region this thread creates
+         void setHotTeam( ThreadTeam *team );
+
+         //! \brief Wall time breakdown of this thread
+         ThreadTimes & getThreadTimes();
+         ThreadTimes const & getThreadTimes() const;
    };
 
    extern __thread BaseThread *myThread;
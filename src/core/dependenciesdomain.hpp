@@ -37,6 +37,7 @@ namespace nanos {
 
 inline DependenciesDomain::~DependenciesDomain ( )
 {
+   NANOS_LOCK_PROFILE( LockProfiler::unregisterLock( &_instanceLock ) )
 }
 
 inline RecursiveLock& DependenciesDomain::getInstanceLock()
@@ -106,12 +106,18 @@ using namespace dependencies_domain_internal;
       public:
         /*! \brief DependenciesDomain default constructor
          */
-         DependenciesDomain ( ) :  _id( _atomicSeed++ ) {}
+         DependenciesDomain ( ) :  _id( _atomicSeed++ )
+         {
+            NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_instanceLock, "deps-domain-instance" ) )
+         }
 
         /*! \brief DependenciesDomain copy constructor
          */
          DependenciesDomain ( const DependenciesDomain &depDomain )
-            : _id( _atomicSeed++ ) {}
+            : _id( _atomicSeed++ )
+         {
+            NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_instanceLock, "deps-domain-instance" ) )
+         }
 
         /*! \brief DependenciesDomain destructor
          */
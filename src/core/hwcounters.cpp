@@ -0,0 +1,263 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "hwcounters_decl.hpp"
+#include "workdescriptor.hpp"
+#include "config.hpp"
+#include "lock.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+using namespace nanos;
+
+struct HWCounters::ThreadCounters {
+   int                                   _fds[NUM_HW_COUNTERS];     /**< Opened events, in group read order */
+   Counter                               _counters[NUM_HW_COUNTERS];/**< Counter read at each group position */
+   unsigned int                          _numOpen;
+   bool                                  _started;
+   uint64_t                              _last[NUM_COUNTERS];
+   std::map< const char *, TypeStats >   _types;                    /**< Only touched by the owner thread */
+   ThreadCounters                       *_next;
+
+   ThreadCounters() : _numOpen( 0 ), _started( false ), _types(), _next( NULL )
+   {
+      for ( unsigned int i = 0; i < NUM_HW_COUNTERS; i++ ) _fds[i] = -1;
+      for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) _last[i] = 0;
+   }
+
+   void open()
+   {
+#if defined(__linux__) && defined(__NR_perf_event_open)
+      static const uint64_t configs[NUM_HW_COUNTERS] = {
+         PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+         PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_STALLED_CYCLES_BACKEND
+      };
+
+      for ( unsigned int c = 0; c < NUM_HW_COUNTERS; c++ ) {
+         struct perf_event_attr attr;
+         std::memset( &attr, 0, sizeof( attr ) );
+         attr.size = sizeof( attr );
+         attr.type = PERF_TYPE_HARDWARE;
+         attr.config = configs[c];
+         attr.disabled = _numOpen == 0 ? 1 : 0;
+         attr.exclude_kernel = 1;
+         attr.exclude_hv = 1;
+         attr.read_format = PERF_FORMAT_GROUP;
+
+         int groupFd = _numOpen == 0 ? -1 : _fds[0];
+         int fd = syscall( __NR_perf_event_open, &attr, 0, -1, groupFd, 0 );
+         if ( fd < 0 ) {
+            // Without the group leader (cycles) there is no group at all
+            if ( _numOpen == 0 ) return;
+            continue;
+         }
+         _fds[_numOpen] = fd;
+         _counters[_numOpen] = (Counter) c;
+         _numOpen++;
+      }
+      ioctl( _fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+      ioctl( _fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+#endif
+   }
+
+   void close()
+   {
+      for ( unsigned int i = 0; i < _numOpen; i++ ) ::close( _fds[i] );
+      _numOpen = 0;
+   }
+};
+
+namespace {
+   __thread void *myCounters = NULL;
+}
+
+HWCounters::TypeStats::TypeStats() : _tasks( 0 )
+{
+   for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) _values[i] = 0;
+}
+
+HWCounters::HWCounters() : _enabled( false ), _threads( NULL ), _threadsLock(), _hwAvailable( false ) {}
+
+HWCounters::~HWCounters()
+{
+   ThreadCounters *tc = _threads;
+   while ( tc != NULL ) {
+      ThreadCounters *next = tc->_next;
+      tc->close();
+      delete tc;
+      tc = next;
+   }
+}
+
+void HWCounters::config( Config &cfg )
+{
+   cfg.registerConfigOption( "hw-counters", NEW Config::FlagOption( _enabled ),
+                             "Measure hardware counters (perf_event_open) per task" );
+   cfg.registerArgOption( "hw-counters", "hw-counters" );
+   cfg.registerEnvOption( "hw-counters", "NX_HW_COUNTERS" );
+}
+
+bool HWCounters::isEnabled() const
+{
+   return _enabled;
+}
+
+HWCounters::ThreadCounters * HWCounters::getThreadCounters()
+{
+   ThreadCounters *tc = (ThreadCounters *) myCounters;
+   if ( tc == NULL ) {
+      tc = NEW ThreadCounters();
+      tc->open();
+
+      LockBlock lock( _threadsLock );
+      if ( tc->_numOpen > 0 ) _hwAvailable = true;
+      tc->_next = _threads;
+      _threads = tc;
+      myCounters = tc;
+   }
+   return tc;
+}
+
+void HWCounters::read( ThreadCounters &tc, uint64_t *values )
+{
+   for ( unsigned int i = 0; i < NUM_HW_COUNTERS; i++ ) values[i] = 0;
+
+   if ( tc._numOpen > 0 ) {
+      uint64_t buffer[1 + NUM_HW_COUNTERS];
+      ssize_t bytes = ::read( tc._fds[0], buffer, sizeof( buffer ) );
+      if ( bytes >= (ssize_t) sizeof( uint64_t ) ) {
+         unsigned int n = std::min( (unsigned int) buffer[0], tc._numOpen );
+         for ( unsigned int i = 0; i < n; i++ ) values[tc._counters[i]] = buffer[1 + i];
+      }
+   }
+
+   struct timespec ts;
+   clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+   values[CPU_TIME] = (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+bool HWCounters::wdSwitch( WorkDescriptor *oldWD, WorkDescriptor *newWD, bool last, uint64_t *deltas )
+{
+   ThreadCounters &tc = *getThreadCounters();
+
+   uint64_t now[NUM_COUNTERS];
+   read( tc, now );
+
+   bool charged = false;
+   if ( tc._started && oldWD != NULL ) {
+      TypeStats &type = tc._types[oldWD->getDescription()];
+      for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) {
+         deltas[i] = now[i] - tc._last[i];
+         type._values[i] += deltas[i];
+      }
+      if ( last ) type._tasks++;
+      charged = true;
+   }
+
+   for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) tc._last[i] = now[i];
+   tc._started = true;
+
+   return charged;
+}
+
+void HWCounters::getTypeStats( std::map< std::string, TypeStats > &stats )
+{
+   LockBlock lock( _threadsLock );
+   for ( ThreadCounters *tc = _threads; tc != NULL; tc = tc->_next ) {
+      for ( std::map< const char *, TypeStats >::const_iterator it = tc->_types.begin(); it != tc->_types.end(); it++ ) {
+         TypeStats &type = stats[ it->first != NULL ? it->first : "(unnamed)" ];
+         type._tasks += it->second._tasks;
+         for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) type._values[i] += it->second._values[i];
+      }
+   }
+}
+
+const char *HWCounters::getCounterName( Counter counter )
+{
+   switch ( counter ) {
+      case CYCLES:       return "cycles";
+      case INSTRUCTIONS: return "instructions";
+      case CACHE_MISSES: return "cache-misses";
+      case STALLS:       return "stalls";
+      case CPU_TIME:     return "cpu-time";
+      default:           return "unknown";
+   }
+}
+
+const char *HWCounters::getEventKey( Counter counter )
+{
+   switch ( counter ) {
+      case CYCLES:       return "hwc-cycles";
+      case INSTRUCTIONS: return "hwc-instructions";
+      case CACHE_MISSES: return "hwc-cache-misses";
+      case STALLS:       return "hwc-stalls";
+      case CPU_TIME:     return "hwc-cpu-time";
+      default:           return "";
+   }
+}
+
+std::string HWCounters::getSummary()
+{
+   std::map< std::string, TypeStats > stats;
+   getTypeStats( stats );
+
+   std::ostringstream s;
+   s << "=== Task counters";
+   if ( !_hwAvailable ) s << " (perf_event_open not available, CPU time only)";
+   s << std::endl;
+   s << "=== " << std::setw( 24 ) << std::left << "task type" << std::right
+     << std::setw( 10 ) << "tasks"
+     << std::setw( 14 ) << "cpu (ms)";
+   if ( _hwAvailable ) {
+      s << std::setw( 16 ) << "cycles"
+        << std::setw( 16 ) << "instructions"
+        << std::setw( 7 ) << "IPC"
+        << std::setw( 14 ) << "cache-misses"
+        << std::setw( 14 ) << "stalls";
+   }
+   s << std::endl;
+
+   for ( std::map< std::string, TypeStats >::const_iterator it = stats.begin(); it != stats.end(); it++ ) {
+      const TypeStats &type = it->second;
+      s << "=== " << std::setw( 24 ) << std::left << it->first << std::right
+        << std::setw( 10 ) << type._tasks
+        << std::setw( 14 ) << std::fixed << std::setprecision( 3 ) << type._values[CPU_TIME] / 1.0e6;
+      if ( _hwAvailable ) {
+         double ipc = type._values[CYCLES] > 0 ? (double) type._values[INSTRUCTIONS] / type._values[CYCLES] : 0.0;
+         s << std::setw( 16 ) << type._values[CYCLES]
+           << std::setw( 16 ) << type._values[INSTRUCTIONS]
+           << std::setw( 7 ) << std::setprecision( 2 ) << ipc
+           << std::setw( 14 ) << type._values[CACHE_MISSES]
+           << std::setw( 14 ) << type._values[STALLS];
+      }
+      s << std::endl;
+   }
+   return s.str();
+}
@@ -0,0 +1,96 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOX_HWCOUNTERS_DECL
+#define _NANOX_HWCOUNTERS_DECL
+
+#include <map>
+#include <string>
+#include <stdint.h>
+#include "lock_decl.hpp"
+#include "config_decl.hpp"
+#include "workdescriptor_fwd.hpp"
+
+namespace nanos {
+
+   /*! \brief Per task hardware counters
+    *
+    *  Every thread opens a perf_event_open group (cycles, instructions, cache
+    *  misses and backend stalls) the first time it switches WDs, and reads it
+    *  on every context switch. The deltas are attributed to the WD leaving the
+    *  thread, raised as point events and aggregated per task type (the WD
+    *  description). The thread CPU time is always measured, so when perf is not
+    *  available (not supported, or forbidden by perf_event_paranoid) the
+    *  counters degrade to that software clock only.
+    */
+   class HWCounters {
+      public:
+         enum Counter { CYCLES = 0, INSTRUCTIONS, CACHE_MISSES, STALLS, CPU_TIME, NUM_COUNTERS };
+         static const unsigned int NUM_HW_COUNTERS = CPU_TIME;
+
+         struct TypeStats {
+            uint64_t _tasks;                     /**< Finished WDs of this type */
+            uint64_t _values[NUM_COUNTERS];      /**< Accumulated counter deltas */
+
+            TypeStats();
+         };
+
+      private:
+         struct ThreadCounters;
+         typedef std::map< std::string, TypeStats > TypeStatsMap;
+
+         bool             _enabled;
+         ThreadCounters  *_threads;              /**< Counters of every thread that switched a WD */
+         Lock             _threadsLock;
+         bool             _hwAvailable;          /**< At least one thread could open the perf group */
+
+         ThreadCounters * getThreadCounters();
+         void read( ThreadCounters &tc, uint64_t *values );
+
+      private:
+         /*! \brief HWCounters copy constructor (disabled) */
+         HWCounters( HWCounters const & );
+         /*! \brief HWCounters copy assignment operator (disabled) */
+         HWCounters & operator=( HWCounters const & );
+
+      public:
+         HWCounters();
+         ~HWCounters();
+
+         void config( Config &cfg );
+         bool isEnabled() const;
+
+         /*! \brief Attributes the counters since the previous switch to oldWD
+          *  \param deltas Output, counter deltas charged to oldWD
+          *  \return false if there was no WD to charge
+          */
+         bool wdSwitch( WorkDescriptor *oldWD, WorkDescriptor *newWD, bool last, uint64_t *deltas );
+
+         /*! \brief Aggregates the per thread statistics by task type */
+         void getTypeStats( std::map< std::string, TypeStats > &stats );
+
+         static const char *getCounterName( Counter counter );
+         static const char *getEventKey( Counter counter );
+
+         std::string getSummary();
+   };
+
+} // namespace nanos
+
+#endif
@@ -373,6 +373,25 @@ void Instrumentation::wdSwitch( WorkDescriptor* oldWD, WorkDescriptor* newWD, bo
    InstrumentationContextData *old_icd = NULL;
    InstrumentationContextData *new_icd = NULL;
 
+   /* Charging hardware counters to the leaving wd (before closing its context) */
+   HWCounters &hwc = sys.getHWCounters();
+   if ( hwc.isEnabled() ) {
+      uint64_t deltas[HWCounters::NUM_COUNTERS];
+      if ( hwc.wdSwitch( oldWD, newWD, last, deltas ) ) {
+         static nanos_event_key_t hwcKeys[HWCounters::NUM_COUNTERS];
+         static bool hwcKeysLoaded = false;
+         if ( !hwcKeysLoaded ) {
+            for ( unsigned int c = 0; c < HWCounters::NUM_COUNTERS; c++ ) {
+               hwcKeys[c] = getInstrumentationDictionary()->getEventKey( HWCounters::getEventKey( (HWCounters::Counter) c ) );
+            }
+            hwcKeysLoaded = true;
+         }
+         nanos_event_value_t hwcValues[HWCounters::NUM_COUNTERS];
+         for ( unsigned int c = 0; c < HWCounters::NUM_COUNTERS; c++ ) hwcValues[c] = (nanos_event_value_t) deltas[c];
+         raisePointEvents( HWCounters::NUM_COUNTERS, hwcKeys, hwcValues );
+      }
+   }
+
 
    /* Computing number of leaving wd related events*/
    if ( oldWD!=NULL ) {
@@ -675,6 +675,28 @@ namespace nanos {
             /* 71 */ registerEventKey("cache-evict", "Cache eviction", false, EVENT_ADVANCED);
             /* 72 */ registerEventKey("copy-data-alloc","Cache allocation", false, EVENT_ADVANCED);
 
+            /* 73 */ registerEventKey("network-op", "Network operation completed", true, EVENT_ADVANCED);
+            registerEventValue("network-op", "NANOS_NETWORK_PUT", "Put issue" );               /* 1 */
+            registerEventValue("network-op", "NANOS_NETWORK_GET", "Get" );                     /* 2 */
+            registerEventValue("network-op", "NANOS_NETWORK_PUT_STRIDED", "Strided put issue" );/* 3 */
+            registerEventValue("network-op", "NANOS_NETWORK_GET_STRIDED", "Strided get" );     /* 4 */
+            registerEventValue("network-op", "NANOS_NETWORK_WORK_MSG", "Work message" );       /* 5 */
+            registerEventValue("network-op", "NANOS_NETWORK_WORK_DONE", "Work done round trip" ); /* 6 */
+            registerEventValue("network-op", "NANOS_NETWORK_DIR_SYNC", "Directory synchronization" ); /* 7 */
+            registerEventValue("network-op", "NANOS_NETWORK_WORK_STEAL", "Remote work steal round trip" ); /* 8 */
+            /* 74 */ registerEventKey("network-op-latency", "Network operation latency (ns)", true, EVENT_ADVANCED);
+            /* 75 */ registerEventKey("network-op-node", "Network operation remote node", true, EVENT_ADVANCED);
+            /* 76 */ registerEventKey("lock-site", "Lock contention: lock site", true, EVENT_ADVANCED);
+            /* 77 */ registerEventKey("lock-acquisitions", "Lock contention: acquisitions", true, EVENT_ADVANCED);
+            /* 78 */ registerEventKey("lock-contended", "Lock contention: contended acquisitions", true, EVENT_ADVANCED);
+            /* 79 */ registerEventKey("lock-spin-time", "Lock contention: cumulative spin time (ns)", true, EVENT_ADVANCED);
+            /* 80 */ registerEventKey("lock-max-spin-time", "Lock contention: maximum spin time (ns)", true, EVENT_ADVANCED);
+            /* 81 */ registerEventKey("hwc-cycles", "Task counters: cycles", true, EVENT_DEFAULT);
+            /* 82 */ registerEventKey("hwc-instructions", "Task counters: instructions", true, EVENT_DEFAULT);
+            /* 83 */ registerEventKey("hwc-cache-misses", "Task counters: cache misses", true, EVENT_DEFAULT);
+            /* 84 */ registerEventKey("hwc-stalls", "Task counters: backend stall cycles", true, EVENT_DEFAULT);
+            /* 85 */ registerEventKey("hwc-cpu-time", "Task counters: thread CPU time (ns)", true, EVENT_DEFAULT);
+
             /* ** */ registerEventKey("debug","Debug Key", true, EVENT_ADVANCED ); /* Keep this key as the last one */
          }
 
@@ -0,0 +1,135 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "livemetrics.hpp"
+#include "system.hpp"
+#include "config.hpp"
+#include "os.hpp"
+#include "debug.hpp"
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace nanos;
+
+LiveMetrics::LiveMetrics() : _enabled( false ), _name(), _segment( NULL ) {}
+
+LiveMetrics::~LiveMetrics()
+{
+   stop();
+}
+
+void LiveMetrics::config( Config &cfg )
+{
+   cfg.registerConfigOption( "live-metrics", NEW Config::FlagOption( _enabled ),
+                             "Publishes thread and scheduler metrics in a shared memory segment" );
+   cfg.registerArgOption( "live-metrics", "live-metrics" );
+   cfg.registerEnvOption( "live-metrics", "NX_LIVE_METRICS" );
+
+   cfg.registerConfigOption( "live-metrics-name", NEW Config::StringVar( _name ),
+                             "Name of the shared memory segment (default: /nanox-<pid>)" );
+   cfg.registerArgOption( "live-metrics-name", "live-metrics-name" );
+   cfg.registerEnvOption( "live-metrics-name", "NX_LIVE_METRICS_NAME" );
+}
+
+void LiveMetrics::start()
+{
+   if ( !_enabled || _segment != NULL ) return;
+
+   if ( _name.empty() ) {
+      std::ostringstream name;
+      name << "/nanox-" << getpid();
+      _name = name.str();
+   } else if ( _name[0] != '/' ) {
+      _name = "/" + _name;
+   }
+
+   int fd = shm_open( _name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644 );
+   if ( fd < 0 ) {
+      warning0( "Live metrics disabled: could not create shared memory segment " << _name << " (" << strerror( errno ) << ")" );
+      return;
+   }
+   if ( ftruncate( fd, sizeof( livemetrics::Segment ) ) != 0 ) {
+      warning0( "Live metrics disabled: could not size shared memory segment " << _name << " (" << strerror( errno ) << ")" );
+      close( fd );
+      shm_unlink( _name.c_str() );
+      return;
+   }
+   void *addr = mmap( NULL, sizeof( livemetrics::Segment ), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+   close( fd );
+   if ( addr == MAP_FAILED ) {
+      warning0( "Live metrics disabled: could not map shared memory segment " << _name << " (" << strerror( errno ) << ")" );
+      shm_unlink( _name.c_str() );
+      return;
+   }
+
+   livemetrics::Segment *segment = (livemetrics::Segment *) addr;
+   std::memset( segment, 0, sizeof( livemetrics::Segment ) );
+   segment->version = livemetrics::FORMAT_VERSION;
+   segment->maxThreads = livemetrics::MAX_THREADS;
+   segment->pid = getpid();
+   segment->threadMetricsSize = sizeof( livemetrics::ThreadMetrics );
+   segment->startTime = (int64_t) time( NULL );
+   std::string program = ( OS::getArgc() > 0 && OS::getArg( 0 ) != NULL ) ? OS::getArg( 0 ) : "";
+   size_t slash = program.find_last_of( '/' );
+   if ( slash != std::string::npos ) program = program.substr( slash + 1 );
+   std::strncpy( segment->program, program.c_str(), sizeof( segment->program ) - 1 );
+
+   // Readers check the magic last, when the rest of the header is valid
+   memoryFence();
+   std::memcpy( segment->magic, livemetrics::MAGIC, sizeof( livemetrics::MAGIC ) );
+
+   _segment = segment;
+   publishGlobals();
+
+   verbose0( "Live metrics published in shared memory segment " << _name );
+}
+
+void LiveMetrics::stop()
+{
+   if ( _segment == NULL ) return;
+
+   livemetrics::Segment *segment = _segment;
+   _segment = NULL;
+   memoryFence();
+
+   munmap( segment, sizeof( livemetrics::Segment ) );
+   shm_unlink( _name.c_str() );
+}
+
+void LiveMetrics::publishGlobals()
+{
+   livemetrics::Segment *segment = _segment;
+   if ( segment == NULL ) return;
+
+   static const double start = OS::getMonotonicTime();
+
+   livemetrics::GlobalMetrics &global = segment->global;
+   global.readyTasks = sys.getReadyNum();
+   global.totalTasks = sys.getTaskNum();
+   global.idleThreads = sys.getIdleNum();
+   global.createdTasks = sys.getCreatedTasks();
+   global.updateTime = (int64_t) ( ( OS::getMonotonicTime() - start ) * 1.0e9 );
+}
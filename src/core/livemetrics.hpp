@@ -0,0 +1,98 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LIVEMETRICS
+#define _NANOS_LIVEMETRICS
+
+#include "livemetrics_decl.hpp"
+#include "basethread.hpp"
+#include "workdescriptor.hpp"
+
+namespace nanos {
+
+inline bool LiveMetrics::isEnabled() const { return _segment != NULL; }
+
+inline std::string const & LiveMetrics::getName() const { return _name; }
+
+inline livemetrics::ThreadMetrics * LiveMetrics::getThreadMetrics() const
+{
+   if ( _segment == NULL ) return NULL;
+   BaseThread *thread = getMyThreadSafe();
+   if ( thread == NULL ) return NULL;
+   unsigned int id = (unsigned int) thread->getId();
+   return id < livemetrics::MAX_THREADS ? &_segment->threads[id] : NULL;
+}
+
+inline void LiveMetrics::taskCreated()
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm != NULL ) tm->tasksCreated++;
+}
+
+inline void LiveMetrics::taskThrottled()
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm != NULL ) tm->tasksThrottled++;
+}
+
+inline void LiveMetrics::wdSwitched( WorkDescriptor const &wd )
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm == NULL ) return;
+   tm->currentWD = wd.getId();
+   tm->state = livemetrics::THREAD_RUNNING;
+}
+
+inline void LiveMetrics::taskFinished()
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm == NULL ) return;
+   // Busy threads also publish the global statistics, but only every 256 tasks
+   if ( ( ++tm->tasksExecuted & 255 ) == 0 ) publishGlobals();
+}
+
+inline void LiveMetrics::threadIdle()
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm == NULL ) return;
+   if ( tm->state != livemetrics::THREAD_IDLE ) tm->state = livemetrics::THREAD_IDLE;
+   if ( ( ++tm->idleLoops & 1023 ) == 0 ) publishGlobals();
+}
+
+inline void LiveMetrics::copiedIn( size_t bytes )
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm != NULL ) tm->bytesIn += bytes;
+}
+
+inline void LiveMetrics::copiedOut( size_t bytes )
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm != NULL ) tm->bytesOut += bytes;
+}
+
+inline void LiveMetrics::evicted()
+{
+   livemetrics::ThreadMetrics *tm = getThreadMetrics();
+   if ( tm != NULL ) tm->evictions++;
+}
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,87 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LIVEMETRICS_DECL
+#define _NANOS_LIVEMETRICS_DECL
+
+#include <string>
+#include <stddef.h>
+#include "config_decl.hpp"
+#include "workdescriptor_fwd.hpp"
+#include "livemetrics_format.hpp"
+
+namespace nanos {
+
+   /*! \brief Live runtime metrics published in a POSIX shared memory segment
+    *
+    *  When enabled (--live-metrics) the runtime creates a shared memory segment
+    *  (see livemetrics_format.hpp) where every thread keeps its own counters
+    *  and state, and the global scheduler statistics are copied from time to
+    *  time. External tools like nanox-top can attach to it while the
+    *  application runs.
+    *
+    *  Updates are plain stores to the thread own slot: no atomic operations,
+    *  no locks, and no shared cache lines except for the occasional copy of
+    *  the global statistics. When disabled every hook is a single test.
+    */
+   class LiveMetrics {
+      private:
+         bool                   _enabled;
+         std::string            _name;         /**< Name of the shared memory segment */
+         livemetrics::Segment  *_segment;      /**< NULL when not publishing */
+
+         livemetrics::ThreadMetrics * getThreadMetrics() const;
+         void publishGlobals();
+
+      private:
+         /*! \brief LiveMetrics copy constructor (disabled) */
+         LiveMetrics( LiveMetrics const & );
+         /*! \brief LiveMetrics copy assignment operator (disabled) */
+         LiveMetrics & operator=( LiveMetrics const & );
+
+      public:
+         LiveMetrics();
+         ~LiveMetrics();
+
+         void config( Config &cfg );
+
+         /*! \brief Creates and maps the shared memory segment */
+         void start();
+         /*! \brief Unmaps and removes the segment. No thread may update metrics after it */
+         void stop();
+
+         bool isEnabled() const;
+         std::string const & getName() const;
+
+         /*! \name Hooks, called by the thread whose metrics change */
+         //@{
+         void taskCreated();
+         void taskThrottled();
+         void wdSwitched( WorkDescriptor const &wd );
+         void taskFinished();
+         void threadIdle();
+         void copiedIn( size_t bytes );
+         void copiedOut( size_t bytes );
+         void evicted();
+         //@}
+   };
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,84 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LIVEMETRICS_FORMAT_HPP
+#define _NANOS_LIVEMETRICS_FORMAT_HPP
+
+#include <stdint.h>
+
+/*! \file livemetrics_format.hpp
+ *  \brief Layout of the shared memory segment published by the live metrics
+ *  subsystem (--live-metrics) and read by nanox-top.
+ *
+ *  The segment is a single Segment structure. Every thread only writes its
+ *  own ThreadMetrics slot (one per 128 bytes, so threads never share a cache
+ *  line), and the GlobalMetrics are copied from the scheduler statistics by
+ *  whatever thread publishes them. Values are written with plain stores:
+ *  readers may see a slightly stale or inconsistent snapshot, never a torn
+ *  64-bit value.
+ */
+
+namespace nanos {
+namespace livemetrics {
+
+   static const char MAGIC[8] = { 'N', 'X', 'L', 'I', 'V', 'E', '0', '1' };
+   static const uint32_t FORMAT_VERSION = 1;
+   static const unsigned int MAX_THREADS = 512;
+
+   enum ThreadState { THREAD_UNUSED = 0, THREAD_RUNNING, THREAD_IDLE };
+
+   struct GlobalMetrics {
+      int64_t  readyTasks;
+      int64_t  totalTasks;          /**< Tasks created and not finished yet */
+      int64_t  idleThreads;
+      int64_t  createdTasks;
+      int64_t  updateTime;          /**< Nanoseconds since the start of the runtime */
+   };
+
+   struct ThreadMetrics {
+      uint64_t tasksExecuted;
+      uint64_t tasksCreated;
+      uint64_t tasksThrottled;      /**< Tasks not created due to the throttle policy */
+      uint64_t idleLoops;           /**< Iterations of the idle loop without work */
+      uint64_t bytesIn;             /**< Bytes copied to the memory space of the thread device */
+      uint64_t bytesOut;            /**< Bytes copied back from it */
+      uint64_t evictions;           /**< Device cache invalidations done by this thread */
+      int64_t  currentWD;           /**< Id of the WD being run (state == THREAD_RUNNING) */
+      uint32_t state;               /**< ThreadState */
+      int32_t  cpu;
+      char     pad[56];
+   };
+
+   struct Segment {
+      char          magic[8];
+      uint32_t      version;
+      uint32_t      maxThreads;
+      int32_t       pid;
+      uint32_t      threadMetricsSize;
+      int64_t       startTime;      /**< Seconds since the epoch */
+      char          program[64];
+      GlobalMetrics global;
+      char          pad[120];
+      ThreadMetrics threads[MAX_THREADS];
+   };
+
+} // namespace livemetrics
+} // namespace nanos
+
+#endif
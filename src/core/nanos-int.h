@@ -328,6 +328,54 @@ typedef struct nanos_lock_t {
 #endif
 } nanos_lock_t;
 
+/* Network statistics C interface. Gets and round trips are timed until they
+ * complete, puts only until they have been issued to the conduit. */
+typedef enum { NANOS_NETWORK_PUT = 0, NANOS_NETWORK_GET, NANOS_NETWORK_PUT_STRIDED, NANOS_NETWORK_GET_STRIDED,
+               NANOS_NETWORK_WORK_MSG, NANOS_NETWORK_WORK_DONE, NANOS_NETWORK_DIR_SYNC,
+               NANOS_NETWORK_WORK_STEAL,
+               NANOS_NETWORK_NUM_OPS } nanos_network_op_t;
+
+#define NANOS_NETWORK_STATS_BUCKETS 32
+
+typedef struct {
+   unsigned long long count;      /**< Number of operations */
+   unsigned long long bytes;      /**< Bytes moved by those operations */
+   unsigned long long total_ns;   /**< Accumulated latency */
+   unsigned long long max_ns;     /**< Worst latency seen */
+   unsigned long long histogram[NANOS_NETWORK_STATS_BUCKETS]; /**< histogram[i]: latency below 2^i us */
+} nanos_network_op_stats_t;
+
+/* Task type statistics C interface */
+#define NANOS_TASK_STATS_BUCKETS 32
+
+typedef struct {
+   unsigned long long total_ns;   /**< Accumulated time */
+   unsigned long long min_ns;     /**< Shortest time seen */
+   unsigned long long max_ns;     /**< Longest time seen */
+   unsigned long long histogram[NANOS_TASK_STATS_BUCKETS]; /**< histogram[i]: time below 2^i us */
+} nanos_task_time_stats_t;
+
+typedef struct {
+   unsigned long long count;                  /**< Number of finished tasks */
+   nanos_task_time_stats_t execution;         /**< From start to end of execution */
+   nanos_task_time_stats_t latency;           /**< From creation to start of execution */
+   nanos_task_time_stats_t dependence_wait;   /**< From submission until dependences were satisfied */
+} nanos_task_type_stats_t;
+
+/* Thread time breakdown C interface */
+typedef enum { NANOS_THREAD_EXECUTING = 0, NANOS_THREAD_SCHEDULING, NANOS_THREAD_SPINNING, NANOS_THREAD_BLOCKED,
+               NANOS_THREAD_NUM_TIMES } nanos_thread_time_t;
+
+#define NANOS_FIND_WORK_BUCKETS 32
+
+typedef struct {
+   unsigned long long time_ns[NANOS_THREAD_NUM_TIMES];   /**< Wall time spent in each nanos_thread_time_t */
+   unsigned long long find_work_count;                   /**< Times the thread went idle and found work */
+   unsigned long long find_work_total_ns;                /**< Accumulated time to find work */
+   unsigned long long find_work_max_ns;                  /**< Longest time to find work */
+   unsigned long long find_work_histogram[NANOS_FIND_WORK_BUCKETS]; /**< find_work_histogram[i]: time below 2^i us */
+} nanos_thread_time_stats_t;
+
 /* Translation function type  */
 typedef void (* nanos_translate_args_t) (void *, nanos_wd_t);
 
@@ -34,6 +34,7 @@
 
 #include <limits>
 #include <iomanip>
+#include <algorithm>
 
 #define VERBOSE_COMPLETION 0
 
@@ -49,9 +50,23 @@ Network::Network () : _numNodes(1), _api((NetworkAPI *) 0), _nodeNum(0),
    _deferredWorkReqsLock(), _recvSeqN(0), _waitingPutRequestsLock(),
    _waitingPutRequests(), _receivedUnmatchedPutRequests(),
    _delayedBySeqNumberPutReqs(), _delayedBySeqNumberPutReqsLock(),
-   _forwardedRegions(NULL),_gpuPresend(1), _smpPresend(1),
+   _forwardedRegions(NULL), _metadataBatches(NULL), _lastSyncReceivedWDs(0),
+   _gpuPresend(1), _smpPresend(1),
    _metadataSequenceNumbers(NULL), _recvMetadataSeq(1), _syncReqs(),
-   _syncReqsLock(), _nodeBarrierCounter(0), _parentWD(NULL) {}
+   _syncReqsLock(), _transferChunkSize(0), _maxTransferChunks(16),
+   _transferChunksInFlight(0), _stats(), _remoteStealing(false),
+   _stealableWDs(), _stealableWDsLock(), _runningRemoteWDs(0), _idleNotified(false),
+   _stealRequests(), _stealRequestsLock(), _idleNodes(), _stolenWDs(),
+   _stealStartTimes(NULL), _stealLock(), _nodeBarrierCounter(0), _parentWD(NULL)
+{
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_deferredWorkReqsLock, "network-deferred-work" ) )
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_waitingPutRequestsLock, "network-waiting-puts" ) )
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_delayedBySeqNumberPutReqsLock, "network-delayed-puts" ) )
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_syncReqsLock, "network-sync-reqs" ) )
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_stealableWDsLock, "network-steal" ) )
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_stealRequestsLock, "network-steal" ) )
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_stealLock, "network-steal" ) )
+}
 
 Network::~Network () {}
 
@@ -100,6 +115,14 @@ void Network::initialize( NetworkAPI *api )
    }
 
    _forwardedRegions = NEW RegionsForwarded[ getNumNodes()-1 ];
+   _metadataBatches = NEW MetadataBatch[ getNumNodes()-1 ];
+
+   _stats.initialize( getNumNodes() );
+
+   _stealStartTimes = NEW double[ getNumNodes() ];
+   for ( unsigned int i = 0; i < getNumNodes(); i += 1 ) {
+      _stealStartTimes[ i ] = 0.0;
+   }
 }
 
 void Network::finalize()
@@ -127,6 +150,16 @@ void Network::poll( unsigned int id)
       if ( _nodeNum != MASTER_NODE_NUM && myThread->getId() == 0 ) {
          processSyncRequests();
       }
+      if ( _remoteStealing ) {
+         if ( _nodeNum == MASTER_NODE_NUM ) {
+            processIdleNodes();
+            processStolenWDs();
+         } else {
+            processStealRequests();
+            submitHeldWDs();
+            checkIdle();
+         }
+      }
       SendDataRequest * req = _dataSendRequests.tryFetch();
       if ( req ) {
          _api->processSendDataRequest( req );
@@ -154,7 +187,11 @@ void Network::sendWorkMsg( unsigned int dest, WorkDescriptor const &wd )
       NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent( NANOS_WD_REMOTE, id, 0, 0, dest ); )
 
       std::size_t expectedData = _sentWdData.getSentData( wd.getId() );
+      flushRegionMetadata( dest );
+      double startTime = OS::getMonotonicTime();
+      _stats.workSent( dest, &wd );
       _api->sendWorkMsg( dest, wd, expectedData );
+      _stats.record( NANOS_NETWORK_WORK_MSG, dest, expectedData, startTime );
    }
 }
 
@@ -169,6 +206,9 @@ void Network::sendWorkDoneMsg( unsigned int nodeNum, void const *remoteWdAddr )
       if ( _nodeNum != MASTER_NODE_NUM )
       {
          _api->sendWorkDoneMsg( nodeNum, remoteWdAddr );
+         if ( _remoteStealing ) {
+            _runningRemoteWDs--;
+         }
       }
    }
 }
@@ -179,6 +219,7 @@ void Network::notifyWorkDone ( unsigned int nodeNum, void *remoteWdAddr, int peI
    //NANOS_INSTRUMENT ( nanos_event_id_t id = ( ((nanos_event_id_t) remoteWdAddr) ) ; )
    //NANOS_INSTRUMENT ( instr->raiseClosePtPEventNkvs( NANOS_WD_REMOTE, id, 0, NULL, NULL, nodeNum ); )
 
+   _stats.workDone( remoteWdAddr );
    ( (WD *) remoteWdAddr )->notifyOutlinedCompletion();
 }
 
@@ -186,27 +227,24 @@ void Network::put ( unsigned int remoteNode, uint64_t remoteAddr, void *localAdd
 {
    if ( _api != NULL )
    {
-      unsigned int seq = 0;
+      double startTime = OS::getMonotonicTime();
       _sentWdData.addSentData( wdId, size );
-      reg_key_t obj = sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject );
-      if ( !_forwardedRegions[remoteNode-1].isRegionForwarded( global_reg_t( hostRegId, obj ) ) ) {
-         global_reg_t reg( hostRegId, obj );
-         CopyData cd;
-         reg.fillCopyData( cd, remoteAddr - reg.getFirstAddress(0) );
-         nanos_region_dimension_internal_t dims[cd.getNumDimensions()];
-         reg.fillDimensionData( dims );
-         cd.setDimensions(dims);
-         cd.setHostRegionId( hostRegId );
-
-         seq = getMetadataSequenceNumber( remoteNode );
-         _api->sendRegionMetadata( remoteNode, &cd, seq );
-         seq += 1;
-         _forwardedRegions[remoteNode-1].addForwardedRegion( reg );
+      global_reg_t reg( hostRegId, sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject ) );
+      unsigned int seq = forwardRegionMetadata( remoteNode, reg, remoteAddr );
+      //std::cerr << " send put with seq " << seq << std::endl;
+      if ( isPipelinedTransfer( size ) ) {
+         /* Each chunk gets its own staging buffer in the remote segment, the
+          * remote node releases the WD once all the chunks have been received.
+          * A chunk stays in flight until the remote node frees its buffer. */
+         for ( std::size_t offset = 0; offset < size; offset += _transferChunkSize ) {
+            std::size_t chunkSize = ( size - offset ) < _transferChunkSize ? size - offset : _transferChunkSize;
+            acquireTransferChunk();
+            _api->putChunk( remoteNode, remoteAddr + offset, ( (char *) localAddr ) + offset, chunkSize, wdId, wd, hostObject, hostRegId, seq );
+         }
       } else {
-         seq = checkMetadataSequenceNumber( remoteNode );
+         _api->put( remoteNode, remoteAddr, localAddr, size, wdId, wd, hostObject, hostRegId, seq );
       }
-      //std::cerr << " send put with seq " << seq << std::endl;
-      _api->put( remoteNode, remoteAddr, localAddr, size, wdId, wd, hostObject, hostRegId, seq );
+      _stats.record( NANOS_NETWORK_PUT, remoteNode, size, startTime );
    }
 }
 
@@ -214,26 +252,12 @@ void Network::putStrided1D ( unsigned int remoteNode, uint64_t remoteAddr, void
 {
    if ( _api != NULL )
    {
-      unsigned int seq = 0;
+      double startTime = OS::getMonotonicTime();
       _sentWdData.addSentData( wdId, size * count );
-      reg_key_t obj = sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject );
-      if ( !_forwardedRegions[remoteNode-1].isRegionForwarded( global_reg_t( hostRegId, obj ) ) ) {
-         global_reg_t reg( hostRegId, obj );
-         CopyData cd;
-         reg.fillCopyData( cd, remoteAddr - reg.getFirstAddress(0) );
-         nanos_region_dimension_internal_t dims[cd.getNumDimensions()];
-         reg.fillDimensionData( dims );
-         cd.setDimensions(dims);
-         cd.setHostRegionId( hostRegId );
-
-         seq = getMetadataSequenceNumber( remoteNode );
-         _api->sendRegionMetadata( remoteNode, &cd, seq );
-         seq += 1;
-         _forwardedRegions[remoteNode-1].addForwardedRegion( reg );
-      } else {
-         seq = checkMetadataSequenceNumber( remoteNode );
-      }
+      global_reg_t reg( hostRegId, sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject ) );
+      unsigned int seq = forwardRegionMetadata( remoteNode, reg, remoteAddr );
       _api->putStrided1D( remoteNode, remoteAddr, localAddr, localPack, size, count, ld, wdId, wd, hostObject, hostRegId, seq );
+      _stats.record( NANOS_NETWORK_PUT_STRIDED, remoteNode, size * count, startTime );
    }
 }
 
@@ -249,8 +273,12 @@ void Network::get ( void *localAddr, unsigned int remoteNode, uint64_t remoteAdd
       reg.fillDimensionData( dims );
       cd.setDimensions(dims);
       cd.setHostRegionId( hostRegId );
+      _metadataBatches[remoteNode-1]._lock.acquire();
       _forwardedRegions[remoteNode-1].addForwardedRegion( reg );
+      _metadataBatches[remoteNode-1]._lock.release();
 
+      req->_remoteNode = remoteNode;
+      req->_issueTime = OS::getMonotonicTime();
       _api->get( localAddr, remoteNode, remoteAddr, size, req, cd );
    }
 }
@@ -267,8 +295,12 @@ void Network::getStrided1D ( void *packedAddr, unsigned int remoteNode, uint64_t
       reg.fillDimensionData( dims );
       cd.setDimensions(dims);
       cd.setHostRegionId( hostRegId );
+      _metadataBatches[remoteNode-1]._lock.acquire();
       _forwardedRegions[remoteNode-1].addForwardedRegion( reg );
+      _metadataBatches[remoteNode-1]._lock.release();
 
+      req->_remoteNode = remoteNode;
+      req->_issueTime = OS::getMonotonicTime();
       _api->getStrided1D( packedAddr, remoteNode, remoteTag, remoteAddr, size, count, ld, req, cd );
    }
 }
@@ -382,26 +414,8 @@ void Network::sendRequestPut( unsigned int dest, uint64_t origAddr, unsigned int
    {
       _sentWdData.addSentData( wdId, len );
       //(*myThread->_file) << __func__ << " hostObject " << (void *) hostObject << " from node " << dest << " to node " << dataDest << std::endl;
-      // added
-      unsigned int seq = 0;
-      reg_key_t obj = sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject );
-      if ( !_forwardedRegions[dataDest-1].isRegionForwarded( global_reg_t( hostRegId, obj ) ) ) {
-         global_reg_t reg( hostRegId, obj );
-         CopyData cd;
-         reg.fillCopyData( cd, dstAddr - reg.getFirstAddress(0) );
-         nanos_region_dimension_internal_t dims[cd.getNumDimensions()];
-         reg.fillDimensionData( dims );
-         cd.setDimensions(dims);
-         cd.setHostRegionId( hostRegId );
-
-         seq = getMetadataSequenceNumber( dataDest );
-         _api->sendRegionMetadata( dataDest, &cd, seq );
-         seq += 1;
-         _forwardedRegions[dataDest-1].addForwardedRegion( reg );
-      } else {
-         seq = checkMetadataSequenceNumber( dataDest );
-      }
-      // added
+      global_reg_t reg( hostRegId, sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject ) );
+      forwardRegionMetadata( dataDest, reg, dstAddr );
       _api->sendRequestPut( dest, origAddr, dataDest, dstAddr, len, wdId, wd, hostObject, hostRegId, 0 );
    }
 }
@@ -411,24 +425,8 @@ void Network::sendRequestPutStrided1D( unsigned int dest, uint64_t origAddr, uns
    if ( _api != NULL )
    {
       _sentWdData.addSentData( wdId, len * count );
-      unsigned int seq = 0;
-      reg_key_t obj = sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject );
-      if ( !_forwardedRegions[dataDest-1].isRegionForwarded( global_reg_t( hostRegId, obj ) ) ) {
-         global_reg_t reg( hostRegId, obj );
-         CopyData cd;
-         reg.fillCopyData( cd, dstAddr - reg.getFirstAddress(0) );
-         nanos_region_dimension_internal_t dims[cd.getNumDimensions()];
-         reg.fillDimensionData( dims );
-         cd.setDimensions(dims);
-         cd.setHostRegionId( hostRegId );
-
-         seq = getMetadataSequenceNumber( dataDest );
-         _api->sendRegionMetadata( dataDest, &cd, seq );
-         seq += 1;
-         _forwardedRegions[dataDest-1].addForwardedRegion( reg );
-      } else {
-         seq = checkMetadataSequenceNumber( dataDest );
-      }
+      global_reg_t reg( hostRegId, sys.getHostMemory().getRegionDirectoryKey( (uint64_t) hostObject ) );
+      forwardRegionMetadata( dataDest, reg, dstAddr );
       _api->sendRequestPutStrided1D( dest, origAddr, dataDest, dstAddr, len, count, ld, wdId, wd, hostObject, hostRegId, 0 );
    }
 }
@@ -494,6 +492,7 @@ void Network::freeReceiveMemory( void * addr ) {
 
 // API -> system mechanisms
 Network::ReceivedWDData::ReceivedWDData() : _recvWdDataMap(), _lock(), _receivedWDs( 0 ) {
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_lock, "network-received-wds" ) )
 }
 
 Network::ReceivedWDData::~ReceivedWDData() {
@@ -512,8 +511,7 @@ void Network::ReceivedWDData::addData( unsigned int wdId, std::size_t size, WD *
       NANOS_INSTRUMENT ( nanos_event_id_t id = ( ((nanos_event_id_t) wdId)  )  ; )
       NANOS_INSTRUMENT ( instr->createDeferredPtPEnd ( *wd, NANOS_WD_REMOTE, id, 0, 0, 0 ); )
       NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent ( NANOS_WD_DOMAIN, (nanos_event_id_t) wdId, 0, 0 );)
-      sys.setupWD( *wd, parent );
-      sys.submit( *wd );
+      sys.getNetwork()->releaseReceivedWD( *wd, parent );
       _receivedWDs++;
       //std::cerr <<"["<< gasnet_mynode()<< "] release wd (by data) new seq is " << _recvSeqN.value()   << std::endl;
    } else {
@@ -535,8 +533,7 @@ void Network::ReceivedWDData::addWD( unsigned int wdId, WorkDescriptor *wd, std:
       NANOS_INSTRUMENT ( nanos_event_id_t id = ( ((nanos_event_id_t) wdId)  )  ; )
       NANOS_INSTRUMENT ( instr->createDeferredPtPEnd ( *wd, NANOS_WD_REMOTE, id, 0, 0, 0 ); )
       NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent ( NANOS_WD_DOMAIN, (nanos_event_id_t) wdId, 0, 0 );)
-      sys.setupWD( *wd, parent );
-      sys.submit( *wd );
+      sys.getNetwork()->releaseReceivedWD( *wd, parent );
       _receivedWDs++;
    //std::cerr <<"["<< gasnet_mynode()<< "] release wd (by wd) new seq is " << _recvSeqN.value()   << std::endl;
    } else {
@@ -549,6 +546,7 @@ unsigned int Network::ReceivedWDData::getReceivedWDsCount() const {
 }
 
 Network::SentWDData::SentWDData() : _sentWdDataMap(), _lock() {
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_lock, "network-sent-wds" ) )
 }
 
 Network::SentWDData::~SentWDData() {
@@ -879,7 +877,7 @@ unsigned int Network::updateMetadataSequenceNumber( unsigned int value )  {
 }
 
 GetRequest::GetRequest( char* hostAddr, std::size_t size, char *recvAddr, DeviceOps *ops ) : _complete(0),
-   _hostAddr( hostAddr ), _size( size ), _recvAddr( recvAddr ), _ops( ops ) {
+   _hostAddr( hostAddr ), _size( size ), _recvAddr( recvAddr ), _ops( ops ), _remoteNode( 0 ), _issueTime( 0.0 ) {
 }
 
 GetRequest::~GetRequest() {
@@ -907,6 +905,7 @@ void GetRequest::clear() {
       (*myThread->_file) << std::setprecision(std::numeric_limits<double>::digits10) << OS::getMonotonicTime() << " Completed copyOut request, hostAddr="<< (void*)_hostAddr <<" ["<< *((double*) _hostAddr) <<"] ops=" << (void *) _ops << std::endl;
    }
    sys.getNetwork()->freeReceiveMemory( _recvAddr );
+   sys.getNetwork()->getStats().record( NANOS_NETWORK_GET, _remoteNode, _size, _issueTime );
    _ops->completeOp();
 }
 
@@ -927,9 +926,22 @@ void GetRequestStrided::clear() {
    }
    //NANOS_INSTRUMENT( inst2.close(); );
    _packer->free_pack( (uint64_t) _hostAddr, _size, _count, _recvAddr );
+   sys.getNetwork()->getStats().record( NANOS_NETWORK_GET_STRIDED, _remoteNode, _size * _count, _issueTime );
    _ops->completeOp();
 }
 
+GetRequestChunk::GetRequestChunk( char* hostAddr, std::size_t size, char *recvAddr, DeviceOps *ops ) :
+   GetRequest( hostAddr, size, recvAddr, ops ) {
+}
+
+GetRequestChunk::~GetRequestChunk() {
+}
+
+void GetRequestChunk::clear() {
+   GetRequest::clear();
+   sys.getNetwork()->releaseTransferChunk();
+}
+
 void Network::notifyRegionMetaData( CopyData *cd, unsigned int seq ) {
    global_reg_t reg;
    if ( seq ) {
@@ -966,6 +978,7 @@ int Network::getSmpPresend() const {
 void Network::deleteDirectoryObject( GlobalRegionDictionary const *obj ) {
    global_reg_t reg( 1, obj );
    for (unsigned int idx = 0; idx < getNumNodes()-1; idx += 1) {
+      LockBlock lock( _metadataBatches[ idx ]._lock );
       _forwardedRegions[ idx ].removeForwardedRegion( reg );
       //annotate wich metadata seq number we are, then those messages increasing the value should have the syncDir bool set
    }
@@ -973,12 +986,18 @@ void Network::deleteDirectoryObject( GlobalRegionDictionary const *obj ) {
 
 void Network::synchronizeDirectory( void *addr ) {
    if ( this->getNodeNum() == 0 ) { //this is called by the slaves by the handler of this message, avoid the recursive call
+      double startTime = OS::getMonotonicTime();
       if ( _api != NULL ) {
          for (unsigned int idx = 1; idx < getNumNodes(); idx += 1) {
             _api->synchronizeDirectory( idx, addr );
          }
       }
       this->nodeBarrier(); //slave node barrier is in notifySynchronizeDirectory
+      if ( _api != NULL ) {
+         for (unsigned int idx = 1; idx < getNumNodes(); idx += 1) {
+            _stats.record( NANOS_NETWORK_DIR_SYNC, idx, 0, startTime );
+         }
+      }
    }
 }
 
@@ -1003,13 +1022,22 @@ void Network::processSyncRequests() {
                _syncReqs.pop_front();
                _syncReqsLock.release();
 
-               for ( unsigned int idx = 0; idx < s.getNumWDs(); idx += 1 ) {
-                  if ( s.getAddr() != NULL ) {
-                     sys.getHostMemory().synchronize( *(s.getWDs()[idx]), s.getAddr() );
-                  } else {
-                     sys.getHostMemory().synchronize( *(s.getWDs()[idx]) );
+               /* Only the WDs received from the master can modify data in
+                * this node, if none arrived since the last full
+                * synchronization there is nothing new to flush back */
+               unsigned int receivedWDs = _recvWdData.getReceivedWDsCount();
+               if ( receivedWDs != _lastSyncReceivedWDs ) {
+                  for ( unsigned int idx = 0; idx < s.getNumWDs(); idx += 1 ) {
+                     if ( s.getAddr() != NULL ) {
+                        sys.getHostMemory().synchronize( *(s.getWDs()[idx]), s.getAddr() );
+                     } else {
+                        sys.getHostMemory().synchronize( *(s.getWDs()[idx]) );
+                     }
                   }
                }
+               if ( s.getAddr() == NULL ) {
+                  _lastSyncReceivedWDs = receivedWDs;
+               }
                this->nodeBarrier(); //matches the call in synchronizeDirectory
             } else {
                _syncReqsLock.release();
@@ -1024,5 +1052,262 @@ void Network::setParentWD(WD *wd) {
 }
 
 void Network::notifyIdle( unsigned int node ) {
-   sys.notifyIdle( node );
+   if ( _remoteStealing ) {
+      /* only the master dispatches work, slaves ignore idle messages */
+      if ( _nodeNum == MASTER_NODE_NUM ) {
+         LockBlock lock( _stealLock );
+         _idleNodes.push_back( node );
+      }
+   } else {
+      sys.notifyIdle( node );
+   }
+}
+
+void Network::setTransferChunkSize( std::size_t size ) {
+   _transferChunkSize = size;
+}
+
+std::size_t Network::getTransferChunkSize() const {
+   return _transferChunkSize;
+}
+
+void Network::setMaxTransferChunks( unsigned int chunks ) {
+   _maxTransferChunks = chunks > 0 ? chunks : 1;
+}
+
+unsigned int Network::getMaxTransferChunks() const {
+   return _maxTransferChunks;
+}
+
+bool Network::isPipelinedTransfer( std::size_t size ) const {
+   return _transferChunkSize != 0 && size > _transferChunkSize;
+}
+
+void Network::acquireTransferChunk() {
+   unsigned int inFlight = _transferChunksInFlight.value();
+   while ( inFlight >= _maxTransferChunks || !_transferChunksInFlight.cswap( inFlight, inFlight + 1 ) ) {
+      if ( inFlight >= _maxTransferChunks ) {
+         myThread->processTransfers();
+      }
+      inFlight = _transferChunksInFlight.value();
+   }
+}
+
+void Network::releaseTransferChunk() {
+   _transferChunksInFlight--;
+}
+
+NetworkStats &Network::getStats() {
+   return _stats;
+}
+
+void Network::_queueRegionMetadata( unsigned int dest, global_reg_t const &reg, uint64_t remoteAddr ) {
+   if ( !_forwardedRegions[dest-1].isRegionForwarded( reg ) ) {
+      MetadataBatch &batch = _metadataBatches[dest-1];
+      CopyData cd;
+      reg.fillCopyData( cd, remoteAddr - reg.getFirstAddress(0) );
+      cd.setHostRegionId( reg.id );
+
+      std::size_t dimsSize = cd.getNumDimensions() * sizeof( nanos_region_dimension_internal_t );
+      std::size_t offset = batch._buffer.size();
+      batch._buffer.resize( offset + sizeof( CopyData ) + dimsSize );
+      ::memcpy( &batch._buffer[ offset ], &cd, sizeof( CopyData ) );
+      reg.fillDimensionData( (nanos_region_dimension_internal_t *) &batch._buffer[ offset + sizeof( CopyData ) ] );
+
+      unsigned int seq = getMetadataSequenceNumber( dest );
+      if ( batch._numEntries == 0 ) {
+         batch._firstSeq = seq;
+      }
+      batch._numEntries += 1;
+      _forwardedRegions[dest-1].addForwardedRegion( reg );
+   }
+}
+
+void Network::_flushRegionMetadata( unsigned int dest ) {
+   MetadataBatch &batch = _metadataBatches[dest-1];
+   if ( batch._numEntries > 0 ) {
+      _api->sendRegionMetadataBatch( dest, &batch._buffer[0], batch._buffer.size(), batch._numEntries, batch._firstSeq );
+      batch._buffer.clear();
+      batch._numEntries = 0;
+   }
+}
+
+void Network::queueRegionMetadata( unsigned int dest, global_reg_t const &reg, uint64_t remoteAddr ) {
+   if ( _api != NULL ) {
+      LockBlock lock( _metadataBatches[dest-1]._lock );
+      _queueRegionMetadata( dest, reg, remoteAddr );
+   }
+}
+
+void Network::flushRegionMetadata( unsigned int dest ) {
+   if ( _api != NULL ) {
+      LockBlock lock( _metadataBatches[dest-1]._lock );
+      _flushRegionMetadata( dest );
+   }
+}
+
+unsigned int Network::forwardRegionMetadata( unsigned int dest, global_reg_t const &reg, uint64_t remoteAddr ) {
+   LockBlock lock( _metadataBatches[dest-1]._lock );
+   _queueRegionMetadata( dest, reg, remoteAddr );
+   _flushRegionMetadata( dest );
+   /* operations depending on this region must wait for all the metadata sent so far */
+   return checkMetadataSequenceNumber( dest );
+}
+
+void Network::notifyRegionMetaDataBatch( void *buffer, unsigned int numEntries, unsigned int firstSeq ) {
+   char *entry = (char *) buffer;
+   for ( unsigned int idx = 0; idx < numEntries; idx += 1 ) {
+      CopyData *cd = (CopyData *) entry;
+      entry += sizeof( CopyData );
+      cd->setDimensions( (nanos_region_dimension_internal_t *) entry );
+      entry += cd->getNumDimensions() * sizeof( nanos_region_dimension_internal_t );
+      notifyRegionMetaData( cd, firstSeq + idx );
+   }
+}
+
+void Network::setRemoteStealing( bool enable ) {
+   _remoteStealing = enable;
+}
+
+bool Network::isRemoteStealingEnabled() const {
+   return _remoteStealing;
+}
+
+void Network::releaseReceivedWD( WD &wd, WD *parent ) {
+   if ( _remoteStealing ) {
+      LockBlock lock( _stealableWDsLock );
+      _idleNotified = false;
+      /* WDs with copies can not be stolen, their data is already here and
+       * the master cache has them registered for this node */
+      if ( wd.getNumCopies() == 0 &&
+            ( !_stealableWDs.empty() || _runningRemoteWDs.value() >= (unsigned int) sys.getNumThreads() ) ) {
+         _stealableWDs.push_back( &wd );
+         return;
+      }
+      _runningRemoteWDs++;
+   }
+   sys.setupWD( wd, parent );
+   sys.submit( wd );
+}
+
+void Network::submitHeldWDs() {
+   while ( !_stealableWDs.empty() && _runningRemoteWDs.value() < (unsigned int) sys.getNumThreads() ) {
+      WD *wd = NULL;
+      if ( !_stealableWDsLock.tryAcquire() ) return;
+      if ( !_stealableWDs.empty() && _runningRemoteWDs.value() < (unsigned int) sys.getNumThreads() ) {
+         wd = _stealableWDs.front();
+         _stealableWDs.pop_front();
+         _runningRemoteWDs++;
+      }
+      _stealableWDsLock.release();
+      if ( wd != NULL ) {
+         sys.setupWD( *wd, _parentWD );
+         sys.submit( *wd );
+      }
+   }
+}
+
+void Network::checkIdle() {
+   bool idle = false;
+   /* do not report idle before the first WD arrives */
+   if ( !_idleNotified && _runningRemoteWDs.value() == 0 && _recvWdData.getReceivedWDsCount() > 0 ) {
+      LockBlock lock( _stealableWDsLock );
+      if ( !_idleNotified && _stealableWDs.empty() && _runningRemoteWDs.value() == 0 ) {
+         _idleNotified = true;
+         idle = true;
+      }
+   }
+   if ( idle ) {
+      _api->broadcastIdle();
+   }
+}
+
+void Network::notifyStealRequest( unsigned int thief, unsigned int maxWDs ) {
+   LockBlock lock( _stealRequestsLock );
+   _stealRequests.push_back( std::make_pair( thief, maxWDs ) );
+}
+
+void Network::processStealRequests() {
+   if ( _stealRequests.empty() || !_stealRequestsLock.tryAcquire() ) return;
+   std::list< std::pair< unsigned int, unsigned int > > requests;
+   requests.swap( _stealRequests );
+   _stealRequestsLock.release();
+
+   for ( std::list< std::pair< unsigned int, unsigned int > >::const_iterator it = requests.begin(); it != requests.end(); it++ ) {
+      std::vector< WD * > stolen;
+      {
+         /* give away at most half of the held WDs, taken from the back so
+          * the oldest ones still run here */
+         LockBlock lock( _stealableWDsLock );
+         std::size_t count = std::min( (std::size_t) it->second, ( _stealableWDs.size() + 1 ) / 2 );
+         for ( std::size_t idx = 0; idx < count; idx += 1 ) {
+            stolen.push_back( _stealableWDs.back() );
+            _stealableWDs.pop_back();
+         }
+      }
+      std::vector< void * > addrs( stolen.size() );
+      for ( std::size_t idx = 0; idx < stolen.size(); idx += 1 ) {
+         addrs[ idx ] = (void *) stolen[ idx ]->getRemoteAddr();
+         stolen[ idx ]->~WorkDescriptor();
+         delete[] (char *) stolen[ idx ];
+      }
+      _api->sendStolenWork( MASTER_NODE_NUM, it->first, addrs.size(), addrs.empty() ? NULL : &addrs[ 0 ] );
+   }
+}
+
+void Network::processIdleNodes() {
+   if ( _idleNodes.empty() || !_stealLock.tryAcquire() ) return;
+   std::list< unsigned int > idleNodes;
+   idleNodes.swap( _idleNodes );
+   _stealLock.release();
+
+   for ( std::list< unsigned int >::const_iterator it = idleNodes.begin(); it != idleNodes.end(); it++ ) {
+      unsigned int thief = *it;
+      unsigned int victim = MASTER_NODE_NUM;
+      unsigned int victimWork = 1; /* a node with a single WD has nothing to give */
+      for ( unsigned int node = 1; node < getNumNodes(); node += 1 ) {
+         if ( node == thief ) continue;
+         unsigned int work = _stats.getPendingWork( node );
+         if ( work > victimWork ) {
+            victim = node;
+            victimWork = work;
+         }
+      }
+      if ( victim == MASTER_NODE_NUM ) continue;
+
+      {
+         LockBlock lock( _stealLock );
+         if ( _stealStartTimes[ thief ] != 0.0 ) continue; /* steal already in progress */
+         _stealStartTimes[ thief ] = OS::getMonotonicTime();
+      }
+      _api->sendStealRequest( victim, thief, _smpPresend );
+   }
+}
+
+void Network::notifyStolenWork( unsigned int victim, unsigned int thief, unsigned int numWDs, void **wdAddrs ) {
+   double startTime;
+   {
+      LockBlock lock( _stealLock );
+      for ( unsigned int idx = 0; idx < numWDs; idx += 1 ) {
+         _stolenWDs.push_back( std::make_pair( thief, (WD *) wdAddrs[ idx ] ) );
+      }
+      startTime = _stealStartTimes[ thief ];
+      _stealStartTimes[ thief ] = 0.0;
+   }
+   if ( startTime != 0.0 ) {
+      _stats.record( NANOS_NETWORK_WORK_STEAL, victim, numWDs * sizeof( void * ), startTime );
+   }
+}
+
+void Network::processStolenWDs() {
+   if ( _stolenWDs.empty() || !_stealLock.tryAcquire() ) return;
+   std::list< std::pair< unsigned int, WD * > > stolen;
+   stolen.swap( _stolenWDs );
+   _stealLock.release();
+
+   /* The WDs stay tied to the cluster thread of the victim node, their
+    * completion is still accounted in its running queue */
+   for ( std::list< std::pair< unsigned int, WD * > >::const_iterator it = stolen.begin(); it != stolen.end(); it++ ) {
+      sendWorkMsg( it->first, *it->second );
+   }
 }
@@ -24,6 +24,8 @@
 #include <string>
 #include <set>
 #include <list>
+#include <deque>
+#include <map>
 #include <vector>
 #include "functor_decl.hpp"
 #include "globalregt_decl.hpp"
@@ -31,6 +33,7 @@
 #include "networkapi.hpp"
 #include "packer_decl.hpp"
 #include "deviceops_decl.hpp"
+#include "networkstats_decl.hpp"
 #include "debug.hpp"
 
 namespace nanos {
@@ -73,6 +76,8 @@ namespace nanos {
       std::size_t _size;
       char* _recvAddr;
       DeviceOps *_ops;
+      unsigned int _remoteNode;
+      double _issueTime;
 
       GetRequest( char* hostAddr, std::size_t size, char *recvAddr, DeviceOps *ops );
       virtual ~GetRequest();
@@ -93,38 +98,49 @@ namespace nanos {
       virtual void clear();
    };
 
+   /*! \brief One chunk of a pipelined get
+    *  Releases its transfer slot back to the Network once the chunk has been
+    *  copied to its final destination.
+    */
+   struct GetRequestChunk : public GetRequest {
+      GetRequestChunk( char* hostAddr, std::size_t size, char *recvAddr, DeviceOps *ops );
+      virtual ~GetRequestChunk();
+
+      virtual void clear();
+   };
+
+   /*! \brief Regions whose metadata has already been sent to a remote node
+    *  Region ids are dense within a dictionary, so each dictionary keeps a
+    *  bitmap of the known reg_t instead of an ordered set.
+    */
    class RegionsForwarded {
-      std::map< const_reg_key_t, std::set< reg_t > > _regions;
+      typedef std::vector< uint64_t > RegionBitmap;
+      std::map< const_reg_key_t, RegionBitmap > _regions;
 
       public:
 
       bool isRegionForwarded( global_reg_t const &reg ) const {
          bool result = false;
-         std::map< const_reg_key_t, std::set< reg_t > >::const_iterator it = _regions.find( reg.key );
+         std::map< const_reg_key_t, RegionBitmap >::const_iterator it = _regions.find( reg.key );
          if ( it != _regions.end() ) {
-            result = ( it->second.end() != it->second.find( reg.id ) );
+            std::size_t word = reg.id / 64;
+            result = word < it->second.size() && ( it->second[ word ] & ( ( (uint64_t) 1 ) << ( reg.id % 64 ) ) ) != 0;
          }
          return result;
       }
 
       void addForwardedRegion( global_reg_t const &reg ) {
-         std::map< const_reg_key_t, std::set< reg_t > >::iterator it = _regions.lower_bound( reg.key );
-         if ( it == _regions.end() || _regions.key_comp()( reg.key, it->first ) ) {
-            it = _regions.insert( it, std::map< const_reg_key_t, std::set< reg_t > >::value_type( reg.key, std::set< reg_t >() ) );
-         }
-         std::set< reg_t >::iterator sit = it->second.lower_bound( reg.id );
-         if ( sit == it->second.end() || it->second.key_comp()( reg.id, *sit ) ) {
-            sit = it->second.insert( sit, reg.id );
+         RegionBitmap &bitmap = _regions[ reg.key ];
+         std::size_t word = reg.id / 64;
+         if ( word >= bitmap.size() ) {
+            bitmap.resize( word + 1, 0 );
          }
+         bitmap[ word ] |= ( ( (uint64_t) 1 ) << ( reg.id % 64 ) );
       }
 
       void removeForwardedRegion( global_reg_t const &reg ) {
-         std::map< const_reg_key_t, std::set< reg_t > >::iterator it = _regions.lower_bound( reg.key );
-         if ( it == _regions.end() || _regions.key_comp()( reg.key, it->first ) ) {
-            //it can happen: fatal("Region not found @ _regions (by reg.key).");
-         } else {
-            _regions.erase( it );
-         }
+         //it can happen that the key is not found
+         _regions.erase( reg.key );
       }
    };
 
@@ -198,6 +214,24 @@ namespace nanos {
 
 
          RegionsForwarded *_forwardedRegions;
+
+         /*! \brief Region metadata waiting to be sent to a remote node
+          *  Entries are CopyData objects followed by their dimensions, with
+          *  consecutive metadata sequence numbers starting at _firstSeq. The
+          *  lock also protects the _forwardedRegions entry of the node.
+          */
+         struct MetadataBatch {
+            std::vector< char > _buffer;
+            unsigned int        _numEntries;
+            unsigned int        _firstSeq;
+            Lock                _lock;
+            MetadataBatch() : _buffer(), _numEntries( 0 ), _firstSeq( 0 ), _lock() {}
+         };
+         MetadataBatch *_metadataBatches;
+         unsigned int _lastSyncReceivedWDs;         /**< Received WDs at the last full directory synchronization */
+
+         void _queueRegionMetadata( unsigned int dest, global_reg_t const &reg, uint64_t remoteAddr );
+         void _flushRegionMetadata( unsigned int dest );
          int _gpuPresend;
          int _smpPresend;
          Atomic<unsigned int> *_metadataSequenceNumbers;
@@ -237,6 +271,36 @@ namespace nanos {
          std::list<SyncWDs> _syncReqs;
          RecursiveLock _syncReqsLock;
 
+         std::size_t _transferChunkSize;            /**< Transfers larger than this are pipelined, 0 disables it */
+         unsigned int _maxTransferChunks;           /**< Maximum number of chunks in flight */
+         Atomic<unsigned int> _transferChunksInFlight;
+
+         NetworkStats _stats;
+
+         /* Remote work stealing: a slave only submits as many received WDs
+          * as threads it has, the rest are held in _stealableWDs. When a
+          * slave runs out of work it notifies the master (broadcastIdle),
+          * which asks the node with most pending work to give back some of
+          * its held WDs and sends them again to the idle node.
+          */
+         bool _remoteStealing;
+         std::deque< WD * > _stealableWDs;          /**< Slave: received WDs not submitted yet */
+         Lock _stealableWDsLock;
+         Atomic<unsigned int> _runningRemoteWDs;    /**< Slave: received WDs submitted and not finished */
+         bool _idleNotified;                        /**< Slave: the master already knows this node is idle */
+         std::list< std::pair< unsigned int, unsigned int > > _stealRequests; /**< Slave: pending steal requests (thief, max WDs) */
+         Lock _stealRequestsLock;
+         std::list< unsigned int > _idleNodes;      /**< Master: idle nodes with no steal in progress */
+         std::list< std::pair< unsigned int, WD * > > _stolenWDs; /**< Master: stolen WDs to be sent to the thief */
+         double *_stealStartTimes;                  /**< Master: start of the steal in progress of each node, 0 if none */
+         Lock _stealLock;
+
+         void submitHeldWDs();
+         void checkIdle();
+         void processStealRequests();
+         void processIdleNodes();
+         void processStolenWDs();
+
       public:
          static const unsigned int MASTER_NODE_NUM = 0;
          typedef struct {
@@ -334,6 +398,27 @@ namespace nanos {
          void broadcastIdle();
          void processSyncRequests();
          void setParentWD(WD *wd);
+
+         void setTransferChunkSize( std::size_t size );
+         std::size_t getTransferChunkSize() const;
+         void setMaxTransferChunks( unsigned int chunks );
+         unsigned int getMaxTransferChunks() const;
+         bool isPipelinedTransfer( std::size_t size ) const;
+         void acquireTransferChunk();
+         void releaseTransferChunk();
+
+         NetworkStats &getStats();
+
+         void setRemoteStealing( bool enable );
+         bool isRemoteStealingEnabled() const;
+         void releaseReceivedWD( WD &wd, WD *parent );
+         void notifyStealRequest( unsigned int thief, unsigned int maxWDs );
+         void notifyStolenWork( unsigned int victim, unsigned int thief, unsigned int numWDs, void **wdAddrs );
+
+         void queueRegionMetadata( unsigned int dest, global_reg_t const &reg, uint64_t remoteAddr );
+         void flushRegionMetadata( unsigned int dest );
+         unsigned int forwardRegionMetadata( unsigned int dest, global_reg_t const &reg, uint64_t remoteAddr );
+         void notifyRegionMetaDataBatch( void *buffer, unsigned int numEntries, unsigned int firstSeq );
    };
 
 } // namespace nanos
@@ -46,6 +46,8 @@ namespace nanos {
          virtual void sendWorkMsg ( unsigned int dest, WorkDescriptor const &wd, std::size_t expectedData ) = 0;
          virtual void sendWorkDoneMsg ( unsigned int dest, void const *remoteWdAddr ) = 0;
          virtual void put ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq ) = 0;
+         //! \brief Put of a pipelined chunk, releases a transfer chunk of the Network once the remote node frees its staging buffer
+         virtual void putChunk ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq ) = 0;
          virtual void putStrided1D ( unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, void *localPack, std::size_t size, std::size_t count, std::size_t ld, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq ) = 0;
          virtual void get ( void *localAddr, unsigned int remoteNode, uint64_t remoteAddr, std::size_t size, GetRequest *req, CopyData const &cd ) = 0;
          virtual void getStrided1D ( void *packedAddr, unsigned int remoteNode, uint64_t remoteTag, uint64_t remoteAddr, std::size_t size, std::size_t count, std::size_t ld, GetRequestStrided *req, CopyData const &cd ) = 0;
@@ -58,6 +60,7 @@ namespace nanos {
          virtual void sendRequestPutStrided1D( unsigned int dest, uint64_t origAddr, unsigned int dataDest, uint64_t dstAddr, std::size_t len, std::size_t count, std::size_t ld, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq ) = 0;
          virtual std::size_t getTotalBytes() = 0;
          virtual void sendRegionMetadata( unsigned int dest, CopyData *cd, unsigned int seq ) = 0;
+         virtual void sendRegionMetadataBatch( unsigned int dest, void *buffer, std::size_t size, unsigned int numEntries, unsigned int firstSeq ) = 0;
         
          //virtual void setNewMasterDirectory(NewRegionDirectory *d) = 0;
          //virtual void setGpuCache(Cache *_cache) = 0;
@@ -68,6 +71,8 @@ namespace nanos {
          virtual void processSendDataRequest( SendDataRequest *req ) = 0;
          virtual void synchronizeDirectory( unsigned int node, void *addr ) = 0;
          virtual void broadcastIdle() = 0;
+         virtual void sendStealRequest( unsigned int dest, unsigned int thief, unsigned int maxWDs ) = 0;
+         virtual void sendStolenWork( unsigned int dest, unsigned int thief, unsigned int numWDs, void **wdAddrs ) = 0;
    };
 
 } // namespace nanos
@@ -0,0 +1,189 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include <sstream>
+#include <iomanip>
+#include "networkstats_decl.hpp"
+#include "atomic.hpp"
+#include "lock.hpp"
+#include "os.hpp"
+#include "system.hpp"
+#include "instrumentation.hpp"
+
+using namespace nanos;
+
+NetworkStats::OpStats::OpStats() : _count( 0 ), _bytes( 0 ), _totalNs( 0 ), _maxNs( 0 ) {
+   for ( unsigned int idx = 0; idx < NUM_BUCKETS; idx += 1 ) {
+      _histogram[ idx ] = 0;
+   }
+}
+
+NetworkStats::NetworkStats() : _numNodes( 0 ), _nodes( NULL ), _recvMemoryRetries( 0 ),
+   _pendingWork(), _pendingWorkLock() {
+}
+
+NetworkStats::~NetworkStats() {
+   delete[] _nodes;
+}
+
+void NetworkStats::initialize( unsigned int numNodes ) {
+   _numNodes = numNodes;
+   _nodes = NEW NodeStats[ numNodes ];
+}
+
+unsigned int NetworkStats::getNumNodes() const {
+   return _numNodes;
+}
+
+unsigned int NetworkStats::getBucket( uint64_t ns ) {
+   uint64_t us = ns / 1000;
+   unsigned int bucket = 0;
+   while ( us != 0 && bucket < NUM_BUCKETS - 1 ) {
+      us >>= 1;
+      bucket += 1;
+   }
+   return bucket;
+}
+
+void NetworkStats::record( nanos_network_op_t op, unsigned int node, std::size_t bytes, double startTime ) {
+   if ( node >= _numNodes ) return;
+
+   double elapsed = OS::getMonotonicTime() - startTime;
+   uint64_t ns = elapsed > 0.0 ? (uint64_t) ( elapsed * 1e9 ) : 0;
+   OpStats &stats = _nodes[ node ]._ops[ op ];
+
+   stats._count++;
+   stats._bytes += (uint64_t) bytes;
+   stats._totalNs += ns;
+   stats._histogram[ getBucket( ns ) ]++;
+   uint64_t max = stats._maxNs.value();
+   while ( ns > max && !stats._maxNs.cswap( max, ns ) ) {
+      max = stats._maxNs.value();
+   }
+
+   NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
+   NANOS_INSTRUMENT ( static nanos_event_key_t opKey = ID->getEventKey("network-op"); )
+   NANOS_INSTRUMENT ( static nanos_event_key_t latencyKey = ID->getEventKey("network-op-latency"); )
+   NANOS_INSTRUMENT ( static nanos_event_key_t nodeKey = ID->getEventKey("network-op-node"); )
+   NANOS_INSTRUMENT ( nanos_event_key_t keys[3]; )
+   NANOS_INSTRUMENT ( nanos_event_value_t values[3]; )
+   NANOS_INSTRUMENT ( keys[0] = opKey; values[0] = (nanos_event_value_t) op + 1; )
+   NANOS_INSTRUMENT ( keys[1] = latencyKey; values[1] = (nanos_event_value_t) ns; )
+   NANOS_INSTRUMENT ( keys[2] = nodeKey; values[2] = (nanos_event_value_t) node; )
+   NANOS_INSTRUMENT ( if ( myThread != NULL ) sys.getInstrumentation()->raisePointEvents( 3, keys, values ); )
+}
+
+void NetworkStats::addSegmentRetry( unsigned int node ) {
+   if ( node < _numNodes ) _nodes[ node ]._segmentRetries++;
+}
+
+void NetworkStats::addRecvMemoryRetry() {
+   _recvMemoryRetries++;
+}
+
+void NetworkStats::workSent( unsigned int node, void const *wdAddr ) {
+   LockBlock lock( _pendingWorkLock );
+   _pendingWork[ wdAddr ] = std::make_pair( node, OS::getMonotonicTime() );
+}
+
+void NetworkStats::workDone( void const *wdAddr ) {
+   unsigned int node = 0;
+   double startTime = 0.0;
+   {
+      LockBlock lock( _pendingWorkLock );
+      PendingWorkMap::iterator it = _pendingWork.find( wdAddr );
+      if ( it == _pendingWork.end() ) return;
+      node = it->second.first;
+      startTime = it->second.second;
+      _pendingWork.erase( it );
+   }
+   record( NANOS_NETWORK_WORK_DONE, node, 0, startTime );
+}
+
+unsigned int NetworkStats::getPendingWork( unsigned int node ) {
+   unsigned int count = 0;
+   LockBlock lock( _pendingWorkLock );
+   for ( PendingWorkMap::const_iterator it = _pendingWork.begin(); it != _pendingWork.end(); it++ ) {
+      if ( it->second.first == node ) count += 1;
+   }
+   return count;
+}
+
+void NetworkStats::getOpStats( unsigned int node, nanos_network_op_t op, nanos_network_op_stats_t *stats ) const {
+   OpStats const &s = _nodes[ node ]._ops[ op ];
+   stats->count = s._count.value();
+   stats->bytes = s._bytes.value();
+   stats->total_ns = s._totalNs.value();
+   stats->max_ns = s._maxNs.value();
+   for ( unsigned int idx = 0; idx < NUM_BUCKETS; idx += 1 ) {
+      stats->histogram[ idx ] = s._histogram[ idx ].value();
+   }
+}
+
+uint64_t NetworkStats::getSegmentRetries( unsigned int node ) const {
+   return _nodes[ node ]._segmentRetries.value();
+}
+
+uint64_t NetworkStats::getRecvMemoryRetries() const {
+   return _recvMemoryRetries.value();
+}
+
+const char *NetworkStats::getOpName( nanos_network_op_t op ) {
+   switch ( op ) {
+      case NANOS_NETWORK_PUT:         return "put-issue";
+      case NANOS_NETWORK_GET:         return "get";
+      case NANOS_NETWORK_PUT_STRIDED: return "put-strided-issue";
+      case NANOS_NETWORK_GET_STRIDED: return "get-strided";
+      case NANOS_NETWORK_WORK_MSG:    return "work-msg";
+      case NANOS_NETWORK_WORK_DONE:   return "work-done";
+      case NANOS_NETWORK_DIR_SYNC:    return "dir-sync";
+      case NANOS_NETWORK_WORK_STEAL:  return "work-steal";
+      default:                        return "unknown";
+   }
+}
+
+std::string NetworkStats::getSummary() const {
+   std::ostringstream s;
+   s << "==================== Network Summary =====================" << std::endl;
+   s << "=== Local receive memory retries: " << getRecvMemoryRetries() << std::endl;
+   for ( unsigned int node = 0; node < _numNodes; node += 1 ) {
+      bool header = false;
+      for ( unsigned int op = 0; op < NANOS_NETWORK_NUM_OPS; op += 1 ) {
+         nanos_network_op_stats_t stats;
+         getOpStats( node, (nanos_network_op_t) op, &stats );
+         if ( stats.count == 0 ) continue;
+         if ( !header ) {
+            s << "=== Node " << node << ", segment retries: " << getSegmentRetries( node ) << std::endl;
+            header = true;
+         }
+         s << "===  | " << std::setw(17) << std::left << getOpName( (nanos_network_op_t) op ) << std::right
+           << " ops: " << stats.count << ", bytes: " << stats.bytes
+           << ", avg: " << ( stats.total_ns / stats.count ) / 1000 << " us"
+           << ", max: " << stats.max_ns / 1000 << " us" << std::endl;
+         s << "===  |   histogram (us):";
+         for ( unsigned int idx = 0; idx < NUM_BUCKETS; idx += 1 ) {
+            if ( stats.histogram[ idx ] != 0 ) {
+               s << " <" << ( 1ULL << idx ) << ":" << stats.histogram[ idx ];
+            }
+         }
+         s << std::endl;
+      }
+   }
+   return s.str();
+}
@@ -0,0 +1,107 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOX_NETWORKSTATS_DECL
+#define _NANOX_NETWORKSTATS_DECL
+
+#include <map>
+#include <string>
+#include <stdint.h>
+#include "atomic_decl.hpp"
+#include "lock_decl.hpp"
+#include "nanos-int.h"
+
+namespace nanos {
+
+   /*! \brief Per destination node network counters
+    *
+    *  For each destination node and operation type (see nanos_network_op_t)
+    *  keeps the number of operations, the bytes moved, the accumulated and
+    *  maximum latency and a log2 histogram of latencies, where bucket i counts
+    *  the operations that took less than 2^i microseconds (bucket 0 holds
+    *  sub-microsecond ones and the last bucket anything larger). Puts are
+    *  timed until issued, not until the data reaches the remote node.
+    */
+   class NetworkStats {
+      public:
+         static const unsigned int NUM_BUCKETS = NANOS_NETWORK_STATS_BUCKETS;
+
+      private:
+         struct OpStats {
+            Atomic<uint64_t> _count;
+            Atomic<uint64_t> _bytes;
+            Atomic<uint64_t> _totalNs;
+            Atomic<uint64_t> _maxNs;
+            Atomic<uint64_t> _histogram[NUM_BUCKETS];
+
+            OpStats();
+         };
+
+         struct NodeStats {
+            OpStats          _ops[NANOS_NETWORK_NUM_OPS];
+            Atomic<uint64_t> _segmentRetries;   /**< Polls done waiting for space in this node's segment */
+         };
+
+         unsigned int     _numNodes;
+         NodeStats       *_nodes;
+         Atomic<uint64_t> _recvMemoryRetries;   /**< Polls done waiting for local receive memory */
+
+         typedef std::map< void const *, std::pair< unsigned int, double > > PendingWorkMap;
+         PendingWorkMap   _pendingWork;         /**< Outstanding work messages, keyed by WD address */
+         Lock             _pendingWorkLock;
+
+         static unsigned int getBucket( uint64_t ns );
+
+      private:
+         /*! \brief NetworkStats copy constructor (disabled) */
+         NetworkStats( NetworkStats const & );
+         /*! \brief NetworkStats copy assignment operator (disabled) */
+         NetworkStats & operator=( NetworkStats const & );
+
+      public:
+         NetworkStats();
+         ~NetworkStats();
+
+         void initialize( unsigned int numNodes );
+         unsigned int getNumNodes() const;
+
+         /*! \brief Records one completed operation against node, started at startTime (OS::getMonotonicTime) */
+         void record( nanos_network_op_t op, unsigned int node, std::size_t bytes, double startTime );
+
+         void addSegmentRetry( unsigned int node );
+         void addRecvMemoryRetry();
+
+         /*! \brief Work-done round trips, matched by the address of the WD sent */
+         void workSent( unsigned int node, void const *wdAddr );
+         void workDone( void const *wdAddr );
+         /*! \brief Number of WDs sent to node that have not finished yet */
+         unsigned int getPendingWork( unsigned int node );
+
+         void getOpStats( unsigned int node, nanos_network_op_t op, nanos_network_op_stats_t *stats ) const;
+         uint64_t getSegmentRetries( unsigned int node ) const;
+         uint64_t getRecvMemoryRetries() const;
+
+         static const char *getOpName( nanos_network_op_t op );
+
+         std::string getSummary() const;
+   };
+
+} // namespace nanos
+
+#endif
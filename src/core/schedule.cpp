@@ -28,6 +28,7 @@
 #include "instrumentationmodule_decl.hpp"
 #include "os.hpp"
 #include "wddeque.hpp"
+#include "task_reduction.hpp"
 #include "smpthread.hpp"
 #include "nanos-int.h"
 
@@ -50,6 +51,21 @@ void SchedulerConf::config (Config &cfg)
 
    cfg.registerConfigOption ( "hold-tasks", NEW Config::FlagOption( _holdTasks ), "Do not submit tasks until a taskwait is reached." );
    cfg.registerArgOption ( "hold-tasks", "hold-tasks" );
+
+   Config::MapVar<SyncWait>* sync_wait = NEW Config::MapVar<SyncWait>( _syncWait );
+   sync_wait->addOption( "spin", SYNC_WAIT_SPIN );
+   sync_wait->addOption( "block", SYNC_WAIT_BLOCK );
+   cfg.registerConfigOption ( "sync-wait", sync_wait,
+         "How threads wait on barriers and conditions with no other work: spin (default) or block after an adaptive spin" );
+   cfg.registerArgOption ( "sync-wait", "sync-wait" );
+
+   cfg.registerConfigOption ( "sync-spin-time", NEW Config::UintVar( _syncSpinTime ),
+         "Set the maximum time (in usec) to spin on a condition before blocking with --sync-wait=block (default = 50)" );
+   cfg.registerArgOption ( "sync-spin-time", "sync-spin-time" );
+
+   cfg.registerConfigOption ( "sync-block-time", NEW Config::UintVar( _syncBlockTime ),
+         "Set the maximum time (in usec) blocked on a condition before looking for work again (default = 1000)" );
+   cfg.registerArgOption ( "sync-block-time", "sync-block-time" );
 }
 
 void Scheduler::submit ( WD &wd, bool force_queue )
@@ -73,6 +89,7 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
 
    wd.submitted();
    wd.setReady();
+   sys.getTaskStats().wdReady( wd );
 
    /* handle tied tasks */
    BaseThread *wd_tiedto = wd.isTiedTo();
@@ -116,7 +133,9 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
    // The thread is not paused, mark it as so
    myThread->unpause();
    // And go on
+   const nanos_thread_time_t previous_time = mythread->getThreadTimes().enter( NANOS_THREAD_SCHEDULING );
    WD *next = getMyThreadSafe()->getTeam()->getSchedulePolicy().atSubmit( myThread, wd );
+   mythread->getThreadTimes().enter( previous_time );
 
    /* If SchedulePolicy have returned a 'next' value, we have to context switch to
       that WorkDescriptor */
@@ -157,6 +176,7 @@ void Scheduler::_submit ( WD ** wds, size_t numElems )
    {
       WD* wd = wds[i];
       wd->_mcontrol.preInit();
+      sys.getTaskStats().wdReady( *wd );
       
       // If the wd is tied to anyone
       BaseThread *wd_tiedto = wd->isTiedTo();
@@ -193,6 +213,8 @@ void Scheduler::updateExitStats ( WD &wd )
 {
    sys.throttleTaskOut();
    if ( wd.isConfigured() ) sys.getSchedulerStats()._totalTasks--;
+   sys.getLiveMetrics().taskFinished();
+   sys.getTaskStats().wdFinished( wd );
 }
 
 struct TestInputs {
@@ -260,6 +282,10 @@ inline void Scheduler::idleLoop ()
    sys.getSchedulerStats()._idleThreads++;
    myThread->setIdle( true );
 
+   // Thread times: the loop spins unless it is calling the policy, blocked or running a task
+   const nanos_thread_time_t previous_time = myThread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
+   myThread->getThreadTimes().idleStarted();
+
    for ( ; ; ) {
       BaseThread *thread = getMyThreadSafe();
 
@@ -296,7 +322,9 @@ inline void Scheduler::idleLoop ()
 
          NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(event_num, &Keys[event_start], &Values[event_start]); )
 
+         thread->getThreadTimes().enter( NANOS_THREAD_BLOCKED );
          thread->wait();
+         thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
 
          NANOS_INSTRUMENT (total_spins = 0; )
          NANOS_INSTRUMENT (total_blocks = 0; )
@@ -336,7 +364,9 @@ inline void Scheduler::idleLoop ()
             // Increase the number of steal attempts
             if ( steal ) ++num_steals;
             
+            thread->getThreadTimes().enter( NANOS_THREAD_SCHEDULING );
             next = behaviour::getWD(thread,current,steal*num_steals);
+            thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
 
             NANOS_INSTRUMENT ( unsigned long long end_sched = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  ); )
             NANOS_INSTRUMENT (time_scheds += ( end_sched - begin_sched ); )
@@ -374,11 +404,17 @@ inline void Scheduler::idleLoop ()
          thread->setIdle( false );
          sys.getSchedulerStats()._idleThreads--;
 
+         thread->getThreadTimes().workFound();
+         thread->getThreadTimes().enter( NANOS_THREAD_EXECUTING );
+
          behaviour::switchWD(thread, current, next);
 
          thread = getMyThreadSafe();
          thread->step();
 
+         thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
+         thread->getThreadTimes().idleStarted();
+
          sys.getSchedulerStats()._idleThreads++;
          thread->setIdle( true );
 
@@ -403,8 +439,10 @@ inline void Scheduler::idleLoop ()
       
       // Otherwise, getWD returned NULL, increase the counter
       ++num_empty_calls;
+      sys.getLiveMetrics().threadIdle();
 
       thread->idle();
+      TaskReduction::helpReduce();
       //if ( sys.getNetwork()->getNodeNum() > 0 ) {
       //   sys.getNetwork()->poll(0);
       //}
@@ -413,15 +451,18 @@ inline void Scheduler::idleLoop ()
          NANOS_INSTRUMENT ( total_spins += init_spins; )
 
          // Perform yield and/or block
+         thread->getThreadTimes().enter( NANOS_THREAD_BLOCKED );
          thread_manager->idle( yields
 #ifdef NANOS_INSTRUMENTATION_ENABLED
                , total_yields, total_blocks, time_yields, time_blocks
 #endif
                );
+         thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
 
          spins = init_spins;
       }
    }
+   myThread->getThreadTimes().enter( previous_time );
    myThread->setIdle(false);
    sys.getSchedulerStats()._idleThreads--;
    //current->~WorkDescriptor();
@@ -446,6 +487,17 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
 
    ThreadManager *const thread_manager = sys.getThreadManager();
 
+   //! With blocking waits the WD is never left for the idle loop: the thread
+   //! spins for an adaptive budget and then blocks on the condition itself
+   const bool block = sys.getSchedulerConf().getSyncWait() == SchedulerConf::SYNC_WAIT_BLOCK;
+   uint64_t wait_start = 0, spin_budget = 0;
+   if ( block ) {
+      wait_start = AdaptiveWait::now();
+      spin_budget = condition->getSpinBudget( sys.getSchedulerConf().getSyncSpinTime() );
+   }
+
+   const nanos_thread_time_t previous_time = thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
+
    verbose("Wait on condition");
    while ( !condition->check() /* FIXME:xteruel do we needed? && thread->isRunning() */) {
       if ( checks == 0 ) {
@@ -466,8 +518,11 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
                if ( !next ) {
                   memoryFence();
                   if ( sys.getSchedulerStats()._readyTasks > 0 ) {
-                     if ( sys.getSchedulerConf().getSchedulerEnabled() )
+                     if ( sys.getSchedulerConf().getSchedulerEnabled() ) {
+                        thread->getThreadTimes().enter( NANOS_THREAD_SCHEDULING );
                         next = thread->getTeam()->getSchedulePolicy().atBlock( thread, current );
+                        thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
+                     }
             if ( next != NULL ) {
                 verbose("Got wd through atBlock");
             }
@@ -482,7 +537,7 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
             }
 
             //! Finally coming back to our Thread's WD (idle task)
-            if ( !next && supportULT && sys.getSchedulerConf().getSchedulerEnabled() ) {
+            if ( !next && supportULT && !block && sys.getSchedulerConf().getSchedulerEnabled() ) {
                next = &(thread->getThreadWD());
             if ( next != NULL ) {
                 verbose("Got wd through getThreadWD");
@@ -492,13 +547,23 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
             //! If found a wd to switch to, execute it
             if ( next ) {
                verbose("   switching to " << next->getId() ); //FIXME:xteruel
+               thread->getThreadTimes().enter( NANOS_THREAD_EXECUTING );
                switchTo ( next );
                thread = getMyThreadSafe();
+               thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
                supportULT = thread->runningOn()->supportsUserLevelThreads();
                thread->step();
             } else {
                condition->unlock();
-               thread->atBlock();
+               if ( block && AdaptiveWait::now() - wait_start > spin_budget ) {
+                  thread->getThreadTimes().enter( NANOS_THREAD_BLOCKED );
+                  condition->block( sys.getSchedulerConf().getSyncBlockTime() );
+                  thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
+               } else {
+                  thread->getThreadTimes().enter( NANOS_THREAD_BLOCKED );
+                  thread->atBlock();
+                  thread->getThreadTimes().enter( NANOS_THREAD_SPINNING );
+               }
             }
          } else condition->unlock();
          checks = (unsigned int) sys.getSchedulerConf().getNumChecks();
@@ -506,6 +571,10 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
       checks--;
    }
 
+   thread->getThreadTimes().enter( previous_time );
+
+   if ( block ) condition->recordWait( AdaptiveWait::now() - wait_start );
+
    current->setSyncCond( NULL );
    if ( !current->isReady() ) current->setReady();
 }
@@ -762,6 +831,7 @@ void Scheduler::postOutlineWork ( WD *wd, bool schedule, BaseThread *owner )
 
 void Scheduler::outlineWork( BaseThread *currentThread, WD *wd ) {
    NANOS_INSTRUMENT( sys.getInstrumentation()->wdSwitch( NULL, wd, false) );
+   sys.getLiveMetrics().wdSwitched( *wd );
    currentThread->outlineWorkDependent( *wd );
 }
 
@@ -775,7 +845,9 @@ void Scheduler::finishWork( WD * wd, bool schedule )
       BaseThread *thread = getMyThreadSafe();
       ThreadTeam *thread_team = thread->getTeam();
       if ( thread_team ) {
+         const nanos_thread_time_t previous_time = thread->getThreadTimes().enter( NANOS_THREAD_SCHEDULING );
          WD *prefetchedWD = thread_team->getSchedulePolicy().atBeforeExit( thread, *wd, schedule );
+         thread->getThreadTimes().enter( previous_time );
          if ( prefetchedWD ) {
             prefetchedWD->_mcontrol.preInit();
             thread->addNextWD( prefetchedWD );
@@ -827,6 +899,7 @@ bool Scheduler::inlineWork ( WD *wd, bool schedule )
 
    // Set current WD to new WD
    thread->setCurrentWD( *wd );
+   sys.getLiveMetrics().wdSwitched( *wd );
 
    // Instrumenting context switch: wd enters cpu (last = n/a)
    NANOS_INSTRUMENT( sys.getInstrumentation()->wdSwitch( oldwd, wd, false) );
@@ -857,6 +930,7 @@ bool Scheduler::inlineWork ( WD *wd, bool schedule )
 
    // Restore current WD to old WD
    thread->setCurrentWD( *oldwd );
+   sys.getLiveMetrics().wdSwitched( *oldwd );
 
    // Tiedness rules
    ensure(oldwd->isTiedTo() == NULL || thread == oldwd->isTiedTo(),
@@ -955,6 +1029,7 @@ void Scheduler::switchTo ( WD *to )
       NANOS_INSTRUMENT( WD *oldWD = myThread->getCurrentWD(); )
       NANOS_INSTRUMENT( sys.getInstrumentation()->wdSwitch( oldWD, to, false ) );
 
+      sys.getLiveMetrics().wdSwitched( *to );
       myThread->switchTo( to, switchHelper );
 
    } else {
@@ -1051,6 +1126,7 @@ void Scheduler::exitTo ( WD *to )
 
     NANOS_INSTRUMENT( WD *oldWD = myThread->getCurrentWD(); )
     NANOS_INSTRUMENT( sys.getInstrumentation()->wdSwitch( oldWD, to, true ) );
+    sys.getLiveMetrics().wdSwitched( *to );
     myThread->exitTo( to, Scheduler::exitHelper );
 }
 
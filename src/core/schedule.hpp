@@ -79,6 +79,21 @@ inline bool SchedulerConf::getHoldTasksEnabled ( void ) const
    return _holdTasks;
 }
 
+inline SchedulerConf::SyncWait SchedulerConf::getSyncWait ( void ) const
+{
+   return _syncWait;
+}
+
+inline uint64_t SchedulerConf::getSyncSpinTime ( void ) const
+{
+   return (uint64_t) _syncSpinTime * 1000;
+}
+
+inline uint64_t SchedulerConf::getSyncBlockTime ( void ) const
+{
+   return (uint64_t) _syncBlockTime * 1000;
+}
+
 inline const std::string & SchedulePolicy::getName () const
 {
    return _name;
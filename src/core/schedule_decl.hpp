@@ -93,19 +93,29 @@ namespace nanos {
    class SchedulerConf
    {
       friend class System;
+      public:
+         //! \brief How threads wait on a condition when there is nothing else to run
+         enum SyncWait {
+            SYNC_WAIT_SPIN,   //!< Keep spinning (or run the idle loop)
+            SYNC_WAIT_BLOCK   //!< Spin for an adaptive time, then block the thread on the condition
+         };
       private: /* PRIVATE DATA MEMBERS */
          unsigned int                  _numSpins;          //!< Number of spins before yield
          unsigned int                  _numChecks;         //!< Number of checks before schedule
          bool                          _schedulerEnabled;  //!< Scheduler is enabled
          int                           _numStealAfterSpins;//!< Steal every so spins
          bool                          _holdTasks;         //!< Submit tasks when a taskwait is reached
+         SyncWait                      _syncWait;          //!< How threads wait on conditions
+         unsigned int                  _syncSpinTime;      //!< Maximum spin time before blocking (us)
+         unsigned int                  _syncBlockTime;     //!< Maximum block time before looking for work again (us)
       private: /* PRIVATE METHODS */
         //! \brief SchedulerConf default constructor (private)
         SchedulerConf() : _numSpins(1), _numChecks(1), _schedulerEnabled(true),
-        _numStealAfterSpins(1), _holdTasks(false) {}
+        _numStealAfterSpins(1), _holdTasks(false), _syncWait(SYNC_WAIT_SPIN),
+        _syncSpinTime(50), _syncBlockTime(1000) {}
         //! \brief SchedulerConf copy constructor (private)
         SchedulerConf ( SchedulerConf &sc ) : _numSpins(), _numChecks(),
-        _schedulerEnabled(), _holdTasks()
+        _schedulerEnabled(), _holdTasks(), _syncWait(), _syncSpinTime(), _syncBlockTime()
         {
            fatal("SchedulerConf: Illegal use of class");
         }
@@ -128,6 +138,12 @@ namespace nanos {
          bool getSchedulerEnabled () const;
          //! \brief Returns if holding tasks is enabled 
          bool getHoldTasksEnabled () const;
+         //! \brief Returns how threads wait on conditions
+         SyncWait getSyncWait () const;
+         //! \brief Returns the maximum spin time (ns) before blocking on a condition
+         uint64_t getSyncSpinTime () const;
+         //! \brief Returns the maximum time (ns) blocked on a condition before looking for work again
+         uint64_t getSyncBlockTime () const;
 
          //! \brief Configure scheduler runtime options
          void config ( Config &cfg );
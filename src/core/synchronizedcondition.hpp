@@ -22,8 +22,10 @@
 
 #include "synchronizedcondition_decl.hpp"
 #include "atomic.hpp"
+#include "adaptivewait.hpp"
 #include "basethread_decl.hpp"
-#include "schedule_decl.hpp"
+#include "system_decl.hpp"
+#include "schedule.hpp"
 
 namespace nanos {
 
@@ -39,6 +41,31 @@ inline void GenericSyncCond::unlock()
    _lock.release();
 }
 
+inline uint64_t GenericSyncCond::getSpinBudget( uint64_t maxSpin ) const
+{
+   return _wait.getSpinBudget( maxSpin );
+}
+
+inline void GenericSyncCond::recordWait( uint64_t waited )
+{
+   _wait.record( waited );
+}
+
+inline void GenericSyncCond::block( uint64_t timeout )
+{
+   int generation = _wait.prepareBlock();
+   if ( check() ) _wait.cancelBlock();
+   else _wait.block( generation, timeout );
+}
+
+inline void GenericSyncCond::wakeBlocked()
+{
+   // Only --sync-wait=block puts threads to sleep on the condition, spinning
+   // waits do not pay the fence and the sleepers check on every signal
+   if ( sys.getSchedulerConf().getSyncWait() != SchedulerConf::SYNC_WAIT_BLOCK ) return;
+   _wait.wake();
+}
+
 template <class _T>
 inline void SynchronizedCondition< _T>::wait()
 {
@@ -76,6 +103,7 @@ inline void SynchronizedCondition< _T>::signal()
       Scheduler::wakeUp(wd);
    }
    unlock(); 
+   wakeBlocked();
 }
 
 template <class _T>
@@ -87,6 +115,7 @@ inline void SynchronizedCondition< _T>::signal_one()
       Scheduler::wakeUp(wd);
    }
    unlock();
+   wakeBlocked();
 }
 
 } // namespace nanos
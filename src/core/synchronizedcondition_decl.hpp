@@ -25,6 +25,7 @@
 #include <vector>
 #include "atomic_decl.hpp"
 #include "lock_decl.hpp"
+#include "adaptivewait_decl.hpp"
 #include "debug.hpp"
 #include "workdescriptor_fwd.hpp"
 
@@ -169,6 +170,7 @@ namespace nanos {
    {
       private:
          Lock _lock; /**< Lock to block and unblock WorkDescriptors securely. */
+         AdaptiveWait _wait; /**< Threads blocked on the condition, see SchedulerConf::SYNC_WAIT_BLOCK */
       private:
          /*! \brief GenericSyncCond copy constructor (disabled)
           */
@@ -179,7 +181,7 @@ namespace nanos {
       public:
          /*! \brief GenericSyncCond default constructor
           */
-         GenericSyncCond() : _lock() {}
+         GenericSyncCond() : _lock(), _wait() {}
          /*! \brief GenericSyncCond destructor
           */
          virtual ~GenericSyncCond() {}
@@ -211,6 +213,23 @@ namespace nanos {
           * can unlock it after removing the current WD from the stack.
           */
          void unlock();
+
+         /*! \brief Time (ns) to spin on the condition before blocking the thread
+          */
+         uint64_t getSpinBudget( uint64_t maxSpin ) const;
+
+         /*! \brief Accounts a wait on the condition that took waited ns
+          */
+         void recordWait( uint64_t waited );
+
+         /*! \brief Blocks the thread for at most timeout ns, unless the condition
+          * is true or gets signaled
+          */
+         void block( uint64_t timeout );
+
+         /*! \brief Wakes up the threads blocked on the condition
+          */
+         void wakeBlocked();
    };
 
   /*! \brief Abstract template synchronization class.
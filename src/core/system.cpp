@@ -21,10 +21,12 @@
 #include <string.h>
 #include <signal.h>
 #include <set>
+#include <algorithm>
 #include <climits>
 
 #include "atomic.hpp"
 #include "system.hpp"
+#include "lockprofiler_decl.hpp"
 #include "config.hpp"
 #include "plugin.hpp"
 #include "schedule.hpp"
@@ -85,8 +87,13 @@ System::System () :
       /*jb _numPEs( INT_MAX ), _numThreads( 0 ),*/ _deviceStackSize( 0 ), _profile( false ),
       _instrument( false ), _verboseMode( false ), _summary( false ), _executionMode( DEDICATED ), _initialMode( POOL ),
       _untieMaster( true ), _delayedStart( false ), _synchronizedStart( true ), _alreadyFinished( false ),
-      _predecessorLists( false ), _throttlePolicy ( NULL ),
-      _schedStats(), _schedConf(), _defSchedule( "bf" ), _defThrottlePolicy( "hysteresis" ), 
+      _predecessorLists( false ), _hotTeams( true ), _userLocks( UserLock::DEFAULT ),
+      _threadBudget( 0 ), _busyThreads( 1 ), _nestedPools(), _nestedLock(),
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+      _lockProfileTop( 10 ),
+#endif
+      _throttlePolicy ( NULL ),
+      _schedStats(), _liveMetrics(), _taskStats(), _threadTimeStats(), _schedConf(), _defSchedule( "bf" ), _defThrottlePolicy( "hysteresis" ), 
       _defBarr( "centralized" ), _defInstr ( "empty_trace" ), _defDepsManager( "plain" ), _defArch( "smp" ),
       _initializedThreads ( 0 ), /*_targetThreads ( 0 ),*/ _pausedThreads( 0 ),
       _pausedThreadsCond(), _unpausedThreadsCond(),
@@ -99,7 +106,7 @@ System::System () :
       , _pinnedMemoryCUDA( NEW CUDAPinnedMemoryManager() )
 #endif
 #ifdef NANOS_INSTRUMENTATION_ENABLED
-      , _enableEvents(), _disableEvents(), _instrumentDefault("default"), _enableCpuidEvent( false )
+      , _enableEvents(), _disableEvents(), _instrumentDefault("default"), _enableCpuidEvent( false ), _hwCounters()
 #endif
       , _lockPoolSize(37), _lockPool( NULL ), _mainTeam (NULL), _simulator(false),  _task_max_retries(1), _affinityFailureCount( 0 )
       , _createLocalTasks( false )
@@ -328,6 +335,38 @@ void System::config ()
                              "Activates summary mode" );
    cfg.registerArgOption( "summary", "summary" );
 
+   cfg.registerConfigOption( "hot-teams", NEW Config::FlagOption( _hotTeams ),
+                             "Reuses the team of the previous parallel region opened by the same thread (enabled by default)" );
+   cfg.registerArgOption( "hot-teams", "hot-teams" );
+   cfg.registerEnvOption( "hot-teams", "NX_HOT_TEAMS" );
+
+   cfg.registerConfigOption( "thread-budget", NEW Config::PositiveVar( _threadBudget ),
+                             "Maximum number of threads running parallel regions at once, nested teams get fewer threads "
+                             "beyond it (default: one per worker)" );
+   cfg.registerArgOption( "thread-budget", "thread-budget" );
+   cfg.registerEnvOption( "thread-budget", "NX_THREAD_BUDGET" );
+
+   Config::MapVar<UserLock::Kind>* user_locks = NEW Config::MapVar<UserLock::Kind>( _userLocks );
+   user_locks->addOption( "default", UserLock::DEFAULT );
+   user_locks->addOption( "ticket", UserLock::TICKET );
+   user_locks->addOption( "mcs", UserLock::MCS );
+   user_locks->addOption( "task", UserLock::TASK );
+   cfg.registerConfigOption( "user-locks", user_locks,
+                             "Implementation of user locks and critical sections: default (as runtime locks), ticket, mcs (OpenMP locks only, other ones are ticket locks) or task (waiting tasks leave the thread to other work after --sync-spin-time)" );
+   cfg.registerArgOption( "user-locks", "user-locks" );
+   cfg.registerEnvOption( "user-locks", "NX_USER_LOCKS" );
+
+   _liveMetrics.config( cfg );
+   _taskStats.config( cfg );
+   _threadTimeStats.config( cfg );
+
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+   cfg.registerConfigOption( "lock-profile-top", NEW Config::UintVar( _lockProfileTop ),
+                             "Number of lock sites shown in the lock contention report (0 disables it)" );
+   cfg.registerArgOption( "lock-profile-top", "lock-profile-top" );
+   cfg.registerEnvOption( "lock-profile-top", "NX_LOCK_PROFILE_TOP" );
+#endif
+
 #ifdef NANOS_INSTRUMENTATION_ENABLED
    //! Registering instrumentation specific options
    cfg.registerConfigOption( "instrument-default", NEW Config::StringVar ( _instrumentDefault ),
@@ -345,6 +384,8 @@ void System::config ()
    cfg.registerConfigOption( "instrument-cpuid", NEW Config::FlagOption ( _enableCpuidEvent ),
                              "Add cpuid event when binding is disabled (expensive)" );
    cfg.registerArgOption( "instrument-cpuid", "instrument-cpuid" );
+
+   _hwCounters.config( cfg );
 #endif
 
    // Registering cluster options: load the cluster support
@@ -428,6 +469,12 @@ void System::config ()
    verbose0 ( "Reading Configuration" );
 
    cfg.init();
+
+   // The execution summary reports the task type statistics and thread times
+   if ( _summary ) {
+      _taskStats.enable();
+      _threadTimeStats.enable();
+   }
    
    // Now read compiler-supplied flags
    // Open the own executable
@@ -560,6 +607,7 @@ void System::start ()
    verbose0( "[NUMA] " << availNUMANodes << " NUMA node(s) available for the user." );
 
    _targetThreads = _smpPlugin->getNumThreads();
+   if ( _threadBudget == 0 ) _threadBudget = _targetThreads;
 
    // Set up internal data for each worker
    for ( ThreadList::const_iterator it = _workers.begin(); it != _workers.end(); it++ ) {
@@ -625,6 +673,9 @@ void System::start ()
    NANOS_INSTRUMENT ( sys.getInstrumentation()->raiseCloseStateEvent() );
    NANOS_INSTRUMENT ( sys.getInstrumentation()->raiseOpenStateEvent (NANOS_RUNNING) );
 
+   // Live metrics are published once the runtime is ready to run tasks
+   _liveMetrics.start();
+
    // List unrecognised arguments
    std::string unrecog = Config::getOrphanOptions();
    if ( !unrecog.empty() ) warning( "Unrecognised arguments: " << unrecog );
@@ -684,6 +735,12 @@ void System::finish ()
    }
    verbose ( "...thread has been joined" );
 
+   //! \note no other thread updates live metrics from now on
+   _liveMetrics.stop();
+
+   //! \note threads are deleted before the execution summary is printed
+   _threadTimeStats.stop();
+
 
    ensure( _schedStats._readyTasks == 0, "Ready task counter has an invalid value!");
 
@@ -708,6 +765,11 @@ void System::finish ()
    //! \note Master leaves team and finalizes thread structures (before insrumentation ends)
    _workers[0]->finish();
 
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+   //! \note printing lock contention report (before instrumentation ends)
+   if ( _lockProfileTop > 0 ) lockContentionReport();
+#endif
+
    //! \note finalizing instrumentation (if active)
    NANOS_INSTRUMENT ( sys.getInstrumentation()->raiseCloseStateEvent() );
    NANOS_INSTRUMENT ( sys.getInstrumentation()->finalize() );
@@ -733,9 +795,16 @@ void System::finish ()
 
    //! \note deleting loaded worksharings
    for ( WorkSharings::const_iterator it = _worksharings.begin(); it !=   _worksharings.end(); it++ ) {
+      if ( _summary ) _worksharingSummary += it->second->getSummary();
       delete ( WorkSharing * )  it->second;
    }
    
+   //! \note deleting the teams kept for reuse
+   for ( ThreadList::iterator it = _workers.begin(); it != _workers.end(); it++ ) {
+      delete it->second->getHotTeam();
+      it->second->setHotTeam( NULL );
+   }
+
    //! \note  printing thread team statistics and deleting it
    if ( team->getScheduleData() != NULL ) team->getScheduleData()->printStats();
 
@@ -976,6 +1045,9 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
 
    //Copy reduction data from parent
    if (uwg) wd->copyReductions((WorkDescriptor *)uwg);
+
+   _liveMetrics.taskCreated();
+   _taskStats.wdCreated( *wd );
 }
 
 /*! \brief Duplicates the whole structure for a given WD
@@ -1138,6 +1210,7 @@ void System::submit ( WD &work )
 {
    SchedulePolicy* policy = getDefaultSchedulePolicy();
    policy->onSystemSubmit( work, SchedulePolicy::SYS_SUBMIT );
+   _taskStats.wdSubmitted( work );
 
    work.submit();
 }
@@ -1147,6 +1220,7 @@ void System::submitWithDependencies (WD& work, size_t numDataAccesses, DataAcces
 {
    SchedulePolicy* policy = getDefaultSchedulePolicy();
    policy->onSystemSubmit( work, SchedulePolicy::SYS_SUBMIT_WITH_DEPENDENCIES );
+   _taskStats.wdSubmitted( work );
 
    WD *current = myThread->getCurrentWD(); 
    current->submitWithDependencies( work, numDataAccesses , dataAccesses);
@@ -1193,29 +1267,34 @@ BaseThread * System::getUnassignedWorker ( void )
 
    for ( ThreadList::iterator it = _workers.begin(); it != _workers.end(); it++ ) {
       thread = it->second;
-
-      // skip iteration if binding is enabled and the thread is running on a deactivated CPU
-      bool cpu_active = thread->runningOn()->isActive();
-      if ( _smpPlugin->getBinding() && !cpu_active ) {
-         continue;
-      }
-
-      thread->lock();
-      if ( !thread->hasTeam() && !thread->getNextTeam() ) {
-         // Thread may be idle and running or blocked but its CPU is active
-         if ( !thread->isSleeping() || thread->runningOn()->isActive() ) {
-            thread->reserve(); // set team flag only
-            thread->unlock();
-            return thread;
-         }
-      }
-      thread->unlock();
+      if ( reserveWorker( thread ) ) return thread;
    }
 
    //! \note If no thread has found, return NULL.
    return NULL;
 }
 
+bool System::reserveWorker ( BaseThread *thread )
+{
+   // skip thread if binding is enabled and the thread is running on a deactivated CPU
+   bool cpu_active = thread->runningOn()->isActive();
+   if ( _smpPlugin->getBinding() && !cpu_active ) {
+      return false;
+   }
+
+   thread->lock();
+   if ( !thread->hasTeam() && !thread->getNextTeam() ) {
+      // Thread may be idle and running or blocked but its CPU is active
+      if ( !thread->isSleeping() || thread->runningOn()->isActive() ) {
+         thread->reserve(); // set team flag only
+         thread->unlock();
+         return true;
+      }
+   }
+   thread->unlock();
+   return false;
+}
+
 BaseThread * System::getWorker ( unsigned int n )
 {
    BaseThread *worker = NULL;
@@ -1277,16 +1356,37 @@ ThreadTeam * System::createTeam ( unsigned nthreads, void *constraints, bool reu
    //! \note Getting default scheduler
    SchedulePolicy *sched = sys.getDefaultSchedulePolicy();
 
-   //! \note Getting scheduler team data (if any)
-   ScheduleTeamData *std = ( sched->getTeamDataSize() > 0 )? sched->createTeamData() : NULL;
+   //! \note Teams created from a member of a parallel region are nested, they only get the threads left in the budget
+   ThreadTeam *parent = reuse ? myThread->getTeam() : NULL;
+   bool nested = parent != NULL && parent->getParent() != NULL;
+   unsigned int others = reuse ? nthreads - 1 : nthreads;
+
+   if ( nested ) {
+      unsigned int granted = takeThreadBudget( others );
+      if ( granted < others ) {
+         debug( "Thread budget exhausted, nested team of " << nthreads << " threads gets " << nthreads - others + granted );
+         nthreads -= others - granted;
+         others = granted;
+      }
+   } else {
+      _busyThreads += others;
+   }
 
-   //! \note create team object
-   ThreadTeam * team = NEW ThreadTeam( nthreads, *sched, std, *_defBarrFactory(), *(_pmInterface->getThreadTeamData()),
-                                       reuse? myThread->getTeam() : NULL );
+   //! \note Reusing the team of the previous parallel region of this thread, if it fits (hot team)
+   ThreadTeam * team = ( reuse && constraints == NULL ) ? takeHotTeam( nthreads, *sched ) : NULL;
+
+   if ( team == NULL ) {
+      //! \note Getting scheduler team data (if any)
+      ScheduleTeamData *std = ( sched->getTeamDataSize() > 0 )? sched->createTeamData() : NULL;
+
+      //! \note create team object
+      team = NEW ThreadTeam( nthreads, *sched, std, *_defBarrFactory(), *(_pmInterface->getThreadTeamData()), parent );
+   }
 
    debug( "Creating team " << team << " of " << nthreads << " threads" );
 
    unsigned int remaining_threads = nthreads;
+   unsigned int previous_member = 0;
 
    //! \note Reusing current thread
    if ( reuse ) {
@@ -1294,10 +1394,20 @@ ThreadTeam * System::createTeam ( unsigned nthreads, void *constraints, bool reu
       remaining_threads--;
    }
 
-   //! \note Getting rest of the members 
+   //! \note Nested teams may be created by several threads at once, and they may create workers
+   bool pooled = nested && remaining_threads > 0;
+   if ( pooled ) _nestedLock.acquire();
+
+   //! \note Getting rest of the members, a hot team gets its previous ones back first
    while ( remaining_threads > 0 ) {
 
-      BaseThread *thread = getUnassignedWorker();
+      BaseThread *thread = NULL;
+      while ( thread == NULL && previous_member < team->getMembers().size() ) {
+         BaseThread *member = team->getMembers()[previous_member++];
+         if ( member != myThread && reserveWorker( member ) ) thread = member;
+      }
+      if ( thread == NULL && nested ) thread = getNestedWorker( team->getLevel() );
+      if ( thread == NULL ) thread = getUnassignedWorker();
       // Check if we don't have a worker because it needs to be created
       if ( !thread && _workers.size() < nthreads ) {
          _smpPlugin->createWorker( _workers );
@@ -1314,11 +1424,50 @@ ThreadTeam * System::createTeam ( unsigned nthreads, void *constraints, bool reu
       remaining_threads--;
    }
 
+   if ( pooled ) _nestedLock.release();
+
    team->init();
 
    return team;
 }
 
+unsigned System::takeThreadBudget ( unsigned nthreads )
+{
+   Atomic<int> busy, taken;
+   do {
+      busy = _busyThreads.value();
+      int available = _threadBudget - busy.value();
+      if ( available <= 0 ) return 0;
+      if ( (unsigned) available < nthreads ) nthreads = available;
+      taken = busy.value() + nthreads;
+   } while ( !_busyThreads.cswap( busy, taken ) );
+
+   return nthreads;
+}
+
+BaseThread * System::getNestedWorker ( int level )
+{
+   if ( (int) _nestedPools.size() <= level ) _nestedPools.resize( level + 1 );
+   ThreadPool &pool = _nestedPools[level];
+
+   //! \note Dormant workers of this level first, they are still bound to the CPU they had
+   for ( ThreadPool::iterator it = pool.begin(); it != pool.end(); it++ ) {
+      if ( reserveWorker( *it ) ) return *it;
+   }
+
+   //! \note Idle workers of the initial team next
+   BaseThread *thread = getUnassignedWorker();
+   if ( thread != NULL ) return thread;
+
+   //! \note Otherwise, the budget allows a new worker, bound to the CPU with fewer threads
+   _smpPlugin->createWorker( _workers );
+   thread = _workers.rbegin()->second;
+   if ( !reserveWorker( thread ) ) return NULL;
+   pool.push_back( thread );
+
+   return thread;
+}
+
 void System::endTeam ( ThreadTeam *team )
 {
    debug("Destroying thread team " << team << " with size " << team->size() );
@@ -1334,10 +1483,49 @@ void System::endTeam ( ThreadTeam *team )
 
    // For OpenMP applications at the end of the parallel return the claimed cpus
    _threadManager->returnClaimedCpus();
-   
+
+   //! \note Members return their threads to the budget, workers of the nested pools go dormant until the next team
+   int creator = team->getCreatorId();
+   const ThreadTeam::Members &members = team->getMembers();
+   _busyThreads -= (int) members.size() - ( creator >= 0 ? 1 : 0 );
+
+   _nestedLock.acquire();
+   if ( team->getLevel() < (int) _nestedPools.size() ) {
+      ThreadPool &pool = _nestedPools[team->getLevel()];
+      for ( ThreadPool::iterator it = pool.begin(); it != pool.end(); it++ ) {
+         BaseThread *thread = *it;
+         if ( std::find( members.begin(), members.end(), thread ) == members.end() ) continue;
+         thread->lock();
+         if ( !thread->hasTeam() && !thread->getNextTeam() ) thread->sleep();
+         thread->unlock();
+      }
+   }
+   _nestedLock.release();
+
+   //! \note The creator keeps the team for its next parallel region, instead of the previous one
+   if ( _hotTeams && creator >= 0 && team->getMembers()[creator] == myThread ) {
+      ThreadTeam *previous = myThread->getHotTeam();
+      myThread->setHotTeam( team );
+      team = previous;
+   }
+
    delete team;
 }
 
+ThreadTeam * System::takeHotTeam ( unsigned nthreads, SchedulePolicy &sched )
+{
+   ThreadTeam *team = myThread->getHotTeam();
+   if ( team == NULL ) return NULL;
+
+   // The barrier and the scheduler team data depend on the number of threads and the policy
+   if ( team->getMembers().size() != nthreads || &team->getSchedulePolicy() != &sched ||
+        team->getParent() != myThread->getTeam() ) return NULL;
+
+   myThread->setHotTeam( NULL );
+   team->reset();
+   return team;
+}
+
 void System::waitUntilThreadsPaused ()
 {
    // Wake up all workers to avoid deadlock
@@ -1427,10 +1615,52 @@ void System::executionSummary()
    output << "==========================================================" << std::endl;
    output << "=== Application ended in " << seconds << " seconds" << std::endl;
    output << "=== " << getCreatedTasks() << " tasks have been executed" << std::endl;
+   output << _taskStats.getSummary();
+   if ( _threadTimeStats.isEnabled() ) output << _threadTimeStats.getSummary();
+   output << _worksharingSummary;
+   if ( _net.getNumNodes() > 1 ) {
+      output << _net.getStats().getSummary();
+   }
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   if ( _hwCounters.isEnabled() ) {
+      output << _hwCounters.getSummary();
+   }
+#endif
    output << "==========================================================" << std::endl;
    message0( output.str() );
 }
 
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+void System::lockContentionReport()
+{
+   std::vector<LockSiteSummary> sites;
+   LockProfiler::getTopSites( _lockProfileTop, sites );
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary();
+   nanos_event_key_t keys[5];
+   keys[0] = ID->getEventKey( "lock-site" );
+   keys[1] = ID->getEventKey( "lock-acquisitions" );
+   keys[2] = ID->getEventKey( "lock-contended" );
+   keys[3] = ID->getEventKey( "lock-spin-time" );
+   keys[4] = ID->getEventKey( "lock-max-spin-time" );
+   for ( std::vector<LockSiteSummary>::const_iterator it = sites.begin(); it != sites.end(); it++ ) {
+      //! \note value 0 is reserved, site ids are shifted by one
+      nanos_event_value_t values[5];
+      values[0] = it->_site + 1;
+      values[1] = it->_stats._acquisitions;
+      values[2] = it->_stats._contended;
+      values[3] = it->_stats._spinTime;
+      values[4] = it->_stats._maxSpinTime;
+      ID->registerEventValue( "lock-site", it->_name.c_str(), values[0], it->_name.c_str(), false );
+      sys.getInstrumentation()->raisePointEvents( 5, keys, values );
+   }
+#endif
+
+   message0( LockProfiler::getReport( _lockProfileTop ) );
+}
+#endif
+
 #ifdef NANOS_INSTRUMENTATION_ENABLED
 // XXX Temporary hack, do not commit
 namespace {
@@ -32,6 +32,9 @@
 #include "instrumentation_decl.hpp"
 #include "synchronizedcondition.hpp"
 #include "regioncache.hpp"
+#include "livemetrics.hpp"
+#include "taskstats.hpp"
+#include "threadtimes.hpp"
 #include <cmath>
 #include <climits>
 
@@ -317,6 +320,8 @@ inline void System::setInstrumentation ( Instrumentation *instr ) { _instrumenta
 
 #ifdef NANOS_INSTRUMENTATION_ENABLED
 inline bool System::isCpuidEventEnabled ( void ) const { return _enableCpuidEvent; }
+
+inline HWCounters & System::getHWCounters ( void ) { return _hwCounters; }
 #endif
 
 inline void System::registerSlicer ( const std::string &label, Slicer *slicer) { _slicers[label] = slicer; }
@@ -327,6 +332,10 @@ inline void System::setDefaultSchedulePolicy ( SchedulePolicy *policy ) { _defSc
 inline SchedulePolicy * System::getDefaultSchedulePolicy ( ) const  { return _defSchedulePolicy; }
 
 inline SchedulerStats & System::getSchedulerStats () { return _schedStats; }
+
+inline LiveMetrics & System::getLiveMetrics () { return _liveMetrics; }
+inline TaskStats & System::getTaskStats () { return _taskStats; }
+inline ThreadTimeStats & System::getThreadTimeStats () { return _threadTimeStats; }
 inline SchedulerConf  & System::getSchedulerConf ()  { return _schedConf; }
 
 inline void System::stopScheduler ()
@@ -505,6 +514,12 @@ inline unsigned int System::nextPEId () { return _peIdSeed++; }
 
 inline Lock * System::getLockAddress ( void *addr ) const { return &_lockPool[((((uintptr_t)addr)>>8)%_lockPoolSize)];} ;
 
+inline UserLock::Kind System::getUserLocks () const { return _userLocks; }
+
+inline int System::getThreadBudget () const { return _threadBudget; }
+
+inline int System::getBusyThreads () const { return _busyThreads.value(); }
+
 inline bool System::haveDependencePendantWrites ( void *addr ) const
 {
    return myThread->getCurrentWD()->getDependenciesDomain().haveDependencePendantWrites ( addr );
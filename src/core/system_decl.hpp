@@ -43,6 +43,11 @@
 #include "hwloc_decl.hpp"
 #include "threadmanager_decl.hpp"
 #include "router_decl.hpp"
+#include "hwcounters_decl.hpp"
+#include "livemetrics_decl.hpp"
+#include "taskstats_decl.hpp"
+#include "threadtimes_decl.hpp"
+#include "userlock_decl.hpp"
 
 #include "regiondirectory_decl.hpp"
 #include "smpdevice_decl.hpp"
@@ -91,6 +96,8 @@ namespace nanos {
          typedef std::map<std::string, WorkSharing *> WorkSharings;
          typedef std::multimap<std::string, std::string> ModulesPlugins;
          typedef std::vector<ArchPlugin*> ArchitecturePlugins;
+         typedef std::vector<BaseThread *> ThreadPool;
+         typedef std::vector<ThreadPool> NestedPools;
 
          //! \brief Compiler supplied flags in symbols
          struct SuppliedFlags
@@ -123,10 +130,22 @@ namespace nanos {
          bool                 _synchronizedStart;
          bool                 _alreadyFinished;       //!< \brief Prevent System::finish from being executed more than once.
          bool                 _predecessorLists;      //!< \brief Maintain predecessors list (disabled by default).
+         bool                 _hotTeams;              //!< \brief Reuse the team of the previous parallel region of each thread
+         UserLock::Kind       _userLocks;             //!< \brief Implementation of the locks of the user API
+         int                  _threadBudget;          //!< \brief Threads that may run parallel regions at once, 0 for one per worker
+         Atomic<int>          _busyThreads;           //!< \brief Threads currently taken by teams, including the initial one
+         NestedPools          _nestedPools;           //!< \brief Workers created for nested teams, by nesting level
+         Lock                 _nestedLock;            //!< \brief Serializes the creation of nested teams
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+         unsigned int         _lockProfileTop;        //!< \brief Number of lock sites shown in the contention report
+#endif
 
 
          ThrottlePolicy      *_throttlePolicy;
          SchedulerStats       _schedStats;
+         LiveMetrics          _liveMetrics;
+         TaskStats            _taskStats;
+         ThreadTimeStats      _threadTimeStats;
          SchedulerConf        _schedConf;
          std::string          _defSchedule;           //!< \brief Name of default scheduler
          std::string          _defThrottlePolicy;     //!< \brief Name of default throttole policy (cutoff)
@@ -181,6 +200,7 @@ namespace nanos {
          std::string          _conduit;
 
          WorkSharings         _worksharings; /**< set of global worksharings */
+         std::string          _worksharingSummary; /**< Taken before the worksharings are deleted */
 
          Instrumentation     *_instrumentation; /**< Instrumentation object used in current execution */
          SchedulePolicy      *_defSchedulePolicy;
@@ -225,6 +245,7 @@ namespace nanos {
          std::list<std::string>    _disableEvents;
          std::string               _instrumentDefault;
          bool                      _enableCpuidEvent;
+         HWCounters                _hwCounters;
 #endif
 
          const int                 _lockPoolSize;
@@ -277,6 +298,12 @@ namespace nanos {
           */
          void executionSummary( void );
 
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+         /*! \brief Prints the most contended lock sites and raises them as instrumentation events
+          */
+         void lockContentionReport( void );
+#endif
+
       public:
          /*! \brief System default constructor
           */
@@ -386,6 +413,28 @@ namespace nanos {
           */
          BaseThread * getUnassignedWorker ( void );
 
+         /*!
+          * \brief Reserves thread if it has no team, as getUnassignedWorker() would
+          * \return true if thread has been reserved
+          */
+         bool reserveWorker ( BaseThread *thread );
+
+         /*!
+          * \brief Returns the team kept by the current thread if it fits a new team, NULL otherwise
+          */
+         ThreadTeam * takeHotTeam ( unsigned nthreads, SchedulePolicy &sched );
+
+         /*!
+          * \brief Takes up to nthreads threads from the thread budget
+          * \return number of threads taken, 0 when the budget is exhausted
+          */
+         unsigned takeThreadBudget ( unsigned nthreads );
+
+         /*!
+          * \brief Returns a dormant worker of the nested pool of the given level, or a new one
+          */
+         BaseThread * getNestedWorker ( int level );
+
          /*!
           * \brief Returns a new team of threads
           * \param[in] nthreads Number of threads in the team.
@@ -482,6 +531,8 @@ namespace nanos {
 
 #ifdef NANOS_INSTRUMENTATION_ENABLED
          bool isCpuidEventEnabled ( void ) const;
+
+         HWCounters & getHWCounters ( void );
 #endif
 
          void registerSlicer ( const std::string &label, Slicer *slicer);
@@ -493,6 +544,9 @@ namespace nanos {
          SchedulePolicy * getDefaultSchedulePolicy ( ) const;
 
          SchedulerStats & getSchedulerStats ();
+         LiveMetrics & getLiveMetrics ();
+         TaskStats & getTaskStats ();
+         ThreadTimeStats & getThreadTimeStats ();
          SchedulerConf  & getSchedulerConf();
 
          /*! \brief Disables the execution of pending WDs in the scheduler's
@@ -620,6 +674,14 @@ namespace nanos {
           */
          Lock * getLockAddress(void *addr ) const;
 
+         UserLock::Kind getUserLocks () const;
+
+         //! \brief Returns the maximum number of threads running parallel regions at once
+         int getThreadBudget () const;
+
+         //! \brief Returns the number of threads currently taken by teams
+         int getBusyThreads () const;
+
          /*! \brief Returns if there are pendant writes for a given memory address
           *
           *  \param [in] addr memory address
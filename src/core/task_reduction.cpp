@@ -0,0 +1,201 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "system.hpp"
+#include "instrumentation.hpp"
+#include "task_reduction.hpp"
+#include "atomic.hpp"
+#include "lock.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+
+namespace nanos {
+
+   //! \brief Reduction being finished that idle threads can help with
+   struct TaskReductionCombine {
+      TaskReduction   *reduction;
+      size_t           masterId;
+      size_t           chunkElements;
+      size_t           numChunks;
+      Atomic<size_t>   nextChunk;
+      Atomic<int>      helpers;      //!< Threads other than the owner working on it
+
+      //! \brief Reduces chunks until none is left
+      void run ( void )
+      {
+         size_t chunk;
+         while ( ( chunk = nextChunk++ ) < numChunks ) {
+            size_t first = chunk * chunkElements;
+            size_t last = first + chunkElements;
+            if ( last > reduction->_num_elements ) last = reduction->_num_elements;
+            reduction->combine( masterId, first, last );
+         }
+      }
+   };
+
+} // namespace nanos
+
+using namespace nanos;
+
+//! Reductions smaller than two chunks, in bytes, are reduced by a single thread
+static const size_t combineChunkSize = 64 * 1024;
+
+//! Only one reduction at a time is offered to idle threads
+static Lock combineLock;
+static TaskReductionCombine * volatile combineJob = NULL;
+
+//! \brief Size of a private copy padded to its alignment
+//!
+//! Copies are cache line aligned so that threads do not share lines, and page
+//! aligned when larger than a page: each page is first touched by the thread
+//! that initializes the copy, which places it on that thread's NUMA node.
+static size_t getPrivateAlignment ( size_t size )
+{
+   static const size_t pageSize = sysconf( _SC_PAGESIZE );
+   return size >= pageSize ? pageSize : NANOS_CACHELINE;
+}
+
+static void * allocatePrivate ( size_t size )
+{
+   void *storage = NULL;
+   if ( posix_memalign( &storage, getPrivateAlignment( size ), size ) != 0 ) throw NANOS_ENOMEM;
+   return storage;
+}
+
+void TaskReduction::allocateStorage ( void )
+{
+   size_t alignment = getPrivateAlignment( _size );
+   _size = ( _size + alignment - 1 ) & ~( alignment - 1 );
+
+   char * storage = (char *) allocatePrivate( _size * _num_threads );
+   _min = & storage[0];
+   _max = & storage[_size * _num_threads];
+   for ( size_t i=0; i<_num_threads; i++) {
+      _storage[i].data = (void *) &storage[i * _size];
+      _storage[i].isInitialized = false;
+   }
+}
+
+void * TaskReduction::allocate( size_t id )
+{
+   // Called by the thread that owns the copy, that will also touch it first
+   _storage[id].data = allocatePrivate( _size );
+   return _storage[id].data;
+}
+
+inline void TaskReduction::reduceElements ( reducer_t reducer, char *out, char *in, size_t n )
+{
+   if ( _arrayReducer != NULL ) {
+      _arrayReducer( out, in, n );
+   } else {
+      for( size_t j=0; j<n; j++ ) {
+         reducer( &out[j*_size_element], &in[j*_size_element] );
+      }
+   }
+}
+
+void TaskReduction::combine ( size_t masterId, size_t first, size_t last )
+{
+   char *master = &((char*)_storage[masterId].data)[first*_size_element];
+
+   //reduce all to masterId
+   for ( size_t i = masterId + 1; i<_num_threads; i++) {
+      if ( _storage[i].isInitialized ) {
+         reduceElements( _reducer, master, &((char*)_storage[i].data)[first*_size_element], last - first );
+      }
+   }
+
+   //reduce masterId to global
+   reduceElements( _reducer_orig_var, &((char*)_original)[first*_size_element], master, last - first );
+}
+
+void TaskReduction::reduce()
+{
+   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 2) );
+
+   //find first private copy that was allocated during execution
+   size_t masterId = 0;
+   for ( size_t i=0; i<_num_threads; i++) {
+      if ( _storage[i].isInitialized ){
+         masterId = i;
+         break;
+      }
+   }
+
+   if ( !_storage[masterId].isInitialized ) {
+      // No private copy has been used
+   } else if( _isFortranArrayReduction ) {
+      for ( size_t i = masterId + 1; i<_num_threads; i++) {
+         if ( _storage[i].isInitialized ) {
+            _reducer((char*)_storage[masterId].data ,(_storage[i].data));
+         }
+      }
+      _reducer_orig_var(_original ,_storage[masterId].data);
+   } else {
+      TaskReductionCombine job;
+      job.reduction = this;
+      job.masterId = masterId;
+      job.chunkElements = combineChunkSize / _size_element > 0 ? combineChunkSize / _size_element : 1;
+      job.numChunks = ( _num_elements + job.chunkElements - 1 ) / job.chunkElements;
+      job.nextChunk = 0;
+      job.helpers = 0;
+
+      bool offered = false;
+      if ( job.numChunks > 1 && combineJob == NULL && combineLock.tryAcquire() ) {
+         if ( combineJob == NULL ) {
+            combineJob = &job;
+            offered = true;
+         }
+         combineLock.release();
+      }
+
+      job.run();
+
+      if ( offered ) {
+         combineLock.acquire();
+         combineJob = NULL;
+         combineLock.release();
+         // Helpers can only be finishing the chunks they took
+         while ( job.helpers.value() != 0 ) sched_yield();
+         memoryFence();
+      }
+   }
+
+   for ( size_t i = masterId; i<_num_threads; i++) {
+      _storage[i].isInitialized = false;
+   }
+
+   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 0 ) );
+}
+
+void TaskReduction::helpReduce()
+{
+   if ( combineJob == NULL || !combineLock.tryAcquire() ) return;
+
+   TaskReductionCombine *job = combineJob;
+   if ( job != NULL ) job->helpers++;
+   combineLock.release();
+
+   if ( job != NULL ) {
+      job->run();
+      job->helpers--;
+   }
+}
@@ -22,6 +22,9 @@
 
 #include "nanos-int.h"
 
+#include <vector>
+#include <stdlib.h>
+
 //! \brief This class represent a Task Reduction.
 //!
 //! It contains all the information needed to handle a task reduction. It storages the
@@ -37,6 +40,7 @@ class TaskReduction {
 
       typedef void ( *initializer_t ) ( void *omp_priv,  void* omp_orig );
       typedef void ( *reducer_t ) ( void *obj1, void *obj2 );
+      typedef void ( *array_reducer_t ) ( void *obj1, void *obj2, size_t n );
       typedef struct {void * data; bool isInitialized;} field_t;
       typedef std::vector<field_t> storage_t;
 
@@ -57,6 +61,7 @@ class TaskReduction {
       // are only different when we are doing a Fortran Array Reduction
       reducer_t       _reducer;          //!< Reducer operator
       reducer_t       _reducer_orig_var; //!< Reducer on orignal variable
+      array_reducer_t _arrayReducer;     //!< Reducer of n consecutive elements, when known
 
       storage_t       _storage;          //!< Private copy vector
       size_t          _size;             //!< Size of array (size of element is scalar)
@@ -71,14 +76,26 @@ class TaskReduction {
       //! \brief TaskReduction copy constructor (disabled)
       TaskReduction( const TaskReduction &tr ) {}
 
+      //! \brief Allocates one private copy per thread from a single block
+      void allocateStorage ( void );
+
+      //! \brief Reduces n elements of 'in' into 'out'
+      void reduceElements ( reducer_t reducer, char *out, char *in, size_t n );
+
+      //! \brief Reduces the elements [first, last) of every private copy into
+      //! the masterId one and then into the original variable
+      void combine ( size_t masterId, size_t first, size_t last );
+
+      friend struct TaskReductionCombine;
+
    public:
 
       //! \brief TaskReduction constructor only used when we are performing a Reduction
       TaskReduction( void *orig, initializer_t f_init, reducer_t f_red,
     		  	  size_t size, size_t size_elem, size_t
-				  threads, unsigned depth, bool lazy )
+				  threads, unsigned depth, bool lazy, array_reducer_t f_array_red = NULL )
                	   : _original(orig), _dependence(orig), _depth(depth), _initializer(f_init),
-					 _reducer(f_red), _reducer_orig_var(f_red), _storage(threads),
+					 _reducer(f_red), _reducer_orig_var(f_red), _arrayReducer(f_array_red), _storage(threads),
 					 _size(size), _size_element(size_elem),_num_elements(size/size_elem),
 					 _num_threads(threads), _min(NULL), _max(NULL), _isLazyPriv (lazy), _isFortranArrayReduction(false)
    {
@@ -92,15 +109,7 @@ class TaskReduction {
          }
       }
       else {
-         NANOS_ARCHITECTURE_PADDING_SIZE(_size);
-
-         char * storage = (char*) malloc (_size*threads);
-         _min = & storage[0];
-         _max = & storage[_size * threads];
-         for ( size_t i=0; i<_num_threads; i++) {
-            _storage[i].data = (void *) &storage[i * _size];
-            _storage[i].isInitialized = false;
-         }
+         allocateStorage();
       }
    }
 
@@ -109,7 +118,7 @@ class TaskReduction {
             reducer_t f_red_orig_var, size_t array_descriptor_size, size_t
             threads, unsigned depth, bool lazy )
          : _original(orig), _dependence(dep), _depth(depth),
-         _initializer(f_init), _reducer(f_red), _reducer_orig_var(f_red_orig_var), _storage(threads),
+         _initializer(f_init), _reducer(f_red), _reducer_orig_var(f_red_orig_var), _arrayReducer(NULL), _storage(threads),
          _size(array_descriptor_size), _size_element(0),_num_elements(0),
          _num_threads(threads), _min(NULL), _max(NULL), _isLazyPriv(lazy), _isFortranArrayReduction(true)
    {
@@ -124,15 +133,7 @@ class TaskReduction {
          }
       }
       else {
-         NANOS_ARCHITECTURE_PADDING_SIZE(_size);
-         char * storage = (char*) malloc (_size * threads);
-
-         _min = & storage[0];
-         _max = & storage[_size * threads];
-         for ( size_t i=0; i<_num_threads; i++) {
-            _storage[i].data = (void *) &storage[i * _size];
-            _storage[i].isInitialized = false;
-         }
+         allocateStorage();
       }
    }
 
@@ -160,8 +161,15 @@ class TaskReduction {
       //original one. Currently, it also re-initializes to the neutral element
       //these private copies because we cannot guarantee that the reduction has
       //been finalized
+      //
+      //! Large reductions are split in chunks of elements that idle threads
+      //! help to reduce, see helpReduce()
       void reduce();
 
+      //! \brief Called by idle threads, reduces chunks of the reduction being
+      //! finished, if any
+      static void helpReduce();
+
       //! \brief It allocates the private copy associated with the 'id' thread
       void * allocate( size_t id );
 
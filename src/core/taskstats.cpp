@@ -0,0 +1,222 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "taskstats.hpp"
+#include "config.hpp"
+#include "lock.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+using namespace nanos;
+
+struct TaskStats::ThreadStats {
+   std::map< const char *, nanos_task_type_stats_t >  _types;   /**< Only touched by the owner thread */
+   ThreadStats                                       *_next;
+
+   ThreadStats() : _types(), _next( NULL ) {}
+};
+
+namespace {
+   __thread void *myStats = NULL;
+
+   unsigned int getBucket( uint64_t ns )
+   {
+      uint64_t us = ns / 1000;
+      unsigned int bucket = 0;
+      while ( us != 0 && bucket < TaskStats::NUM_BUCKETS - 1 ) {
+         us >>= 1;
+         bucket += 1;
+      }
+      return bucket;
+   }
+
+   //! \brief Adds one sample, count is the number of samples already in s
+   void addSample( nanos_task_time_stats_t &s, uint64_t count, uint64_t ns )
+   {
+      s.total_ns += ns;
+      if ( count == 0 || ns < s.min_ns ) s.min_ns = ns;
+      if ( ns > s.max_ns ) s.max_ns = ns;
+      s.histogram[ getBucket( ns ) ]++;
+   }
+
+   //! \brief Merges b into a, counts are the number of samples of each one
+   void merge( nanos_task_time_stats_t &a, uint64_t countA, nanos_task_time_stats_t const &b, uint64_t countB )
+   {
+      if ( countB == 0 ) return;
+      a.total_ns += b.total_ns;
+      if ( countA == 0 || b.min_ns < a.min_ns ) a.min_ns = b.min_ns;
+      if ( b.max_ns > a.max_ns ) a.max_ns = b.max_ns;
+      for ( unsigned int i = 0; i < TaskStats::NUM_BUCKETS; i++ ) a.histogram[i] += b.histogram[i];
+   }
+
+   void merge( nanos_task_type_stats_t &a, nanos_task_type_stats_t const &b )
+   {
+      merge( a.execution, a.count, b.execution, b.count );
+      merge( a.latency, a.count, b.latency, b.count );
+      merge( a.dependence_wait, a.count, b.dependence_wait, b.count );
+      a.count += b.count;
+   }
+
+   uint64_t elapsed( uint64_t from, uint64_t to )
+   {
+      return ( from != 0 && to > from ) ? to - from : 0;
+   }
+}
+
+TaskStats::TaskStats() : _enabled( false ), _threads( NULL ), _threadsLock() {}
+
+TaskStats::~TaskStats()
+{
+   ThreadStats *ts = _threads;
+   while ( ts != NULL ) {
+      ThreadStats *next = ts->_next;
+      delete ts;
+      ts = next;
+   }
+}
+
+void TaskStats::config( Config &cfg )
+{
+   cfg.registerConfigOption( "task-stats", NEW Config::FlagOption( _enabled ),
+                             "Collect execution statistics per task type (implied by --summary)" );
+   cfg.registerArgOption( "task-stats", "task-stats" );
+   cfg.registerEnvOption( "task-stats", "NX_TASK_STATS" );
+}
+
+void TaskStats::enable()
+{
+   _enabled = true;
+}
+
+TaskStats::ThreadStats * TaskStats::getThreadStats()
+{
+   ThreadStats *ts = (ThreadStats *) myStats;
+   if ( ts == NULL ) {
+      ts = NEW ThreadStats();
+
+      LockBlock lock( _threadsLock );
+      ts->_next = _threads;
+      _threads = ts;
+      myStats = ts;
+   }
+   return ts;
+}
+
+void TaskStats::record( WorkDescriptor &wd )
+{
+   ThreadStats &ts = *getThreadStats();
+   Times const &times = wd.getStatsTimes();
+   uint64_t end = now();
+
+   std::map< const char *, nanos_task_type_stats_t >::iterator it = ts._types.find( wd.getDescription() );
+   if ( it == ts._types.end() ) {
+      nanos_task_type_stats_t empty;
+      std::memset( &empty, 0, sizeof( empty ) );
+      it = ts._types.insert( std::make_pair( wd.getDescription(), empty ) ).first;
+   }
+   nanos_task_type_stats_t &type = it->second;
+
+   addSample( type.execution, type.count, elapsed( times._started, end ) );
+   addSample( type.latency, type.count, elapsed( times._created, times._started ) );
+   addSample( type.dependence_wait, type.count, elapsed( times._submitted, times._ready ) );
+   type.count++;
+}
+
+void TaskStats::collect( TypeStatsMap &stats )
+{
+   LockBlock lock( _threadsLock );
+   for ( ThreadStats *ts = _threads; ts != NULL; ts = ts->_next ) {
+      for ( std::map< const char *, nanos_task_type_stats_t >::const_iterator it = ts->_types.begin(); it != ts->_types.end(); it++ ) {
+         std::string name( it->first != NULL ? it->first : "(unnamed)" );
+         TypeStatsMap::iterator type = stats.find( name );
+         if ( type == stats.end() ) {
+            stats.insert( std::make_pair( name, it->second ) );
+         } else {
+            merge( type->second, it->second );
+         }
+      }
+   }
+}
+
+void TaskStats::getTypes( std::vector<const char *> &types )
+{
+   // Different WDs may point to different copies of the same description
+   std::map< std::string, const char * > names;
+   {
+      LockBlock lock( _threadsLock );
+      for ( ThreadStats *ts = _threads; ts != NULL; ts = ts->_next ) {
+         for ( std::map< const char *, nanos_task_type_stats_t >::const_iterator it = ts->_types.begin(); it != ts->_types.end(); it++ ) {
+            const char *name = it->first != NULL ? it->first : "(unnamed)";
+            names.insert( std::make_pair( std::string( name ), name ) );
+         }
+      }
+   }
+   for ( std::map< std::string, const char * >::const_iterator it = names.begin(); it != names.end(); it++ ) {
+      types.push_back( it->second );
+   }
+}
+
+void TaskStats::getTypeStats( std::string const &type, nanos_task_type_stats_t &stats )
+{
+   TypeStatsMap all;
+   collect( all );
+   TypeStatsMap::const_iterator it = all.find( type );
+   if ( it != all.end() ) stats = it->second;
+   else std::memset( &stats, 0, sizeof( stats ) );
+}
+
+uint64_t TaskStats::getMeanExecutionTime( std::string const &type )
+{
+   nanos_task_type_stats_t stats;
+   getTypeStats( type, stats );
+   return stats.count > 0 ? stats.execution.total_ns / stats.count : 0;
+}
+
+std::string TaskStats::getSummary()
+{
+   TypeStatsMap stats;
+   collect( stats );
+
+   std::ostringstream s;
+   s << "=================== Task Type Summary ====================" << std::endl;
+   for ( TypeStatsMap::const_iterator it = stats.begin(); it != stats.end(); it++ ) {
+      nanos_task_type_stats_t const &type = it->second;
+      if ( type.count == 0 ) continue;
+      s << "=== " << it->first << ": " << type.count << " tasks" << std::endl;
+      s << "===  | execution (us)   avg: " << ( type.execution.total_ns / type.count ) / 1000
+        << ", min: " << type.execution.min_ns / 1000
+        << ", max: " << type.execution.max_ns / 1000 << std::endl;
+      s << "===  | latency (us)     avg: " << ( type.latency.total_ns / type.count ) / 1000
+        << ", min: " << type.latency.min_ns / 1000
+        << ", max: " << type.latency.max_ns / 1000 << std::endl;
+      s << "===  | deps wait (us)   avg: " << ( type.dependence_wait.total_ns / type.count ) / 1000
+        << ", min: " << type.dependence_wait.min_ns / 1000
+        << ", max: " << type.dependence_wait.max_ns / 1000 << std::endl;
+      s << "===  |   execution histogram (us):";
+      for ( unsigned int idx = 0; idx < NUM_BUCKETS; idx += 1 ) {
+         if ( type.execution.histogram[ idx ] != 0 ) {
+            s << " <" << ( 1ULL << idx ) << ":" << type.execution.histogram[ idx ];
+         }
+      }
+      s << std::endl;
+   }
+   return s.str();
+}
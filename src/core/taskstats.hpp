@@ -0,0 +1,72 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOX_TASKSTATS
+#define _NANOX_TASKSTATS
+
+#include "taskstats_decl.hpp"
+#include "workdescriptor.hpp"
+#include <time.h>
+
+namespace nanos {
+
+inline bool TaskStats::isEnabled() const { return _enabled; }
+
+inline uint64_t TaskStats::now()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+inline void TaskStats::wdCreated( WorkDescriptor &wd )
+{
+   if ( _enabled ) wd.getStatsTimes()._created = now();
+}
+
+inline void TaskStats::wdSubmitted( WorkDescriptor &wd )
+{
+   if ( _enabled ) wd.getStatsTimes()._submitted = now();
+}
+
+inline void TaskStats::wdReady( WorkDescriptor &wd )
+{
+   if ( !_enabled ) return;
+   // Only the first time: tied tasks and slicers may go through the scheduler again
+   Times &times = wd.getStatsTimes();
+   if ( times._ready == 0 ) times._ready = now();
+}
+
+inline void TaskStats::wdStarted( WorkDescriptor &wd )
+{
+   if ( !_enabled ) return;
+   Times &times = wd.getStatsTimes();
+   times._started = now();
+   // Successors released straight to a thread never go through Scheduler::submit
+   if ( times._ready == 0 ) times._ready = times._started;
+}
+
+inline void TaskStats::wdFinished( WorkDescriptor &wd )
+{
+   if ( _enabled && wd.getStatsTimes()._started != 0 ) record( wd );
+}
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,116 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOX_TASKSTATS_DECL
+#define _NANOX_TASKSTATS_DECL
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "lock_decl.hpp"
+#include "config_decl.hpp"
+#include "workdescriptor_fwd.hpp"
+#include "nanos-int.h"
+
+namespace nanos {
+
+   /*! \brief Per task type execution statistics
+    *
+    *  When enabled (--task-stats, or implied by --summary) every WD records the
+    *  time it was created, submitted, became ready and started. When it
+    *  finishes, the thread finishing it charges the execution time, the
+    *  creation to start latency and the dependence wait time to the task type
+    *  (the WD description) in its own table, without atomics or locks. The
+    *  per thread tables are merged on demand, so reading the statistics is
+    *  expensive and should not be done per task.
+    *
+    *  Histograms are log2: bucket i counts the tasks that took less than 2^i
+    *  microseconds (bucket 0 holds sub-microsecond ones and the last bucket
+    *  anything larger).
+    */
+   class TaskStats {
+      public:
+         static const unsigned int NUM_BUCKETS = NANOS_TASK_STATS_BUCKETS;
+
+         /*! \brief Timestamps kept in every WD, in nanoseconds, 0 when not reached */
+         struct Times {
+            uint64_t _created;
+            uint64_t _submitted;
+            uint64_t _ready;
+            uint64_t _started;
+
+            Times() : _created( 0 ), _submitted( 0 ), _ready( 0 ), _started( 0 ) {}
+         };
+
+      private:
+         struct ThreadStats;
+         typedef std::map< std::string, nanos_task_type_stats_t > TypeStatsMap;
+
+         bool             _enabled;
+         ThreadStats     *_threads;        /**< Tables of every thread that finished a WD */
+         Lock             _threadsLock;
+
+         ThreadStats * getThreadStats();
+         /*! \brief Charges a finished WD to its task type in the table of the current thread */
+         void record( WorkDescriptor &wd );
+         void collect( TypeStatsMap &stats );
+
+      private:
+         /*! \brief TaskStats copy constructor (disabled) */
+         TaskStats( TaskStats const & );
+         /*! \brief TaskStats copy assignment operator (disabled) */
+         TaskStats & operator=( TaskStats const & );
+
+      public:
+         TaskStats();
+         ~TaskStats();
+
+         void config( Config &cfg );
+         void enable();
+         bool isEnabled() const;
+
+         static uint64_t now();
+
+         /*! \name Hooks, called along the life of a WD */
+         //@{
+         void wdCreated( WorkDescriptor &wd );
+         void wdSubmitted( WorkDescriptor &wd );
+         void wdReady( WorkDescriptor &wd );
+         void wdStarted( WorkDescriptor &wd );
+         void wdFinished( WorkDescriptor &wd );
+         //@}
+
+         /*! \brief Names of the task types with finished tasks
+          *  The names are the WD descriptions, so they live as long as the program.
+          */
+         void getTypes( std::vector<const char *> &types );
+         /*! \brief Statistics of a task type, all zero if no task of that type has finished */
+         void getTypeStats( std::string const &type, nanos_task_type_stats_t &stats );
+         /*! \brief Mean execution time in nanoseconds of a task type, 0 if unknown
+          *  Meant for cost models that refresh their predictions from time to time.
+          */
+         uint64_t getMeanExecutionTime( std::string const &type );
+
+         std::string getSummary();
+   };
+
+} // namespace nanos
+
+#endif
@@ -30,12 +30,12 @@ namespace nanos {
 
 inline ThreadTeam::ThreadTeam ( int maxThreads, SchedulePolicy &policy, ScheduleTeamData *data,
                                 Barrier &barrierImpl, ThreadTeamData & ttd, ThreadTeam * parent )
-                              : _threads(), _idList(), _expectedThreads(), _starSize(0), _idleThreads( 0 ),
+                              : _threads(), _idList(), _expectedThreads(), _members(), _starSize(0), _idleThreads( 0 ),
                                 _numTasks( 0 ), _barrier(barrierImpl),
                                 _singleGuardCount( 0 ), _schedulePolicy( policy ),
                                 _scheduleData( data ), _threadTeamData( ttd ), _parent( parent ),
                                 _level( parent == NULL ? 0 : parent->getLevel() + 1 ), _creatorId(-1),
-                                _wsDescriptor(NULL), _redList(), _lock()
+                                _wsDescriptor(NULL), _instrumentationId(0), _redList(), _lock()
 { }
 
 inline ThreadTeam::~ThreadTeam ()
@@ -65,6 +65,32 @@ inline void ThreadTeam::init ()
 {
    _barrier.init( size() );
    _threadTeamData.init( _parent );
+
+   _members.clear();
+   for ( ThreadTeamList::const_iterator it = _threads.begin(); it != _threads.end(); ++it ) {
+      _members.push_back( it->second );
+   }
+}
+
+inline void ThreadTeam::reset ()
+{
+   ensure( size() == 0 && _expectedThreads.empty(), "Reusing a non-empty team!" );
+   ensure( _redList.empty(), "Reusing a team with pending reductions!" );
+
+   // Team ids are given again from 0, and the single guards of the new team data start at 0
+   _starSize = 0;
+   _idleThreads = 0;
+   _numTasks = 0;
+   _singleGuardCount = 0;
+   _creatorId = -1;
+   _wsDescriptor = NULL;
+   _instrumentationId = 0;
+   _level = _parent == NULL ? 0 : _parent->getLevel() + 1;
+}
+
+inline const ThreadTeam::Members & ThreadTeam::getMembers () const
+{
+   return _members;
 }
 
 inline void ThreadTeam::resized ()
@@ -198,6 +224,16 @@ inline int ThreadTeam::getCreatorId() const
    return _creatorId;
 }
 
+inline uint64_t ThreadTeam::getInstrumentationId() const
+{
+   return _instrumentationId;
+}
+
+inline void ThreadTeam::setInstrumentationId( uint64_t id )
+{
+   _instrumentationId = id;
+}
+
 inline unsigned ThreadTeam::getNumStarringThreads( void ) const
 {
    return _starSize.value();
@@ -259,6 +295,35 @@ inline void ThreadTeam::computeVectorReductions ( void )
    }
 }
 
+inline bool ThreadTeam::hasReductions ( void ) const { return !_redList.empty(); }
+
+inline void ThreadTeam::combineReductionPrivates ( unsigned dst, unsigned src )
+{
+   nanos_reduction_t *red;
+   ReductionList::iterator it;
+   for ( it = _redList.begin(); it != _redList.end(); it++) {
+      red = *it;
+      if ( red->vop ) continue;
+      char *privates = reinterpret_cast<char*>(red->privates);
+      red->bop( privates + dst * red->element_size, privates + src * red->element_size, red->num_scalars );
+   }
+}
+
+inline void ThreadTeam::computeCombinedReductions ( unsigned id )
+{
+   nanos_reduction_t *red;
+   ReductionList::iterator it;
+   for ( it = _redList.begin(); it != _redList.end(); it++) {
+      red = *it;
+      if ( red->vop ) {
+         red->vop( this->size(), red->original, red->privates );
+      } else {
+         char *privates = reinterpret_cast<char*>(red->privates);
+         red->bop( red->original, privates + id * red->element_size, red->num_scalars );
+      }
+   }
+}
+
 inline void *ThreadTeam::getReductionPrivateData ( void* s )
 {
    ReductionList::iterator it;
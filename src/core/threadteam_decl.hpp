@@ -52,6 +52,9 @@ namespace nanos {
 
    class ThreadTeam
    {
+      public:
+         typedef std::vector<BaseThread *>         Members;        /**< Team members, by team id */
+
       private:
          typedef std::list<nanos_reduction_t*>     ReductionList;  /**< List of Reduction op's (Bursts) */
          typedef std::map<unsigned, BaseThread *>  ThreadTeamList; /**< List of team members */
@@ -62,6 +65,7 @@ namespace nanos {
          ThreadTeamList               _threads;          /**< Threads that make up the team */
          ThreadTeamIdList             _idList;           /**< List of id usage (reusing old id's) */
          ThreadSet                    _expectedThreads;  /**< Threads expected to form the team */
+         Members                      _members;          /**< Threads the team was initialized with */
          Atomic<size_t>               _starSize;
          int                          _idleThreads;
          int                          _numTasks;
@@ -78,6 +82,7 @@ namespace nanos {
          int                          _level;            /**< Nesting level of the team */
          int                          _creatorId;        /**< Team Id of the thread that created the team */
          nanos_ws_desc_t             *_wsDescriptor;     /**< Worksharing queue (pointer managed due specific atomic op's over these pointers) */
+         uint64_t                     _instrumentationId; /**< Team identifier given by the instrumentation plugin, 0 if not set */
          ReductionList                _redList;          /**< Reduction List */
          Lock                         _lock;
       private:
@@ -117,6 +122,17 @@ namespace nanos {
           */
          void init ();
 
+         /*! \brief Prepares a team whose threads have all left to be formed again
+          *
+          *  The barrier, the scheduler team data and the members of the previous
+          *  formation are kept, so the same threads can be added again.
+          */
+         void reset ();
+
+         /*! \brief Threads the team was initialized with, by team id
+          */
+         const Members & getMembers () const;
+
          /*! This method should be called when there's a change in the team size to readjust all structures
           *  \warn Not implemented yet!
           */
@@ -169,6 +185,14 @@ namespace nanos {
          */
          int getCreatorId() const;
 
+        /*! \brief returns the identifier given to the team by the instrumentation, 0 if not set
+         */
+         uint64_t getInstrumentationId() const;
+
+        /*! \brief sets the identifier of the team used by the instrumentation
+         */
+         void setInstrumentationId( uint64_t id );
+
         /*! \brief returns WorkSharing 
          */
          nanos_ws_desc_t  *getWorkSharingDescriptor( void );
@@ -213,6 +237,21 @@ namespace nanos {
          */
          void computeVectorReductions ( void );
 
+        /*! \brief Returns whether there are reductions to compute at next barrier
+         */
+         bool hasReductions ( void ) const;
+
+        /*! \brief Combines the private copy of thread src into the one of thread dst
+         *
+         *  Lets barriers combine privates in parallel as threads arrive. Reductions
+         *  with a vector operation are left untouched.
+         */
+         void combineReductionPrivates ( unsigned dst, unsigned src );
+
+        /*! \brief Compute reductions whose privates have already been combined into the copy of thread id
+         */
+         void computeCombinedReductions ( unsigned id );
+
         /*! \brief Get final size
          */
          size_t getFinalSize ( void ) const;
@@ -0,0 +1,154 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "threadtimes.hpp"
+#include "config.hpp"
+#include "basethread.hpp"
+#include "system.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+using namespace nanos;
+
+ThreadTimes::ThreadTimes() : _current( NANOS_THREAD_EXECUTING ), _since( 0 ), _idleSince( 0 ),
+   _findWorkCount( 0 ), _findWorkTotal( 0 ), _findWorkMax( 0 )
+{
+   std::memset( _times, 0, sizeof( _times ) );
+   std::memset( _findWorkHistogram, 0, sizeof( _findWorkHistogram ) );
+}
+
+void ThreadTimes::start( nanos_thread_time_t state )
+{
+   if ( _since != 0 ) return;
+   _current = state;
+   _since = ThreadTimeStats::now();
+}
+
+void ThreadTimes::stop()
+{
+   if ( _since == 0 ) return;
+   _times[_current] += ThreadTimeStats::now() - _since;
+   _since = 0;
+}
+
+void ThreadTimes::addTo( nanos_thread_time_stats_t &stats ) const
+{
+   // Read without synchronization: values from a running thread may be slightly stale
+   for ( int i = 0; i < NANOS_THREAD_NUM_TIMES; i++ ) stats.time_ns[i] += _times[i];
+   uint64_t since = _since;
+   if ( since != 0 ) {
+      uint64_t t = ThreadTimeStats::now();
+      if ( t > since ) stats.time_ns[_current] += t - since;
+   }
+
+   stats.find_work_count += _findWorkCount;
+   stats.find_work_total_ns += _findWorkTotal;
+   if ( _findWorkMax > stats.find_work_max_ns ) stats.find_work_max_ns = _findWorkMax;
+   for ( int i = 0; i < NANOS_FIND_WORK_BUCKETS; i++ ) stats.find_work_histogram[i] += _findWorkHistogram[i];
+}
+
+ThreadTimeStats::ThreadTimeStats() : _enabled( false ), _stopped( false ), _finalSummary() {}
+
+void ThreadTimeStats::config( Config &cfg )
+{
+   cfg.registerConfigOption( "thread-times", NEW Config::FlagOption( _enabled ),
+                             "Account threads time executing, scheduling, spinning and blocked (implied by --summary)" );
+   cfg.registerArgOption( "thread-times", "thread-times" );
+   cfg.registerEnvOption( "thread-times", "NX_THREAD_TIMES" );
+}
+
+void ThreadTimeStats::enable()
+{
+   _enabled = true;
+}
+
+void ThreadTimeStats::stop()
+{
+   if ( !_enabled || _stopped ) return;
+   _finalSummary = getSummary();
+   _stopped = true;
+}
+
+bool ThreadTimeStats::getStats( int thread, nanos_thread_time_stats_t &stats )
+{
+   std::memset( &stats, 0, sizeof( stats ) );
+
+   if ( thread >= 0 ) {
+      BaseThread *worker = sys.getWorker( (unsigned int) thread );
+      if ( worker == NULL ) return false;
+      worker->getThreadTimes().addTo( stats );
+      return true;
+   }
+
+   for ( System::ThreadList::iterator it = sys.getWorkersBegin(); it != sys.getWorkersEnd(); it++ ) {
+      it->second->getThreadTimes().addTo( stats );
+   }
+   return true;
+}
+
+const char * ThreadTimeStats::getTimeName( nanos_thread_time_t time )
+{
+   switch ( time ) {
+      case NANOS_THREAD_EXECUTING:  return "executing";
+      case NANOS_THREAD_SCHEDULING: return "scheduling";
+      case NANOS_THREAD_SPINNING:   return "spinning";
+      case NANOS_THREAD_BLOCKED:    return "blocked";
+      default:                      return "unknown";
+   }
+}
+
+std::string ThreadTimeStats::getSummary()
+{
+   if ( _stopped ) return _finalSummary;
+
+   std::ostringstream s;
+   s << "=================== Thread Time Summary ==================" << std::endl;
+
+   for ( System::ThreadList::iterator it = sys.getWorkersBegin(); it != sys.getWorkersEnd(); it++ ) {
+      nanos_thread_time_stats_t stats;
+      std::memset( &stats, 0, sizeof( stats ) );
+      it->second->getThreadTimes().addTo( stats );
+
+      uint64_t total = 0;
+      for ( int i = 0; i < NANOS_THREAD_NUM_TIMES; i++ ) total += stats.time_ns[i];
+      if ( total == 0 ) continue;
+
+      s << "=== Thread " << it->first << ":";
+      for ( int i = 0; i < NANOS_THREAD_NUM_TIMES; i++ ) {
+         s << " " << getTimeName( (nanos_thread_time_t) i ) << " "
+           << std::fixed << std::setprecision( 1 ) << ( 100.0 * stats.time_ns[i] ) / total << "%";
+      }
+      s << std::endl;
+      if ( stats.find_work_count > 0 ) {
+         s << "===  | find work (us)   avg: " << ( stats.find_work_total_ns / stats.find_work_count ) / 1000
+           << ", max: " << stats.find_work_max_ns / 1000
+           << ", count: " << stats.find_work_count << std::endl;
+         s << "===  |   find work histogram (us):";
+         for ( unsigned int idx = 0; idx < NANOS_FIND_WORK_BUCKETS; idx += 1 ) {
+            if ( stats.find_work_histogram[ idx ] != 0 ) {
+               s << " <" << ( 1ULL << idx ) << ":" << stats.find_work_histogram[ idx ];
+            }
+         }
+         s << std::endl;
+      }
+   }
+   return s.str();
+}
@@ -0,0 +1,75 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOX_THREADTIMES
+#define _NANOX_THREADTIMES
+
+#include "threadtimes_decl.hpp"
+#include <time.h>
+
+namespace nanos {
+
+inline uint64_t ThreadTimeStats::now()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+inline bool ThreadTimeStats::isEnabled() const { return _enabled; }
+
+inline nanos_thread_time_t ThreadTimes::enter( nanos_thread_time_t state )
+{
+   nanos_thread_time_t previous = _current;
+   if ( _since == 0 ) return previous;
+
+   uint64_t t = ThreadTimeStats::now();
+   _times[_current] += t - _since;
+   _since = t;
+   _current = state;
+   return previous;
+}
+
+inline void ThreadTimes::idleStarted()
+{
+   if ( _since != 0 ) _idleSince = ThreadTimeStats::now();
+}
+
+inline void ThreadTimes::workFound()
+{
+   if ( _idleSince == 0 ) return;
+
+   uint64_t ns = ThreadTimeStats::now() - _idleSince;
+   _idleSince = 0;
+
+   uint64_t us = ns / 1000;
+   unsigned int bucket = 0;
+   while ( us != 0 && bucket < NANOS_FIND_WORK_BUCKETS - 1 ) {
+      us >>= 1;
+      bucket += 1;
+   }
+   _findWorkCount++;
+   _findWorkTotal += ns;
+   if ( ns > _findWorkMax ) _findWorkMax = ns;
+   _findWorkHistogram[bucket]++;
+}
+
+} // namespace nanos
+
+#endif
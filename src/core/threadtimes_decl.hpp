@@ -0,0 +1,120 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOX_THREADTIMES_DECL
+#define _NANOX_THREADTIMES_DECL
+
+#include <string>
+#include <stdint.h>
+#include "config_decl.hpp"
+#include "nanos-int.h"
+
+namespace nanos {
+
+   /*! \brief Wall time breakdown of one thread
+    *
+    *  The thread is always in one of the nanos_thread_time_t states: executing
+    *  tasks, inside scheduling policy calls, spinning in the idle loop, or
+    *  blocked (yielding the CPU or sleeping). Every state change charges the
+    *  time since the previous one to the state being left, so states nest:
+    *  an idle loop run from a taskwait returns to executing when it leaves.
+    *
+    *  It also measures how long the thread takes to find work since it
+    *  became idle. Only the owner thread updates it, with plain stores.
+    */
+   class ThreadTimes {
+      private:
+         uint64_t             _times[NANOS_THREAD_NUM_TIMES];
+         nanos_thread_time_t  _current;
+         uint64_t             _since;           /**< Start of the current state */
+         uint64_t             _idleSince;       /**< Time the thread became idle, 0 if it is not looking for work */
+         uint64_t             _findWorkCount;
+         uint64_t             _findWorkTotal;
+         uint64_t             _findWorkMax;
+         uint64_t             _findWorkHistogram[NANOS_FIND_WORK_BUCKETS];
+
+      private:
+         /*! \brief ThreadTimes copy constructor (disabled) */
+         ThreadTimes( ThreadTimes const & );
+         /*! \brief ThreadTimes copy assignment operator (disabled) */
+         ThreadTimes & operator=( ThreadTimes const & );
+
+      public:
+         ThreadTimes();
+
+         /*! \brief Starts accounting, in state */
+         void start( nanos_thread_time_t state );
+         /*! \brief Stops accounting, charging the current state */
+         void stop();
+
+         /*! \brief Changes the current state
+          *  \return The state left, to be restored by the caller
+          */
+         nanos_thread_time_t enter( nanos_thread_time_t state );
+
+         /*! \brief The thread starts looking for work */
+         void idleStarted();
+         /*! \brief The thread found work since the last idleStarted() */
+         void workFound();
+
+         /*! \brief Adds the times of this thread to stats, including the current state */
+         void addTo( nanos_thread_time_stats_t &stats ) const;
+   };
+
+   /*! \brief Configuration and reports of the thread time breakdown
+    *
+    *  Enabled with --thread-times, or implied by --summary. When disabled the
+    *  hooks in the scheduler are a single test and no clock is read.
+    */
+   class ThreadTimeStats {
+      private:
+         bool        _enabled;
+         bool        _stopped;
+         std::string _finalSummary;    /**< Taken by stop(), while the threads still exist */
+
+      private:
+         /*! \brief ThreadTimeStats copy constructor (disabled) */
+         ThreadTimeStats( ThreadTimeStats const & );
+         /*! \brief ThreadTimeStats copy assignment operator (disabled) */
+         ThreadTimeStats & operator=( ThreadTimeStats const & );
+
+      public:
+         ThreadTimeStats();
+
+         void config( Config &cfg );
+         void enable();
+         bool isEnabled() const;
+         /*! \brief Keeps the summary of the threads, to be called before they are deleted */
+         void stop();
+
+         static uint64_t now();
+
+         /*! \brief Times of a worker thread, or of all of them when thread is negative
+          *  \return false if there is no such thread
+          */
+         bool getStats( int thread, nanos_thread_time_stats_t &stats );
+
+         static const char *getTimeName( nanos_thread_time_t time );
+
+         std::string getSummary();
+   };
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,143 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "userlock.hpp"
+#include "system.hpp"
+#include "schedule.hpp"
+#include "synchronizedcondition.hpp"
+#include "adaptivewait.hpp"
+#include "atomic.hpp"
+#include "lock.hpp"
+
+#include <stdint.h>
+
+namespace nanos {
+
+   //! \brief WD suspended on a task-aware lock, it lives in the stack of the WD
+   struct UserLockWaiter {
+      nanos_lock_t                                  *lock;
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+      int                                            granted;   //!< Set when the lock is handed over to the WD
+#else
+      volatile int                                   granted;
+#endif
+      SingleSyncCond<EqualConditionChecker<int> >    cond;
+      UserLockWaiter                                *next;
+
+      UserLockWaiter ( nanos_lock_t &l ) : lock( &l ), granted( 0 ), cond( EqualConditionChecker<int>( &granted, 1 ) ), next( NULL ) {}
+   };
+
+   //! \brief Waiters, in arrival order, of the locks whose address hashes to the queue
+   struct UserLockQueue {
+      Lock              lock;
+      Atomic<int>       waiters;   //!< Read without the lock by releasers
+      UserLockWaiter   *head;
+      UserLockWaiter   *tail;
+      char              pad[NANOS_CACHELINE];
+
+      UserLockQueue () : lock(), waiters( 0 ), head( NULL ), tail( NULL ) {}
+   };
+
+} // namespace nanos
+
+using namespace nanos;
+
+namespace {
+   const unsigned int numUserLockQueues = 64;
+   UserLockQueue userLockQueues[numUserLockQueues];
+
+   inline UserLockQueue & getQueue ( nanos_lock_t &lock )
+   {
+      return userLockQueues[ ( (uintptr_t) &lock / sizeof( nanos_lock_t ) ) % numUserLockQueues ];
+   }
+}
+
+/*! Waiters take the lock word themselves only before queueing, once queued
+ *  the lock is handed over to them. Queueing and the last try happen under
+ *  the lock of the queue, and releasers look for waiters after releasing the
+ *  word, so either the try or the releaser sees the other one.
+ */
+void UserLock::acquireTaskAware ( nanos_lock_t &lock )
+{
+   Lock &word = static_cast<Lock &>( lock );
+   if ( word.tryAcquire() ) return;
+
+   // The holder may be about to release it, spin for a while first
+   const uint64_t start = AdaptiveWait::now();
+   const uint64_t spinTime = sys.getSchedulerConf().getSyncSpinTime();
+   do {
+      if ( word.getState() == NANOS_LOCK_FREE && word.tryAcquire() ) return;
+   } while ( AdaptiveWait::now() - start < spinTime );
+
+   UserLockQueue &queue = getQueue( lock );
+   UserLockWaiter waiter( lock );
+
+   queue.lock.acquire();
+   queue.waiters++;
+   memoryFence();
+   if ( word.tryAcquire() ) {
+      queue.waiters--;
+      queue.lock.release();
+      return;
+   }
+   if ( queue.tail == NULL ) queue.head = &waiter;
+   else queue.tail->next = &waiter;
+   queue.tail = &waiter;
+   queue.lock.release();
+
+   // Other work runs on this thread until the lock is handed over
+   waiter.cond.waitConditionAndSignalers();
+}
+
+void UserLock::releaseTaskAware ( nanos_lock_t &lock )
+{
+   Lock &word = static_cast<Lock &>( lock );
+   UserLockQueue &queue = getQueue( lock );
+
+   word.release();
+   memoryFence();
+   if ( queue.waiters.value() == 0 ) return;
+
+   queue.lock.acquire();
+   UserLockWaiter *previous = NULL, *waiter = queue.head;
+   while ( waiter != NULL && waiter->lock != &lock ) {
+      previous = waiter;
+      waiter = waiter->next;
+   }
+
+   // If another thread has taken the lock meanwhile, its release hands it over
+   if ( waiter == NULL || !word.tryAcquire() ) {
+      queue.lock.release();
+      return;
+   }
+
+   if ( previous == NULL ) queue.head = waiter->next;
+   else previous->next = waiter->next;
+   if ( queue.tail == waiter ) queue.tail = previous;
+   queue.waiters--;
+
+   // The waiter may leave as soon as it sees the lock granted, but not before the signal is over
+   waiter->cond.reference();
+   memoryFence();
+   waiter->granted = 1;
+   queue.lock.release();
+
+   waiter->cond.signal();
+   waiter->cond.unreference();
+}
@@ -0,0 +1,59 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_USERLOCK
+#define _NANOS_USERLOCK
+
+#include "userlock_decl.hpp"
+#include "lock.hpp"
+#include "ticketlock.hpp"
+#include "system.hpp"
+
+namespace nanos {
+
+inline void UserLock::acquire ( nanos_lock_t &lock )
+{
+   switch ( sys.getUserLocks() ) {
+      case DEFAULT: static_cast<Lock &>( lock ).acquire(); break;
+      case TASK: acquireTaskAware( lock ); break;
+      default: static_cast<TicketLock &>( lock ).acquire();
+   }
+}
+
+inline bool UserLock::tryAcquire ( nanos_lock_t &lock )
+{
+   switch ( sys.getUserLocks() ) {
+      case DEFAULT:
+      case TASK: return static_cast<Lock &>( lock ).tryAcquire();
+      default: return static_cast<TicketLock &>( lock ).tryAcquire();
+   }
+}
+
+inline void UserLock::release ( nanos_lock_t &lock )
+{
+   switch ( sys.getUserLocks() ) {
+      case DEFAULT: static_cast<Lock &>( lock ).release(); break;
+      case TASK: releaseTaskAware( lock ); break;
+      default: static_cast<TicketLock &>( lock ).release();
+   }
+}
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,56 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_USERLOCK_DECL
+#define _NANOS_USERLOCK_DECL
+
+#include "nanos-int.h"
+
+namespace nanos {
+
+   /*! \brief Locks of the user API: nanos_*_lock, critical sections and OpenMP locks
+    *
+    *  The implementation is chosen at run time with --user-locks. A
+    *  nanos_lock_t is used in place either as a Lock (the default) or as a
+    *  TicketLock. MCS locks do not fit in a nanos_lock_t, they are only used
+    *  by OpenMP locks, and nanos_lock_t ones are TicketLocks with them.
+    *
+    *  Task-aware locks are Locks whose waiters, after spinning for a while,
+    *  leave the thread to other work: the WD is suspended on a wait queue of
+    *  the lock and the release hands the lock over to the first waiter, that
+    *  is queued again through the scheduler.
+    */
+   class UserLock
+   {
+      public:
+         typedef enum { DEFAULT, TICKET, MCS, TASK } Kind;
+
+      private:
+         static void acquireTaskAware ( nanos_lock_t &lock );
+         static void releaseTaskAware ( nanos_lock_t &lock );
+
+      public:
+         static void acquire ( nanos_lock_t &lock );
+         static bool tryAcquire ( nanos_lock_t &lock );
+         static void release ( nanos_lock_t &lock );
+   };
+
+} // namespace nanos
+
+#endif
@@ -33,6 +33,8 @@ namespace nanos {
 inline WDDeque::WDDeque( bool enableDeviceCounter ) : _dq(), _lock(), _nelems(0), _ndevs(),
    _deviceCounter( enableDeviceCounter )
 {
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_lock, "wd-deque" ) )
+
    if ( _deviceCounter ) {
       const DeviceList &devs = sys.getSupportedDevices();
       for ( DeviceList::const_iterator it = devs.begin(); it != devs.end(); ++it ) {
@@ -531,6 +533,8 @@ inline WDPriorityQueue<T>::WDPriorityQueue( bool enableDeviceCounter, bool optim
    : _dq(), _lock(), _nelems(0), _optimise( optimise ), _reverse( reverse ), _ndevs(), _deviceCounter( enableDeviceCounter ),
      _getter( getter ), _maxPriority( 0 ), _minPriority( 0 )
 {
+   NANOS_LOCK_PROFILE( LockProfiler::registerLock( &_lock, "wd-priority-queue" ) )
+
    if ( _deviceCounter ) {
       const DeviceList &devs = sys.getSupportedDevices();
       for ( DeviceList::const_iterator it = devs.begin(); it != devs.end(); ++it ) {
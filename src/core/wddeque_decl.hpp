@@ -139,7 +139,7 @@ namespace nanos {
          WDDeque( bool enableDeviceCounter = true );
          /*! \brief WDDeque destructor
           */
-         ~WDDeque() {}
+         ~WDDeque() { NANOS_LOCK_PROFILE( LockProfiler::unregisterLock( &_lock ) ) }
 
          bool empty ( void ) const;
          size_t size() const;
@@ -366,7 +366,7 @@ namespace nanos {
          
          /*! \brief WDPriorityQueue destructor
           */
-         ~WDPriorityQueue() {}
+         ~WDPriorityQueue() { NANOS_LOCK_PROFILE( LockProfiler::unregisterLock( &_lock ) ) }
 
          bool empty ( void ) const;
          size_t size() const;
@@ -132,6 +132,7 @@ void WorkDescriptor::start (ULTFlag isUserLevelThread, WorkDescriptor *previous)
 
    // Getting run time
    _runTime = ( sys.getDefaultSchedulePolicy()->isCheckingWDRunTime() ? OS::getMonotonicTimeUs() : 0.0 );
+   sys.getTaskStats().wdStarted( *this );
 
 }
 
@@ -176,6 +177,7 @@ bool WorkDescriptor::isInputDataReady() {
 
       // Getting run time
       _runTime = ( sys.getDefaultSchedulePolicy()->isCheckingWDRunTime() ? OS::getMonotonicTimeUs() : 0.0 );
+      sys.getTaskStats().wdStarted( *this );
 
    }
    return result;
@@ -560,7 +562,8 @@ void WorkDescriptor::exitWork ( WorkDescriptor &work )
 }
 
 void WorkDescriptor::registerTaskReduction( void *p_orig, size_t p_size, size_t p_el_size,
-      void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ) )
+      void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ),
+      void (*p_array_reducer)( void *, void *, size_t ) )
 {
    //! Check if we have registered a reduction with this address
    task_reduction_vector_t::reverse_iterator it;
@@ -582,7 +585,8 @@ void WorkDescriptor::registerTaskReduction( void *p_orig, size_t p_size, size_t
 					   p_el_size,
 					   sys.getThreadManager()->getMaxThreads(),
 					   myThread->getCurrentWD()->getDepth(),
-					   sys._lazyPrivatizationEnabled
+					   sys._lazyPrivatizationEnabled,
+					   p_array_reducer
 					   )
        );
    }
@@ -58,7 +58,7 @@ inline WorkDescriptor::WorkDescriptor ( int ndevices, DeviceData **devs, size_t
                                  _copiesNotInChunk(false), _description(description), _instrumentationContextData(), _slicer(NULL),
                                  _taskReductions(),
                                  _notifyCopy( NULL ), _notifyThread( NULL ), _remoteAddr( NULL ), _callback(0), _arguments(0),
-                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _schedPredecessorLocs(),
+                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _statsTimes(), _schedPredecessorLocs(),
                                  _mcontrol( this, numCopies )
                                  {
                                     _flags.is_final = 0;
@@ -95,7 +95,7 @@ inline WorkDescriptor::WorkDescriptor ( DeviceData *device, size_t data_size, si
                                  _priority( 0 ),  _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk(false), _description(description), _instrumentationContextData(), _slicer(NULL), _taskReductions(),
                                  _notifyCopy( NULL ), _notifyThread( NULL ), _remoteAddr( NULL ), _callback(0), _arguments(0), 
-                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _schedPredecessorLocs(),
+                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _statsTimes(), _schedPredecessorLocs(),
                                  _mcontrol( this, numCopies )
                                  {
                                      _devices = new DeviceData*[1];
@@ -135,7 +135,7 @@ inline WorkDescriptor::WorkDescriptor ( const WorkDescriptor &wd, DeviceData **d
                                  _priority( wd._priority ), _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk( wd._copiesNotInChunk), _description(description), _instrumentationContextData(), _slicer(wd._slicer), _taskReductions(),
                                  _notifyCopy( NULL ), _notifyThread( NULL ), _remoteAddr( NULL ), _callback(0), _arguments(0),
-                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _schedPredecessorLocs(),
+                                 _submittedWDs( NULL ), _reachedTaskwait( false ), _statsTimes(), _schedPredecessorLocs(),
                                  _mcontrol( this, wd._numCopies )
                                  {
                                     if ( wd._parent != NULL ) wd._parent->addWork(*this);
@@ -498,6 +498,8 @@ inline bool WorkDescriptor::isRuntimeTask( void ) const { return _flags.is_runti
 
 inline const char * WorkDescriptor::getDescription ( void ) const  { return _description; }
 
+inline TaskStats::Times & WorkDescriptor::getStatsTimes ( void ) { return _statsTimes; }
+
 inline void WorkDescriptor::addWork ( WorkDescriptor &work )
 {
    _components++;
@@ -43,6 +43,7 @@
 
 #include "dependenciesdomain_decl.hpp"
 #include "task_reduction_decl.hpp"
+#include "taskstats_decl.hpp"
 #include "simpleallocator_decl.hpp"
 #include "schedule_fwd.hpp"   // ScheduleWDData
 
@@ -277,6 +278,7 @@ typedef std::set<const Device *>  DeviceList;
          void                         *_arguments;
          std::vector<WorkDescriptor *>*_submittedWDs;
          bool                          _reachedTaskwait;
+         TaskStats::Times              _statsTimes;             //!< Life cycle timestamps, only set when task statistics are enabled
       public:
          int                           _schedValues[8];
          std::map<memory_space_id_t,unsigned int>   _schedPredecessorLocs;
@@ -692,6 +694,9 @@ typedef std::set<const Device *>  DeviceList;
 
          const char * getDescription ( void ) const;
 
+         //! \brief Timestamps used by the task type statistics
+         TaskStats::Times & getStatsTimes ( void );
+
          //! \brief Removing work from current WorkDescriptor
          virtual void exitWork ( WorkDescriptor &work );
 
@@ -711,9 +716,11 @@ typedef std::set<const Device *>  DeviceList;
          void convertToRegularWD();
 
          //! \brief This function registers a new task reduction over a
-         //variable if it is not already registered.
+         //variable if it is not already registered. p_array_reducer, when
+         //given, reduces many consecutive elements at once.
          void registerTaskReduction( void *p_orig, size_t p_size, size_t elem_size,
-                 void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ) );
+                 void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ),
+                 void (*p_array_reducer)( void *, void *, size_t ) = NULL );
 
          //! \brief This function registers a new fortran task reduction over an
          //array if it is not already registered.
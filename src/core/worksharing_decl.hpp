@@ -18,6 +18,7 @@
 /*************************************************************************************/
 
 #include "nanos-int.h"
+#include <string>
 
 #ifndef _NANOS_WORK_SHARING_H
 #define _NANOS_WORK_SHARING_H
@@ -35,12 +36,19 @@ namespace nanos {
          //! \return only one thread per loop will get 'true' (single like behaviour)
          virtual bool create( nanos_ws_desc_t **wsd, nanos_ws_info_t *info ) = 0;
 
+         //! \brief create a loop descriptor, knowing the code address that creates it
+         //! Policies that learn from the previous executions of each loop override it
+         virtual bool createAtSite( nanos_ws_desc_t **wsd, nanos_ws_info_t *info, const void *site ) { return create( wsd, info ); }
+
          //! \brief Get next chunk of iterations
          //! \return if there are more iterations to execute
          virtual void nextItem( nanos_ws_desc_t *wsd, nanos_ws_item_t *wsi ) = 0 ;
 
          //! \brief Duplicates a WorkSharing Descriptor
          virtual void duplicateWS ( nanos_ws_desc_t *orig, nanos_ws_desc_t **copy) = 0;
+
+         //! \brief What the policy has learned, for the execution summary
+         virtual std::string getSummary() const { return std::string(); }
    };
 
 } // namespace nanos
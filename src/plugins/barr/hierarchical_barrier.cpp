@@ -0,0 +1,270 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "barrier.hpp"
+#include "system.hpp"
+#include "atomic.hpp"
+#include "schedule.hpp"
+#include "plugin.hpp"
+#include "synchronizedcondition.hpp"
+#include "allocator_decl.hpp"
+
+#include <vector>
+
+namespace nanos {
+   namespace ext {
+
+      /*! \class HierarchicalBarrier
+       *  \brief implements a combining tree barrier shaped after the machine topology
+       *
+       *  Participants are grouped level by level: hardware threads of a core,
+       *  cores sharing an L3 cache, caches of a socket and finally sockets. The
+       *  lowest participant of each group is its leader and takes part in the
+       *  next level. Team ids follow the CPU order with the default (compact)
+       *  binding, so consecutive participants are grouped.
+       *
+       *  Each participant arrives by setting its own flag, and leaves when its
+       *  leader sets its release flag, both with sense reversal and on separate
+       *  cache lines. Leaders combine the reduction privates of their group as
+       *  it arrives, so team reductions take as many steps as levels.
+       */
+      class HierarchicalBarrier: public Barrier
+      {
+
+         private:
+            /*! Flag written by one thread and waited by another one, padded to its own cache line */
+            struct Flag {
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+               int value;
+#else
+               volatile int value;
+#endif
+               SingleSyncCond<EqualConditionChecker<int> > condition;
+               char pad[NANOS_CACHELINE];
+
+               Flag() : value( 0 ), condition() {}
+               Flag( const Flag & orig ) : value( 0 ), condition( orig.condition ) {}
+               Flag & operator= ( const Flag & orig ) { value = 0; condition = orig.condition; return *this; }
+            };
+
+            /*! Per participant data */
+            struct Node {
+               Flag               arrival;     /*!< Set by the participant, waited by its parent */
+               Flag               release;     /*!< Set by the parent, waited by the participant */
+               int                sense;       /*!< Only used by the participant */
+               int                parent;
+               std::vector<int>   children;    /*!< Lower levels first */
+
+               Node() : arrival(), release(), sense( 0 ), parent( -1 ), children() {}
+            };
+
+            typedef std::vector<Node> Nodes;
+            typedef std::vector<Nodes *> Trees;
+
+            /*! Participants may still be leaving a barrier while others resize it
+             *  when leaving the team, so trees are never modified once built and
+             *  previous ones are kept until the barrier is destroyed. Teams that
+             *  are formed again switch back to the tree of their size. */
+            Nodes *_nodes;
+            Trees _trees;
+            int _numParticipants;
+
+            static void getFanIns ( std::vector<int> &fanIns );
+            void build ( int numParticipants );
+            void wait ( Flag &flag, int sense );
+            void signal ( Flag &flag, int sense );
+
+         public:
+            HierarchicalBarrier () : Barrier(), _nodes( NULL ), _trees(), _numParticipants( 0 ) {}
+            HierarchicalBarrier ( const HierarchicalBarrier& orig ) : Barrier(orig), _nodes( NULL ), _trees(), _numParticipants( 0 )
+               { init( orig._numParticipants ); }
+
+            const HierarchicalBarrier & operator= ( const HierarchicalBarrier & orig );
+
+            virtual ~HierarchicalBarrier()
+            {
+               for ( Trees::iterator it = _trees.begin(); it != _trees.end(); it++ ) delete *it;
+            }
+
+            void init ( int numParticipants );
+            void resize ( int numThreads );
+
+            void barrier ( int participant );
+      };
+
+      const HierarchicalBarrier & HierarchicalBarrier::operator= ( const HierarchicalBarrier & orig )
+      {
+         // self-assignment
+         if ( &orig == this ) return *this;
+
+         Barrier::operator=(orig);
+
+         if ( orig._numParticipants != _numParticipants )
+            resize(orig._numParticipants);
+
+         return *this;
+      }
+
+      /*! \brief Group sizes of each level, from the hardware threads of a core up to the sockets */
+      void HierarchicalBarrier::getFanIns ( std::vector<int> &fanIns )
+      {
+         unsigned int threadsPerCore = 0, coresPerCache = 0, cachesPerSocket = 0;
+         sys._hwloc.getCpuHierarchy( threadsPerCore, coresPerCache, cachesPerSocket );
+
+         if ( threadsPerCore == 0 && coresPerCache == 0 && cachesPerSocket == 0 ) {
+            // Without hwloc, the SMP plugin still knows the CPUs of each socket
+            threadsPerCore = 1;
+            coresPerCache = sys.getSMPPlugin()->getCPUsPerSocket();
+            cachesPerSocket = 1;
+         }
+
+         if ( threadsPerCore > 1 ) fanIns.push_back( threadsPerCore );
+         if ( coresPerCache > 1 ) fanIns.push_back( coresPerCache );
+         if ( cachesPerSocket > 1 ) fanIns.push_back( cachesPerSocket );
+      }
+
+      void HierarchicalBarrier::build ( int numParticipants )
+      {
+         // Every completed barrier leaves all the nodes of its tree with the same sense
+         for ( Trees::iterator it = _trees.begin(); it != _trees.end(); it++ ) {
+            if ( (int) (*it)->size() == numParticipants ) {
+               _nodes = *it;
+               _numParticipants = numParticipants;
+               return;
+            }
+         }
+
+         // Top levels, over the sockets, gather at most this many leaders each
+         const int maxTopFanIn = 8;
+
+         Nodes &nodes = *NEW Nodes( numParticipants );
+
+         std::vector<int> fanIns;
+         getFanIns( fanIns );
+
+         int stride = 1;
+         for ( unsigned int level = 0; stride < numParticipants; level++ ) {
+            int fanIn;
+            if ( level < fanIns.size() ) {
+               fanIn = fanIns[level];
+            } else {
+               int leaders = ( numParticipants + stride - 1 ) / stride;
+               fanIn = leaders <= maxTopFanIn ? leaders : 4;
+            }
+
+            // Leaders of the previous level are the multiples of stride
+            int group = stride * fanIn;
+            for ( int p = 0; p < numParticipants; p += stride ) {
+               int leader = p - p % group;
+               if ( leader != p ) {
+                  nodes[p].parent = leader;
+                  nodes[leader].children.push_back( p );
+               }
+            }
+            stride = group;
+         }
+
+         // The tree must be complete before any participant can see it
+         memoryFence();
+         _trees.push_back( &nodes );
+         _nodes = &nodes;
+         _numParticipants = numParticipants;
+      }
+
+      void HierarchicalBarrier::init( int numParticipants )
+      {
+         build( numParticipants );
+      }
+
+      void HierarchicalBarrier::resize( int numParticipants )
+      {
+         build( numParticipants );
+      }
+
+      inline void HierarchicalBarrier::wait ( Flag &flag, int sense )
+      {
+         flag.condition.setConditionChecker( EqualConditionChecker<int>( &flag.value, sense ) );
+         flag.condition.wait();
+      }
+
+      inline void HierarchicalBarrier::signal ( Flag &flag, int sense )
+      {
+         // Whatever was done before, including reductions, is visible to the waiter
+         memoryFence();
+         flag.value = sense;
+         flag.condition.signal();
+      }
+
+      void HierarchicalBarrier::barrier( int participant )
+      {
+         Nodes &nodes = *_nodes;
+         Node &me = nodes[participant];
+         int sense = me.sense = 1 - me.sense;
+
+         ThreadTeam *team = myThread->getTeam();
+         bool reductions = team->hasReductions();
+
+         /*! Arrival: wait for the groups this participant leads, combining their privates */
+         for ( std::vector<int>::const_iterator it = me.children.begin(); it != me.children.end(); it++ ) {
+            wait( nodes[*it].arrival, sense );
+            if ( reductions ) team->combineReductionPrivates( participant, *it );
+         }
+
+         if ( me.parent != -1 ) {
+            signal( me.arrival, sense );
+            wait( me.release, sense );
+         } else if ( reductions ) {
+            memoryFence();
+            team->computeCombinedReductions( participant );
+            team->cleanUpReductionList();
+         }
+
+         /*! Release: top levels first, so that the whole tree wakes up sooner */
+         for ( std::vector<int>::reverse_iterator it = me.children.rbegin(); it != me.children.rend(); it++ ) {
+            signal( nodes[*it].release, sense );
+         }
+      }
+
+
+      static Barrier * createHierarchicalBarrier()
+      {
+         return NEW HierarchicalBarrier();
+      }
+
+
+      /*! \class HierarchicalBarrierPlugin
+       *  \brief plugin of the related HierarchicalBarrier class
+       *  \see HierarchicalBarrier
+       */
+      class HierarchicalBarrierPlugin : public Plugin
+      {
+
+         public:
+            HierarchicalBarrierPlugin() : Plugin( "Hierarchical Barrier Plugin",1 ) {}
+
+            virtual void config( Config &cfg ) {}
+
+            virtual void init() {
+               sys.setDefaultBarrFactory( createHierarchicalBarrier );
+            }
+      };
+   }
+}
+
+DECLARE_PLUGIN("barr-hierarchical",nanos::ext::HierarchicalBarrierPlugin);
@@ -22,18 +22,37 @@
 #include "instrumentation.hpp"
 #include "instrumentationcontext_decl.hpp"
 #include "ompt.h"
+#include <vector>
 
 using namespace nanos;
 
-extern "C" {
+namespace nanos {
+   namespace ompt {
+      Lock                  _lock;
+      ompt_parallel_id_t    count_parallel_id = 1;
 
-   namespace nanos {
-      namespace ompt {
-         Lock _lock;
-         std::map<void *, int> map_parallel_id;
-         ompt_parallel_id_t    count_parallel_id = 1;
+      /*! \brief Returns the parallel id of a team, assigning a new one the first time
+       *  The id is kept in the team itself, so only the first lookup takes the lock.
+       */
+      ompt_parallel_id_t getParallelId( ThreadTeam *team );
+      ompt_parallel_id_t getParallelId( ThreadTeam *team )
+      {
+         if ( team == NULL ) return (ompt_parallel_id_t) 0;
+         ompt_parallel_id_t id = (ompt_parallel_id_t) team->getInstrumentationId();
+         if ( id != 0 ) return id;
+
+         LockBlock lock( _lock );
+         id = (ompt_parallel_id_t) team->getInstrumentationId();
+         if ( id == 0 ) {
+            id = count_parallel_id++;
+            team->setInstrumentationId( (uint64_t) id );
+         }
+         return id;
       }
    }
+}
+
+extern "C" {
 
    int ompt_initialize(
          ompt_function_lookup_t lookup,  /* function to look up OMPT API routines by name */
@@ -51,15 +70,6 @@ extern "C" {
    ompt_state_t nanos_state_values[OMPT_NANOS_STATES] = { ompt_state_first, ompt_state_idle, ompt_state_work_serial, ompt_state_work_parallel, ompt_state_undefined };
    const char  *nanos_state_string[OMPT_NANOS_STATES] = { "First", "Idle", "Serial", "Parallel", "Undefined" };
 
-   // Scheduler break point callback
-   typedef void (*break_point_callback_t)( void );
-
-   void breakPointCallBack(void); 
-   void breakPointCallBack(void) { 
-      // fprintf(stderr, "sched. step, thread %p\n", nanos::myThread);
-      nanos::myThread->setSteps(1);
-   }
-
    //! List of callback declarations
    ompt_parallel_begin_callback_t      ompt_nanos_event_parallel_begin = NULL;
    ompt_parallel_end_callback_t        ompt_nanos_event_parallel_end = NULL;
@@ -260,24 +270,13 @@ extern "C" {
    ompt_parallel_id_t ompt_nanos_get_parallel_id( int ancestor_level )
    {
 
-      ompt_parallel_id_t rv = 0;
-
       ThreadTeam *tt = myThread->getTeam();
       while ( ancestor_level > 0 && tt != NULL ) {
          tt = tt->getParent();
          ancestor_level--;
       }
-      if ( tt != NULL ) {
-
-         nanos::ompt::_lock.acquire();
-         if ( nanos::ompt::map_parallel_id.find((void *) tt ) != nanos::ompt::map_parallel_id.end() )
-            rv = nanos::ompt::map_parallel_id[(void *) tt];
-         else
-            rv = (ompt_parallel_id_t) 0;
-         nanos::ompt::_lock.release();
-      }
-      
-      return rv;
+
+      return nanos::ompt::getParallelId( tt );
    }
 
    int ompt_nanos_get_parallel_team_size( int ancestor_level );
@@ -342,13 +341,160 @@ extern "C" {
 
 namespace nanos
 {
-   class InstrumentationOMPT: public Instrumentation 
+   class InstrumentationOMPT: public Instrumentation
    {
       private:
-         ompt_task_id_t * _previousTask;
-         int            * _threadActive;
+         /*! \brief Handles an event of the list, it may consume the events that follow it */
+         typedef void (*EventHandler) ( Event *events, unsigned int count, unsigned int &i );
+
+         struct KeyHandlers {
+            EventHandler point;
+            EventHandler burstStart;
+            EventHandler burstEnd;
+
+            KeyHandlers() : point( NULL ), burstStart( NULL ), burstEnd( NULL ) {}
+         };
+
+         std::vector<KeyHandlers>  _handlers;     /**< Indexed by event key, only for the keys the registered callbacks need */
+         ompt_task_id_t          * _previousTask;
+         int                     * _threadActive;
+
+         static nanos_event_key_t    _setNumThreadsKey;
+         static nanos_event_key_t    _parallelOutlineKey;
+         static nanos_event_key_t    _teamPtrKey;
+         static nanos_event_value_t  _apiCreateTeam;
+         static nanos_event_value_t  _apiEndTeam;
+         static nanos_event_value_t  _apiBarrier;
+         static nanos_event_value_t  _apiEnterTeam;
+         static nanos_event_value_t  _apiLeaveTeam;
+         static nanos_event_value_t  _apiTaskwait;
+
+         /*! \brief Enables an event key and returns its handlers */
+         KeyHandlers & wire( const char *keyName )
+         {
+            InstrumentationDictionary *iD = getInstrumentationDictionary();
+            iD->switchEventPrefix( keyName, EVENT_ENABLED );
+            nanos_event_key_t key = iD->getEventKey( keyName );
+            if ( key >= _handlers.size() ) _handlers.resize( key + 1 );
+            return _handlers[key];
+         }
+
+         static ompt_task_id_t currentTaskId()
+         {
+            return (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId();
+         }
+
+         static void taskBegin( Event *events, unsigned int count, unsigned int &i )
+         {
+            WorkDescriptor *wd = (WorkDescriptor *) events[i].getValue();
+            if ( wd->isImplicit() ) return;
+            //Add an event for each task implementation
+            for ( unsigned int j = 0; j < wd->getNumDevices(); j++) {
+               ompt_nanos_event_task_begin(
+                     currentTaskId(),
+                     NULL,  // FIXME: task frame
+                     (ompt_task_id_t) wd->getId(),
+                     (void*)wd->getDevices()[j]->getWorkFct()
+                     );
+            }
+         }
+
+         static void dependence( Event *events, unsigned int count, unsigned int &i )
+         {
+            nanos_event_value_t dependence_value = events[i].getValue();
+            int sender_id = (int) ( dependence_value >> 32 ) & 0xFFFFFFFF;
+            int receiver_id = (int) ( dependence_value & 0xFFFFFFFF );
+
+            ompt_nanos_event_dependence(
+               (ompt_task_id_t) sender_id,
+               (ompt_task_id_t) receiver_id
+            );
+         }
+
+         static void apiBegin( Event *events, unsigned int count, unsigned int &i )
+         {
+            nanos_event_value_t val = events[i].getValue();
+
+            if ( val == _apiEndTeam ) {
+               if ( !ompt_nanos_event_parallel_end ) return;
+               ThreadTeam *team = NULL;
+               while ( i + 1 < count ) {
+                  Event &e1 = events[++i];
+                  if ( e1.getKey() == _teamPtrKey ) {
+                     team = (ThreadTeam *) e1.getValue();
+                     break;
+                  }
+               }
+               ompt_nanos_event_parallel_end (
+                     nanos::ompt::getParallelId( team ),
+                     currentTaskId(),
+                     ompt_invoker_runtime);
+            } else if ( val == _apiBarrier && ompt_nanos_event_barrier_begin ) {
+               ompt_nanos_event_barrier_begin (
+                     nanos::ompt::getParallelId( myThread->getTeam() ),
+                     currentTaskId(),
+                     NULL);
+            } else if ( val == _apiLeaveTeam && ompt_nanos_event_implicit_task_end ) {
+               ompt_nanos_event_implicit_task_end (
+                     nanos::ompt::getParallelId( myThread->getTeam() ),
+                     currentTaskId() );
+            } else if ( val == _apiTaskwait && ompt_nanos_event_taskwait_begin ) {
+               ompt_nanos_event_taskwait_begin (
+                     nanos::ompt::getParallelId( myThread->getTeam() ),
+                     currentTaskId() );
+            }
+         }
+
+         static void apiEnd( Event *events, unsigned int count, unsigned int &i )
+         {
+            nanos_event_value_t val = events[i].getValue();
+
+            if ( val == _apiBarrier && ompt_nanos_event_barrier_end ) {
+               ompt_nanos_event_barrier_end (
+                     nanos::ompt::getParallelId( myThread->getTeam() ),
+                     currentTaskId() );
+            } else if ( val == _apiCreateTeam && ompt_nanos_event_parallel_begin ) {
+               uint32_t team_size = 0;
+               void *parallel_fct = NULL;
+               ThreadTeam *team = NULL;
+
+               while ( i + 1 < count ) {
+                  Event &e1 = events[++i];
+                  if ( e1.getKey() == _setNumThreadsKey ) {
+                     team_size = (uint32_t) e1.getValue();
+                  } else if ( e1.getKey() == _parallelOutlineKey ) {
+                     parallel_fct = (void *) e1.getValue();
+                  } else if ( e1.getKey() == _teamPtrKey ) {
+                     team = (ThreadTeam *) e1.getValue();
+                     break;
+                  }
+               }
+
+               ompt_frame_t cb_frame;
+               cb_frame.exit_runtime_frame = NULL; // FIXME: frame data of parent task
+               cb_frame.reenter_runtime_frame = NULL; // FIXME: as ^^^
+
+               ompt_nanos_event_parallel_begin (
+                     currentTaskId(),
+                     &cb_frame,
+                     nanos::ompt::getParallelId( team ),
+                     (uint32_t) team_size,
+                     (void *) parallel_fct,
+                     ompt_invoker_runtime
+                     );
+            } else if ( val == _apiEnterTeam && ompt_nanos_event_implicit_task_begin ) {
+               ompt_nanos_event_implicit_task_begin (
+                     nanos::ompt::getParallelId( myThread->getTeam() ),
+                     currentTaskId() );
+            } else if ( val == _apiTaskwait && ompt_nanos_event_taskwait_end ) {
+               ompt_nanos_event_taskwait_end (
+                     nanos::ompt::getParallelId( myThread->getTeam() ),
+                     currentTaskId() );
+            }
+         }
+
       public:
-         InstrumentationOMPT( ) : Instrumentation( *NEW InstrumentationContextDisabled()), _previousTask(NULL) {}
+         InstrumentationOMPT( ) : Instrumentation( *NEW InstrumentationContextDisabled()), _handlers(), _previousTask(NULL), _threadActive(NULL) {}
          ~InstrumentationOMPT() { }
          void initialize( void )
          {
@@ -361,6 +507,39 @@ namespace nanos
                _threadActive[i] = 0;
             }
 
+            // Only the events needed by the callbacks registered by the tool reach the plugin,
+            // the runtime does not create the others (disabled keys are 0)
+            InstrumentationDictionary *iD = getInstrumentationDictionary();
+            iD->switchEventPrefix( "", EVENT_DISABLED );
+            _emitStateEvents = false;
+            _emitPtPEvents = false;
+            _emitInternalEvents = false;
+
+            if ( ompt_nanos_event_task_begin ) wire( "create-wd-ptr" ).point = taskBegin;
+            if ( ompt_nanos_event_dependence ) wire( "dependence" ).point = dependence;
+            if ( ompt_nanos_event_parallel_begin || ompt_nanos_event_parallel_end ||
+                 ompt_nanos_event_barrier_begin || ompt_nanos_event_barrier_end ||
+                 ompt_nanos_event_implicit_task_begin || ompt_nanos_event_implicit_task_end ||
+                 ompt_nanos_event_taskwait_begin || ompt_nanos_event_taskwait_end ) {
+               KeyHandlers &api = wire( "api" );
+               api.burstStart = apiBegin;
+               api.burstEnd = apiEnd;
+               _apiCreateTeam = iD->getEventValue( "api", "create_team" );
+               _apiEndTeam = iD->getEventValue( "api", "end_team" );
+               _apiBarrier = iD->getEventValue( "api", "omp_barrier" );
+               _apiEnterTeam = iD->getEventValue( "api", "enter_team" );
+               _apiLeaveTeam = iD->getEventValue( "api", "leave_team" );
+               _apiTaskwait = iD->getEventValue( "api", "wg_wait_completion" );
+               if ( ompt_nanos_event_parallel_begin ) {
+                  wire( "set-num-threads" );
+                  wire( "parallel-outline-fct" );
+                  _setNumThreadsKey = iD->getEventKey( "set-num-threads" );
+                  _parallelOutlineKey = iD->getEventKey( "parallel-outline-fct" );
+               }
+               wire( "team-ptr" );
+               _teamPtrKey = iD->getEventKey( "team-ptr" );
+            }
+
             // initialize() cannot reference myThead object
             if (ompt_nanos_event_thread_begin) {
                ompt_nanos_event_thread_begin( (ompt_thread_type_t) ompt_thread_initial, (ompt_thread_id_t) 0);
@@ -374,202 +553,47 @@ namespace nanos
             }
             if ( ompt_nanos_event_shutdown ) ompt_nanos_event_shutdown();
             if ( _previousTask ) free ( _previousTask );
+            if ( _threadActive ) free ( _threadActive );
          }
          void disable( void ) {}
          void enable( void ) {}
          void addEventList ( unsigned int count, Event *events )
          {
-            InstrumentationDictionary *iD = getInstrumentationDictionary();
-            static const nanos_event_key_t create_wd_ptr = iD->getEventKey("create-wd-ptr");
-            static const nanos_event_key_t set_num_threads = iD->getEventKey("set-num-threads");
-
-            static const nanos_event_key_t api = iD->getEventKey("api");
-            static const nanos_event_value_t api_create_team = iD->getEventValue("api","create_team");
-            static const nanos_event_value_t api_end_team = iD->getEventValue("api","end_team");
-            static const nanos_event_value_t api_barrier = iD->getEventValue("api","omp_barrier");
-            static const nanos_event_value_t api_enter_team = iD->getEventValue("api","enter_team");
-            static const nanos_event_value_t api_leave_team = iD->getEventValue("api","leave_team");
-            static const nanos_event_value_t api_taskwait = iD->getEventValue("api","wg_wait_completion");
-
-            static const nanos_event_key_t parallel_outline = iD->getEventKey("parallel-outline-fct");
-            static const nanos_event_key_t team_info = iD->getEventKey("team-ptr");
-            static const nanos_event_key_t dependence =  iD->getEventKey("dependence");
-            //static const nanos_event_key_t dep_direction = iD->getEventKey("dep-direction");
-            //static const nanos_event_key_t dep_address = iD->getEventKey("dep-address");
-
-            unsigned int i;
-            for( i=0; i<count; i++) {
-               Event &e = events[i];
-// XXX: debug information
-#if 0
-               int thid = nanos::myThread? nanos::myThread->getId():0; 
-               fprintf(stderr,"NANOS++ [%d]: (%d/%d) event %ld value %lu\n",
-                     thid,
-                     (int)i+1,
-                     (int)count,
-                     (long) e.getKey(),
-                     (unsigned long) e.getValue()
-                     ); 
-#endif
-               switch ( e.getType() ) {
+            for ( unsigned int i = 0; i < count; i++ ) {
+               nanos_event_key_t key = events[i].getKey();
+               if ( key == 0 || key >= _handlers.size() ) continue;
+
+               EventHandler handler = NULL;
+               switch ( events[i].getType() ) {
                   case NANOS_POINT:
-                     if ( e.getKey( ) == create_wd_ptr && ompt_nanos_event_task_begin )
-                     {
-                        WorkDescriptor *wd = (WorkDescriptor *) e.getValue();
-                        if ( !wd->isImplicit() ) {
-                           //Add an event for each task implementation
-                           for ( unsigned int j = 0; j < wd->getNumDevices(); j++) {
-                              ompt_nanos_event_task_begin(
-                                    (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId(),
-                                    NULL,  // FIXME: task frame
-                                    (ompt_task_id_t) wd->getId(),
-                                    (void*)wd->getDevices()[j]->getWorkFct()
-                                    );
-                           }
-                        }
-                     }
-                     if ( e.getKey() == dependence && ompt_nanos_event_dependence ) {
-                        nanos_event_value_t dependence_value = e.getValue();
-                        int sender_id = (int) ( dependence_value >> 32 ) & 0xFFFFFFFF;
-                        int receiver_id = (int) ( dependence_value & 0xFFFFFFFF );
-
-                        ompt_nanos_event_dependence(
-                           (ompt_task_id_t) sender_id,
-                           (ompt_task_id_t) receiver_id
-                        );
-                     }
+                     handler = _handlers[key].point;
                      break;
                   case NANOS_BURST_START:
-                     if ( e.getKey( ) == api )
-                     {
-                        nanos_event_value_t val = e.getValue();
-
-                        // getting current team id
-                        ThreadTeam *tt = myThread->getTeam();
-                        ompt_parallel_id_t team_id = 0;
-                        if ( tt != NULL ) {
-                           nanos::ompt::_lock.acquire();
-                           if ( nanos::ompt::map_parallel_id.find((void *) tt ) != nanos::ompt::map_parallel_id.end() )
-                              team_id = nanos::ompt::map_parallel_id[(void *) tt];
-                           nanos::ompt::_lock.release();
-                        }
-
-                        if ( val == api_end_team && ompt_nanos_event_parallel_end ) {
-                           void *team_ptr = NULL;
-                           ompt_parallel_id_t p_id = 0;
-                           while ( i < count ) {
-                              Event &e1 = events[++i];
-                              if ( e1.getKey() == team_info) {
-                                 team_ptr = (void *) e1.getValue();
-                                 nanos::ompt::_lock.acquire();
-                                 if ( nanos::ompt::map_parallel_id.find((void *) team_ptr ) != nanos::ompt::map_parallel_id.end() ) {
-                                    p_id = nanos::ompt::map_parallel_id[(void *) team_ptr];
-                                 }
-                                 nanos::ompt::_lock.release();
-                                 break;
-                              }
-                           }
-                           ompt_nanos_event_parallel_end (
-                                 (ompt_parallel_id_t) p_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId(),
-                                 ompt_invoker_runtime);
-                        } else if ( val == api_barrier && ompt_nanos_event_barrier_begin ) {
-                           ompt_nanos_event_barrier_begin (
-                                 (ompt_parallel_id_t) team_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId(),
-                                 NULL);
-                        } else if ( val == api_leave_team && ompt_nanos_event_implicit_task_end ) {
-                           ompt_nanos_event_implicit_task_end (
-                                 (ompt_parallel_id_t) team_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId() );
-                        } else if ( val == api_taskwait && ompt_nanos_event_taskwait_begin ) {
-                           ompt_nanos_event_taskwait_begin (
-                                 (ompt_parallel_id_t) team_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId() );
-                        }
-
-                     }
+                     handler = _handlers[key].burstStart;
                      break;
                   case NANOS_BURST_END:
-                     if ( e.getKey( ) == api )
-                     {
-                        nanos_event_value_t val = e.getValue();
-                        
-                        // getting current team id
-                        ThreadTeam *tt = myThread->getTeam();
-                        ompt_parallel_id_t team_id = 0;
-                        if ( tt != NULL ) {
-                           nanos::ompt::_lock.acquire();
-                           if ( nanos::ompt::map_parallel_id.find((void *) tt ) != nanos::ompt::map_parallel_id.end() )
-                              team_id = nanos::ompt::map_parallel_id[(void *) tt];
-                           nanos::ompt::_lock.release();
-                        }
-
-                        if ( val == api_barrier && ompt_nanos_event_barrier_end ) {
-                           ompt_nanos_event_barrier_end (
-                                 (ompt_parallel_id_t) team_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId() );
-                        } else if ( val == api_create_team && ompt_nanos_event_parallel_begin ) {
-                           uint32_t team_size = 0;
-                           void *parallel_fct = NULL;
-                           void *team_ptr = NULL;
-                           ompt_parallel_id_t p_id = 0;
-
-                           while ( i < count ) {
-                              Event &e1 = events[++i];
-                              if ( e1.getKey() == set_num_threads ) {
-                                 team_size = (uint32_t) e1.getValue();
-                              }
-                              else if ( e1.getKey() == parallel_outline ) {
-                                 parallel_fct = (void *) e1.getValue();
-                              } else if ( e1.getKey() == team_info) {
-                                 team_ptr = (void *) e1.getValue();
-                                 nanos::ompt::_lock.acquire();
-                                 if ( nanos::ompt::map_parallel_id.find((void *) team_ptr ) == nanos::ompt::map_parallel_id.end() ) {
-                                    p_id = nanos::ompt::count_parallel_id++;
-                                    nanos::ompt::map_parallel_id[(void *) team_ptr] = p_id;
-                                 }
-                                 nanos::ompt::_lock.release();
-                                 break;
-                              }
-                           }
-
-                           ompt_frame_t cb_frame;
-                           cb_frame.exit_runtime_frame = NULL; // FIXME: frame data of parent task
-                           cb_frame.reenter_runtime_frame = NULL; // FIXME: as ^^^
-
-                           ompt_nanos_event_parallel_begin (
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId(),
-                                 &cb_frame,
-                                 (ompt_parallel_id_t) p_id,
-                                 (uint32_t) team_size,
-                                 (void *) parallel_fct,
-                                 ompt_invoker_runtime
-                                 );
-                        } else if ( val == api_enter_team && ompt_nanos_event_implicit_task_begin ) {
-                           ompt_nanos_event_implicit_task_begin (
-                                 (ompt_parallel_id_t) team_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId() );
-                        } else if ( val == api_taskwait && ompt_nanos_event_taskwait_end ) {
-                           ompt_nanos_event_taskwait_end (
-                                 (ompt_parallel_id_t) team_id,
-                                 (ompt_task_id_t) nanos::myThread->getCurrentWD()->getId() );
-                        }
-                     }
-                     break;
-                  case NANOS_STATE_START:
-                  case NANOS_STATE_END:
-                  case NANOS_SUBSTATE_START:
-                  case NANOS_SUBSTATE_END:
-                  case NANOS_PTP_START:
-                  case NANOS_PTP_END:
-                  case EVENT_TYPES:
+                     handler = _handlers[key].burstEnd;
                      break;
                   default:
                      break;
                }
+               if ( handler != NULL ) handler( events, count, i );
             }
          }
+         /*! \brief WDs do not need an instrumentation context: no events are deferred */
+         void wdCreate( WorkDescriptor* newWD ) {}
+         void flushDeferredEvents ( WorkDescriptor* wd ) {}
+         /*! \brief Task switches go straight to the task callbacks, without building events */
+         void wdSwitch( WorkDescriptor* oldWD, WorkDescriptor* newWD, bool last )
+         {
+            // Hardware counters are charged to the tasks by the generic implementation
+            if ( sys.getHWCounters().isEnabled() ) {
+               Instrumentation::wdSwitch( oldWD, newWD, last );
+               return;
+            }
+            if ( oldWD != NULL ) addSuspendTask( *oldWD, last );
+            if ( newWD != NULL ) addResumeTask( *newWD );
+         }
          void addResumeTask( WorkDescriptor &w )
          {
             if ( !ompt_nanos_event_task_switch ) return;
@@ -585,20 +609,18 @@ namespace nanos
          }
          void addSuspendTask( WorkDescriptor &w, bool last )
          {
-            int thid = (int) nanos::myThread->getId();
-            if (last) _previousTask[thid] = (ompt_task_id_t) 0;
-            else _previousTask[thid] = (ompt_task_id_t) w.getId();
-
             if (ompt_nanos_event_task_end && last) {
                ompt_nanos_event_task_end((ompt_task_id_t) w.getId());
             }
+
+            // The previous task is only needed by the task switch callback
+            if ( !ompt_nanos_event_task_switch ) return;
+            int thid = (int) nanos::myThread->getId();
+            if (last) _previousTask[thid] = (ompt_task_id_t) 0;
+            else _previousTask[thid] = (ompt_task_id_t) w.getId();
          }
-         void threadStart( BaseThread &thread ) 
+         void threadStart( BaseThread &thread )
          {
-            // Setting break point
-            thread.setSteps (1);
-            thread.setCallBack ( breakPointCallBack );
-
             int thid = nanos::myThread->getId();
 
             if (ompt_nanos_event_thread_begin) {
@@ -614,6 +636,17 @@ namespace nanos
          }
          void incrementMaxThreads( void ) {}
    };
+
+   nanos_event_key_t    InstrumentationOMPT::_setNumThreadsKey = 0;
+   nanos_event_key_t    InstrumentationOMPT::_parallelOutlineKey = 0;
+   nanos_event_key_t    InstrumentationOMPT::_teamPtrKey = 0;
+   nanos_event_value_t  InstrumentationOMPT::_apiCreateTeam = 0;
+   nanos_event_value_t  InstrumentationOMPT::_apiEndTeam = 0;
+   nanos_event_value_t  InstrumentationOMPT::_apiBarrier = 0;
+   nanos_event_value_t  InstrumentationOMPT::_apiEnterTeam = 0;
+   nanos_event_value_t  InstrumentationOMPT::_apiLeaveTeam = 0;
+   nanos_event_value_t  InstrumentationOMPT::_apiTaskwait = 0;
+
    namespace ext
    {
       class InstrumentationOMPTPlugin : public Plugin
@@ -0,0 +1,447 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "plugin.hpp"
+#include "system.hpp"
+#include "instrumentation.hpp"
+#include "instrumentationcontext_decl.hpp"
+#include "atomic.hpp"
+#include "lock.hpp"
+#include "os.hpp"
+#include "ring_trace_format.hpp"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+namespace nanos {
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+namespace ringtrace {
+
+   /*! \brief Cheapest monotonic timestamp available, converted to ns offline */
+   inline uint64_t readTicks()
+   {
+#if defined(__x86_64__) || defined(__i386__)
+      uint32_t lo, hi;
+      __asm__ __volatile__ ( "rdtsc" : "=a" (lo), "=d" (hi) );
+      return ( ( (uint64_t) hi ) << 32 ) | lo;
+#else
+      struct timespec ts;
+      clock_gettime( CLOCK_MONOTONIC, &ts );
+      return ( (uint64_t) ts.tv_sec ) * 1000000000ULL + ts.tv_nsec;
+#endif
+   }
+
+   /*! \brief Records of one thread
+    *  The owner thread is the only producer and the flusher thread the only
+    *  consumer, so the buffer needs no locks: each side only writes its own
+    *  index. Events that do not fit are dropped (and counted) instead of
+    *  blocking the thread.
+    */
+   class RingBuffer {
+      private:
+         Record           *_records;
+         uint64_t          _mask;
+         Atomic<uint64_t>  _head;      /**< Next record to write, owner thread */
+         Atomic<uint64_t>  _tail;      /**< Next record to flush, flusher thread */
+         uint64_t          _dropped;
+         uint16_t          _thread;
+
+         RingBuffer( RingBuffer const & );
+         RingBuffer & operator=( RingBuffer const & );
+
+      public:
+         /*! \param size number of records, must be a power of two */
+         RingBuffer( uint64_t size, uint16_t thread ) : _records( NEW Record[ size ] ), _mask( size - 1 ),
+            _head( 0 ), _tail( 0 ), _dropped( 0 ), _thread( thread ) {}
+
+         ~RingBuffer() { delete[] _records; }
+
+         void push( unsigned int count, Instrumentation::Event *events, uint64_t time )
+         {
+            uint64_t head = _head.value();
+            if ( head + count - _tail.value() > _mask + 1 ) {
+               _dropped += count;
+               return;
+            }
+            for ( unsigned int i = 0; i < count; i++ ) {
+               Instrumentation::Event &e = events[i];
+               Record &r = _records[ ( head + i ) & _mask ];
+               r.time = time;
+               r.value = e.getValue();
+               r.id = e.getId();
+               r.key = e.getKey();
+               r.thread = _thread;
+               r.type = (uint8_t) e.getType();
+               r.domain = (uint8_t) e.getDomain();
+            }
+#ifndef HAVE_NEW_GCC_ATOMIC_OPS
+            memoryFence();
+#endif
+            _head = head + count;
+         }
+
+         /*! \brief Hands the pending records to writer, returns how many */
+         template < class Writer >
+         uint64_t flush( Writer &writer )
+         {
+            uint64_t tail = _tail.value();
+            uint64_t head = _head.value();
+            uint64_t pending = head - tail;
+            while ( tail != head ) {
+               uint64_t first = tail & _mask;
+               uint64_t n = std::min( head - tail, _mask + 1 - first );
+               writer.write( &_records[ first ], n * sizeof( Record ) );
+               tail += n;
+            }
+            _tail = tail;
+            return pending;
+         }
+
+         uint64_t getDropped() const { return _dropped; }
+   };
+
+   /*! \brief Output file written through a sliding mmap'ed window */
+   class MappedFile {
+      private:
+         static const uint64_t WINDOW_SIZE = 4 * 1024 * 1024;
+
+         int       _fd;
+         char     *_window;
+         uint64_t  _windowOffset;
+         uint64_t  _fileSize;
+         uint64_t  _position;
+
+         MappedFile( MappedFile const & );
+         MappedFile & operator=( MappedFile const & );
+
+         bool mapWindow( uint64_t offset )
+         {
+            if ( _window != NULL ) {
+               munmap( _window, WINDOW_SIZE );
+               _window = NULL;
+            }
+            if ( _fileSize < offset + WINDOW_SIZE ) {
+               if ( ftruncate( _fd, offset + WINDOW_SIZE ) != 0 ) return false;
+               _fileSize = offset + WINDOW_SIZE;
+            }
+            void *addr = mmap( NULL, WINDOW_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, offset );
+            if ( addr == MAP_FAILED ) return false;
+            _window = (char *) addr;
+            _windowOffset = offset;
+            return true;
+         }
+
+      public:
+         MappedFile() : _fd( -1 ), _window( NULL ), _windowOffset( 0 ), _fileSize( 0 ), _position( 0 ) {}
+         ~MappedFile() {}
+
+         bool open( std::string const &name )
+         {
+            _fd = ::open( name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+            return _fd != -1;
+         }
+
+         bool isOpen() const { return _fd != -1; }
+
+         void seek( uint64_t position ) { _position = position; }
+
+         uint64_t getPosition() const { return _position; }
+
+         void write( void const *data, std::size_t len )
+         {
+            if ( _fd == -1 ) return;
+            char const *src = (char const *) data;
+            while ( len > 0 ) {
+               if ( _window == NULL || _position < _windowOffset || _position >= _windowOffset + WINDOW_SIZE ) {
+                  if ( !mapWindow( _position - ( _position % WINDOW_SIZE ) ) ) {
+                     warning0( "ring_trace: could not map the trace file, tracing stopped" );
+                     ::close( _fd );
+                     _fd = -1;
+                     return;
+                  }
+               }
+               std::size_t n = std::min( (uint64_t) len, _windowOffset + WINDOW_SIZE - _position );
+               std::memcpy( _window + ( _position - _windowOffset ), src, n );
+               src += n;
+               len -= n;
+               _position += n;
+            }
+         }
+
+         void close()
+         {
+            if ( _window != NULL ) {
+               munmap( _window, WINDOW_SIZE );
+               _window = NULL;
+            }
+            if ( _fd != -1 ) {
+               if ( ftruncate( _fd, _position ) != 0 ) {
+                  warning0( "ring_trace: could not truncate the trace file" );
+               }
+               ::close( _fd );
+               _fd = -1;
+            }
+         }
+   };
+
+   static __thread RingBuffer *myBuffer = NULL;
+
+} // namespace ringtrace
+#endif
+
+class InstrumentationRingTrace: public Instrumentation
+{
+   public:
+      static std::string _fileName;
+      static int         _bufferSize;       /**< Records per thread */
+      static int         _flushInterval;    /**< Flusher period in microseconds */
+
+#ifndef NANOS_INSTRUMENTATION_ENABLED
+   public:
+      // constructor
+      InstrumentationRingTrace() : Instrumentation() {}
+      // destructor
+      ~InstrumentationRingTrace() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void ) {}
+      void finalize( void ) {}
+      void disable( void ) {}
+      void enable( void ) {}
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+      void addEventList ( unsigned int count, Event *events ) {}
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+#else
+   private:
+      ringtrace::MappedFile                  _file;
+      std::vector< ringtrace::RingBuffer * > _buffers;
+      Lock                                   _buffersLock;
+      Lock                                   _fileLock;       /**< Serializes flushes */
+      volatile bool                          _enabled;
+      volatile bool                          _stop;
+      bool                                   _flusherStarted;
+      pthread_t                              _flusher;
+      uint64_t                               _numRecords;
+      uint64_t                               _startTicks;
+      double                                 _startTime;
+      std::string                            _traceName;
+
+      ringtrace::RingBuffer *registerThread()
+      {
+         LockBlock lock( _buffersLock );
+         uint64_t size = 1;
+         while ( size < (uint64_t) _bufferSize ) size <<= 1;
+         ringtrace::RingBuffer *buffer = NEW ringtrace::RingBuffer( size, (uint16_t) _buffers.size() );
+         _buffers.push_back( buffer );
+         ringtrace::myBuffer = buffer;
+         return buffer;
+      }
+
+      void flushBuffers()
+      {
+         LockBlock fileLock( _fileLock );
+         if ( !_file.isOpen() ) return;
+         _buffersLock.acquire();
+         std::vector< ringtrace::RingBuffer * > buffers( _buffers );
+         _buffersLock.release();
+         for ( std::vector< ringtrace::RingBuffer * >::iterator it = buffers.begin(); it != buffers.end(); it++ ) {
+            _numRecords += (*it)->flush( _file );
+         }
+      }
+
+      static void * flusherLoop( void *arg )
+      {
+         InstrumentationRingTrace *trace = (InstrumentationRingTrace *) arg;
+         while ( !trace->_stop ) {
+            usleep( _flushInterval );
+            trace->flushBuffers();
+         }
+         return NULL;
+      }
+
+      void writeDictionary()
+      {
+         std::ostringstream s;
+         InstrumentationDictionary *iD = getInstrumentationDictionary();
+         for ( InstrumentationDictionary::ConstKeyMapIterator kit = iD->beginKeyMap(); kit != iD->endKeyMap(); kit++ ) {
+            InstrumentationKeyDescriptor *kD = kit->second;
+            s << "K\t" << kD->getId() << "\t" << kit->first << "\t" << kD->getDescription() << "\n";
+            for ( InstrumentationKeyDescriptor::ConstValueMapIterator vit = kD->beginValueMap(); vit != kD->endValueMap(); vit++ ) {
+               s << "V\t" << kD->getId() << "\t" << vit->second->getId() << "\t" << vit->second->getDescription() << "\n";
+            }
+         }
+         std::string dictionary = s.str();
+         _file.write( dictionary.c_str(), dictionary.size() );
+      }
+
+   public:
+      // constructor
+      InstrumentationRingTrace() : Instrumentation( *new InstrumentationContextDisabled() ), _file(), _buffers(),
+         _buffersLock(), _fileLock(), _enabled( false ), _stop( false ), _flusherStarted( false ), _flusher(),
+         _numRecords( 0 ), _startTicks( 0 ), _startTime( 0.0 ), _traceName() {}
+      // destructor
+      ~InstrumentationRingTrace()
+      {
+         for ( std::vector< ringtrace::RingBuffer * >::iterator it = _buffers.begin(); it != _buffers.end(); it++ ) {
+            delete *it;
+         }
+      }
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void )
+      {
+         std::ostringstream name;
+         if ( _fileName.empty() ) {
+            name << "nanox-trace-" << getpid() << "-" << sys.getNetwork()->getNodeNum() << ".nxr";
+         } else {
+            name << _fileName;
+         }
+         _traceName = name.str();
+         if ( !_file.open( _traceName ) ) {
+            warning0( "ring_trace: could not open " << _traceName << ", tracing disabled" );
+            return;
+         }
+         _file.seek( sizeof( ringtrace::FileHeader ) );
+
+         _startTime = OS::getMonotonicTime();
+         _startTicks = ringtrace::readTicks();
+         _enabled = true;
+
+         _flusherStarted = pthread_create( &_flusher, NULL, flusherLoop, this ) == 0;
+         if ( !_flusherStarted ) {
+            warning0( "ring_trace: could not start the flusher thread, records will be flushed at shutdown" );
+         }
+      }
+
+      void finalize( void )
+      {
+         if ( !_file.isOpen() ) return;
+
+         _enabled = false;
+         _stop = true;
+         if ( _flusherStarted ) pthread_join( _flusher, NULL );
+
+         /* calibrate the ticks against the monotonic clock */
+         uint64_t endTicks = ringtrace::readTicks();
+         double endTime = OS::getMonotonicTime();
+
+         flushBuffers();
+
+         ringtrace::FileHeader header;
+         std::memset( &header, 0, sizeof( header ) );
+         std::memcpy( header.magic, ringtrace::MAGIC, sizeof( header.magic ) );
+         header.version = ringtrace::FORMAT_VERSION;
+         header.recordSize = sizeof( ringtrace::Record );
+         header.numThreads = _buffers.size();
+         header.node = sys.getNetwork()->getNodeNum();
+         header.recordsOffset = sizeof( ringtrace::FileHeader );
+         header.numRecords = _numRecords;
+         for ( std::vector< ringtrace::RingBuffer * >::iterator it = _buffers.begin(); it != _buffers.end(); it++ ) {
+            header.droppedRecords += (*it)->getDropped();
+         }
+         header.startTicks = _startTicks;
+         header.ticksPerNs = endTime > _startTime ? ( endTicks - _startTicks ) / ( ( endTime - _startTime ) * 1e9 ) : 1.0;
+         header.dictionaryOffset = _file.getPosition();
+         writeDictionary();
+         header.dictionarySize = _file.getPosition() - header.dictionaryOffset;
+
+         uint64_t end = _file.getPosition();
+         _file.seek( 0 );
+         _file.write( &header, sizeof( header ) );
+         _file.seek( end );
+         _file.close();
+
+         if ( header.droppedRecords > 0 ) {
+            warning0( "ring_trace: " << header.droppedRecords << " events were dropped, increase --ring-trace-buffer" );
+         }
+         message0( "ring_trace: " << _numRecords << " events written to " << _traceName );
+      }
+
+      void disable( void ) { _enabled = false; }
+      void enable( void ) { _enabled = _file.isOpen(); }
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+
+      void addEventList ( unsigned int count, Event *events )
+      {
+         if ( !_enabled ) return;
+         ringtrace::RingBuffer *buffer = ringtrace::myBuffer;
+         if ( buffer == NULL ) buffer = registerThread();
+         buffer->push( count, events, ringtrace::readTicks() );
+      }
+
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+#endif
+
+};
+
+std::string InstrumentationRingTrace::_fileName = "";
+int InstrumentationRingTrace::_bufferSize = 65536;
+int InstrumentationRingTrace::_flushInterval = 10000;
+
+namespace ext {
+
+class InstrumentationRingTracePlugin : public Plugin {
+   public:
+      InstrumentationRingTracePlugin () : Plugin("Instrumentation which writes a binary trace through per-thread ring buffers.",1) {}
+      ~InstrumentationRingTracePlugin () {}
+
+      void config( Config &cfg )
+      {
+         cfg.setOptionsSection( "Ring trace plugin", "Binary ring-buffer trace plugin specific options" );
+
+         cfg.registerConfigOption( "ring-trace-file", NEW Config::StringVar( InstrumentationRingTrace::_fileName ),
+                                   "Trace file name (default: nanox-trace-<pid>-<node>.nxr)" );
+         cfg.registerArgOption( "ring-trace-file", "ring-trace-file" );
+         cfg.registerEnvOption( "ring-trace-file", "NX_RING_TRACE_FILE" );
+
+         cfg.registerConfigOption( "ring-trace-buffer", NEW Config::PositiveVar( InstrumentationRingTrace::_bufferSize ),
+                                   "Events kept per thread before they are flushed (rounded up to a power of two)" );
+         cfg.registerArgOption( "ring-trace-buffer", "ring-trace-buffer" );
+         cfg.registerEnvOption( "ring-trace-buffer", "NX_RING_TRACE_BUFFER" );
+
+         cfg.registerConfigOption( "ring-trace-flush-interval", NEW Config::PositiveVar( InstrumentationRingTrace::_flushInterval ),
+                                   "Microseconds between flushes of the thread buffers" );
+         cfg.registerArgOption( "ring-trace-flush-interval", "ring-trace-flush-interval" );
+         cfg.registerEnvOption( "ring-trace-flush-interval", "NX_RING_TRACE_FLUSH_INTERVAL" );
+      }
+
+      void init ()
+      {
+         sys.setInstrumentation( new InstrumentationRingTrace() );
+      }
+};
+
+} // namespace ext
+
+} // namespace nanos
+
+DECLARE_PLUGIN("instrumentation-ring_trace",nanos::ext::InstrumentationRingTracePlugin);
@@ -0,0 +1,80 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_RING_TRACE_FORMAT_HPP
+#define _NANOS_RING_TRACE_FORMAT_HPP
+
+#include <stdint.h>
+
+/*! \file ring_trace_format.hpp
+ *  \brief Binary layout of the traces written by the ring_trace instrumentation
+ *  plugin and read by nanox-trace-convert.
+ *
+ *  A trace file contains:
+ *   - a FileHeader at offset 0,
+ *   - numRecords Records starting at recordsOffset, each thread in timestamp
+ *     order but threads interleaved in flush order,
+ *   - the event dictionary at dictionaryOffset, as text lines:
+ *       "K\t<key>\t<name>\t<description>\n"
+ *       "V\t<key>\t<value>\t<description>\n"
+ *
+ *  Timestamps are raw ticks, ( ticks - startTicks ) / ticksPerNs gives the
+ *  nanoseconds since the start of the execution.
+ */
+
+namespace nanos {
+namespace ringtrace {
+
+   static const char MAGIC[8] = { 'N', 'X', 'R', 'I', 'N', 'G', '0', '1' };
+   static const uint32_t FORMAT_VERSION = 1;
+
+   struct FileHeader {
+      char     magic[8];
+      uint32_t version;
+      uint32_t recordSize;        /**< sizeof(Record) of the writer */
+      uint32_t numThreads;
+      uint32_t node;              /**< Cluster node number */
+      uint64_t recordsOffset;
+      uint64_t numRecords;
+      uint64_t droppedRecords;    /**< Events lost because a ring buffer was full */
+      uint64_t dictionaryOffset;
+      uint64_t dictionarySize;
+      uint64_t startTicks;
+      double   ticksPerNs;
+   };
+
+   /*! \brief One event, fixed size (32 bytes)
+    *  type is a nanos_event_type_t. key and value are the event key and value;
+    *  for NANOS_STATE_* events value holds the state. PtP events also use
+    *  domain and id.
+    */
+   struct Record {
+      uint64_t time;
+      int64_t  value;
+      uint64_t id;
+      uint32_t key;
+      uint16_t thread;
+      uint8_t  type;
+      uint8_t  domain;
+   };
+
+} // namespace ringtrace
+} // namespace nanos
+
+#endif
@@ -18,6 +18,7 @@
 /*************************************************************************************/
 
 #include "tdg_utils.hpp"
+#include "tdg_stream_format.hpp"
 
 #include "instrumentation.hpp"
 #include "instrumentationcontext_decl.hpp"
@@ -28,6 +29,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -40,6 +42,19 @@
 
 namespace {
     nanos::Lock lock;
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+    //! Records of a thread waiting to be written to the stream log
+    struct StreamBuffer {
+        enum { capacity = 4096 };
+        nanos::tdgstream::Record  records[capacity];
+        unsigned int              size;
+        int64_t                   burst_start;   /*!< Start of the user code burst running on this thread, -1 if none */
+        StreamBuffer             *next;
+    };
+
+    __thread StreamBuffer *my_stream_buffer = NULL;
+#endif
 }
 
 namespace nanos {
@@ -52,6 +67,8 @@ class InstrumentationTDGInstrumentation: public Instrumentation
 public:
     // public static data-members
     static std::string _nodeSizeFunc;
+    static bool _streamMode;
+    static std::string _streamFile;
     
 private:
     Node* _root;
@@ -66,6 +83,14 @@ private:
 #ifdef NANOS_INSTRUMENTATION_ENABLED
     int64_t _next_tw_id;
     int64_t _next_conc_id;
+
+    // streaming mode: nodes and edges are logged as they appear instead of kept in memory
+    FILE *_stream;
+    Lock _stream_lock;                  /*!< Protects _stream and _stream_buffers */
+    StreamBuffer *_stream_buffers;
+    std::string _stream_name;
+    Atomic<int64_t> _stream_taskwaits;
+    uint64_t _stream_records;
 #endif
 
     inline int64_t getMyWDId() {
@@ -485,7 +510,9 @@ public:
     InstrumentationTDGInstrumentation() : Instrumentation(*new InstrumentationContextDisabled()),
                                           _graph_nodes(), _funct_id_to_decl_map(), 
                                           _min_time(HUGE_VAL), _total_time(0.0), _min_diam(1.0),
-                                          _next_tw_id(0), _next_conc_id(0)
+                                          _next_tw_id(0), _next_conc_id(0),
+                                          _stream(NULL), _stream_lock(), _stream_buffers(NULL), _stream_name(),
+                                          _stream_taskwaits(0), _stream_records(0)
     {}
     
     // destructor
@@ -495,10 +522,153 @@ public:
     void initialize(void) 
     {
         _root = new Node(0, 0, Root);
+
+        if (_streamMode) {
+            _stream_name = _streamFile;
+            if (_stream_name.empty()) {
+                std::string program = OS::getArg(0);
+                size_t slash_pos = program.find_last_of("/");
+                if (slash_pos != std::string::npos)
+                    program = program.substr(slash_pos+1);
+                std::stringstream ss; ss << program << "_" << getpid() << ".tdg";
+                _stream_name = ss.str();
+            }
+            _stream = fopen(_stream_name.c_str(), "wb");
+            if (_stream == NULL) {
+                warning("Could not open the TDG stream file '" << _stream_name << "', streaming disabled");
+                _streamMode = false;
+                return;
+            }
+            fwrite(tdgstream::MAGIC, sizeof(tdgstream::MAGIC), 1, _stream);
+
+            // Task bodies are timed with the user code bursts: they are closed and reopened
+            // when a task is suspended and resumed, and they do not include the time a thread
+            // spends in the runtime while the finished task is still its current WD
+            getInstrumentationDictionary()->switchEventPrefix("user-code", EVENT_ENABLED);
+            // The dependences of a new task give the size of the data it accesses
+            getInstrumentationDictionary()->switchEventPrefix("wd-num-deps", EVENT_ENABLED);
+            getInstrumentationDictionary()->switchEventPrefix("wd-deps-ptr", EVENT_ENABLED);
+        }
     }
-    
+
+    /*! \brief Time since the start of the execution, in nanoseconds */
+    static int64_t get_stream_time()
+    {
+        static const double start = OS::getMonotonicTime();
+        return (int64_t) ((OS::getMonotonicTime() - start) * 1.0e9);
+    }
+
+    StreamBuffer* get_stream_buffer()
+    {
+        StreamBuffer *buffer = my_stream_buffer;
+        if (buffer == NULL) {
+            buffer = new StreamBuffer();
+            buffer->size = 0;
+            buffer->burst_start = -1;
+            _stream_lock.acquire();
+            buffer->next = _stream_buffers;
+            _stream_buffers = buffer;
+            _stream_lock.release();
+            my_stream_buffer = buffer;
+        }
+        return buffer;
+    }
+
+    //! \pre _stream_lock is held
+    void flush_stream_buffer(StreamBuffer *buffer)
+    {
+        if (buffer->size == 0) return;
+        fwrite(buffer->records, sizeof(tdgstream::Record), buffer->size, _stream);
+        _stream_records += buffer->size;
+        buffer->size = 0;
+    }
+
+    void stream_record(tdgstream::RecordType type, int64_t a, int64_t b, int64_t c)
+    {
+        StreamBuffer *buffer = get_stream_buffer();
+        if (buffer->size == StreamBuffer::capacity) {
+            _stream_lock.acquire();
+            flush_stream_buffer(buffer);
+            _stream_lock.release();
+        }
+        BaseThread *thread = getMyThreadSafe();
+        tdgstream::Record &r = buffer->records[buffer->size++];
+        r.type = type;
+        r.thread = (thread != NULL) ? thread->getId() : 0;
+        r.time = get_stream_time();
+        r.a = a;
+        r.b = b;
+        r.c = c;
+    }
+
+    void stream_function(int64_t funct_id, std::string const &name)
+    {
+        tdgstream::Record r;
+        r.type = tdgstream::FUNCTION;
+        r.thread = 0;
+        r.time = get_stream_time();
+        r.a = funct_id;
+        r.b = name.size();
+        r.c = 0;
+        std::string padded(name);
+        padded.resize((name.size() + 7) & ~((size_t) 7), '\0');
+        _stream_lock.acquire();
+        fwrite(&r, sizeof(r), 1, _stream);
+        fwrite(padded.data(), 1, padded.size(), _stream);
+        _stream_lock.release();
+    }
+
+    //! Logs the bytes accessed by the dependences and the copies of a new wd
+    //! The dependences come in the same event list than its create-wd-ptr event
+    void stream_data_sizes(WorkDescriptor *wd, unsigned int count, Event *events,
+                           nanos_event_key_t num_deps_key, nanos_event_key_t deps_ptr_key)
+    {
+        int64_t num_deps = 0;
+        nanos_data_access_internal_t const *deps = NULL;
+        for (unsigned int i = 0; i < count; i++) {
+            if (events[i].getKey() == num_deps_key) num_deps = events[i].getValue();
+            else if (events[i].getKey() == deps_ptr_key) deps = (nanos_data_access_internal_t const *) events[i].getValue();
+        }
+
+        int64_t dep_bytes = 0;
+        for (int64_t d = 0; deps != NULL && d < num_deps; d++) {
+            nanos_region_dimension_internal_t const *dims = (nanos_region_dimension_internal_t const *) deps[d].dimensions;
+            if (dims == NULL || deps[d].dimension_count <= 0) continue;
+            int64_t bytes = 1;
+            for (short dim = 0; dim < deps[d].dimension_count; dim++) bytes *= dims[dim].accessed_length;
+            dep_bytes += bytes;
+        }
+
+        int64_t copy_bytes = 0;
+        for (size_t c = 0; c < wd->getNumCopies(); c++) {
+            copy_bytes += wd->getCopies()[c].getSize();
+        }
+
+        if (dep_bytes != 0 || copy_bytes != 0) {
+            stream_record(tdgstream::DATA, wd->getId(), dep_bytes, copy_bytes);
+        }
+    }
+
+    void finalize_stream()
+    {
+        _stream_lock.acquire();
+        for (StreamBuffer *buffer = _stream_buffers; buffer != NULL; buffer = buffer->next) {
+            flush_stream_buffer(buffer);
+        }
+        fclose(_stream);
+        _stream = NULL;
+        _stream_lock.release();
+        std::cerr << "Task Dependency Graph log (" << _stream_records << " records) written to file '"
+                  << _stream_name << "'" << std::endl;
+    }
+
     void finalize(void)
     {
+        if (_streamMode) {
+            finalize_stream();
+            return;
+        }
+
         // So far, taskwaits have been synchronized with the tasks created previously
         // But those tasks created after a given taskwait have not been connected to the taskwait
         // Note: The wd of a taskwait is always a negative number!
@@ -584,6 +754,8 @@ public:
 
     void addResumeTask(WorkDescriptor &w)
     {
+        // In streaming mode the execution time is taken from the user code bursts
+        if (_streamMode) return;
         Node* n = find_node_from_wd_id(w.getId());
         if(n != NULL) {
             n->set_last_time(get_current_time());
@@ -592,6 +764,7 @@ public:
 
     void addSuspendTask(WorkDescriptor &w, bool last)
     {
+        if (_streamMode) return;
         Node* n = find_node_from_wd_id(w.getId());
         if(n != NULL) {
             double time = (double) get_current_time() - n->get_last_time();
@@ -608,16 +781,29 @@ public:
         static const nanos_event_key_t user_funct_location = iD->getEventKey("user-funct-location");
         static const nanos_event_key_t taskwait = iD->getEventKey("taskwait");
         static const nanos_event_key_t critical_wd_id = iD->getEventKey("critical-wd-id");
+        static const nanos_event_key_t user_code = iD->getEventKey("user-code");
+        static const nanos_event_key_t wd_num_deps = iD->getEventKey("wd-num-deps");
+        static const nanos_event_key_t wd_deps_ptr = iD->getEventKey("wd-deps-ptr");
 
         // Get the node corresponding to the wd_id calling this function
         // This node won't exist if the calling wd corresponds to that of the master thread
         int64_t current_wd_id = getMyWDId();
-        Node* current_parent = find_node_from_wd_id(current_wd_id);
+        Node* current_parent = _streamMode ? NULL : find_node_from_wd_id(current_wd_id);
 
         unsigned int i;
         for(i=0; i<count; i++) {
             Event &e = events[i];
-            if (e.getKey() == create_wd_ptr)
+            if (_streamMode && user_code != 0 && e.getKey() == user_code)
+            {   // A task body starts or stops running in this thread (value = wd id)
+                StreamBuffer *buffer = get_stream_buffer();
+                if (e.getType() == NANOS_BURST_START) {
+                    buffer->burst_start = get_stream_time();
+                } else if (e.getType() == NANOS_BURST_END && buffer->burst_start >= 0) {
+                    stream_record(tdgstream::EXECUTION, e.getValue(), buffer->burst_start, get_stream_time());
+                    buffer->burst_start = -1;
+                }
+            }
+            else if (e.getKey() == create_wd_ptr)
             {  // A wd is submitted => create a new node
 
                 // Get the identifier of the task function
@@ -626,6 +812,11 @@ public:
 
                 // Get the identifier of the wd
                 int64_t wd_id = wd->getId();
+                if (_streamMode) {
+                    stream_record(tdgstream::TASK, wd_id, current_wd_id, funct_id);
+                    stream_data_sizes(wd, count, events, wd_num_deps, wd_deps_ptr);
+                    continue;
+                }
                 _next_tw_id = std::min(_next_tw_id, -wd_id);
                 _next_conc_id = wd_id + 1;
                 // Create the new node
@@ -639,7 +830,7 @@ public:
                     Node::connect_nodes(current_parent, new_node, Nesting);
                 }
             }
-            else if (e.getKey() == critical_wd_id)
+            else if (e.getKey() == critical_wd_id && !_streamMode)
             {
                int64_t wd_id = e.getValue();
                Node *n = find_node_from_wd_id(wd_id);
@@ -669,6 +860,7 @@ public:
                         // description = func_type @ file @ line   -> store the whole description
                         _funct_id_to_decl_map[ func_id ] = description.substr(0, pos3);
                     }
+                    if (_streamMode) stream_function(func_id, _funct_id_to_decl_map[ func_id ]);
                 }
                 _funct_id_to_decl_map_lock.release();
             }
@@ -716,6 +908,11 @@ public:
                                   return; }
                 }
 
+                if (_streamMode) {
+                    stream_record(tdgstream::DEPENDENCE, sender_wd_id, receiver_wd_id, dep_value);
+                    continue;
+                }
+
                 // Create the relation between the sender and the receiver
                 Node* sender = find_node_from_wd_id(sender_wd_id);
                 Node* receiver = find_node_from_wd_id(receiver_wd_id);
@@ -743,6 +940,10 @@ public:
             }
             else if (e.getKey() == taskwait)
             {   // A taskwait occurs
+                if (_streamMode) {
+                    stream_record(tdgstream::TASKWAIT, -(++_stream_taskwaits), current_wd_id, 0);
+                    continue;
+                }
                 // Synchronize all previous nodes created by the same task that have not been yet synchronized
                 Node* new_node = new Node(_next_tw_id, -1, TaskwaitNode);
                 --_next_tw_id;
@@ -774,6 +975,8 @@ public:
 };
 
 std::string InstrumentationTDGInstrumentation::_nodeSizeFunc = "log";
+bool InstrumentationTDGInstrumentation::_streamMode = false;
+std::string InstrumentationTDGInstrumentation::_streamFile = "";
 
 namespace ext {
     
@@ -789,6 +992,17 @@ namespace ext {
                                      "Defines the size of the nodes depending on the execution time of the related task. "
                                      "Accepted values are: constant (default), linear, log");
             cfg.registerArgOption("node-size", "node-size");
+
+            cfg.registerConfigOption("tdg-stream", NEW Config::FlagOption(InstrumentationTDGInstrumentation::_streamMode),
+                                     "Write nodes and edges to a binary log as they appear, instead of keeping the whole "
+                                     "graph in memory and printing it at the end (see nanox-tdg-analyze)");
+            cfg.registerArgOption("tdg-stream", "tdg-stream");
+            cfg.registerEnvOption("tdg-stream", "NX_TDG_STREAM");
+
+            cfg.registerConfigOption("tdg-stream-file", NEW Config::StringVar(InstrumentationTDGInstrumentation::_streamFile),
+                                     "Name of the TDG log file (default: <program>_<pid>.tdg)");
+            cfg.registerArgOption("tdg-stream-file", "tdg-stream-file");
+            cfg.registerEnvOption("tdg-stream-file", "NX_TDG_STREAM_FILE");
         }
         
         void init ()
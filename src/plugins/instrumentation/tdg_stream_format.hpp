@@ -0,0 +1,67 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_TDG_STREAM_FORMAT_HPP
+#define _NANOS_TDG_STREAM_FORMAT_HPP
+
+#include <stdint.h>
+
+/*! \file tdg_stream_format.hpp
+ *  \brief Binary log written by the tdg instrumentation plugin in streaming
+ *  mode (--tdg-stream) and read by nanox-tdg-analyze and nanox-sched-sim.
+ *
+ *  The file starts with MAGIC followed by a sequence of Records. Records of
+ *  different threads are interleaved in flush order: readers must sort them
+ *  by time to get the order in which they were emitted. Times are
+ *  nanoseconds since the start of the execution.
+ *
+ *  A FUNCTION record is followed by 'b' bytes holding the task type name,
+ *  padded to a multiple of 8.
+ */
+
+namespace nanos {
+namespace tdgstream {
+
+    static const char MAGIC[8] = { 'N', 'X', 'T', 'D', 'G', '0', '0', '1' };
+
+    enum RecordType {
+        TASK = 1,       /*!< a = wd id, b = parent wd id, c = function id */
+        DEPENDENCE,     /*!< a = sender node, b = receiver node, c = dep-direction value */
+        TASKWAIT,       /*!< a = taskwait node (negative), b = parent wd id */
+        EXECUTION,      /*!< a = wd id, b = start time, c = end time (one per execution burst) */
+        FUNCTION,       /*!< a = function id, b = name length */
+        DATA            /*!< a = wd id, b = bytes accessed by its dependences, c = bytes of its copies */
+    };
+
+    /*! \brief Offset added to the ids of concurrent/commutative nodes */
+    static const int64_t CONCURRENT_MIN_ID = 1000000;
+
+    struct Record {
+        uint32_t type;
+        uint32_t thread;
+        int64_t  time;          /*!< When the record was emitted */
+        int64_t  a;
+        int64_t  b;
+        int64_t  c;
+    };
+
+} // namespace tdgstream
+} // namespace nanos
+
+#endif
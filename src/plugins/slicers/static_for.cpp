@@ -21,16 +21,51 @@
 #include "slicer.hpp"
 #include "system.hpp"
 #include "smpdd.hpp"
+#include "lock.hpp"
+
+#include <vector>
 
 namespace nanos {
 namespace ext {
 
+//! \brief Blocks of the last invocation of a loop with chunk 0, and where each one ran
+struct StaticForBlocks {
+   Lock                    lock;       //!< Only serializes invocations of loops hashed to this slot
+   void *                  outline;    //!< Loop whose blocks are kept, NULL if none yet
+   int64_t                 lower;
+   int64_t                 upper;
+   int64_t                 step;
+   int                     numThreads;
+   int64_t                 niters;
+   std::vector<int64_t>    lowers;     //!< First iteration of each block
+   std::vector<int64_t>    counts;     //!< Number of iterations of each block
+   std::vector<int>        cpus;       //!< CPU of the thread each block was tied to, -1 if none yet
+   std::vector<BaseThread *> owners;   //!< Thread each block goes to in the current invocation
+   std::vector<bool>       taken;      //!< Threads already given a block in the current invocation
+
+   StaticForBlocks () : lock(), outline( NULL ), lower( 0 ), upper( 0 ), step( 0 ), numThreads( 0 ), niters( 0 ),
+                        lowers(), counts(), cpus(), owners(), taken() {}
+};
+
 class SlicerStaticFor: public Slicer
 {
    private:
+      //! Loops are identified by their outline and hashed to a fixed slot, a
+      //! loop that collides with another one only loses the placement of its
+      //! blocks
+      enum { LOOP_SLOTS = 64 };
+
+      StaticForBlocks _loops[LOOP_SLOTS];
+
+      StaticForBlocks & getBlocks ( void *outline )
+      {
+         return _loops[ ( (uintptr_t) outline >> 4 ) % LOOP_SLOTS ];
+      }
+
+      void submitBlocks ( WorkDescriptor &work, std::vector<BaseThread *> &target_threads );
    public:
       // constructor
-      SlicerStaticFor ( ) { }
+      SlicerStaticFor ( ) : _loops() { }
 
       // destructor
       ~SlicerStaticFor ( ) { }
@@ -40,6 +75,14 @@ class SlicerStaticFor: public Slicer
       bool dequeue ( WorkDescriptor *wd, WorkDescriptor **slice ) { *slice = wd; return true; }
 };
 
+//! \brief Runs the single block of iterations of a slice, its bounds were computed when submitted
+static void blockLoop ( void *arg )
+{
+   nanos_loop_info_t * loop_info = (nanos_loop_info_t *) arg;
+   if ( loop_info->chunk == 0 ) return;
+   ((DeviceData::work_fct)(loop_info->args))(arg);
+}
+
 static void staticLoop ( void *arg )
 {
    debug ( "Executing static loop wrapper");
@@ -132,7 +175,7 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
 
    SMPDD &dd = ( SMPDD & ) work.getActiveDevice();
    loop_info->args = ( void * ) dd.getWorkFct();
-   dd = SMPDD(staticLoop);
+   dd = SMPDD( loop_info->chunk == 0 ? blockLoop : staticLoop );
 
    int64_t _chunk = loop_info->chunk;
    int64_t _lower = loop_info->lower;
@@ -140,37 +183,8 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
    int64_t _step  = loop_info->step;
 
    if ( _chunk == 0 ) {
-
-      // Compute chunk and adjustment
-      int64_t _niters = (((_upper - _lower) / _step ) + 1 );
-      int64_t _adjust = _niters % valid_threads;
-      _chunk = ((_niters / valid_threads) ) * _step;
-      // Computing specific loop boundaries for WorkDescriptor 0
-      loop_info->chunk = _chunk + (( _adjust > 0 ) ? _step : 0);
-      loop_info->stride = _niters * _step; 
-      // Creating additional WorkDescriptors: 1..N
-      for ( i = 1; i < valid_threads; i++ ) {
-
-         // Computing lower and upper bound
-         _lower += _chunk + (( _adjust > (i-1) ) ? _step : 0);
-         // Duplicating slice
-         slice = NULL;
-         sys.duplicateWD( &slice, &work );
-   
-         debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
-
-         // Computing specific loop boundaries for current slice
-         loop_info = ( nanos_loop_info_t * ) slice->getData();
-         loop_info->lower = _lower;
-         loop_info->chunk = _chunk + (( _adjust > i ) ? _step : 0);
-         loop_info->stride = _niters * _step; 
-
-         // Submit: slice (WorkDescriptor i, running on Thread i)
-         sys.setupWD ( *slice, work.getParent() );
-         BaseThread &target_thread = *target_threads[i];
-         slice->tieTo( target_thread );
-         target_thread.addNextWD(slice);
-      }
+      submitBlocks( work, target_threads );
+      return;
    } else {
       // Computing offset between threads
       int _sign = ( _step < 0 ) ? -1 : +1;
@@ -224,6 +238,129 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
    }
 }
 
+//! \brief NUMA node of a CPU, all of them are in the same one without hwloc
+static unsigned int getNumaNode ( int cpu )
+{
+   return sys._hwloc.isHwlocAvailable() ? sys._hwloc.getNumaNodeOfCpu( cpu ) : 0;
+}
+
+/*! \brief Hands each thread a single contiguous block of iterations
+ *
+ *  Bounds are kept per loop and reused while the loop is invoked again with
+ *  the same iteration space and number of threads. Each block then goes to
+ *  the thread that ran it the previous time, or to one in the same NUMA
+ *  node, so iterative sweeps over an array keep touching the memory they
+ *  first touched.
+ */
+void SlicerStaticFor::submitBlocks ( WorkDescriptor &work, std::vector<BaseThread *> &target_threads )
+{
+   BaseThread *mythread = myThread;
+   nanos_loop_info_t *loop_info = ( nanos_loop_info_t * ) work.getData();
+   int num_threads = target_threads.size();
+   int64_t lower = loop_info->lower, upper = loop_info->upper, step = loop_info->step;
+   void *outline = loop_info->args;
+   BaseThread *first;
+
+   {
+      StaticForBlocks &blocks = getBlocks( outline );
+      LockBlock lock( blocks.lock );
+
+      if ( blocks.outline != outline || blocks.lower != lower || blocks.upper != upper || blocks.step != step ||
+           blocks.numThreads != num_threads ) {
+         blocks.outline = outline;
+         blocks.lower = lower;
+         blocks.upper = upper;
+         blocks.step = step;
+         blocks.numThreads = num_threads;
+         blocks.lowers.clear();
+         blocks.counts.clear();
+
+         //! Empty iteration spaces have a single empty block
+         bool empty = ( step > 0 ) ? lower > upper : lower < upper;
+         blocks.niters = empty ? 0 : ( upper - lower ) / step + 1;
+         int64_t num_blocks = blocks.niters < num_threads ? ( empty ? 1 : blocks.niters ) : num_threads;
+         int64_t size = blocks.niters / num_blocks, adjust = blocks.niters % num_blocks;
+         int64_t first_iter = lower;
+         for ( int64_t i = 0; i < num_blocks; i++ ) {
+            int64_t count = size + ( ( i < adjust ) ? 1 : 0 );
+            blocks.lowers.push_back( first_iter );
+            blocks.counts.push_back( count );
+            first_iter += count * step;
+         }
+         blocks.cpus.assign( num_blocks, -1 );
+      }
+
+      const std::vector<int64_t> &lowers = blocks.lowers;
+      const std::vector<int64_t> &counts = blocks.counts;
+      std::vector<BaseThread *> &owners = blocks.owners;
+      std::vector<bool> &taken = blocks.taken;
+      int64_t niters = blocks.niters;
+
+      //! Same CPU first, then same NUMA node, then whatever thread is left
+      size_t num_blocks = lowers.size(), i;
+      taken.assign( num_threads, false );
+      owners.assign( num_blocks, (BaseThread *) NULL );
+      for ( int pass = 0; pass < 3; pass++ ) {
+         for ( i = 0; i < num_blocks; i++ ) {
+            if ( owners[i] != NULL ) continue;
+            int cpu = blocks.cpus[i];
+            if ( pass < 2 && cpu == -1 ) continue;
+            for ( int t = 0; t < num_threads; t++ ) {
+               if ( taken[t] ) continue;
+               int thread_cpu = target_threads[t]->getCpuId();
+               if ( ( pass == 0 && thread_cpu != cpu ) ||
+                    ( pass == 1 && getNumaNode( thread_cpu ) != getNumaNode( cpu ) ) ) continue;
+               owners[i] = target_threads[t];
+               taken[t] = true;
+               break;
+            }
+         }
+      }
+      for ( i = 0; i < num_blocks; i++ ) blocks.cpus[i] = owners[i]->getCpuId();
+
+      // Creating additional WorkDescriptors: 1..N
+      for ( i = 1; i < num_blocks; i++ ) {
+         WorkDescriptor *slice = NULL;
+         sys.duplicateWD( &slice, &work );
+
+         debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
+
+         loop_info = ( nanos_loop_info_t * ) slice->getData();
+         loop_info->lower = lowers[i];
+         loop_info->upper = lowers[i] + ( counts[i] - 1 ) * step;
+         loop_info->chunk = counts[i] * step;
+         loop_info->stride = niters * step;
+         loop_info->last = ( i == num_blocks - 1 );
+
+         sys.setupWD ( *slice, work.getParent() );
+         slice->tieTo( *owners[i] );
+         owners[i]->addNextWD( slice );
+      }
+
+      // WorkDescriptor 0 is the original one, empty when the loop has no iterations
+      loop_info = ( nanos_loop_info_t * ) work.getData();
+      loop_info->lower = lowers[0];
+      loop_info->upper = lowers[0] + ( counts[0] - 1 ) * step;
+      loop_info->chunk = counts[0] * step;
+      loop_info->stride = niters * step;
+      loop_info->last = ( num_blocks == 1 && niters > 0 );
+      first = owners[0];
+   }
+
+   // The slot is released before running the first block inline, it may
+   // invoke loops hashed to the same slot
+   work.convertToRegularWD();
+   work.tieTo( *first );
+   if ( mythread == first ) {
+      if ( Scheduler::inlineWork( &work, false ) ) {
+         work.~WorkDescriptor();
+         delete[] (char *) &work;
+      }
+   } else {
+      first->addNextWD( &work );
+   }
+}
+
 class SlicerStaticForPlugin : public Plugin {
    public:
       SlicerStaticForPlugin () : Plugin("Slicer for Loops using a static policy",1) {}
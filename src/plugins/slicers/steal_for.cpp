@@ -0,0 +1,206 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "plugin.hpp"
+#include "slicer.hpp"
+#include "system.hpp"
+#include "smpdd.hpp"
+#include "stealablerange.hpp"
+
+namespace nanos {
+namespace ext {
+
+/*! \brief Loop data shared by all the slices of a steal_for loop */
+struct StealLoopData
+{
+   void            *work;          /**< Outlined loop body */
+   int64_t          lower;
+   int64_t          upper;
+   int64_t          step;
+   int64_t          chunk;         /**< Iterations per chunk */
+   int64_t          numOfChunks;
+   int              numRanges;     /**< One per slice */
+   Atomic<int>      finished;      /**< Slices that finished the loop */
+   StealableRange  *ranges;        /**< Chunks left of each slice */
+};
+
+/*! \brief Slicer for loops balanced through work stealing
+ *
+ *  As static_for, one slice is tied to each thread of the team, starting with
+ *  a contiguous block of the chunks. Slices take their chunks without
+ *  contention and, once they run out, steal half of the chunks left of the
+ *  slice with most of them.
+ */
+class SlicerStealFor: public Slicer
+{
+   private:
+   public:
+      // constructor
+      SlicerStealFor ( ) { }
+
+      // destructor
+      ~SlicerStealFor ( ) { }
+
+      // headers (implemented below)
+      void submit ( WorkDescriptor & work ) ;
+      bool dequeue ( WorkDescriptor *wd, WorkDescriptor **slice ) { *slice = wd; return true; }
+};
+
+static void stealLoop ( void *arg )
+{
+   debug ( "Executing steal loop wrapper");
+
+   nanos_loop_info_t *loop_info = (nanos_loop_info_t *) arg;
+   StealLoopData *data = (StealLoopData *) loop_info->args;
+   int sign = ( data->step < 0 ) ? -1 : +1;
+   uint32_t chunk;
+
+   while ( takeOrStealChunk( data->ranges, data->numRanges, loop_info->thid, chunk ) ) {
+      loop_info->lower = data->lower + chunk * data->chunk * data->step;
+      loop_info->upper = loop_info->lower + data->chunk * data->step - sign;
+      if ( ( data->upper * sign ) < ( loop_info->upper * sign ) ) loop_info->upper = data->upper;
+      loop_info->last = chunk == (uint32_t) ( data->numOfChunks - 1 );
+
+      ((DeviceData::work_fct)(data->work))(arg);
+   }
+
+   // Nobody looks at the ranges once all the slices are done
+   if ( ++data->finished == data->numRanges ) {
+      delete[] data->ranges;
+      delete data;
+   }
+}
+
+void SlicerStealFor::submit ( WorkDescriptor &work )
+{
+   debug ( "Submitting sliced task " << &work << ":" << work.getId() );
+
+   BaseThread *mythread = myThread;
+   ThreadTeam *team = mythread->getTeam();
+   WorkDescriptor *slice = NULL;
+   nanos_loop_info_t *loop_info;
+   int i;
+
+   // Ensure team stability during the job distribution
+   while ( !team->isStable() ) memoryFence();
+   team->lock();
+
+   // Threads compatible with the work descriptor, see static_for
+   int num_threads = team->getFinalSize();
+   int valid_threads = 0, first_valid_thread = 0;
+   std::vector<BaseThread*> target_threads;
+   for ( i = 0; i < num_threads; i++) {
+      BaseThread &thread = team->getThread(i);
+      if ( work.canRunIn( *thread.runningOn() ) ) {
+         target_threads.push_back( &thread );
+         ++valid_threads;
+      }
+   }
+
+   team->unlock();
+
+   loop_info = ( nanos_loop_info_t * ) work.getData();
+
+   StealLoopData *data = NEW StealLoopData();
+   SMPDD &dd = ( SMPDD & ) work.getActiveDevice();
+   data->work = ( void * ) dd.getWorkFct();
+   dd = SMPDD(stealLoop);
+
+   data->lower = loop_info->lower;
+   data->upper = loop_info->upper;
+   data->step = loop_info->step;
+
+   int64_t niters = (((data->upper - data->lower) / data->step ) + 1 );
+   if ( niters < 0 ) niters = 0;
+
+   // Without a chunk size, get several chunks per thread so there is something to steal
+   int64_t chunk = loop_info->chunk;
+   if ( chunk < 1 ) chunk = niters / ( 16 * valid_threads );
+   if ( chunk < 1 ) chunk = 1;
+   // Chunk indexes must fit in the packed ranges
+   const int64_t max_chunks = 0xffffffffLL;
+   if ( niters / chunk >= max_chunks ) chunk = niters / ( max_chunks - 1 ) + 1;
+   data->chunk = chunk;
+   data->numOfChunks = niters / chunk + ( ( niters % chunk != 0 ) ? 1 : 0 );
+
+   // Static distribution of the chunks
+   data->numRanges = valid_threads;
+   data->finished = 0;
+   data->ranges = NEW StealableRange[valid_threads];
+   int64_t lower = 0;
+   for ( i = 0; i < valid_threads; i++ ) {
+      int64_t size = data->numOfChunks / valid_threads + ( ( i < data->numOfChunks % valid_threads ) ? 1 : 0 );
+      data->ranges[i].set( (uint32_t) lower, (uint32_t) ( lower + size ) );
+      lower += size;
+   }
+
+   loop_info->args = data;
+   loop_info->thid = 0;
+   loop_info->threads = valid_threads;
+
+   // Creating additional WorkDescriptors: 1..N
+   for ( i = 1; i < valid_threads; i++ ) {
+      slice = NULL;
+      sys.duplicateWD( &slice, &work );
+
+      debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
+
+      loop_info = ( nanos_loop_info_t * ) slice->getData();
+      loop_info->thid = i;
+
+      // Submit: slice (WorkDescriptor i, running on Thread i)
+      sys.setupWD ( *slice, work.getParent() );
+      BaseThread &target_thread = *target_threads[i];
+      slice->tieTo( target_thread );
+      target_thread.addNextWD(slice);
+   }
+
+   // Submit: work (WorkDescriptor 0, running on thread 'first')
+   BaseThread &first_thread = *target_threads[first_valid_thread];
+   work.convertToRegularWD();
+   work.tieTo( first_thread );
+   if ( mythread == &first_thread ) {
+      if ( Scheduler::inlineWork( &work, false ) ) {
+         work.~WorkDescriptor();
+         delete[] (char *) &work;
+      }
+   }
+   else
+   {
+      first_thread.addNextWD( (WorkDescriptor *) &work);
+   }
+}
+
+class SlicerStealForPlugin : public Plugin {
+   public:
+      SlicerStealForPlugin () : Plugin("Slicer for Loops using a work stealing policy",1) {}
+      ~SlicerStealForPlugin () {}
+
+      virtual void config( Config& cfg ) {}
+
+      void init ()
+      {
+         sys.registerSlicer("steal_for", NEW SlicerStealFor() );
+      }
+};
+
+} // namespace ext
+} // namespace nanos
+
+DECLARE_PLUGIN("slicer-steal_for",nanos::ext::SlicerStealForPlugin);
@@ -0,0 +1,385 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "nanos-int.h"
+#include "atomic.hpp"
+#include "lock.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "threadtimes.hpp"
+#include "worksharing_decl.hpp"
+
+#include <map>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+namespace nanos {
+namespace ext {
+
+//! \brief Schedules the auto worksharing chooses from
+enum AutoSchedule { AUTO_STATIC, AUTO_DYNAMIC, AUTO_GUIDED };
+
+//! \brief What has been learned about one loop site run by a given number of threads
+struct AutoLoopSite {
+   unsigned int   executions;
+   AutoSchedule   schedule;     // schedule for the next execution
+   int64_t        chunkSize;    // chunk size for the next execution (minimum one for guided)
+   bool           settled;      // the schedule is not tried against static any more
+   double         iterCost;     // ns per iteration, moving average
+   double         iterCostCV;   // coefficient of variation of the iteration cost among chunks
+   double         imbalance;    // busy time of the slowest thread over the average, with static
+   double         staticTime;   // wall clock ns per iteration with the static schedule
+   double         lastTime;     // wall clock ns per iteration of the last execution
+
+   AutoLoopSite () : executions( 0 ), schedule( AUTO_STATIC ), chunkSize( 0 ), settled( false ),
+      iterCost( 0 ), iterCostCV( 0 ), imbalance( 1 ), staticTime( 0 ), lastTime( 0 ) {}
+};
+
+//! \brief Measurements of one thread during one execution, on its own cache line
+struct AutoThreadStats {
+   uint64_t       since;        // start of the current chunk, 0 if none
+   int64_t        iters;        // iterations of the current chunk
+   uint64_t       busy;         // ns executing chunks
+   uint64_t       chunks;
+   double         sumCost;      // sum of the ns per iteration of each chunk
+   double         sumCost2;
+   bool           gotBlock;     // static schedule, the block of the thread has been handed out
+   char           pad[NANOS_CACHELINE];
+
+   AutoThreadStats () : since( 0 ), iters( 0 ), busy( 0 ), chunks( 0 ), sumCost( 0 ), sumCost2( 0 ), gotBlock( false ) {}
+};
+
+typedef struct {
+   int64_t                   lowerBound;   // loop lower bound
+   int64_t                   upperBound;   // loop upper bound
+   int64_t                   loopStep;     // loop step
+   int64_t                   chunkSize;    // loop chunk size
+   int64_t                   niters;       // number of iterations
+   AutoSchedule              schedule;
+   int                       numThreads;
+   Atomic<int64_t>           next;         // next iteration to hand out (dynamic and guided)
+   Atomic<int>               finished;     // threads that got the last (empty) item
+   uint64_t                  start;        // creation time
+   AutoLoopSite             *site;
+   AutoThreadStats          *stats;
+} WorkSharingAutoLoopInfo;
+
+//! \brief Worksharing for loops that chooses the schedule of each loop site from its previous executions
+//!
+//! Loop sites are identified by the code address that creates the loop and
+//! the number of threads. The first execution of a site is static and the
+//! busy time of each thread is measured. If threads are balanced, the site
+//! stays static. Otherwise the next execution tries dynamic, when the cost
+//! of the iterations varies, or guided, with chunks lasting long enough to
+//! amortize taking them. The tried schedule is kept unless the loop took
+//! longer than with static.
+class WorkSharingAutoFor : public WorkSharing {
+   private:
+      typedef std::pair<const void *, int> SiteKey;
+      typedef std::map<SiteKey, AutoLoopSite> Sites;
+
+      Sites    _sites;
+      Lock     _lock;
+
+      //! Chunks should take at least this long for the overhead of taking them to be negligible
+      static const uint64_t MIN_CHUNK_TIME = 20000;
+      //! Static is kept while the slowest thread is busy at most this much longer than the average
+      static const double MAX_IMBALANCE;
+      //! Above this coefficient of variation of the iteration cost, dynamic is preferred to guided
+      static const double IRREGULAR_CV;
+
+      static const char *getScheduleName ( AutoSchedule schedule )
+      {
+         switch ( schedule ) {
+            case AUTO_STATIC:  return "static";
+            case AUTO_DYNAMIC: return "dynamic";
+            case AUTO_GUIDED:  return "guided";
+            default:           return "unknown";
+         }
+      }
+
+      //! \brief Hands out the next iterations [first, first+count) to thread id
+      //! \return false when there are no iterations left
+      bool takeIterations ( WorkSharingAutoLoopInfo *loop_data, int id, int64_t &first, int64_t &count )
+      {
+         int64_t niters = loop_data->niters;
+
+         switch ( loop_data->schedule ) {
+            case AUTO_STATIC:
+            {
+               AutoThreadStats &me = loop_data->stats[id];
+               if ( me.gotBlock ) return false;
+               me.gotBlock = true;
+               int64_t block = niters / loop_data->numThreads;
+               int64_t adjust = niters % loop_data->numThreads;
+               first = block * id + ( ( id < adjust ) ? id : adjust );
+               count = block + ( ( id < adjust ) ? 1 : 0 );
+               return count > 0;
+            }
+            case AUTO_DYNAMIC:
+               first = loop_data->next.fetchAndAdd( loop_data->chunkSize );
+               if ( first >= niters ) return false;
+               count = ( niters - first < loop_data->chunkSize ) ? niters - first : loop_data->chunkSize;
+               return true;
+            case AUTO_GUIDED:
+               for ( ;; ) {
+                  first = loop_data->next.value();
+                  if ( first >= niters ) return false;
+                  int64_t remaining = niters - first;
+                  count = remaining / ( 2 * loop_data->numThreads );
+                  if ( count < loop_data->chunkSize ) count = loop_data->chunkSize;
+                  if ( count > remaining ) count = remaining;
+                  if ( compareAndSwap( &loop_data->next.override(), first, first + count ) ) return true;
+               }
+         }
+         return false;
+      }
+
+      //! \brief Updates the site with the measurements of an execution and chooses the schedule for the next one
+      void learn ( WorkSharingAutoLoopInfo *loop_data, uint64_t wall )
+      {
+         if ( loop_data->niters == 0 ) return;
+
+         int num_threads = loop_data->numThreads;
+         uint64_t total = 0, slowest = 0, chunks = 0;
+         double sum_cost = 0, sum_cost2 = 0;
+         for ( int i = 0; i < num_threads; i++ ) {
+            AutoThreadStats &stats = loop_data->stats[i];
+            total += stats.busy;
+            if ( stats.busy > slowest ) slowest = stats.busy;
+            chunks += stats.chunks;
+            sum_cost += stats.sumCost;
+            sum_cost2 += stats.sumCost2;
+         }
+         if ( total == 0 || chunks == 0 ) return;
+
+         double cost = (double) total / loop_data->niters;
+         double mean = sum_cost / chunks;
+         double variance = sum_cost2 / chunks - mean * mean;
+         double cv = ( variance > 0 && mean > 0 ) ? std::sqrt( variance ) / mean : 0;
+         double time = (double) wall / loop_data->niters;
+
+         LockBlock guard( _lock );
+         AutoLoopSite &site = *loop_data->site;
+
+         site.iterCost = site.executions == 0 ? cost : ( site.iterCost + cost ) / 2;
+         site.executions++;
+         site.lastTime = time;
+
+         if ( loop_data->schedule == AUTO_STATIC ) {
+            site.imbalance = ( (double) slowest * num_threads ) / total;
+            site.iterCostCV = cv;
+            site.staticTime = site.staticTime == 0 ? time : ( site.staticTime + time ) / 2;
+         } else {
+            // Many chunks give a better estimation than one block per thread
+            site.iterCostCV = cv;
+         }
+
+         if ( site.settled ) {
+            if ( site.schedule != AUTO_STATIC ) site.chunkSize = getChunkSize( site, loop_data->niters, num_threads );
+            return;
+         }
+
+         if ( loop_data->schedule == AUTO_STATIC ) {
+            // First execution: keep static only if threads are balanced
+            if ( num_threads == 1 || site.imbalance <= MAX_IMBALANCE ) {
+               site.settled = true;
+               return;
+            }
+            // Irregular iterations need dynamic, unless there are too few chunks
+            // to balance: guided also gets smaller chunks towards the end
+            bool irregular = site.iterCostCV > IRREGULAR_CV;
+            bool enough_chunks = getAmortizingChunk( site ) * 4 * num_threads <= loop_data->niters;
+            site.schedule = ( irregular && enough_chunks ) ? AUTO_DYNAMIC : AUTO_GUIDED;
+            site.chunkSize = getChunkSize( site, loop_data->niters, num_threads );
+         } else {
+            // The tried schedule stays unless it is slower than static
+            site.settled = true;
+            if ( time > site.staticTime ) {
+               site.schedule = AUTO_STATIC;
+               site.chunkSize = 0;
+            } else {
+               site.chunkSize = getChunkSize( site, loop_data->niters, num_threads );
+            }
+         }
+      }
+
+      //! \brief Smallest chunk lasting long enough
+      static int64_t getAmortizingChunk ( const AutoLoopSite &site )
+      {
+         int64_t chunk = site.iterCost > 0 ? (int64_t) std::ceil( MIN_CHUNK_TIME / site.iterCost ) : 1;
+         return chunk < 1 ? 1 : chunk;
+      }
+
+      //! \brief Smallest chunk lasting long enough, without going under four chunks per thread
+      static int64_t getChunkSize ( const AutoLoopSite &site, int64_t niters, int num_threads )
+      {
+         int64_t chunk = getAmortizingChunk( site );
+         int64_t balanced = niters / ( 4 * num_threads );
+         if ( chunk > balanced ) chunk = balanced;
+         return chunk < 1 ? 1 : chunk;
+      }
+
+   public:
+      WorkSharingAutoFor () : WorkSharing(), _sites(), _lock() {}
+
+      //! \brief create a loop descriptor, without a site to learn from
+      bool create ( nanos_ws_desc_t **wsd, nanos_ws_info_t *info )
+      {
+         return createAtSite( wsd, info, NULL );
+      }
+
+      //! \brief create a loop descriptor
+      //! \return only one thread per loop will get 'true' (single like behaviour)
+      bool createAtSite ( nanos_ws_desc_t **wsd, nanos_ws_info_t *info, const void *site )
+      {
+         nanos_ws_info_loop_t *loop_info = (nanos_ws_info_loop_t *) info;
+         bool single = false;
+
+         *wsd = myThread->getTeamWorkSharingDescriptor( &single );
+         if ( single ) {
+
+            WorkSharingAutoLoopInfo *loop_data = NEW WorkSharingAutoLoopInfo();
+
+            // Non implicit tasks execute the whole loop on their own
+            int num_threads = myThread->getCurrentWD()->isImplicit() ? myThread->getTeam()->getFinalSize() : 1;
+
+            loop_data->lowerBound = loop_info->lower_bound;
+            loop_data->upperBound = loop_info->upper_bound;
+            loop_data->loopStep   = loop_info->loop_step;
+
+            int64_t niters = (((loop_info->upper_bound - loop_info->lower_bound) / loop_info->loop_step ) + 1 );
+            loop_data->niters = niters < 0 ? 0 : niters;
+
+            {
+               LockBlock guard( _lock );
+               AutoLoopSite &learned = _sites[ SiteKey( site, num_threads ) ];
+               loop_data->site      = &learned;
+               loop_data->schedule  = learned.schedule;
+               loop_data->chunkSize = learned.chunkSize < 1 ? 1 : learned.chunkSize;
+            }
+
+            loop_data->numThreads = num_threads;
+            loop_data->next = 0;
+            loop_data->finished = 0;
+            loop_data->stats = NEW AutoThreadStats[num_threads];
+            loop_data->start = ThreadTimeStats::now();
+
+            (*wsd)->data = loop_data;
+
+            memoryFence();     // Split initialization phase (before) from make it visible (after)
+
+            (*wsd)->ws = this; // Once 'ws' field has a value, any other thread can use the structure
+
+         }
+
+         // wait until worksharing descriptor is initialized
+         while ( (*wsd)->ws == NULL ) {;}
+
+         return single;
+      }
+
+      //! \brief Get next chunk of iterations
+      void nextItem( nanos_ws_desc_t *wsd, nanos_ws_item_t *item )
+      {
+         nanos_ws_item_loop_t    *loop_item = ( nanos_ws_item_loop_t *) item;
+         WorkSharingAutoLoopInfo *loop_data = ( WorkSharingAutoLoopInfo *) wsd->data;
+
+         int id = loop_data->numThreads == 1 ? 0 : myThread->getTeamId();
+         ensure( id < loop_data->numThreads, "Auto worksharing: thread out of the team" );
+
+         // The previous chunk of this thread has just finished
+         AutoThreadStats &me = loop_data->stats[id];
+         uint64_t now = ThreadTimeStats::now();
+         if ( me.since != 0 && me.iters > 0 ) {
+            uint64_t elapsed = now - me.since;
+            double cost = (double) elapsed / me.iters;
+            me.busy += elapsed;
+            me.chunks++;
+            me.sumCost += cost;
+            me.sumCost2 += cost * cost;
+         }
+
+         int64_t first, count;
+         if ( !takeIterations( loop_data, id, first, count ) ) {
+            me.since = 0;
+            loop_item->execute = false;
+            // Nobody looks at the loop data once all threads got their last item
+            if ( ++loop_data->finished == loop_data->numThreads ) {
+               learn( loop_data, now - loop_data->start );
+               delete[] loop_data->stats;
+               delete loop_data;
+               wsd->data = NULL;
+            }
+            return;
+         }
+
+         me.since = now;
+         me.iters = count;
+
+         loop_item->lower = loop_data->lowerBound + first * loop_data->loopStep;
+         loop_item->upper = loop_item->lower + ( count - 1 ) * loop_data->loopStep;
+         loop_item->last = first + count == loop_data->niters;
+         loop_item->execute = true;
+      }
+
+      void duplicateWS ( nanos_ws_desc_t *orig, nanos_ws_desc_t **copy) {}
+
+      std::string getSummary () const
+      {
+         if ( _sites.empty() ) return std::string();
+
+         std::ostringstream s;
+         s << "=================== Auto Loop Schedules ==================" << std::endl;
+         for ( Sites::const_iterator it = _sites.begin(); it != _sites.end(); it++ ) {
+            const AutoLoopSite &site = it->second;
+            if ( site.executions == 0 ) continue;
+            s << "=== Loop " << it->first.first << " (" << it->first.second << " threads): "
+              << getScheduleName( site.schedule );
+            if ( site.schedule != AUTO_STATIC ) s << ", chunk " << site.chunkSize;
+            s << ( site.settled ? "" : " (learning)" ) << ", " << site.executions << " executions" << std::endl;
+            s << "===  | iteration cost (ns): " << std::fixed << std::setprecision( 1 ) << site.iterCost
+              << ", cv: " << std::setprecision( 2 ) << site.iterCostCV
+              << ", static imbalance: " << site.imbalance << std::endl;
+         }
+         return s.str();
+      }
+};
+
+const double WorkSharingAutoFor::MAX_IMBALANCE = 1.1;
+const double WorkSharingAutoFor::IRREGULAR_CV = 0.5;
+
+class WorkSharingAutoForPlugin : public Plugin {
+   public:
+      WorkSharingAutoForPlugin () : Plugin("Worksharing plugin for loops choosing the policy from previous executions",1) {}
+     ~WorkSharingAutoForPlugin () {}
+
+      virtual void config( Config& cfg ) {}
+
+      void init ()
+      {
+         sys.registerWorkSharing("auto_for", NEW WorkSharingAutoFor() );
+      }
+};
+
+} // namespace ext
+} // namespace nanos
+
+DECLARE_PLUGIN( "placeholder-name", nanos::ext::WorkSharingAutoForPlugin );
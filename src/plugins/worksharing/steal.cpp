@@ -0,0 +1,162 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "nanos-int.h"
+#include "atomic.hpp"
+#include "stealablerange.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "worksharing_decl.hpp"
+
+namespace nanos {
+namespace ext {
+
+typedef struct {
+   int64_t                   lowerBound;   // loop lower bound
+   int64_t                   upperBound;   // loop upper bound
+   int64_t                   loopStep;     // loop step
+   int64_t                   chunkSize;    // loop chunk size
+   int64_t                   numOfChunks;  // number of chunks for the loop
+   int                       numRanges;    // one per thread
+   Atomic<int>               finished;     // threads that got the last (empty) item
+   StealableRange           *ranges;       // chunks left of each thread
+} WorkSharingStealLoopInfo;
+
+//! \brief Worksharing for loops balanced through work stealing
+//!
+//! Each thread starts with a contiguous block of chunks, as in a static
+//! schedule, and takes them one by one from its own range without contention.
+//! Once it runs out, it steals half of the chunks left of the thread with
+//! most of them. Without a chunk size, chunks are sized to get several per
+//! thread so there is something to steal.
+class WorkSharingStealFor : public WorkSharing {
+
+      //! \brief create a loop descriptor
+      //! \return only one thread per loop will get 'true' (single like behaviour)
+      bool create ( nanos_ws_desc_t **wsd, nanos_ws_info_t *info )
+      {
+         nanos_ws_info_loop_t *loop_info = (nanos_ws_info_loop_t *) info;
+         bool single = false;
+
+         *wsd = myThread->getTeamWorkSharingDescriptor( &single );
+         if ( single ) {
+
+            WorkSharingStealLoopInfo *loop_data = NEW WorkSharingStealLoopInfo();
+
+            // Non implicit tasks execute the whole loop on their own
+            int num_threads = myThread->getCurrentWD()->isImplicit() ? myThread->getTeam()->getFinalSize() : 1;
+
+            loop_data->lowerBound = loop_info->lower_bound;
+            loop_data->upperBound = loop_info->upper_bound;
+            loop_data->loopStep   = loop_info->loop_step;
+
+            int64_t niters = (((loop_info->upper_bound - loop_info->lower_bound) / loop_info->loop_step ) + 1 );
+            if ( niters < 0 ) niters = 0;
+
+            int64_t chunk_size = loop_info->chunk_size;
+            if ( chunk_size < 1 ) chunk_size = niters / ( 16 * num_threads );
+            if ( chunk_size < 1 ) chunk_size = 1;
+            // Chunk indexes must fit in the packed ranges
+            const int64_t max_chunks = 0xffffffffLL;
+            if ( niters / chunk_size >= max_chunks ) chunk_size = niters / ( max_chunks - 1 ) + 1;
+            loop_data->chunkSize  = chunk_size;
+
+            int64_t chunks = niters / chunk_size;
+            if ( niters % chunk_size != 0 ) chunks++;
+            loop_data->numOfChunks = chunks;
+
+            // Static distribution of the chunks
+            loop_data->numRanges = num_threads;
+            loop_data->finished = 0;
+            loop_data->ranges = NEW StealableRange[num_threads];
+            int64_t lower = 0;
+            for ( int i = 0; i < num_threads; i++ ) {
+               int64_t size = chunks / num_threads + ( ( i < chunks % num_threads ) ? 1 : 0 );
+               loop_data->ranges[i].set( (uint32_t) lower, (uint32_t) ( lower + size ) );
+               lower += size;
+            }
+
+            (*wsd)->data = loop_data;
+
+            memoryFence();     // Split initialization phase (before) from make it visible (after)
+
+            (*wsd)->ws = this; // Once 'ws' field has a value, any other thread can use the structure
+
+         }
+
+         // wait until worksharing descriptor is initialized
+         while ( (*wsd)->ws == NULL ) {;}
+
+         return single;
+      }
+
+      //! \brief Get next chunk of iterations
+      void nextItem( nanos_ws_desc_t *wsd, nanos_ws_item_t *item )
+      {
+         nanos_ws_item_loop_t     *loop_item = ( nanos_ws_item_loop_t *) item;
+         WorkSharingStealLoopInfo *loop_data = ( WorkSharingStealLoopInfo *) wsd->data;
+
+         int id = loop_data->numRanges == 1 ? 0 : myThread->getTeamId();
+         ensure( id < loop_data->numRanges, "Steal worksharing: thread out of the team" );
+
+         uint32_t mychunk;
+         if ( !takeOrStealChunk( loop_data->ranges, loop_data->numRanges, id, mychunk ) ) {
+            loop_item->execute = false;
+            // Nobody looks at the ranges once all threads got their last item
+            if ( ++loop_data->finished == loop_data->numRanges ) {
+               delete[] loop_data->ranges;
+               delete loop_data;
+               wsd->data = NULL;
+            }
+            return;
+         }
+
+         int sign = (( loop_data->loopStep < 0 ) ? -1 : +1);
+
+         loop_item->lower = loop_data->lowerBound + mychunk * loop_data->chunkSize * loop_data->loopStep;
+
+         loop_item->upper = loop_item->lower + loop_data->chunkSize * loop_data->loopStep - sign;
+         if ( ( loop_data->upperBound * sign ) < ( loop_item->upper * sign ) ) loop_item->upper = loop_data->upperBound;
+
+         loop_item->last = mychunk == (loop_data->numOfChunks - 1);
+
+         loop_item->execute = (loop_item->lower * sign) <= (loop_item->upper * sign);
+      }
+
+      void duplicateWS ( nanos_ws_desc_t *orig, nanos_ws_desc_t **copy) {}
+
+};
+
+class WorkSharingStealForPlugin : public Plugin {
+   public:
+      WorkSharingStealForPlugin () : Plugin("Worksharing plugin for loops using a work stealing policy",1) {}
+     ~WorkSharingStealForPlugin () {}
+
+      virtual void config( Config& cfg ) {}
+
+      void init ()
+      {
+         sys.registerWorkSharing("steal_for", NEW WorkSharingStealFor() );
+      }
+};
+
+} // namespace ext
+} // namespace nanos
+
+DECLARE_PLUGIN( "placeholder-name", nanos::ext::WorkSharingStealForPlugin );
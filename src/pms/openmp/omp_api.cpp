@@ -227,9 +227,11 @@ extern "C"
       }
 
       int num_threads = 0;
-      int threads_busy = 1; // FIXME: Should we keep track of it?
+      // The current thread is busy but it will be part of the new team
+      int threads_busy = sys.getBusyThreads();
       int active_parallel_regions = getMyThreadSafe()->getTeam()->getLevel();
       int threads_available = globalState->getThreadLimit() - threads_busy + 1;
+      if ( threads_available < 1 ) threads_available = 1;
 
       if ( active_parallel_regions >= 1 && !data->icvs()->getNested() ) {
          num_threads = 1;
@@ -77,7 +77,7 @@ namespace nanos
          ws_names[omp_sched_static] = std::string("static_for");
          ws_names[omp_sched_dynamic] = std::string("dynamic_for");
          ws_names[omp_sched_guided] = std::string("guided_for");
-         ws_names[omp_sched_auto] = std::string("static_for");
+         ws_names[omp_sched_auto] = std::string("auto_for");
       }
 
 
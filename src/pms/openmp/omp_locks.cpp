@@ -21,43 +21,62 @@
 #include "nanos.h"
 #include "atomic.hpp"
 #include "lock.hpp"
+#include "mcslock.hpp"
+#include "userlock.hpp"
+#include "system.hpp"
 
 extern "C"
 {
    using namespace nanos;
 
+   // NOTE: omp_lock_t has the size of a pointer: word-sized locks are kept
+   // in place and MCS locks, that are bigger, are allocated and pointed to
+
    NANOS_API_DEF(void, omp_init_lock, ( omp_lock_t *arg ))
    {
-      // NOTE: This assumes Lock is the same size than Void * so nothing has to be allocated
-      Lock *lock = (Lock *) arg;
-
-      new (lock) Lock;
+      if ( sys.getUserLocks() == UserLock::MCS ) {
+         *arg = NEW McsLock();
+      } else {
+         new (arg) nanos_lock_t;
+      }
    }
 
    NANOS_API_DEF(void, omp_destroy_lock, ( omp_lock_t *arg ))
    {
+      if ( sys.getUserLocks() == UserLock::MCS ) {
+         delete (McsLock *) *arg;
+      }
    }
 
    NANOS_API_DEF(void, omp_set_lock, ( omp_lock_t *arg ))
    {
-      Lock &lock = *(Lock *) arg;
-      lock++;
+      if ( sys.getUserLocks() == UserLock::MCS ) {
+         ( (McsLock *) *arg )->acquire();
+      } else {
+         UserLock::acquire( *(nanos_lock_t *) arg );
+      }
    }
 
    NANOS_API_DEF(void, omp_unset_lock,( omp_lock_t *arg ))
    {
-      Lock &lock = *(Lock *) arg;
-      lock--;
+      if ( sys.getUserLocks() == UserLock::MCS ) {
+         ( (McsLock *) *arg )->release();
+      } else {
+         UserLock::release( *(nanos_lock_t *) arg );
+      }
    }
 
    NANOS_API_DEF(int, omp_test_lock ,( omp_lock_t *arg ))
    {
-      Lock &lock = *(Lock *) arg;
-      return lock.tryAcquire();
+      if ( sys.getUserLocks() == UserLock::MCS ) {
+         return ( (McsLock *) *arg )->tryAcquire();
+      } else {
+         return UserLock::tryAcquire( *(nanos_lock_t *) arg );
+      }
    }
 
    struct __omp_nest_lock {
-      Lock lock;
+      nanos_lock_t lock;
       nanos_wd_t owner;
       short count;
    };
@@ -85,7 +104,7 @@ extern "C"
          // count >=1 is assumed because only the owner can set it
          nlock->count++;
       } else {
-         nlock->lock++;
+         UserLock::acquire( nlock->lock );
          // count == 0 is assumed because we just acquired the lock
          nlock->owner = nanos_current_wd();
          nlock->count++;
@@ -100,7 +119,7 @@ extern "C"
       nlock->count--;
       if ( nlock->count == 0 ) {
          nlock->owner = NULL;
-         nlock->lock--;
+         UserLock::release( nlock->lock );
       }
    }
 
@@ -113,7 +132,7 @@ extern "C"
          nlock->count++;
          return 1;
       } else {
-         int result = nlock->lock.tryAcquire();
+         int result = UserLock::tryAcquire( nlock->lock );
          if ( result != 0 ) {
             // count == 0 is assumed because we just acquired the lock
             nlock->owner = nanos_current_wd();
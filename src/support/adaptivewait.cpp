@@ -0,0 +1,61 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "adaptivewait.hpp"
+#include <limits.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+using namespace nanos;
+
+#if defined(__linux__) && defined(SYS_futex)
+#define NANOS_HAVE_FUTEX
+#endif
+
+void AdaptiveWait::block( int generation, uint64_t timeout )
+{
+#ifdef NANOS_HAVE_FUTEX
+   struct timespec ts;
+   ts.tv_sec = timeout / 1000000000ULL;
+   ts.tv_nsec = timeout % 1000000000ULL;
+
+   // Returns at once if the generation already changed, spurious wake ups
+   // and timeouts are handled by the caller checking the condition again
+   syscall( SYS_futex, (int *) &_generation.override(), FUTEX_WAIT_PRIVATE, generation, &ts, NULL, 0 );
+#else
+   // Without futexes just give the CPU away for a while
+   const uint64_t maxSleep = 100000ULL;
+   struct timespec ts;
+   ts.tv_sec = 0;
+   ts.tv_nsec = timeout < maxSleep ? timeout : maxSleep;
+   if ( _generation.value() == generation ) nanosleep( &ts, NULL );
+#endif
+   _sleepers--;
+}
+
+void AdaptiveWait::wakeSleepers()
+{
+   _generation++;
+#ifdef NANOS_HAVE_FUTEX
+   syscall( SYS_futex, (int *) &_generation.override(), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+#endif
+}
@@ -0,0 +1,74 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_ADAPTIVEWAIT
+#define _NANOS_ADAPTIVEWAIT
+
+#include "adaptivewait_decl.hpp"
+#include "atomic.hpp"
+#include <time.h>
+
+namespace nanos {
+
+inline uint64_t AdaptiveWait::now()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+inline uint64_t AdaptiveWait::getSpinBudget( uint64_t maxSpin ) const
+{
+   // Always spin a little: a short wait after a long phase is still caught,
+   // and keeps the average representative
+   const uint64_t minSpin = maxSpin / 8;
+   const uint64_t expected = 2 * _avgWait;
+
+   if ( expected > maxSpin ) return minSpin;
+   return expected > minSpin ? expected : minSpin;
+}
+
+inline void AdaptiveWait::record( uint64_t waited )
+{
+   _avgWait = ( 7 * _avgWait + waited ) / 8;
+}
+
+inline int AdaptiveWait::prepareBlock()
+{
+   // Signallers read the sleepers after making the condition true, so
+   // either the caller sees the condition or the signaller sees the caller
+   _sleepers++;
+   memoryFence();
+   return _generation.value();
+}
+
+inline void AdaptiveWait::cancelBlock()
+{
+   _sleepers--;
+}
+
+inline void AdaptiveWait::wake()
+{
+   memoryFence();
+   if ( _sleepers.value() > 0 ) wakeSleepers();
+}
+
+} // namespace nanos
+
+#endif
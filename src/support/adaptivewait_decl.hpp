@@ -0,0 +1,86 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_ADAPTIVEWAIT_DECL
+#define _NANOS_ADAPTIVEWAIT_DECL
+
+#include <stdint.h>
+#include "atomic_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Spin-then-block wait support for a condition
+    *
+    *  Waiters spin for a budget that adapts to the recent wait times of the
+    *  condition: when waits are short enough spinning pays off, when they are
+    *  long the CPU is better given away early. Past the budget the waiter
+    *  blocks on a futex (a short sleep where futexes are not available)
+    *  until the condition is signalled or a timeout expires.
+    *
+    *  The condition itself is owned by the caller, the usual protocol is:
+    *
+    *     int generation = w.prepareBlock();
+    *     if ( !condition ) w.block( generation, timeout );
+    *     else w.cancelBlock();
+    *
+    *  and signallers call wake() after making the condition true.
+    */
+   class AdaptiveWait
+   {
+      private:
+         Atomic<int>    _generation;   /**< Futex word, changes every time sleepers are woken up */
+         Atomic<int>    _sleepers;     /**< Number of waiters between prepareBlock() and the end of the block */
+         uint64_t       _avgWait;      /**< Moving average of the recent wait times (ns), updated without synchronization */
+
+      private:
+         /*! \brief AdaptiveWait copy constructor (disabled) */
+         AdaptiveWait( const AdaptiveWait & );
+         /*! \brief AdaptiveWait copy assignment operator (disabled) */
+         AdaptiveWait & operator=( const AdaptiveWait & );
+
+         void wakeSleepers();
+
+      public:
+         AdaptiveWait() : _generation( 0 ), _sleepers( 0 ), _avgWait( 0 ) {}
+         ~AdaptiveWait() {}
+
+         /*! \brief Monotonic time in ns */
+         static uint64_t now();
+
+         /*! \brief Time (ns) to spin before blocking, at most maxSpin */
+         uint64_t getSpinBudget( uint64_t maxSpin ) const;
+         /*! \brief Accounts a completed wait of waited ns */
+         void record( uint64_t waited );
+
+         /*! \brief Registers the caller as a sleeper, before checking the condition
+          *  \return The generation to be passed to block()
+          */
+         int prepareBlock();
+         /*! \brief Blocks for at most timeout ns, unless woken up since prepareBlock() */
+         void block( int generation, uint64_t timeout );
+         /*! \brief Unregisters a sleeper that found the condition true */
+         void cancelBlock();
+
+         /*! \brief Wakes up the sleepers, if any */
+         void wake();
+   };
+
+} // namespace nanos
+
+#endif
@@ -150,6 +150,25 @@ void Hwloc::getNumSockets(unsigned int &allowedNodes, int &numSockets, unsigned
 #endif
 }
 
+void Hwloc::getCpuHierarchy( unsigned int &threadsPerCore, unsigned int &coresPerCache, unsigned int &cachesPerSocket )
+{
+   threadsPerCore = 0;
+   coresPerCache = 0;
+   cachesPerSocket = 0;
+#ifdef HWLOC
+   int pus = hwloc_get_nbobjs_by_type( _hwlocTopology, HWLOC_OBJ_PU );
+   int cores = hwloc_get_nbobjs_by_type( _hwlocTopology, HWLOC_OBJ_CORE );
+   int sockets = hwloc_get_nbobjs_by_type( _hwlocTopology, HWLOC_OBJ_SOCKET );
+   int caches = 0;
+   int depth = hwloc_get_cache_type_depth( _hwlocTopology, 3, HWLOC_OBJ_CACHE_UNIFIED );
+   if ( depth >= 0 ) caches = hwloc_get_nbobjs_by_depth( _hwlocTopology, depth );
+
+   if ( pus > 0 && cores > 0 ) threadsPerCore = pus / cores;
+   if ( cores > 0 && caches > 0 ) coresPerCache = cores / caches;
+   if ( caches > 0 && sockets > 0 ) cachesPerSocket = caches / sockets;
+#endif
+}
+
 unsigned int Hwloc::getNumaNodeOfGpu( unsigned int gpu ) {
    unsigned int node = 0;
 #ifdef GPU_DEV
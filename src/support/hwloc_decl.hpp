@@ -51,6 +51,16 @@ class Hwloc {
       unsigned int getNumaNodeOfCpu( unsigned int cpu );
       unsigned int getNumaNodeOfGpu( unsigned int gpu );
       void getNumSockets(unsigned int &allowedNodes, int &numSockets, unsigned int &hwThreads);
+      /*!
+       * \brief Gets the shape of the CPU hierarchy below the sockets.
+       * Any value that cannot be found out is set to 0, as well as all of
+       * them if hwloc is not available.
+       *
+       * @param threadsPerCore Hardware threads of each core.
+       * @param coresPerCache Cores sharing each L3 cache.
+       * @param cachesPerSocket L3 caches of each socket.
+       */
+      void getCpuHierarchy( unsigned int &threadsPerCore, unsigned int &coresPerCache, unsigned int &cachesPerSocket );
 
       /*!
        * \brief Checks if we can see the CPU, to create the PE.
@@ -22,9 +22,24 @@
 
 #include "atomic.hpp"
 #include "lock_decl.hpp"
+#ifdef NANOS_TICKET_LOCKS
+#include "ticketlock.hpp"
+#endif
 
 namespace nanos {
 
+#ifdef NANOS_TICKET_LOCKS
+inline TicketLock & Lock::ticket ()
+{
+   return static_cast<TicketLock &>( static_cast<nanos_lock_t &>( *this ) );
+}
+
+inline const TicketLock & Lock::ticket () const
+{
+   return static_cast<const TicketLock &>( static_cast<const nanos_lock_t &>( *this ) );
+}
+#endif
+
 inline Lock::state_t Lock::operator* () const
 {
    return getState();
@@ -32,7 +47,9 @@ inline Lock::state_t Lock::operator* () const
 
 inline Lock::state_t Lock::getState () const
 {
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+#if defined(NANOS_TICKET_LOCKS)
+   return ticket().getState();
+#elif defined(HAVE_NEW_GCC_ATOMIC_OPS)
    return __atomic_load_n(&state_, __ATOMIC_ACQUIRE);
 #else
    return state_;
@@ -51,7 +68,15 @@ inline void Lock::operator-- ( int val )
 
 inline void Lock::acquire ( void )
 {
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+#if defined(NANOS_LOCK_PROFILING_ENABLED)
+   if ( tryAcquire() ) {
+      LockProfiler::acquired( this );
+   } else {
+      LockProfiler::Time start = LockProfiler::now();
+      acquire_noinst();
+      LockProfiler::contended( this, start );
+   }
+#elif defined(NANOS_TICKET_LOCKS) || defined(HAVE_NEW_GCC_ATOMIC_OPS)
    acquire_noinst();
 #else
    if ( (state_ == NANOS_LOCK_FREE) &&  !__sync_lock_test_and_set( &state_,NANOS_LOCK_BUSY ) ) return;
@@ -74,7 +99,9 @@ inline void Lock::lock()
 
 inline void Lock::acquire_noinst ( void )
 {
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+#if defined(NANOS_TICKET_LOCKS)
+   ticket().acquire();
+#elif defined(HAVE_NEW_GCC_ATOMIC_OPS)
    while (__atomic_exchange_n( &state_, NANOS_LOCK_BUSY, __ATOMIC_ACQ_REL) == NANOS_LOCK_BUSY ) { }
 #else
 spin:
@@ -85,7 +112,9 @@ spin:
 
 inline bool Lock::tryAcquire ( void )
 {
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+#if defined(NANOS_TICKET_LOCKS)
+   return ticket().tryAcquire();
+#elif defined(HAVE_NEW_GCC_ATOMIC_OPS)
    if (__atomic_load_n(&state_, __ATOMIC_ACQUIRE) == NANOS_LOCK_FREE)
    {
       if (__atomic_exchange_n(&state_, NANOS_LOCK_BUSY, __ATOMIC_ACQ_REL) == NANOS_LOCK_BUSY)
@@ -112,7 +141,9 @@ inline bool Lock::try_lock()
 
 inline void Lock::release ( void )
 {
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+#if defined(NANOS_TICKET_LOCKS)
+   ticket().release();
+#elif defined(HAVE_NEW_GCC_ATOMIC_OPS)
    __atomic_store_n(&state_, 0, __ATOMIC_RELEASE);
 #else
    __sync_lock_release( &state_ );
@@ -21,9 +21,18 @@
 #define _NANOS_LOCK_DECL
 
 #include "nanos-int.h"
+#include "lockprofiler_decl.hpp"
+#ifdef NANOS_TICKET_LOCKS
+#include "ticketlock_decl.hpp"
+#endif
 
 namespace nanos {
 
+   /*! \brief Runtime spinlock
+    *
+    *  A test-and-set lock, or a TicketLock when configured with
+    *  --enable-ticket-locks. Both keep the layout of nanos_lock_t.
+    */
    class Lock : public nanos_lock_t
    {
       private:
@@ -33,6 +42,12 @@ namespace nanos {
          Lock( const Lock &lock );
          const Lock & operator= ( const Lock& );
 
+#ifdef NANOS_TICKET_LOCKS
+         /*! \brief The same lock word seen as a TicketLock */
+         TicketLock & ticket ();
+         const TicketLock & ticket () const;
+#endif
+
       public:
          // constructor
          Lock( state_t init=NANOS_LOCK_FREE ) : nanos_lock_t( init ) {};
@@ -0,0 +1,237 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "lockprofiler_decl.hpp"
+#include "lock.hpp"
+#include "atomic.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <time.h>
+
+using namespace nanos;
+
+LockProfiler::TableEntry LockProfiler::_table[LockProfiler::TABLE_SIZE];
+const char *LockProfiler::_siteNames[LockProfiler::MAX_SITES];
+int LockProfiler::_numSites;
+LockProfiler::ThreadStats *LockProfiler::_threads;
+bool LockProfiler::_tableFull;
+
+namespace {
+   //! \brief Protects site and table updates. Always used through the _noinst methods
+   Lock registryLock;
+
+   //! \brief Marks a table entry which has been unregistered
+   const void * const TOMBSTONE = (const void *) 1;
+
+   __thread void *myLockStats = NULL;
+
+   struct SpinTimeGreater {
+      bool operator() ( const LockSiteSummary &a, const LockSiteSummary &b ) const
+      {
+         if ( a._stats._spinTime != b._stats._spinTime ) return a._stats._spinTime > b._stats._spinTime;
+         return a._stats._contended > b._stats._contended;
+      }
+   };
+}
+
+LockProfiler::Time LockProfiler::now ()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (Time) ts.tv_sec * 1000000000ULL + (Time) ts.tv_nsec;
+}
+
+unsigned int LockProfiler::hash ( const void *lock )
+{
+   uint64_t key = (uint64_t) (uintptr_t) lock >> 3;
+   return (unsigned int) ( ( key * 0x9E3779B97F4A7C15ULL ) >> 40 ) & ( TABLE_SIZE - 1 );
+}
+
+LockProfiler::ThreadStats * LockProfiler::getThreadStats ()
+{
+   ThreadStats *stats = (ThreadStats *) myLockStats;
+   if ( stats == NULL ) {
+      // Not using NEW: the allocator may acquire profiled locks
+      stats = (ThreadStats *) std::calloc( 1, sizeof( ThreadStats ) );
+      ThreadStats *head;
+      do {
+         head = _threads;
+         stats->_next = head;
+      } while ( !compareAndSwap( &_threads, head, stats ) );
+      myLockStats = stats;
+   }
+   return stats;
+}
+
+int LockProfiler::findSite ( const void *lock )
+{
+   unsigned int pos = hash( lock );
+   for ( unsigned int probe = 0; probe < TABLE_SIZE; probe++ ) {
+      const TableEntry &entry = _table[( pos + probe ) & ( TABLE_SIZE - 1 )];
+      if ( entry._lock == lock ) return entry._site;
+      if ( entry._lock == NULL ) break;
+   }
+   return UNNAMED_SITE;
+}
+
+int LockProfiler::registerLock ( const void *lock, const char *name )
+{
+   registryLock.acquire_noinst();
+
+   if ( _numSites == 0 ) _siteNames[_numSites++] = "unnamed";
+
+   int site = UNNAMED_SITE;
+   for ( int s = 1; s < _numSites; s++ ) {
+      if ( std::strcmp( _siteNames[s], name ) == 0 ) {
+         site = s;
+         break;
+      }
+   }
+   if ( site == UNNAMED_SITE && _numSites < MAX_SITES ) {
+      site = _numSites;
+      _siteNames[_numSites++] = name;
+   }
+
+   if ( site != UNNAMED_SITE ) {
+      unsigned int pos = hash( lock );
+      TableEntry *slot = NULL;
+      for ( unsigned int probe = 0; probe < TABLE_SIZE; probe++ ) {
+         TableEntry &entry = _table[( pos + probe ) & ( TABLE_SIZE - 1 )];
+         if ( entry._lock == lock ) {
+            slot = &entry;
+            break;
+         }
+         if ( entry._lock == TOMBSTONE && slot == NULL ) slot = &entry;
+         if ( entry._lock == NULL ) {
+            if ( slot == NULL ) slot = &entry;
+            break;
+         }
+      }
+      if ( slot != NULL ) {
+         // Publish the site before the address, lookups are not locked
+         slot->_site = site;
+         memoryFence();
+         slot->_lock = lock;
+      } else {
+         _tableFull = true;
+         site = UNNAMED_SITE;
+      }
+   }
+
+   registryLock.release();
+   return site;
+}
+
+void LockProfiler::unregisterLock ( const void *lock )
+{
+   registryLock.acquire_noinst();
+   unsigned int pos = hash( lock );
+   for ( unsigned int probe = 0; probe < TABLE_SIZE; probe++ ) {
+      TableEntry &entry = _table[( pos + probe ) & ( TABLE_SIZE - 1 )];
+      if ( entry._lock == lock ) {
+         entry._lock = TOMBSTONE;
+         memoryFence();
+         entry._site = UNNAMED_SITE;
+         break;
+      }
+      if ( entry._lock == NULL ) break;
+   }
+   registryLock.release();
+}
+
+void LockProfiler::acquired ( const void *lock )
+{
+   getThreadStats()->_sites[findSite( lock )]._acquisitions++;
+}
+
+void LockProfiler::contended ( const void *lock, Time start )
+{
+   Time spin = now() - start;
+   LockSiteStats &stats = getThreadStats()->_sites[findSite( lock )];
+   stats._acquisitions++;
+   stats._contended++;
+   stats._spinTime += spin;
+   if ( spin > stats._maxSpinTime ) stats._maxSpinTime = spin;
+}
+
+void LockProfiler::getTopSites ( unsigned int n, std::vector<LockSiteSummary> &sites )
+{
+   registryLock.acquire_noinst();
+   int numSites = _numSites > 0 ? _numSites : 1;
+   std::vector<LockSiteSummary> all( numSites );
+   for ( int s = 0; s < numSites; s++ ) {
+      all[s]._site = s;
+      all[s]._name = s == UNNAMED_SITE ? "unnamed" : _siteNames[s];
+      std::memset( &all[s]._stats, 0, sizeof( LockSiteStats ) );
+   }
+   registryLock.release();
+
+   for ( ThreadStats *thread = _threads; thread != NULL; thread = thread->_next ) {
+      for ( int s = 0; s < numSites; s++ ) {
+         const LockSiteStats &ts = thread->_sites[s];
+         LockSiteStats &total = all[s]._stats;
+         total._acquisitions += ts._acquisitions;
+         total._contended += ts._contended;
+         total._spinTime += ts._spinTime;
+         total._maxSpinTime = std::max( total._maxSpinTime, ts._maxSpinTime );
+      }
+   }
+
+   std::sort( all.begin(), all.end(), SpinTimeGreater() );
+
+   sites.clear();
+   for ( std::vector<LockSiteSummary>::const_iterator it = all.begin(); it != all.end() && sites.size() < n; it++ ) {
+      if ( it->_stats._acquisitions == 0 ) continue;
+      sites.push_back( *it );
+   }
+}
+
+std::string LockProfiler::getReport ( unsigned int n )
+{
+   std::vector<LockSiteSummary> sites;
+   getTopSites( n, sites );
+
+   std::ostringstream output;
+   output << "=== Lock contention (top " << n << " sites by spin time)" << std::endl;
+   output << "=== " << std::setw( 24 ) << std::left << "site" << std::right
+          << std::setw( 14 ) << "acquisitions"
+          << std::setw( 12 ) << "contended"
+          << std::setw( 8 ) << "%"
+          << std::setw( 14 ) << "spin (us)"
+          << std::setw( 12 ) << "max (us)" << std::endl;
+
+   for ( std::vector<LockSiteSummary>::const_iterator it = sites.begin(); it != sites.end(); it++ ) {
+      const LockSiteStats &stats = it->_stats;
+      double ratio = stats._acquisitions > 0 ? 100.0 * stats._contended / stats._acquisitions : 0.0;
+      output << "=== " << std::setw( 24 ) << std::left << it->_name << std::right
+             << std::setw( 14 ) << stats._acquisitions
+             << std::setw( 12 ) << stats._contended
+             << std::setw( 8 ) << std::fixed << std::setprecision( 2 ) << ratio
+             << std::setw( 14 ) << std::setprecision( 1 ) << stats._spinTime / 1000.0
+             << std::setw( 12 ) << stats._maxSpinTime / 1000.0 << std::endl;
+   }
+   if ( _tableFull ) {
+      output << "=== Some locks could not be registered and were accounted as unnamed" << std::endl;
+   }
+   return output.str();
+}
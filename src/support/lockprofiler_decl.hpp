@@ -0,0 +1,121 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LOCK_PROFILER_DECL
+#define _NANOS_LOCK_PROFILER_DECL
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*! \brief Lock contention profiling (--enable-lock-profiling)
+ *
+ *  When disabled NANOS_LOCK_PROFILE expands to nothing and Lock and
+ *  RecursiveLock keep their original acquire paths.
+ */
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+#define NANOS_LOCK_PROFILE(f) f;
+#else
+#define NANOS_LOCK_PROFILE(f)
+#endif
+
+namespace nanos {
+
+   /*! \brief Per-thread counters of a lock site */
+   struct LockSiteStats {
+      uint64_t _acquisitions;     /**< Number of acquire() calls */
+      uint64_t _contended;        /**< Acquisitions that found the lock busy */
+      uint64_t _spinTime;         /**< Cumulative time spent waiting (ns) */
+      uint64_t _maxSpinTime;      /**< Longest single wait (ns) */
+   };
+
+   /*! \brief Aggregated counters of a lock site, used by reports */
+   struct LockSiteSummary {
+      int           _site;
+      std::string   _name;
+      LockSiteStats _stats;
+   };
+
+   /*! \brief Collects acquisition statistics of named lock sites
+    *
+    *  Locks are mapped to sites by address (a Lock can not grow, it must keep
+    *  the layout of nanos_lock_t), several locks may share the same site name.
+    *  Locks which are not registered are accounted in the "unnamed" site.
+    *  Counters are kept per thread, without any synchronization, and are only
+    *  aggregated when a report is requested.
+    *
+    *  All the data is zero-initialized POD so that locks can be registered
+    *  during static initialization.
+    */
+   class LockProfiler
+   {
+      public:
+         static const int MAX_SITES = 64;
+         static const int UNNAMED_SITE = 0;
+         typedef uint64_t Time;
+      private:
+         static const unsigned int TABLE_SIZE = 8192;
+
+         struct ThreadStats {
+            LockSiteStats _sites[MAX_SITES];
+            ThreadStats  *_next;
+         };
+
+         struct TableEntry {
+            const void *_lock;
+            int         _site;
+         };
+
+         static TableEntry        _table[TABLE_SIZE];
+         static const char       *_siteNames[MAX_SITES];
+         static int               _numSites;
+         static ThreadStats      *_threads;
+         static bool              _tableFull;
+
+         static ThreadStats * getThreadStats ();
+         static int findSite ( const void *lock );
+         static unsigned int hash ( const void *lock );
+
+         LockProfiler ();
+      public:
+         /*! \brief Current time (ns) */
+         static Time now ();
+
+         /*! \brief Associates a lock with the site name. Returns the site id */
+         static int registerLock ( const void *lock, const char *name );
+
+         /*! \brief Forgets about a lock (before its memory is reused) */
+         static void unregisterLock ( const void *lock );
+
+         /*! \brief Accounts an uncontended acquisition */
+         static void acquired ( const void *lock );
+
+         /*! \brief Accounts an acquisition that had to wait since start */
+         static void contended ( const void *lock, Time start );
+
+         /*! \brief Returns the sites with more contention, sorted by spin time */
+         static void getTopSites ( unsigned int n, std::vector<LockSiteSummary> &sites );
+
+         /*! \brief Human readable report of the top n sites */
+         static std::string getReport ( unsigned int n );
+   };
+
+} // namespace nanos
+
+#endif
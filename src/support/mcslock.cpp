@@ -0,0 +1,50 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "mcslock.hpp"
+
+using namespace nanos;
+
+namespace {
+   //! Queue nodes released by this thread, linked through their next field
+   __thread void *freeNodes = NULL;
+}
+
+McsLock::Node * McsLock::getNode ()
+{
+   Node *node = (Node *) freeNodes;
+   if ( node == NULL ) return NEW Node();
+   freeNodes = node->next;
+   return node;
+}
+
+void McsLock::putNode ( Node *node )
+{
+   node->next = (Node *) freeNodes;
+   freeNodes = node;
+}
+
+void McsLock::releaseThreadNodes ()
+{
+   while ( freeNodes != NULL ) {
+      Node *node = (Node *) freeNodes;
+      freeNodes = node->next;
+      delete node;
+   }
+}
@@ -0,0 +1,88 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_MCSLOCK
+#define _NANOS_MCSLOCK
+
+#include "mcslock_decl.hpp"
+#include "atomic.hpp"
+
+namespace nanos {
+
+inline void McsLock::acquire ()
+{
+   Node *node = getNode();
+   node->next = NULL;
+   node->locked = 1;
+
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+   Node *predecessor = __atomic_exchange_n( &_tail, node, __ATOMIC_ACQ_REL );
+#else
+   memoryFence();
+   Node *predecessor = __sync_lock_test_and_set( &_tail, node );
+#endif
+
+   if ( predecessor != NULL ) {
+      predecessor->next = node;
+      while ( node->locked ) {}
+      memoryFence();
+   }
+   _holder = node;
+}
+
+inline bool McsLock::tryAcquire ()
+{
+   Node *node = getNode();
+   node->next = NULL;
+   node->locked = 0;
+
+   if ( !__sync_bool_compare_and_swap( &_tail, (Node *) NULL, node ) ) {
+      putNode( node );
+      return false;
+   }
+   _holder = node;
+   return true;
+}
+
+inline void McsLock::release ()
+{
+   Node *node = _holder;
+
+   if ( node->next == NULL ) {
+      if ( __sync_bool_compare_and_swap( &_tail, node, (Node *) NULL ) ) {
+         putNode( node );
+         return;
+      }
+      // A waiter has swapped the tail but not linked itself yet
+      while ( node->next == NULL ) {}
+   }
+
+   memoryFence();
+   node->next->locked = 0;
+   putNode( node );
+}
+
+inline bool McsLock::isBusy () const
+{
+   return *(Node * const volatile *) &_tail != NULL;
+}
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,75 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_MCSLOCK_DECL
+#define _NANOS_MCSLOCK_DECL
+
+#include "allocator_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Queue lock (Mellor-Crummey and Scott)
+    *
+    *  Each waiter spins on a flag of its own queue node, so a release only
+    *  touches the cache line of the next waiter no matter how many threads
+    *  wait, and waiters get the lock in arrival order. The lock is two
+    *  pointers wide, it can not be placed in a nanos_lock_t. Queue nodes come
+    *  from a per thread cache, so the lock can be acquired and released in
+    *  different scopes, like any other lock.
+    */
+   class McsLock
+   {
+      private:
+         struct Node {
+            Node * volatile   next;
+            volatile int      locked;
+            char              pad[NANOS_CACHELINE];
+         };
+
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+         Node *               _tail;     /*!< Last waiter, NULL when the lock is free */
+#else
+         Node * volatile      _tail;
+#endif
+         Node *               _holder;   /*!< Node of the current holder, only used by it */
+
+         // disable copy constructor and assignment operator
+         McsLock( const McsLock &lock );
+         const McsLock & operator= ( const McsLock & );
+
+         static Node * getNode ();
+         static void putNode ( Node *node );
+
+      public:
+         McsLock() : _tail( NULL ), _holder( NULL ) {}
+         ~McsLock() {}
+
+         void acquire();
+         bool tryAcquire();
+         void release();
+
+         bool isBusy () const;
+
+         /*! \brief Frees the queue nodes cached by the calling thread, before it exits */
+         static void releaseThreadNodes ();
+   };
+
+} // namespace nanos
+
+#endif
@@ -53,7 +53,17 @@ void RecursiveLock::acquire ( )
       return;
    }
 
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+   if ( __atomic_exchange_n( &state_, NANOS_LOCK_BUSY, __ATOMIC_ACQ_REL) == NANOS_LOCK_BUSY ) {
+      LockProfiler::Time start = LockProfiler::now();
+      while (__atomic_exchange_n( &state_, NANOS_LOCK_BUSY, __ATOMIC_ACQ_REL) == NANOS_LOCK_BUSY ) { }
+      LockProfiler::contended( this, start );
+   } else {
+      LockProfiler::acquired( this );
+   }
+#else
    while (__atomic_exchange_n( &state_, NANOS_LOCK_BUSY, __ATOMIC_ACQ_REL) == NANOS_LOCK_BUSY ) { }
+#endif
 
    __atomic_store_n(&_holderThread, getMyThreadSafe(), __ATOMIC_RELEASE);
    __atomic_add_fetch(&_recursionCount, 1, __ATOMIC_ACQ_REL);
@@ -65,10 +75,20 @@ void RecursiveLock::acquire ( )
       return;
    }
    
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+   LockProfiler::Time start = 0;
+   if ( state_ == NANOS_LOCK_BUSY || __sync_lock_test_and_set( &state_,NANOS_LOCK_BUSY ) ) {
+      start = LockProfiler::now();
+#endif
 spin:
    while ( state_ == NANOS_LOCK_BUSY ) {}
 
    if ( __sync_lock_test_and_set( &state_,NANOS_LOCK_BUSY ) ) goto spin;
+#ifdef NANOS_LOCK_PROFILING_ENABLED
+   }
+   if ( start != 0 ) LockProfiler::contended( this, start );
+   else LockProfiler::acquired( this );
+#endif
 
    _holderThread = getMyThreadSafe();
    _recursionCount++;
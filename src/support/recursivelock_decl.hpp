@@ -21,6 +21,7 @@
 #define _NANOS_RECURSIVELOCK_DECL
 
 #include "nanos-int.h"
+#include "lockprofiler_decl.hpp"
 
 namespace nanos {
 
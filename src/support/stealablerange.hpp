@@ -0,0 +1,136 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_STEALABLE_RANGE
+#define _NANOS_STEALABLE_RANGE
+
+#include <stdint.h>
+#include "atomic.hpp"
+#include "allocator_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Range of chunks [lower, upper) owned by one thread, that others may steal from
+    *
+    *  Both bounds are packed in a single word, so the owner and the thieves
+    *  update them with a single compare and swap: the owner takes chunks from
+    *  the lower end and thieves take half of what remains from the upper end.
+    *  The owner only refills its range once it is empty and nobody updates an
+    *  empty range, so the bounds of a non empty range only move towards each
+    *  other and a compare and swap can not succeed on a stale value (no ABA).
+    *
+    *  Each range is padded to its own cache line, so that owners taking
+    *  chunks do not disturb each other.
+    */
+   class StealableRange
+   {
+      private:
+         Atomic<uint64_t>  _bounds;
+         char              _pad[NANOS_CACHELINE - sizeof( uint64_t )];
+
+         static uint64_t pack ( uint32_t lower, uint32_t upper ) { return ( (uint64_t) upper << 32 ) | lower; }
+         static uint32_t lowerOf ( uint64_t bounds ) { return (uint32_t) bounds; }
+         static uint32_t upperOf ( uint64_t bounds ) { return (uint32_t) ( bounds >> 32 ); }
+
+      public:
+         StealableRange () : _bounds( 0 ) {}
+
+         /*! \brief Sets the range, before it is shared or by its owner once it is empty */
+         void set ( uint32_t lower, uint32_t upper )
+         {
+            _bounds = pack( lower, upper );
+         }
+
+         /*! \brief Takes the next chunk (owner)
+          *  \return false if the range is empty
+          */
+         bool take ( uint32_t &chunk )
+         {
+            uint64_t bounds = _bounds.value();
+            while ( lowerOf( bounds ) < upperOf( bounds ) ) {
+               if ( compareAndSwap( &_bounds.override(), bounds, pack( lowerOf( bounds ) + 1, upperOf( bounds ) ) ) ) {
+                  chunk = lowerOf( bounds );
+                  return true;
+               }
+               bounds = _bounds.value();
+            }
+            return false;
+         }
+
+         /*! \brief Takes half of the remaining chunks, at least one (thieves)
+          *  \return false if the range is empty
+          */
+         bool steal ( uint32_t &lower, uint32_t &upper )
+         {
+            uint64_t bounds = _bounds.value();
+            while ( lowerOf( bounds ) < upperOf( bounds ) ) {
+               uint32_t remaining = upperOf( bounds ) - lowerOf( bounds );
+               uint32_t middle = upperOf( bounds ) - ( remaining + 1 ) / 2;
+               if ( compareAndSwap( &_bounds.override(), bounds, pack( lowerOf( bounds ), middle ) ) ) {
+                  lower = middle;
+                  upper = upperOf( bounds );
+                  return true;
+               }
+               bounds = _bounds.value();
+            }
+            return false;
+         }
+
+         /*! \brief Number of chunks left, only a hint while others update the range */
+         uint32_t size () const
+         {
+            uint64_t bounds = _bounds.value();
+            return lowerOf( bounds ) < upperOf( bounds ) ? upperOf( bounds ) - lowerOf( bounds ) : 0;
+         }
+   };
+
+   /*! \brief Takes the next chunk for thread id out of ranges[0..n), stealing when its own range is empty
+    *  \return false when there are no chunks left
+    */
+   inline bool takeOrStealChunk ( StealableRange *ranges, int n, int id, uint32_t &chunk )
+   {
+      if ( ranges[id].take( chunk ) ) return true;
+
+      // The victim with most chunks left gets the best balance, start
+      // looking at the neighbours so that thieves spread
+      for ( ;; ) {
+         int victim = -1;
+         uint32_t most = 0;
+         for ( int i = 1; i < n; i++ ) {
+            int v = ( id + i ) % n;
+            uint32_t left = ranges[v].size();
+            if ( left > most ) {
+               most = left;
+               victim = v;
+            }
+         }
+         if ( victim == -1 ) return false;
+
+         uint32_t lower, upper;
+         if ( ranges[victim].steal( lower, upper ) ) {
+            chunk = lower;
+            if ( lower + 1 < upper ) ranges[id].set( lower + 1, upper );
+            return true;
+         }
+      }
+   }
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,94 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_TICKETLOCK
+#define _NANOS_TICKETLOCK
+
+#include "ticketlock_decl.hpp"
+
+namespace nanos {
+
+inline unsigned int TicketLock::load () const
+{
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+   return (unsigned int) __atomic_load_n( &state_, __ATOMIC_ACQUIRE );
+#else
+   return (unsigned int) *(volatile state_t *) &state_;
+#endif
+}
+
+inline unsigned int TicketLock::next ( unsigned int state )
+{
+   return state >> TICKET_SHIFT;
+}
+
+inline unsigned int TicketLock::serving ( unsigned int state )
+{
+   return -state & TICKET_MASK;
+}
+
+inline void TicketLock::backoff ( unsigned int waitersAhead )
+{
+   for ( unsigned int i = 0; i < waitersAhead * BACKOFF_SPINS; i++ ) {
+#if defined(__i386__) || defined(__x86_64__)
+      __builtin_ia32_pause();
+#else
+      __asm__ __volatile__( "" ::: "memory" );
+#endif
+   }
+}
+
+inline void TicketLock::acquire ()
+{
+   unsigned int ticket = next( __sync_fetch_and_add( (unsigned int *) &state_, 1U << TICKET_SHIFT ) );
+
+   for ( ; ; ) {
+      unsigned int now = serving( load() );
+      if ( now == ticket ) break;
+      backoff( ( ticket - now ) & TICKET_MASK );
+   }
+}
+
+inline bool TicketLock::tryAcquire ()
+{
+   unsigned int state = load();
+   if ( next( state ) != serving( state ) ) return false;
+   return __sync_bool_compare_and_swap( (unsigned int *) &state_, state, state + ( 1U << TICKET_SHIFT ) );
+}
+
+inline void TicketLock::release ()
+{
+   // Only the holder moves the lower half, but waiters arriving change the
+   // upper one, so it can not simply be decremented without a borrow from it
+   unsigned int state, served;
+   do {
+      state = load();
+      served = ( state & ~TICKET_MASK ) | ( ( state - 1 ) & TICKET_MASK );
+   } while ( !__sync_bool_compare_and_swap( (unsigned int *) &state_, state, served ) );
+}
+
+inline TicketLock::state_t TicketLock::getState () const
+{
+   unsigned int state = load();
+   return next( state ) == serving( state ) ? NANOS_LOCK_FREE : NANOS_LOCK_BUSY;
+}
+
+} // namespace nanos
+
+#endif
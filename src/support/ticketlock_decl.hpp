@@ -0,0 +1,71 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_TICKETLOCK_DECL
+#define _NANOS_TICKETLOCK_DECL
+
+#include "nanos-int.h"
+
+namespace nanos {
+
+   /*! \brief Fair spinlock, waiters get the lock in arrival order
+    *
+    *  It keeps the layout of nanos_lock_t, so it can be used in place of a
+    *  Lock: the upper half of the word is the next ticket to hand out, so
+    *  taking one is a single atomic add whose carry falls off the word, and
+    *  the lower half counts the tickets served downwards. The lock is free
+    *  when both halves add up to zero: a zeroed word is free and
+    *  NANOS_LOCK_BUSY is held with one ticket handed out, as the static
+    *  initializers of the C API expect. Waiters back off in proportion to
+    *  the number of waiters ahead of them, so the lock word is not hammered
+    *  while the queue is long.
+    */
+   class TicketLock : public nanos_lock_t
+   {
+      private:
+         typedef nanos_lock_state_t state_t;
+
+         static const unsigned int TICKET_SHIFT = 16;
+         static const unsigned int TICKET_MASK = ( 1U << TICKET_SHIFT ) - 1;
+         static const unsigned int BACKOFF_SPINS = 64;   /*!< Spins per waiter ahead */
+
+         // disable copy constructor and assignment operator
+         TicketLock( const TicketLock &lock );
+         const TicketLock & operator= ( const TicketLock & );
+
+         unsigned int load () const;
+         static unsigned int next ( unsigned int state );
+         static unsigned int serving ( unsigned int state );
+         static void backoff ( unsigned int waitersAhead );
+
+      public:
+         TicketLock() : nanos_lock_t( NANOS_LOCK_FREE ) {}
+         ~TicketLock() {}
+
+         void acquire();
+         bool tryAcquire();
+         void release();
+
+         /*! \brief NANOS_LOCK_BUSY while held, as Lock::getState() */
+         state_t getState () const;
+   };
+
+} // namespace nanos
+
+#endif
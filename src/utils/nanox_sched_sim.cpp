@@ -0,0 +1,923 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*! \file nanox_sched_sim.cpp
+ *  \brief Replays the task graph logged by the tdg instrumentation plugin in
+ *  streaming mode (--tdg-stream) against the scheduling policies of the
+ *  runtime, using virtual threads and a virtual clock.
+ *
+ *  The program is a Nanos++ application: the policy under test is the one
+ *  selected with --schedule and the virtual threads are the threads of the
+ *  team (--smp-workers). The scheduler is stopped, so the real workers stay
+ *  paused, and the simulator calls the hooks of the policy (atSubmit,
+ *  queue, atIdle, atBlock, atBeforeExit and atAfterExit) on behalf of each
+ *  thread with one synthetic WD per task of the log, as the runtime would do
+ *  at each point of the replay. With -p the program runs itself once per
+ *  policy and prints a table.
+ *
+ *  Task model:
+ *   - the duration of a task is the sum of its execution bursts, the task
+ *     creations and taskwaits it does are replayed at the same point of its
+ *     work (the time blocked in taskwaits is not work),
+ *   - tasks whose parent is not a task of the log (the implicit WDs) are
+ *     tied to thread 0, 1, ... in order of appearance and end with a
+ *     taskwait,
+ *   - dependences are released when the body of the task ends, taskwaits
+ *     wait for every child created before them,
+ *   - a task blocked in a taskwait resumes in the same thread,
+ *   - optionally (-b), a task whose predecessors ran in other threads pays
+ *     the transfer of the data of its dependences.
+ *
+ *  Limitations: only the edges observed in the execution are replayed,
+ *  priorities are not logged, and the policies do not see the dependence
+ *  domain (e.g. immediate successors or the botlev criticality are not
+ *  available to them).
+ */
+
+#include "tdg_stream_format.hpp"
+
+#include "os.hpp"
+#include "schedule.hpp"
+#include "smpdd.hpp"
+#include "system.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+using namespace nanos;
+using namespace nanos::ext;
+using namespace nanos::tdgstream;
+
+namespace {
+
+enum NodeKind { TASK_NODE, ROOT_NODE, JOIN_NODE };
+enum ActionKind { CREATE_ACTION, TASKWAIT_ACTION };
+
+struct Interval {
+   int64_t start;
+   int64_t end;
+
+   bool operator< ( Interval const &other ) const { return start < other.start; }
+};
+
+struct Action {
+   ActionKind kind;
+   int64_t    time;        /**< When it happened in the execution */
+   int64_t    offset;      /**< Work done by the task before it */
+   size_t     child;
+};
+
+struct Node {
+   int64_t                 id;
+   NodeKind                kind;
+   long                    parent;
+   int                     depth;
+   int64_t                 created;
+   int64_t                 work;
+   int64_t                 depBytes;
+   int64_t                 copyBytes;
+   int64_t                 subtreeEnd;    /**< When the task and its descendants ended in the execution */
+   std::vector< Interval > bursts;
+   std::vector< Action >   actions;
+   std::vector< size_t >   preds;
+   std::vector< size_t >   succs;
+
+   Node( int64_t nodeId, NodeKind nodeKind ) : id( nodeId ), kind( nodeKind ), parent( -1 ), depth( 0 ), created( 0 ),
+      work( 0 ), depBytes( 0 ), copyBytes( 0 ), subtreeEnd( 0 ), bursts(), actions(), preds(), succs() {}
+};
+
+struct Trace {
+   std::vector< Node >           nodes;
+   std::map< int64_t, size_t >   index;
+   std::vector< size_t >         roots;
+   int64_t                       begin;
+   int64_t                       taskWork;
+   uint64_t                      tasks;
+
+   Trace() : nodes(), index(), roots(), begin( 0 ), taskWork( 0 ), tasks( 0 ) {}
+
+   size_t getNode( int64_t id, NodeKind kind )
+   {
+      std::map< int64_t, size_t >::iterator it = index.find( id );
+      if ( it != index.end() ) {
+         // Concurrent/commutative nodes may be found in an edge before their task record
+         if ( kind == TASK_NODE && nodes[it->second].kind == JOIN_NODE ) nodes[it->second].kind = TASK_NODE;
+         return it->second;
+      }
+      nodes.push_back( Node( id, kind ) );
+      index[id] = nodes.size() - 1;
+      if ( kind == ROOT_NODE ) roots.push_back( nodes.size() - 1 );
+      return nodes.size() - 1;
+   }
+
+   long findNode( int64_t id ) const
+   {
+      std::map< int64_t, size_t >::const_iterator it = index.find( id );
+      return it == index.end() ? -1 : (long) it->second;
+   }
+};
+
+bool recordBefore( Record const &r1, Record const &r2 )
+{
+   return r1.time < r2.time;
+}
+
+bool actionBefore( Action const &a1, Action const &a2 )
+{
+   return a1.time < a2.time;
+}
+
+/*! \brief Sorts and merges overlapping intervals */
+void normalize( std::vector< Interval > &intervals )
+{
+   std::sort( intervals.begin(), intervals.end() );
+   size_t last = 0;
+   for ( size_t i = 1; i < intervals.size(); i++ ) {
+      if ( intervals[i].start <= intervals[last].end ) {
+         intervals[last].end = std::max( intervals[last].end, intervals[i].end );
+      } else {
+         intervals[++last] = intervals[i];
+      }
+   }
+   if ( !intervals.empty() ) intervals.resize( last + 1 );
+}
+
+/*! \brief Removes the excluded intervals from the busy ones. Both must be normalized */
+std::vector< Interval > subtract( std::vector< Interval > const &busy, std::vector< Interval > const &excluded )
+{
+   std::vector< Interval > result;
+   size_t e = 0;
+   for ( size_t b = 0; b < busy.size(); b++ ) {
+      int64_t start = busy[b].start;
+      while ( e < excluded.size() && excluded[e].end <= start ) e++;
+      for ( size_t x = e; x < excluded.size() && excluded[x].start < busy[b].end; x++ ) {
+         if ( excluded[x].start > start ) {
+            Interval i = { start, excluded[x].start };
+            result.push_back( i );
+         }
+         start = std::max( start, excluded[x].end );
+      }
+      if ( start < busy[b].end ) {
+         Interval i = { start, busy[b].end };
+         result.push_back( i );
+      }
+   }
+   return result;
+}
+
+/*! \brief Work done in the segments before the given time */
+int64_t workBefore( std::vector< Interval > const &segments, std::vector< int64_t > const &prefix, int64_t time )
+{
+   Interval key = { time, time };
+   size_t i = std::upper_bound( segments.begin(), segments.end(), key ) - segments.begin();
+   if ( i == 0 ) return 0;
+   int64_t work = prefix[i - 1];
+   Interval const &s = segments[i - 1];
+   return work + std::max( (int64_t) 0, std::min( time, s.end ) - s.start );
+}
+
+/*! \brief Places the creations and taskwaits of a node in its work timeline */
+void buildTimeline( Trace &trace, Node &node, int64_t end )
+{
+   std::stable_sort( node.actions.begin(), node.actions.end(), actionBefore );
+
+   std::vector< Interval > busy;
+   if ( node.kind == ROOT_NODE ) {
+      Interval i = { trace.begin, end };
+      busy.push_back( i );
+   } else {
+      busy = node.bursts;
+   }
+   normalize( busy );
+
+   // A taskwait blocks the task until every child created before it has ended
+   std::vector< Interval > blocked;
+   int64_t childrenEnd = 0;
+   for ( size_t a = 0; a < node.actions.size(); a++ ) {
+      Action const &action = node.actions[a];
+      if ( action.kind == CREATE_ACTION ) {
+         childrenEnd = std::max( childrenEnd, trace.nodes[action.child].subtreeEnd );
+      } else if ( childrenEnd > action.time ) {
+         Interval i = { action.time, childrenEnd };
+         blocked.push_back( i );
+      }
+   }
+   normalize( blocked );
+
+   std::vector< Interval > segments = subtract( busy, blocked );
+   std::vector< int64_t > prefix( segments.size(), 0 );
+   for ( size_t s = 1; s < segments.size(); s++ ) {
+      prefix[s] = prefix[s - 1] + segments[s - 1].end - segments[s - 1].start;
+   }
+
+   int64_t previous = 0;
+   for ( size_t a = 0; a < node.actions.size(); a++ ) {
+      Action &action = node.actions[a];
+      action.offset = std::max( previous, workBefore( segments, prefix, action.time ) );
+      previous = action.offset;
+   }
+   node.work = std::max( previous, workBefore( segments, prefix, end ) );
+}
+
+bool readLog( const char *fileName, Trace &trace )
+{
+   FILE *f = fopen( fileName, "rb" );
+   if ( f == NULL ) {
+      std::cerr << "Cannot open " << fileName << std::endl;
+      return false;
+   }
+
+   char magic[sizeof( MAGIC )];
+   if ( fread( magic, sizeof( magic ), 1, f ) != 1 || memcmp( magic, MAGIC, sizeof( MAGIC ) ) != 0 ) {
+      std::cerr << fileName << " is not a TDG stream log" << std::endl;
+      fclose( f );
+      return false;
+   }
+
+   std::vector< Record > records;
+   Record r;
+   while ( fread( &r, sizeof( r ), 1, f ) == 1 ) {
+      if ( r.type == FUNCTION ) {
+         // Task type names are not needed
+         size_t padded = ( (size_t) r.b + 7 ) & ~( (size_t) 7 );
+         if ( padded > 0 && fseek( f, (long) padded, SEEK_CUR ) != 0 ) break;
+      } else if ( r.type >= TASK && r.type <= DATA ) {
+         records.push_back( r );
+      } else {
+         std::cerr << "Unknown record type " << r.type << ", stopping" << std::endl;
+         break;
+      }
+   }
+   fclose( f );
+   if ( records.empty() ) {
+      std::cerr << fileName << " has no tasks" << std::endl;
+      return false;
+   }
+   std::stable_sort( records.begin(), records.end(), recordBefore );
+   trace.begin = records[0].time;
+
+   for ( size_t i = 0; i < records.size(); i++ ) {
+      Record const &rec = records[i];
+      switch ( rec.type ) {
+         case TASK: {
+            size_t parent = trace.findNode( rec.b ) >= 0 ? trace.findNode( rec.b ) : trace.getNode( rec.b, ROOT_NODE );
+            size_t task = trace.getNode( rec.a, TASK_NODE );
+            Node &node = trace.nodes[task];
+            node.parent = parent;
+            node.depth = trace.nodes[parent].depth + 1;
+            node.created = rec.time;
+            Action action = { CREATE_ACTION, rec.time, 0, task };
+            trace.nodes[parent].actions.push_back( action );
+            break;
+         }
+         case DEPENDENCE: {
+            // Dependences of taskwaits are covered by the taskwaits themselves
+            if ( rec.a < 0 || rec.b < 0 ) break;
+            size_t sender = trace.getNode( rec.a, JOIN_NODE );
+            size_t receiver = trace.getNode( rec.b, JOIN_NODE );
+            if ( sender == receiver ) break;
+            std::vector< size_t > &preds = trace.nodes[receiver].preds;
+            if ( std::find( preds.begin(), preds.end(), sender ) != preds.end() ) break;
+            preds.push_back( sender );
+            trace.nodes[sender].succs.push_back( receiver );
+            break;
+         }
+         case TASKWAIT: {
+            size_t parent = trace.findNode( rec.b ) >= 0 ? trace.findNode( rec.b ) : trace.getNode( rec.b, ROOT_NODE );
+            Action action = { TASKWAIT_ACTION, rec.time, 0, 0 };
+            trace.nodes[parent].actions.push_back( action );
+            break;
+         }
+         case EXECUTION: {
+            long task = trace.findNode( rec.a );
+            if ( task < 0 || rec.c < rec.b || trace.nodes[task].kind != TASK_NODE ) break;
+            Interval burst = { rec.b, rec.c };
+            trace.nodes[task].bursts.push_back( burst );
+            break;
+         }
+         case DATA: {
+            long task = trace.findNode( rec.a );
+            if ( task < 0 ) break;
+            trace.nodes[task].depBytes = rec.b;
+            trace.nodes[task].copyBytes = rec.c;
+            break;
+         }
+         default:
+            break;
+      }
+   }
+
+   // Children are always added after their parents
+   int64_t end = trace.begin;
+   for ( size_t i = trace.nodes.size(); i-- > 0; ) {
+      Node &node = trace.nodes[i];
+      for ( size_t b = 0; b < node.bursts.size(); b++ ) node.subtreeEnd = std::max( node.subtreeEnd, node.bursts[b].end );
+      for ( size_t a = 0; a < node.actions.size(); a++ ) node.subtreeEnd = std::max( node.subtreeEnd, node.actions[a].time );
+      if ( node.parent >= 0 ) {
+         Node &parent = trace.nodes[node.parent];
+         parent.subtreeEnd = std::max( parent.subtreeEnd, node.subtreeEnd );
+      }
+      end = std::max( end, node.subtreeEnd );
+   }
+
+   for ( size_t i = 0; i < trace.nodes.size(); i++ ) {
+      Node &node = trace.nodes[i];
+      if ( node.kind == JOIN_NODE ) continue;
+      // The implicit WDs end with a taskwait
+      if ( node.kind == ROOT_NODE ) {
+         Action action = { TASKWAIT_ACTION, trace.begin, 0, 0 };
+         for ( size_t a = 0; a < node.actions.size(); a++ ) action.time = std::max( action.time, node.actions[a].time );
+         node.actions.push_back( action );
+         buildTimeline( trace, node, action.time );
+      } else {
+         buildTimeline( trace, node, end );
+         trace.taskWork += node.work;
+         trace.tasks++;
+      }
+   }
+   return true;
+}
+
+/*! \brief Body of the synthetic WDs, they never run */
+void replayOutline( void *args ) {}
+
+/*! \brief Discrete event simulation of a trace with the policy of the current team */
+class Simulator
+{
+   private:
+      struct TaskState {
+         WD       *wd;
+         int       pendingPreds;
+         int       pendingChildren;
+         size_t    nextAction;
+         int64_t   progress;      /**< Work done, negative while paying a transfer */
+         int       thread;        /**< Last thread that ran it */
+         int       submitter;     /**< Thread that made it ready */
+         bool      created;
+         bool      started;
+         bool      bodyDone;
+         bool      complete;
+         bool      blocked;
+
+         TaskState() : wd( NULL ), pendingPreds( 0 ), pendingChildren( 0 ), nextAction( 0 ), progress( 0 ), thread( -1 ),
+            submitter( -1 ), created( false ), started( false ), bodyDone( false ), complete( false ), blocked( false ) {}
+      };
+
+      struct ThreadState {
+         BaseThread             *thread;
+         long                    current;
+         int64_t                 sliceStart;
+         int64_t                 sliceProgress;
+         WD                     *next;       /**< Obtained when a task ended, runs before asking the policy */
+         std::vector< size_t >   blocked;    /**< Tasks waiting in a taskwait, innermost last */
+         int64_t                 busy;
+
+         ThreadState() : thread( NULL ), current( -1 ), sliceStart( 0 ), sliceProgress( 0 ), next( NULL ), blocked(), busy( 0 ) {}
+      };
+
+      Trace                             &_trace;
+      SchedulePolicy                    &_policy;
+      double                             _bandwidth;       /**< Bytes per ns, 0 means free transfers */
+      std::vector< TaskState >           _tasks;
+      std::vector< ThreadState >         _threads;
+      std::map< WD *, size_t >           _wds;
+      std::vector< std::vector< char > > _schedData;
+      int64_t                            _now;
+      size_t                             _pending;         /**< Tasks and implicit WDs not complete yet */
+      double                             _policyTime;
+      uint64_t                           _policyCalls;
+
+      Simulator( const Simulator & );
+      const Simulator & operator= ( const Simulator & );
+
+   public:
+      int64_t                            makespan;
+      uint64_t                           steals;
+      uint64_t                           remoteTasks;
+      int64_t                            remoteBytes;
+      bool                               stalled;
+
+      Simulator( Trace &trace, SchedulePolicy &policy, double bandwidth ) : _trace( trace ), _policy( policy ),
+         _bandwidth( bandwidth ), _tasks( trace.nodes.size() ), _threads(), _wds(), _schedData(), _now( 0 ), _pending( 0 ),
+         _policyTime( 0.0 ), _policyCalls( 0 ), makespan( 0 ), steals( 0 ), remoteTasks( 0 ), remoteBytes( 0 ), stalled( false ) {}
+
+      size_t getNumThreads() const { return _threads.size(); }
+
+      int64_t getBusyTime() const
+      {
+         int64_t busy = 0;
+         for ( size_t t = 0; t < _threads.size(); t++ ) busy += _threads[t].busy;
+         return busy;
+      }
+
+      double getPolicyTimePerCall() const { return _policyCalls > 0 ? _policyTime / _policyCalls : 0.0; }
+
+      void run( ThreadTeam &team );
+
+   private:
+      WD * createWD( Node const &node )
+      {
+         WD *wd = NEW WD( NEW SMPDD( replayOutline ) );
+         size_t schedDataSize = _policy.getWDDataSize();
+         if ( schedDataSize > 0 ) {
+            _schedData.push_back( std::vector< char >( schedDataSize ) );
+            _policy.initWDData( &_schedData.back()[0] );
+            wd->setSchedulerData( reinterpret_cast<ScheduleWDData*>( &_schedData.back()[0] ), /* ownedByWD */ false );
+         }
+         wd->setDepth( node.depth );
+         return wd;
+      }
+
+      long findTask( WD *wd ) const
+      {
+         if ( wd == NULL ) return -1;
+         std::map< WD *, size_t >::const_iterator it = _wds.find( wd );
+         if ( it == _wds.end() ) {
+            std::cerr << "Warning: the policy returned a WD that is not part of the replay" << std::endl;
+            return -1;
+         }
+         return (long) it->second;
+      }
+
+      // Policy hooks, timed
+      double startCall() { _policyCalls++; return OS::getMonotonicTime(); }
+      void endCall( double start ) { _policyTime += OS::getMonotonicTime() - start; }
+
+      WD * callSubmit( int t, WD &wd )
+      {
+         double start = startCall();
+         WD *next = _policy.atSubmit( _threads[t].thread, wd );
+         endCall( start );
+         return next;
+      }
+
+      void callQueue( int t, WD &wd )
+      {
+         double start = startCall();
+         _policy.queue( _threads[t].thread, wd );
+         endCall( start );
+      }
+
+      WD * callIdle( int t, int numSteal )
+      {
+         double start = startCall();
+         WD *next = _policy.atIdle( _threads[t].thread, numSteal );
+         endCall( start );
+         return next;
+      }
+
+      WD * callBlock( int t, WD &current )
+      {
+         double start = startCall();
+         WD *next = _policy.atBlock( _threads[t].thread, &current );
+         endCall( start );
+         return next;
+      }
+
+      WD * callBeforeExit( int t, WD &current )
+      {
+         double start = startCall();
+         WD *next = _policy.atBeforeExit( _threads[t].thread, current, true );
+         endCall( start );
+         return next;
+      }
+
+      WD * callAfterExit( int t, WD &current )
+      {
+         double start = startCall();
+         WD *next = _policy.atAfterExit( _threads[t].thread, &current, 0 );
+         endCall( start );
+         return next;
+      }
+
+      int64_t nextPoint( size_t task ) const
+      {
+         Node const &node = _trace.nodes[task];
+         TaskState const &state = _tasks[task];
+         return state.nextAction < node.actions.size() ? node.actions[state.nextAction].offset : node.work;
+      }
+
+      void stopSlice( int t )
+      {
+         ThreadState &thread = _threads[t];
+         thread.busy += _now - thread.sliceStart;
+         thread.current = -1;
+      }
+
+      void start( int t, size_t task );
+      void resume( int t, size_t task );
+      void submit( int t, size_t task );
+      void keepNext( int t, WD *next );
+      void endBody( int t, size_t task );
+      void release( int t, size_t task );
+      void complete( size_t task );
+      void dispatch();
+};
+
+void Simulator::run( ThreadTeam &team )
+{
+   for ( unsigned int t = 0; t < team.size(); t++ ) {
+      ThreadState state;
+      state.thread = &team.getThread( t );
+      _threads.push_back( state );
+   }
+
+   // The scheduling data of the WDs must not move
+   _schedData.reserve( _trace.nodes.size() );
+   for ( size_t i = 0; i < _trace.nodes.size(); i++ ) {
+      Node const &node = _trace.nodes[i];
+      TaskState &state = _tasks[i];
+      state.pendingPreds = node.preds.size();
+      if ( node.kind == JOIN_NODE ) {
+         state.created = true;
+         continue;
+      }
+      state.wd = createWD( node );
+      _wds[state.wd] = i;
+      _pending++;
+   }
+
+   // The implicit WDs start in their own threads
+   for ( size_t r = 0; r < _trace.roots.size(); r++ ) {
+      size_t root = _trace.roots[r];
+      int t = r % _threads.size();
+      TaskState &state = _tasks[root];
+      state.created = true;
+      state.submitter = t;
+      state.wd->tieTo( *_threads[t].thread );
+      if ( _threads[t].current < 0 ) start( t, root );
+      else callQueue( t, *state.wd );
+   }
+
+   for ( ; ; ) {
+      dispatch();
+
+      // Next thread reaching a creation, a taskwait or the end of its task
+      int first = -1;
+      int64_t when = 0;
+      for ( size_t t = 0; t < _threads.size(); t++ ) {
+         ThreadState const &thread = _threads[t];
+         if ( thread.current < 0 ) continue;
+         int64_t stop = thread.sliceStart + nextPoint( thread.current ) - thread.sliceProgress;
+         if ( first < 0 || stop < when ) {
+            first = t;
+            when = stop;
+         }
+      }
+      if ( first < 0 ) break;
+
+      _now = std::max( _now, when );
+      size_t task = _threads[first].current;
+      Node const &node = _trace.nodes[task];
+      TaskState &state = _tasks[task];
+      state.progress = nextPoint( task );
+
+      if ( state.nextAction == node.actions.size() ) {
+         endBody( first, task );
+         continue;
+      }
+
+      Action const &action = node.actions[state.nextAction++];
+      if ( action.kind == CREATE_ACTION ) {
+         TaskState &child = _tasks[action.child];
+         child.created = true;
+         state.pendingChildren++;
+         if ( child.pendingPreds == 0 ) submit( first, action.child );
+      } else if ( state.pendingChildren > 0 ) {
+         // Taskwait: the thread looks for other work meanwhile
+         state.blocked = true;
+         stopSlice( first );
+         _threads[first].blocked.push_back( task );
+         keepNext( first, callBlock( first, *state.wd ) );
+      }
+   }
+
+   makespan = _now;
+   stalled = _pending > 0;
+}
+
+void Simulator::start( int t, size_t task )
+{
+   TaskState &state = _tasks[task];
+   Node const &node = _trace.nodes[task];
+
+   if ( !state.started ) {
+      state.started = true;
+      // Data produced by predecessors that ran in other threads
+      bool remote = false;
+      for ( size_t p = 0; p < node.preds.size() && !remote; p++ ) {
+         Node const &pred = _trace.nodes[node.preds[p]];
+         if ( pred.kind == JOIN_NODE ) {
+            for ( size_t pp = 0; pp < pred.preds.size() && !remote; pp++ ) {
+               remote = _tasks[pred.preds[pp]].thread >= 0 && _tasks[pred.preds[pp]].thread != t;
+            }
+         } else {
+            remote = _tasks[node.preds[p]].thread >= 0 && _tasks[node.preds[p]].thread != t;
+         }
+      }
+      if ( remote && node.depBytes > 0 ) {
+         remoteTasks++;
+         remoteBytes += node.depBytes;
+         if ( _bandwidth > 0.0 ) state.progress = - (int64_t) ( node.depBytes / _bandwidth );
+      }
+   }
+   if ( state.submitter >= 0 && state.submitter != t ) steals++;
+   state.submitter = t;
+
+   resume( t, task );
+}
+
+void Simulator::resume( int t, size_t task )
+{
+   ThreadState &thread = _threads[t];
+   TaskState &state = _tasks[task];
+   state.thread = t;
+   thread.current = task;
+   thread.sliceStart = _now;
+   thread.sliceProgress = state.progress;
+}
+
+void Simulator::submit( int t, size_t task )
+{
+   TaskState &state = _tasks[task];
+   state.submitter = t;
+
+   WD *next = callSubmit( t, *state.wd );
+   if ( next == NULL ) return;
+
+   ThreadState &thread = _threads[t];
+   if ( thread.current >= 0 ) {
+      // The policy switches to the new task, the creator goes back to the policy
+      size_t current = thread.current;
+      stopSlice( t );
+      _tasks[current].submitter = t;
+      callQueue( t, *_tasks[current].wd );
+   }
+   keepNext( t, next );
+}
+
+void Simulator::keepNext( int t, WD *next )
+{
+   if ( next == NULL ) return;
+   ThreadState &thread = _threads[t];
+   if ( thread.current < 0 && thread.next == NULL ) {
+      long task = findTask( next );
+      if ( task >= 0 ) start( t, task );
+   } else if ( thread.next == NULL ) {
+      thread.next = next;
+   } else {
+      callQueue( t, *next );
+   }
+}
+
+void Simulator::endBody( int t, size_t task )
+{
+   TaskState &state = _tasks[task];
+   state.bodyDone = true;
+   stopSlice( t );
+
+   release( t, task );
+   keepNext( t, callBeforeExit( t, *state.wd ) );
+   if ( state.pendingChildren == 0 ) complete( task );
+   if ( _threads[t].current < 0 && _threads[t].next == NULL ) keepNext( t, callAfterExit( t, *state.wd ) );
+}
+
+void Simulator::release( int t, size_t task )
+{
+   std::vector< size_t > const &succs = _trace.nodes[task].succs;
+   for ( size_t s = 0; s < succs.size(); s++ ) {
+      TaskState &succ = _tasks[succs[s]];
+      if ( --succ.pendingPreds > 0 ) continue;
+      // Concurrent and commutative nodes only join their predecessors
+      if ( _trace.nodes[succs[s]].kind == JOIN_NODE ) release( t, succs[s] );
+      else if ( succ.created ) submit( t, succs[s] );
+   }
+}
+
+void Simulator::complete( size_t task )
+{
+   TaskState &state = _tasks[task];
+   state.complete = true;
+   _pending--;
+
+   long parent = _trace.nodes[task].parent;
+   if ( parent < 0 ) return;
+   TaskState &pstate = _tasks[parent];
+   if ( --pstate.pendingChildren > 0 ) return;
+   if ( pstate.blocked ) pstate.blocked = false;
+   else if ( pstate.bodyDone && !pstate.complete ) complete( parent );
+}
+
+void Simulator::dispatch()
+{
+   for ( size_t t = 0; t < _threads.size(); t++ ) {
+      ThreadState &thread = _threads[t];
+      if ( thread.current >= 0 ) continue;
+
+      if ( thread.next != NULL ) {
+         long task = findTask( thread.next );
+         thread.next = NULL;
+         if ( task >= 0 ) {
+            start( t, task );
+            continue;
+         }
+      }
+
+      // Taskwaits that are over resume before taking new work
+      bool resumed = false;
+      for ( size_t b = thread.blocked.size(); b-- > 0 && !resumed; ) {
+         size_t task = thread.blocked[b];
+         if ( _tasks[task].blocked ) continue;
+         thread.blocked.erase( thread.blocked.begin() + b );
+         resume( t, task );
+         resumed = true;
+      }
+      if ( resumed ) continue;
+
+      WD *next = callIdle( t, 0 );
+      if ( next == NULL ) next = callIdle( t, 1 );
+      long task = findTask( next );
+      if ( task >= 0 ) start( t, task );
+   }
+}
+
+struct Result {
+   std::string  policy;
+   size_t       threads;
+   int64_t      makespan;
+   double       idle;
+   uint64_t     steals;
+   double       remoteMB;
+   double       policyUs;
+};
+
+void printHeader()
+{
+   std::cout << std::setw( 14 ) << std::left << "policy" << std::right
+             << std::setw( 8 ) << "threads"
+             << std::setw( 14 ) << "makespan(ms)"
+             << std::setw( 10 ) << "speedup"
+             << std::setw( 8 ) << "idle%"
+             << std::setw( 10 ) << "steals"
+             << std::setw( 12 ) << "remote(MB)"
+             << std::setw( 12 ) << "us/call" << std::endl;
+}
+
+int simulate( const char *input, std::string label, double bandwidth, bool header )
+{
+   Trace trace;
+   if ( !readLog( input, trace ) ) return EXIT_FAILURE;
+
+   ThreadTeam *team = myThread->getTeam();
+   SchedulePolicy &policy = team->getSchedulePolicy();
+   if ( label.empty() ) label = policy.getName();
+
+   // Keep the workers away from the policy during the replay
+   sys.stopScheduler();
+   sys.waitUntilThreadsPaused();
+
+   Simulator simulator( trace, policy, bandwidth );
+   simulator.run( *team );
+
+   sys.startScheduler();
+   sys.waitUntilThreadsUnpaused();
+
+   if ( simulator.stalled ) {
+      std::cerr << label << ": the replay stalled, some tasks were never returned by the policy" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   int64_t makespan = simulator.makespan;
+   int64_t capacity = makespan * (int64_t) simulator.getNumThreads();
+   if ( header ) printHeader();
+   std::cout << std::fixed << std::setprecision( 3 )
+             << std::setw( 14 ) << std::left << label.substr( 0, 13 ) << std::right
+             << std::setw( 8 ) << simulator.getNumThreads()
+             << std::setw( 14 ) << makespan / 1.0e6
+             << std::setw( 10 ) << std::setprecision( 2 ) << ( makespan > 0 ? (double) trace.taskWork / makespan : 0.0 )
+             << std::setw( 8 ) << std::setprecision( 1 ) << ( capacity > 0 ? 100.0 * ( capacity - simulator.getBusyTime() ) / capacity : 0.0 )
+             << std::setw( 10 ) << simulator.steals
+             << std::setw( 12 ) << std::setprecision( 3 ) << simulator.remoteBytes / 1.0e6
+             << std::setw( 12 ) << simulator.getPolicyTimePerCall() * 1.0e6 << std::endl;
+   return EXIT_SUCCESS;
+}
+
+/*! \brief Runs the simulator once per policy, each one in a new process */
+int compare( char *program, std::vector< std::string > const &policies, std::vector< std::string > const &args,
+             std::string const &threads )
+{
+   std::string baseArgs = getenv( "NX_ARGS" ) != NULL ? getenv( "NX_ARGS" ) : "";
+   int failures = 0;
+
+   printHeader();
+   for ( size_t p = 0; p < policies.size(); p++ ) {
+      std::string nxArgs = baseArgs + " --schedule=" + policies[p];
+      if ( !threads.empty() ) nxArgs += " --smp-workers=" + threads;
+
+      std::vector< char * > argv;
+      argv.push_back( program );
+      argv.push_back( (char *) "-r" );
+      argv.push_back( (char *) policies[p].c_str() );
+      for ( size_t a = 0; a < args.size(); a++ ) argv.push_back( (char *) args[a].c_str() );
+      argv.push_back( NULL );
+
+      std::cout.flush();
+      pid_t pid = fork();
+      if ( pid == 0 ) {
+         setenv( "NX_ARGS", nxArgs.c_str(), 1 );
+         execv( "/proc/self/exe", &argv[0] );
+         execvp( program, &argv[0] );
+         _exit( 127 );
+      }
+      int status = 0;
+      if ( pid < 0 || waitpid( pid, &status, 0 ) < 0 || !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) {
+         std::cout << std::setw( 14 ) << std::left << policies[p].substr( 0, 13 ) << std::right << "   failed" << std::endl;
+         failures++;
+      }
+   }
+   return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void usage( const char *program )
+{
+   std::cerr << "Usage: " << program << " [-p policy,...] [-t threads] [-b GB/s] <log.tdg>" << std::endl
+             << "   -p policies  Replay with each policy (--schedule values) in turn, default: the one in NX_ARGS" << std::endl
+             << "   -t threads   Number of virtual threads (--smp-workers), only with -p" << std::endl
+             << "   -b GB/s      Charge the data of the dependences of a task when its predecessors ran in" << std::endl
+             << "                other threads, at this bandwidth (default: no cost)" << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char **argv )
+{
+   const char *input = NULL;
+   std::vector< std::string > policies;
+   std::string threads, label;
+   std::vector< std::string > childArgs;
+   double bandwidth = 0.0;
+
+   for ( int i = 1; i < argc; i++ ) {
+      std::string arg( argv[i] );
+      if ( arg == "-p" && i + 1 < argc ) {
+         std::string list( argv[++i] );
+         for ( size_t pos = 0; pos <= list.size(); ) {
+            size_t comma = std::min( list.find( ',', pos ), list.size() );
+            if ( comma > pos ) policies.push_back( list.substr( pos, comma - pos ) );
+            pos = comma + 1;
+         }
+      } else if ( arg == "-t" && i + 1 < argc ) {
+         threads = argv[++i];
+      } else if ( arg == "-b" && i + 1 < argc ) {
+         bandwidth = atof( argv[++i] );
+         childArgs.push_back( arg );
+         childArgs.push_back( argv[i] );
+      } else if ( arg == "-r" && i + 1 < argc ) {
+         // Internal: one row of the table of -p
+         label = argv[++i];
+      } else if ( arg == "-h" || arg == "--help" ) {
+         usage( argv[0] );
+         return EXIT_SUCCESS;
+      } else if ( input == NULL && arg[0] != '-' ) {
+         input = argv[i];
+         childArgs.push_back( arg );
+      } else {
+         usage( argv[0] );
+         return EXIT_FAILURE;
+      }
+   }
+   if ( input == NULL ) {
+      usage( argv[0] );
+      return EXIT_FAILURE;
+   }
+
+   if ( !policies.empty() ) return compare( argv[0], policies, childArgs, threads );
+
+   // GB/s is also bytes per ns
+   return simulate( input, label, bandwidth, label.empty() );
+}
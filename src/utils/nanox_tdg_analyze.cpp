@@ -0,0 +1,413 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*! \file nanox_tdg_analyze.cpp
+ *  \brief Analyzes the task dependency graph logs written by the tdg
+ *  instrumentation plugin in streaming mode (--tdg-stream).
+ *
+ *  Reports the total work, the span (critical path) and the average
+ *  parallelism, the work and critical path time of each task type, and the
+ *  parallelism over time of both the measured execution and of an ideal
+ *  schedule with unlimited threads (every task starting as soon as its
+ *  predecessors finish).
+ *
+ *  Graph model:
+ *   - dependences and taskwaits are finish-to-start edges,
+ *   - a task can not start before its parent has started (start-to-start),
+ *   - a task waits for the taskwaits done by its parent before creating it,
+ *     and a taskwait waits for every sibling created before it.
+ */
+
+#include "tdg_stream_format.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+using namespace nanos::tdgstream;
+
+namespace {
+
+enum NodeKind { TASK_NODE, TASKWAIT_NODE, PSEUDO_NODE };
+
+struct Node {
+   int64_t  id;
+   int64_t  funct;
+   NodeKind kind;
+   int64_t  work;          /**< Sum of the execution bursts (ns) */
+   int64_t  start;         /**< Earliest start in the ideal schedule */
+   int64_t  finish;        /**< Finish in the ideal schedule */
+   long     pred;          /**< Predecessor that determined start, -1 if none */
+   bool     predIsStart;   /**< The predecessor constraint was start-to-start */
+
+   Node( int64_t nodeId, NodeKind nodeKind ) : id( nodeId ), funct( 0 ), kind( nodeKind ), work( 0 ),
+      start( 0 ), finish( 0 ), pred( -1 ), predIsStart( false ) {}
+};
+
+struct Edge {
+   size_t from;
+   size_t to;
+   bool   startToStart;
+};
+
+struct Segment {
+   int64_t start;
+   int64_t end;
+};
+
+struct TypeStats {
+   uint64_t tasks;
+   int64_t  work;
+   int64_t  critical;      /**< Time spent in tasks of this type along the critical path */
+   uint64_t criticalTasks;
+
+   TypeStats() : tasks( 0 ), work( 0 ), critical( 0 ), criticalTasks( 0 ) {}
+};
+
+struct Graph {
+   std::vector< Node >                    nodes;
+   std::vector< Edge >                    edges;
+   std::map< int64_t, size_t >            index;
+   std::map< int64_t, std::string >       names;
+   std::vector< Segment >                 segments;
+
+   size_t getNode( int64_t id, NodeKind kind )
+   {
+      std::map< int64_t, size_t >::iterator it = index.find( id );
+      if ( it != index.end() ) {
+         // Concurrent/commutative nodes may be found in an edge before their task record
+         if ( kind == TASK_NODE ) nodes[it->second].kind = TASK_NODE;
+         return it->second;
+      }
+      nodes.push_back( Node( id, kind ) );
+      index[id] = nodes.size() - 1;
+      return nodes.size() - 1;
+   }
+
+   long findNode( int64_t id ) const
+   {
+      std::map< int64_t, size_t >::const_iterator it = index.find( id );
+      return it == index.end() ? -1 : (long) it->second;
+   }
+
+   void addEdge( size_t from, size_t to, bool startToStart )
+   {
+      if ( from == to ) return;
+      Edge e = { from, to, startToStart };
+      edges.push_back( e );
+   }
+
+   std::string getTypeName( int64_t funct ) const
+   {
+      std::map< int64_t, std::string >::const_iterator it = names.find( funct );
+      if ( it != names.end() && !it->second.empty() ) return it->second;
+      std::ostringstream s;
+      s << "func@0x" << std::hex << funct;
+      return s.str();
+   }
+};
+
+bool recordBefore( Record const &r1, Record const &r2 )
+{
+   return r1.time < r2.time;
+}
+
+bool readLog( const char *fileName, Graph &graph )
+{
+   FILE *f = fopen( fileName, "rb" );
+   if ( f == NULL ) {
+      std::cerr << "Cannot open " << fileName << std::endl;
+      return false;
+   }
+
+   char magic[sizeof( MAGIC )];
+   if ( fread( magic, sizeof( magic ), 1, f ) != 1 || memcmp( magic, MAGIC, sizeof( MAGIC ) ) != 0 ) {
+      std::cerr << fileName << " is not a TDG stream log" << std::endl;
+      fclose( f );
+      return false;
+   }
+
+   // Threads flush their records independently, they are sorted by time before building the graph
+   std::vector< Record > records;
+   Record r;
+   while ( fread( &r, sizeof( r ), 1, f ) == 1 ) {
+      if ( r.type == FUNCTION ) {
+         size_t padded = ( (size_t) r.b + 7 ) & ~( (size_t) 7 );
+         std::vector< char > name( padded + 1, '\0' );
+         if ( padded > 0 && fread( &name[0], 1, padded, f ) != padded ) break;
+         graph.names[r.a] = std::string( &name[0], (size_t) r.b );
+      } else if ( r.type >= TASK && r.type <= EXECUTION ) {
+         records.push_back( r );
+      } else if ( r.type == DATA ) {
+         continue;
+      } else {
+         std::cerr << "Unknown record type " << r.type << ", stopping" << std::endl;
+         break;
+      }
+   }
+   fclose( f );
+   std::stable_sort( records.begin(), records.end(), recordBefore );
+
+   // Per parent: children created since its last taskwait, and that taskwait
+   std::map< int64_t, std::vector< size_t > > pendingChildren;
+   std::map< int64_t, size_t > lastTaskwait;
+
+   for ( size_t i = 0; i < records.size(); i++ ) {
+      Record const &rec = records[i];
+      switch ( rec.type ) {
+         case TASK: {
+            size_t task = graph.getNode( rec.a, TASK_NODE );
+            graph.nodes[task].funct = rec.c;
+            long parent = graph.findNode( rec.b );
+            if ( parent >= 0 ) graph.addEdge( parent, task, true );
+            std::map< int64_t, size_t >::const_iterator tw = lastTaskwait.find( rec.b );
+            if ( tw != lastTaskwait.end() ) graph.addEdge( tw->second, task, false );
+            pendingChildren[rec.b].push_back( task );
+            break;
+         }
+         case DEPENDENCE: {
+            size_t sender = graph.getNode( rec.a, PSEUDO_NODE );
+            size_t receiver = graph.getNode( rec.b, PSEUDO_NODE );
+            graph.addEdge( sender, receiver, false );
+            break;
+         }
+         case TASKWAIT: {
+            size_t taskwait = graph.getNode( rec.a, TASKWAIT_NODE );
+            std::vector< size_t > &children = pendingChildren[rec.b];
+            for ( size_t c = 0; c < children.size(); c++ ) graph.addEdge( children[c], taskwait, false );
+            children.clear();
+            std::map< int64_t, size_t >::const_iterator tw = lastTaskwait.find( rec.b );
+            if ( tw != lastTaskwait.end() ) graph.addEdge( tw->second, taskwait, false );
+            lastTaskwait[rec.b] = taskwait;
+            break;
+         }
+         default:
+            break;
+      }
+   }
+
+   // Execution bursts, once every task is known
+   for ( size_t i = 0; i < records.size(); i++ ) {
+      Record const &rec = records[i];
+      if ( rec.type != EXECUTION ) continue;
+      long task = graph.findNode( rec.a );
+      if ( task < 0 || rec.c < rec.b ) continue;    // implicit WDs are not part of the graph
+      graph.nodes[task].work += rec.c - rec.b;
+      Segment s = { rec.b, rec.c };
+      graph.segments.push_back( s );
+   }
+   return true;
+}
+
+/*! \brief Computes the ideal schedule (ASAP, unlimited threads). Returns the span */
+int64_t schedule( Graph &graph, size_t &unordered )
+{
+   size_t n = graph.nodes.size();
+   std::vector< size_t > firstEdge( n + 1, 0 );
+   std::vector< size_t > inDegree( n, 0 );
+   for ( size_t e = 0; e < graph.edges.size(); e++ ) {
+      firstEdge[graph.edges[e].from + 1]++;
+      inDegree[graph.edges[e].to]++;
+   }
+   for ( size_t i = 0; i < n; i++ ) firstEdge[i + 1] += firstEdge[i];
+   std::vector< size_t > successors( graph.edges.size() );
+   std::vector< size_t > fill( firstEdge.begin(), firstEdge.end() - 1 );
+   for ( size_t e = 0; e < graph.edges.size(); e++ ) successors[fill[graph.edges[e].from]++] = e;
+
+   std::vector< size_t > ready;
+   for ( size_t i = 0; i < n; i++ ) if ( inDegree[i] == 0 ) ready.push_back( i );
+
+   size_t processed = 0;
+   int64_t span = 0;
+   while ( !ready.empty() ) {
+      size_t current = ready.back();
+      ready.pop_back();
+      processed++;
+
+      Node &node = graph.nodes[current];
+      node.finish = node.start + node.work;
+      span = std::max( span, node.finish );
+
+      for ( size_t s = firstEdge[current]; s < firstEdge[current + 1]; s++ ) {
+         const Edge &edge = graph.edges[successors[s]];
+         Node &next = graph.nodes[edge.to];
+         int64_t earliest = edge.startToStart ? node.start : node.finish;
+         if ( earliest > next.start || next.pred < 0 ) {
+            if ( earliest >= next.start ) {
+               next.start = earliest;
+               next.pred = current;
+               next.predIsStart = edge.startToStart;
+            }
+         }
+         if ( --inDegree[edge.to] == 0 ) ready.push_back( edge.to );
+      }
+   }
+   unordered = n - processed;
+   return span;
+}
+
+void printProfile( const char *title, std::vector< Segment > const &segments, int64_t begin, int64_t end, unsigned int bins )
+{
+   std::cout << title << std::endl;
+   if ( end <= begin || bins == 0 ) {
+      std::cout << "   (empty)" << std::endl;
+      return;
+   }
+   double width = (double) ( end - begin ) / bins;
+   std::vector< double > busy( bins, 0.0 );
+   for ( size_t i = 0; i < segments.size(); i++ ) {
+      double s = segments[i].start - begin, e = segments[i].end - begin;
+      if ( e <= s ) continue;
+      unsigned int first = std::min( (unsigned int) ( s / width ), bins - 1 );
+      unsigned int last = std::min( (unsigned int) ( e / width ), bins - 1 );
+      for ( unsigned int b = first; b <= last; b++ ) {
+         double lo = std::max( s, b * width ), hi = std::min( e, ( b + 1 ) * width );
+         if ( hi > lo ) busy[b] += hi - lo;
+      }
+   }
+   for ( unsigned int b = 0; b < bins; b++ ) {
+      double parallelism = busy[b] / width;
+      std::cout << "   " << std::setw( 12 ) << std::fixed << std::setprecision( 3 ) << ( b * width ) / 1.0e6 << " ms "
+                << std::setw( 9 ) << std::setprecision( 2 ) << parallelism << " "
+                << std::string( std::min( 60, (int) ( parallelism * 4 + 0.5 ) ), '#' ) << std::endl;
+   }
+}
+
+void usage( const char *program )
+{
+   std::cerr << "Usage: " << program << " [-b bins] <log.tdg>" << std::endl
+             << "   -b bins   Number of intervals of the parallelism profiles (default 20)" << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char **argv )
+{
+   unsigned int bins = 20;
+   const char *input = NULL;
+
+   for ( int i = 1; i < argc; i++ ) {
+      std::string arg( argv[i] );
+      if ( arg == "-b" && i + 1 < argc ) {
+         bins = atoi( argv[++i] );
+      } else if ( arg == "-h" || arg == "--help" ) {
+         usage( argv[0] );
+         return EXIT_SUCCESS;
+      } else if ( input == NULL && arg[0] != '-' ) {
+         input = argv[i];
+      } else {
+         usage( argv[0] );
+         return EXIT_FAILURE;
+      }
+   }
+   if ( input == NULL ) {
+      usage( argv[0] );
+      return EXIT_FAILURE;
+   }
+
+   Graph graph;
+   if ( !readLog( input, graph ) ) return EXIT_FAILURE;
+
+   size_t unordered = 0;
+   int64_t span = schedule( graph, unordered );
+   if ( unordered > 0 ) {
+      std::cerr << "Warning: " << unordered << " nodes are part of a cycle and were ignored" << std::endl;
+   }
+
+   // Totals and per type statistics
+   int64_t work = 0;
+   uint64_t tasks = 0;
+   std::map< std::string, TypeStats > types;
+   std::vector< Segment > ideal;
+   long last = -1;
+   for ( size_t i = 0; i < graph.nodes.size(); i++ ) {
+      const Node &node = graph.nodes[i];
+      if ( last < 0 || node.finish > graph.nodes[last].finish ) last = i;
+      if ( node.kind != TASK_NODE ) continue;
+      TypeStats &type = types[graph.getTypeName( node.funct )];
+      type.tasks++;
+      type.work += node.work;
+      work += node.work;
+      tasks++;
+      Segment s = { node.start, node.finish };
+      ideal.push_back( s );
+   }
+
+   // Walk the critical path backwards
+   uint64_t criticalTasks = 0;
+   bool charge = true;
+   for ( long current = last; current >= 0; current = graph.nodes[current].pred ) {
+      const Node &node = graph.nodes[current];
+      if ( charge && node.kind == TASK_NODE ) {
+         TypeStats &type = types[graph.getTypeName( node.funct )];
+         type.critical += node.work;
+         type.criticalTasks++;
+         criticalTasks++;
+      }
+      // Through a start-to-start edge only the beginning of the parent is on the path
+      charge = !node.predIsStart;
+   }
+
+   int64_t measuredBegin = 0, measuredEnd = 0;
+   for ( size_t i = 0; i < graph.segments.size(); i++ ) {
+      if ( i == 0 || graph.segments[i].start < measuredBegin ) measuredBegin = graph.segments[i].start;
+      if ( i == 0 || graph.segments[i].end > measuredEnd ) measuredEnd = graph.segments[i].end;
+   }
+   int64_t makespan = measuredEnd - measuredBegin;
+
+   std::cout << std::fixed << std::setprecision( 3 );
+   std::cout << "Tasks:                 " << tasks << std::endl;
+   std::cout << "Work:                  " << work / 1.0e6 << " ms" << std::endl;
+   std::cout << "Span (critical path):  " << span / 1.0e6 << " ms, " << criticalTasks << " tasks" << std::endl;
+   std::cout << "Average parallelism:   " << ( span > 0 ? (double) work / span : 0.0 ) << std::endl;
+   std::cout << "Measured makespan:     " << makespan / 1.0e6 << " ms" << std::endl;
+   std::cout << "Measured parallelism:  " << ( makespan > 0 ? (double) work / makespan : 0.0 ) << std::endl;
+   std::cout << std::endl;
+
+   std::cout << std::setw( 40 ) << std::left << "Task type" << std::right
+             << std::setw( 10 ) << "tasks"
+             << std::setw( 14 ) << "work (ms)"
+             << std::setw( 14 ) << "avg (us)"
+             << std::setw( 14 ) << "span (ms)"
+             << std::setw( 10 ) << "span %" << std::endl;
+   for ( std::map< std::string, TypeStats >::const_iterator it = types.begin(); it != types.end(); it++ ) {
+      const TypeStats &type = it->second;
+      std::cout << std::setw( 40 ) << std::left << it->first.substr( 0, 39 ) << std::right
+                << std::setw( 10 ) << type.tasks
+                << std::setw( 14 ) << type.work / 1.0e6
+                << std::setw( 14 ) << ( type.tasks > 0 ? type.work / 1.0e3 / type.tasks : 0.0 )
+                << std::setw( 14 ) << type.critical / 1.0e6
+                << std::setw( 10 ) << std::setprecision( 1 ) << ( span > 0 ? 100.0 * type.critical / span : 0.0 )
+                << std::setprecision( 3 ) << std::endl;
+   }
+   std::cout << std::endl;
+
+   printProfile( "Available parallelism over time (ideal schedule, unlimited threads):", ideal, 0, span, bins );
+   std::cout << std::endl;
+   printProfile( "Measured parallelism over time:", graph.segments, measuredBegin, measuredEnd, bins );
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*! \file nanox_top.cpp
+ *  \brief Live monitor of Nanos++ applications running with --live-metrics.
+ *
+ *  Attaches (read only) to the shared memory segment published by the
+ *  runtime and shows, every interval, the scheduler state and the rates of
+ *  the per thread counters.
+ */
+
+#include "livemetrics_format.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace nanos::livemetrics;
+
+namespace {
+
+const char *SHM_DIR = "/dev/shm";
+const char *SEGMENT_PREFIX = "nanox-";
+
+double now()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+std::vector< std::string > listSegments()
+{
+   std::vector< std::string > segments;
+   DIR *dir = opendir( SHM_DIR );
+   if ( dir == NULL ) return segments;
+   struct dirent *entry;
+   while ( ( entry = readdir( dir ) ) != NULL ) {
+      if ( strncmp( entry->d_name, SEGMENT_PREFIX, strlen( SEGMENT_PREFIX ) ) == 0 ) {
+         segments.push_back( std::string( "/" ) + entry->d_name );
+      }
+   }
+   closedir( dir );
+   return segments;
+}
+
+const Segment * attach( std::string const &name )
+{
+   int fd = shm_open( name.c_str(), O_RDONLY, 0 );
+   if ( fd < 0 ) {
+      std::cerr << "Cannot open segment " << name << ": " << strerror( errno ) << std::endl;
+      return NULL;
+   }
+   struct stat st;
+   if ( fstat( fd, &st ) != 0 || (size_t) st.st_size < sizeof( Segment ) ) {
+      std::cerr << "Segment " << name << " is not a Nanos++ live metrics segment" << std::endl;
+      close( fd );
+      return NULL;
+   }
+   void *addr = mmap( NULL, sizeof( Segment ), PROT_READ, MAP_SHARED, fd, 0 );
+   close( fd );
+   if ( addr == MAP_FAILED ) {
+      std::cerr << "Cannot map segment " << name << ": " << strerror( errno ) << std::endl;
+      return NULL;
+   }
+   const Segment *segment = (const Segment *) addr;
+   if ( memcmp( segment->magic, MAGIC, sizeof( MAGIC ) ) != 0 || segment->version != FORMAT_VERSION
+        || segment->threadMetricsSize != sizeof( ThreadMetrics ) ) {
+      std::cerr << "Segment " << name << " has an unknown format" << std::endl;
+      munmap( addr, sizeof( Segment ) );
+      return NULL;
+   }
+   return segment;
+}
+
+const char * stateName( uint32_t state )
+{
+   switch ( state ) {
+      case THREAD_RUNNING: return "run";
+      case THREAD_IDLE: return "idle";
+      default: return "-";
+   }
+}
+
+std::string formatRate( double value )
+{
+   std::ostringstream s;
+   s << std::fixed;
+   if ( value >= 1.0e6 ) s << std::setprecision( 1 ) << value / 1.0e6 << "M";
+   else if ( value >= 1.0e4 ) s << std::setprecision( 1 ) << value / 1.0e3 << "k";
+   else s << std::setprecision( value < 10 ? 1 : 0 ) << value;
+   return s.str();
+}
+
+void show( const Segment &current, const Segment &previous, double elapsed, bool first )
+{
+   const GlobalMetrics &g = current.global;
+   unsigned int numThreads = 0;
+   for ( unsigned int t = 0; t < MAX_THREADS; t++ ) {
+      if ( current.threads[t].state != THREAD_UNUSED ) numThreads = t + 1;
+   }
+
+   ThreadMetrics total;
+   memset( &total, 0, sizeof( total ) );
+   ThreadMetrics delta;
+   memset( &delta, 0, sizeof( delta ) );
+
+   std::ostringstream threads;
+   threads << std::setw( 6 ) << "thread" << std::setw( 6 ) << "state" << std::setw( 10 ) << "wd"
+           << std::setw( 10 ) << "tasks/s" << std::setw( 10 ) << "create/s" << std::setw( 10 ) << "throt/s"
+           << std::setw( 10 ) << "idle/s" << std::setw( 10 ) << "in MB/s" << std::setw( 10 ) << "out MB/s"
+           << std::setw( 8 ) << "evict/s" << std::endl;
+   for ( unsigned int t = 0; t < numThreads; t++ ) {
+      const ThreadMetrics &c = current.threads[t];
+      const ThreadMetrics &p = previous.threads[t];
+      if ( c.state == THREAD_UNUSED ) continue;
+      double rate = first || elapsed <= 0.0 ? 0.0 : 1.0 / elapsed;
+      double tasks = ( c.tasksExecuted - p.tasksExecuted ) * rate;
+      double created = ( c.tasksCreated - p.tasksCreated ) * rate;
+      double throttled = ( c.tasksThrottled - p.tasksThrottled ) * rate;
+      double idle = ( c.idleLoops - p.idleLoops ) * rate;
+      double in = ( c.bytesIn - p.bytesIn ) * rate;
+      double out = ( c.bytesOut - p.bytesOut ) * rate;
+      double evictions = ( c.evictions - p.evictions ) * rate;
+
+      delta.tasksExecuted += c.tasksExecuted - p.tasksExecuted;
+      delta.tasksCreated += c.tasksCreated - p.tasksCreated;
+      delta.tasksThrottled += c.tasksThrottled - p.tasksThrottled;
+      delta.bytesIn += c.bytesIn - p.bytesIn;
+      delta.bytesOut += c.bytesOut - p.bytesOut;
+      delta.evictions += c.evictions - p.evictions;
+      total.tasksExecuted += c.tasksExecuted;
+      total.tasksCreated += c.tasksCreated;
+      total.tasksThrottled += c.tasksThrottled;
+      total.bytesIn += c.bytesIn;
+      total.bytesOut += c.bytesOut;
+      total.evictions += c.evictions;
+
+      threads << std::setw( 6 ) << t << std::setw( 6 ) << stateName( c.state ) << std::setw( 10 );
+      if ( c.state == THREAD_RUNNING ) threads << c.currentWD; else threads << "-";
+      threads << std::setw( 10 ) << formatRate( tasks ) << std::setw( 10 ) << formatRate( created )
+              << std::setw( 10 ) << formatRate( throttled ) << std::setw( 10 ) << formatRate( idle )
+              << std::setw( 10 ) << formatRate( in / 1.0e6 ) << std::setw( 10 ) << formatRate( out / 1.0e6 )
+              << std::setw( 8 ) << formatRate( evictions ) << std::endl;
+   }
+
+   double rate = first || elapsed <= 0.0 ? 0.0 : 1.0 / elapsed;
+   time_t uptime = time( NULL ) - current.startTime;
+   std::cout << current.program << " (pid " << current.pid << "), up " << uptime << "s, "
+             << numThreads << " threads" << std::endl;
+   std::cout << "Scheduler: " << g.readyTasks << " ready, " << g.totalTasks << " in flight, "
+             << g.idleThreads << " idle threads, " << g.createdTasks << " created"
+             << " (as of " << std::fixed << std::setprecision( 1 ) << g.updateTime / 1.0e9 << "s)" << std::endl;
+   std::cout << "Tasks:     " << formatRate( delta.tasksExecuted * rate ) << "/s executed, "
+             << formatRate( delta.tasksCreated * rate ) << "/s created, "
+             << formatRate( delta.tasksThrottled * rate ) << "/s throttled"
+             << "  [total " << total.tasksExecuted << " / " << total.tasksCreated << " / " << total.tasksThrottled << "]" << std::endl;
+   std::cout << "Data:      " << formatRate( delta.bytesIn * rate / 1.0e6 ) << " MB/s in, "
+             << formatRate( delta.bytesOut * rate / 1.0e6 ) << " MB/s out, "
+             << formatRate( delta.evictions * rate ) << " evictions/s"
+             << "  [total " << total.bytesIn / 1.0e6 << " MB / " << total.bytesOut / 1.0e6 << " MB / " << total.evictions << "]" << std::endl;
+   std::cout << std::endl << threads.str() << std::flush;
+}
+
+void usage( const char *program )
+{
+   std::cerr << "Usage: " << program << " [-d seconds] [-n iterations] [-l] [pid | segment]" << std::endl
+             << "   -d seconds     Refresh interval (default 1)" << std::endl
+             << "   -n iterations  Exit after this number of refreshes" << std::endl
+             << "   -l             List the available segments" << std::endl
+             << "   Without pid or segment, attaches to the only running application" << std::endl
+             << "   (the application must run with NX_ARGS=--live-metrics)" << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char **argv )
+{
+   double interval = 1.0;
+   long iterations = -1;
+   bool list = false;
+   std::string target;
+
+   for ( int i = 1; i < argc; i++ ) {
+      std::string arg( argv[i] );
+      if ( arg == "-d" && i + 1 < argc ) {
+         interval = atof( argv[++i] );
+      } else if ( arg == "-n" && i + 1 < argc ) {
+         iterations = atol( argv[++i] );
+      } else if ( arg == "-l" ) {
+         list = true;
+      } else if ( arg == "-h" || arg == "--help" ) {
+         usage( argv[0] );
+         return EXIT_SUCCESS;
+      } else if ( target.empty() && arg[0] != '-' ) {
+         target = arg;
+      } else {
+         usage( argv[0] );
+         return EXIT_FAILURE;
+      }
+   }
+   if ( interval <= 0.0 ) interval = 1.0;
+
+   std::vector< std::string > segments = listSegments();
+   if ( list ) {
+      for ( size_t i = 0; i < segments.size(); i++ ) std::cout << segments[i] << std::endl;
+      return EXIT_SUCCESS;
+   }
+
+   std::string name;
+   if ( target.empty() ) {
+      if ( segments.size() != 1 ) {
+         std::cerr << ( segments.empty() ? "No running application found" : "Several applications found, choose one (-l)" ) << std::endl;
+         return EXIT_FAILURE;
+      }
+      name = segments[0];
+   } else if ( target.find_first_not_of( "0123456789" ) == std::string::npos ) {
+      name = std::string( "/" ) + SEGMENT_PREFIX + target;
+   } else {
+      name = target[0] == '/' ? target : "/" + target;
+   }
+
+   const Segment *segment = attach( name );
+   if ( segment == NULL ) return EXIT_FAILURE;
+
+   // Snapshots: the runtime keeps writing the segment while we compute the rates
+   std::vector< char > currentBuffer( sizeof( Segment ) ), previousBuffer( sizeof( Segment ) );
+   Segment &current = *(Segment *) &currentBuffer[0];
+   Segment &previous = *(Segment *) &previousBuffer[0];
+
+   bool interactive = isatty( STDOUT_FILENO );
+   double previousTime = now();
+   memcpy( &previous, segment, sizeof( Segment ) );
+   bool first = true;
+
+   for ( long n = 0; iterations < 0 || n < iterations; n++ ) {
+      if ( !first ) usleep( (useconds_t) ( interval * 1.0e6 ) );
+
+      double currentTime = now();
+      memcpy( &current, segment, sizeof( Segment ) );
+
+      if ( interactive ) std::cout << "\033[H\033[2J";
+      else if ( n > 0 ) std::cout << std::endl;
+      show( current, previous, currentTime - previousTime, first );
+
+      if ( kill( current.pid, 0 ) != 0 && errno == ESRCH ) {
+         std::cout << "Application finished" << std::endl;
+         break;
+      }
+
+      memcpy( &previous, &current, sizeof( Segment ) );
+      previousTime = currentTime;
+      first = false;
+   }
+
+   munmap( (void *) segment, sizeof( Segment ) );
+   return EXIT_SUCCESS;
+}
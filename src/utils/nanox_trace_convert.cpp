@@ -0,0 +1,503 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*! \file nanox_trace_convert.cpp
+ *  \brief Converts the binary traces of the ring_trace instrumentation plugin
+ *  to Paraver (.prv/.pcf/.row) and to Chrome tracing JSON (also read by
+ *  Perfetto).
+ */
+
+#include "nanos-int.h"
+#include "ring_trace_format.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace nanos::ringtrace;
+
+namespace {
+
+const uint64_t PRV_STATE_TYPE    = 9000000;
+const uint64_t PRV_SUBSTATE_TYPE = 9000004;
+const uint64_t PRV_EVENT_BASE    = 9200000;
+
+const char *stateNames[] = { "NOT CREATED", "NOT RUNNING", "STARTUP", "SHUTDOWN", "ERROR", "IDLE",
+   "RUNTIME", "RUNNING", "SYNCHRONIZATION", "SCHEDULING", "CREATION",
+   "DATA TRANSFER ISSUE", "CACHE ALLOC/FREE", "YIELD", "ACQUIRING LOCK", "CONTEXT SWITCH",
+   "FILL COLOR", "WAKING UP", "STOPPED", "SYNCED RUNNING", "DEBUG" };
+
+struct Trace {
+   FileHeader                header;
+   std::vector< Record >     records;
+   std::map< uint32_t, std::string > keyNames;
+   std::map< uint32_t, std::string > keyDescriptions;
+   std::map< std::pair< uint32_t, int64_t >, std::string > valueDescriptions;
+
+   uint64_t toNs( uint64_t ticks ) const
+   {
+      if ( ticks <= header.startTicks ) return 0;
+      return (uint64_t) ( ( ticks - header.startTicks ) / header.ticksPerNs );
+   }
+
+   std::string getKeyName( uint32_t key ) const
+   {
+      std::map< uint32_t, std::string >::const_iterator it = keyNames.find( key );
+      if ( it != keyNames.end() ) return it->second;
+      std::ostringstream s;
+      s << "key-" << key;
+      return s.str();
+   }
+
+   std::string getKeyDescription( uint32_t key ) const
+   {
+      std::map< uint32_t, std::string >::const_iterator it = keyDescriptions.find( key );
+      if ( it != keyDescriptions.end() && !it->second.empty() ) return it->second;
+      return getKeyName( key );
+   }
+
+   std::string getValueName( uint32_t key, int64_t value ) const
+   {
+      std::map< std::pair< uint32_t, int64_t >, std::string >::const_iterator it = valueDescriptions.find( std::make_pair( key, value ) );
+      if ( it != valueDescriptions.end() && !it->second.empty() ) return it->second;
+      std::ostringstream s;
+      s << getKeyName( key ) << " " << value;
+      return s.str();
+   }
+};
+
+bool recordTimeLess( Record const &a, Record const &b )
+{
+   return a.time < b.time;
+}
+
+std::string stateName( int64_t state )
+{
+   if ( state >= 0 && state < (int64_t) ( sizeof( stateNames ) / sizeof( stateNames[0] ) ) ) return stateNames[ state ];
+   return "UNKNOWN";
+}
+
+bool readTrace( const char *fileName, Trace &trace )
+{
+   FILE *f = fopen( fileName, "rb" );
+   if ( f == NULL ) {
+      std::cerr << "Could not open " << fileName << std::endl;
+      return false;
+   }
+
+   FileHeader &h = trace.header;
+   if ( fread( &h, sizeof( h ), 1, f ) != 1 || memcmp( h.magic, MAGIC, sizeof( h.magic ) ) != 0 ) {
+      std::cerr << fileName << " is not a ring_trace file" << std::endl;
+      fclose( f );
+      return false;
+   }
+   if ( h.version != FORMAT_VERSION || h.recordSize != sizeof( Record ) ) {
+      std::cerr << fileName << ": unsupported trace version " << h.version << std::endl;
+      fclose( f );
+      return false;
+   }
+   if ( h.ticksPerNs <= 0.0 ) h.ticksPerNs = 1.0;
+
+   trace.records.resize( h.numRecords );
+   if ( h.numRecords > 0 ) {
+      if ( fseek( f, h.recordsOffset, SEEK_SET ) != 0 ||
+           fread( &trace.records[0], sizeof( Record ), h.numRecords, f ) != h.numRecords ) {
+         std::cerr << fileName << ": truncated trace" << std::endl;
+         fclose( f );
+         return false;
+      }
+   }
+
+   std::string dictionary( h.dictionarySize, '\0' );
+   if ( h.dictionarySize > 0 ) {
+      if ( fseek( f, h.dictionaryOffset, SEEK_SET ) != 0 ||
+           fread( &dictionary[0], 1, h.dictionarySize, f ) != h.dictionarySize ) {
+         std::cerr << fileName << ": truncated dictionary" << std::endl;
+         fclose( f );
+         return false;
+      }
+   }
+   fclose( f );
+
+   std::istringstream lines( dictionary );
+   std::string line;
+   while ( std::getline( lines, line ) ) {
+      std::vector< std::string > fields;
+      std::string::size_type start = 0, tab;
+      while ( fields.size() < 3 && ( tab = line.find( '\t', start ) ) != std::string::npos ) {
+         fields.push_back( line.substr( start, tab - start ) );
+         start = tab + 1;
+      }
+      fields.push_back( line.substr( start ) );
+      if ( fields.size() != 4 ) continue;
+      uint32_t key = strtoul( fields[1].c_str(), NULL, 10 );
+      if ( fields[0] == "K" ) {
+         trace.keyNames[ key ] = fields[2];
+         trace.keyDescriptions[ key ] = fields[3];
+      } else if ( fields[0] == "V" ) {
+         trace.valueDescriptions[ std::make_pair( key, (int64_t) strtoll( fields[2].c_str(), NULL, 10 ) ) ] = fields[3];
+      }
+   }
+
+   /* each thread is in order, but flushes interleave them */
+   std::stable_sort( trace.records.begin(), trace.records.end(), recordTimeLess );
+   return true;
+}
+
+/* Paraver */
+
+struct Communication {
+   uint64_t sendTime;
+   uint64_t recvTime;
+   unsigned int sender;
+   unsigned int receiver;
+   int64_t size;
+   unsigned int tag;
+
+   bool operator<( Communication const &c ) const { return sendTime < c.sendTime; }
+};
+
+void writePrvCommunication( std::ostream &o, Communication const &c )
+{
+   o << "3:" << c.sender + 1 << ":1:1:" << c.sender + 1 << ":" << c.sendTime << ":" << c.sendTime
+     << ":" << c.receiver + 1 << ":1:1:" << c.receiver + 1 << ":" << c.recvTime << ":" << c.recvTime
+     << ":" << c.size << ":" << c.tag << "\n";
+}
+
+bool writeParaver( Trace const &trace, std::string const &prefix )
+{
+   unsigned int numThreads = trace.header.numThreads > 0 ? trace.header.numThreads : 1;
+   uint64_t endTime = trace.records.empty() ? 0 : trace.toNs( trace.records.back().time );
+
+   /* communications are written at their send time, match them first */
+   std::vector< Communication > comms;
+   std::map< std::pair< unsigned int, uint64_t >, Record const * > sends;
+   for ( std::vector< Record >::const_iterator it = trace.records.begin(); it != trace.records.end(); it++ ) {
+      std::pair< unsigned int, uint64_t > id( it->domain, it->id );
+      if ( it->type == NANOS_PTP_START ) {
+         sends[ id ] = &*it;
+      } else if ( it->type == NANOS_PTP_END ) {
+         std::map< std::pair< unsigned int, uint64_t >, Record const * >::iterator send = sends.find( id );
+         if ( send == sends.end() ) continue;
+         Communication c;
+         c.sendTime = trace.toNs( send->second->time );
+         c.recvTime = trace.toNs( it->time );
+         c.sender = send->second->thread;
+         c.receiver = it->thread;
+         c.size = it->value;
+         c.tag = it->domain;
+         comms.push_back( c );
+         sends.erase( send );
+      }
+   }
+   std::stable_sort( comms.begin(), comms.end() );
+
+   std::string prvName = prefix + ".prv";
+   std::ofstream prv( prvName.c_str() );
+   if ( !prv ) {
+      std::cerr << "Could not create " << prvName << std::endl;
+      return false;
+   }
+
+   char date[64];
+   time_t now = time( NULL );
+   strftime( date, sizeof( date ), "%d/%m/%y at %H:%M", localtime( &now ) );
+   prv << "#Paraver (" << date << "):" << endTime << "_ns:1(" << numThreads << "):1:1(" << numThreads << ":1)\n";
+
+   std::vector< Communication >::const_iterator comm = comms.begin();
+   for ( std::vector< Record >::const_iterator it = trace.records.begin(); it != trace.records.end(); it++ ) {
+      uint64_t t = trace.toNs( it->time );
+      while ( comm != comms.end() && comm->sendTime <= t ) {
+         writePrvCommunication( prv, *comm );
+         comm++;
+      }
+
+      uint64_t type;
+      int64_t value;
+      switch ( it->type ) {
+         case NANOS_STATE_START:    type = PRV_STATE_TYPE;    value = it->value; break;
+         case NANOS_STATE_END:      type = PRV_STATE_TYPE;    value = 0;         break;
+         case NANOS_SUBSTATE_START: type = PRV_SUBSTATE_TYPE; value = it->value; break;
+         case NANOS_SUBSTATE_END:   type = PRV_SUBSTATE_TYPE; value = 0;         break;
+         case NANOS_BURST_START:
+         case NANOS_POINT:
+            if ( it->key == 0 ) continue;
+            type = PRV_EVENT_BASE + it->key;
+            value = it->value;
+            break;
+         case NANOS_BURST_END:
+            if ( it->key == 0 ) continue;
+            type = PRV_EVENT_BASE + it->key;
+            value = 0;
+            break;
+         default:
+            continue;
+      }
+      prv << "2:" << it->thread + 1 << ":1:1:" << it->thread + 1 << ":" << t << ":" << type << ":" << value << "\n";
+   }
+   for ( ; comm != comms.end(); comm++ ) {
+      writePrvCommunication( prv, *comm );
+   }
+
+   std::string pcfName = prefix + ".pcf";
+   std::ofstream pcf( pcfName.c_str() );
+   pcf << "DEFAULT_OPTIONS\n\nLEVEL               THREAD\nUNITS               NANOSEC\n"
+       << "LOOK_BACK           100\nSPEED               1\nFLAG_ICONS          ENABLED\n"
+       << "NUM_OF_STATE_COLORS 1000\nYMAX_SCALE          37\n\n\n"
+       << "DEFAULT_SEMANTIC\n\nTHREAD_FUNC          State As Is\n\n\n";
+   pcf << "EVENT_TYPE\n0    " << PRV_STATE_TYPE << "    Thread state\n"
+       << "0    " << PRV_SUBSTATE_TYPE << "    Thread sub-state\nVALUES\n";
+   for ( unsigned int s = 0; s < sizeof( stateNames ) / sizeof( stateNames[0] ); s++ ) {
+      pcf << s << "      " << stateNames[ s ] << "\n";
+   }
+   pcf << "\n\n";
+   for ( std::map< uint32_t, std::string >::const_iterator key = trace.keyNames.begin(); key != trace.keyNames.end(); key++ ) {
+      pcf << "EVENT_TYPE\n0    " << PRV_EVENT_BASE + key->first << "    " << trace.getKeyDescription( key->first ) << "\n";
+      bool header = false;
+      std::map< std::pair< uint32_t, int64_t >, std::string >::const_iterator value =
+         trace.valueDescriptions.lower_bound( std::make_pair( key->first, (int64_t) 0 ) );
+      for ( ; value != trace.valueDescriptions.end() && value->first.first == key->first; value++ ) {
+         if ( !header ) {
+            pcf << "VALUES\n0      End\n";
+            header = true;
+         }
+         pcf << value->first.second << "      " << value->second << "\n";
+      }
+      pcf << "\n\n";
+   }
+
+   std::string rowName = prefix + ".row";
+   std::ofstream row( rowName.c_str() );
+   row << "LEVEL CPU SIZE " << numThreads << "\n";
+   for ( unsigned int t = 0; t < numThreads; t++ ) row << "CPU " << t + 1 << "\n";
+   row << "\nLEVEL THREAD SIZE " << numThreads << "\n";
+   for ( unsigned int t = 0; t < numThreads; t++ ) row << "THREAD 1.1." << t + 1 << "\n";
+
+   std::cout << "Wrote " << prvName << ", " << pcfName << " and " << rowName << std::endl;
+   return true;
+}
+
+/* Chrome tracing / Perfetto JSON */
+
+std::string jsonString( std::string const &s )
+{
+   std::string r = "\"";
+   for ( std::string::const_iterator c = s.begin(); c != s.end(); c++ ) {
+      switch ( *c ) {
+         case '"':  r += "\\\""; break;
+         case '\\': r += "\\\\"; break;
+         case '\n': r += "\\n"; break;
+         case '\t': r += "\\t"; break;
+         default:
+            if ( (unsigned char) *c < 0x20 ) r += ' ';
+            else r += *c;
+      }
+   }
+   return r + "\"";
+}
+
+std::string jsonTime( uint64_t ns )
+{
+   char buffer[32];
+   snprintf( buffer, sizeof( buffer ), "%llu.%03llu", (unsigned long long) ( ns / 1000 ), (unsigned long long) ( ns % 1000 ) );
+   return buffer;
+}
+
+class JsonWriter {
+   private:
+      std::ostream &_o;
+      bool          _first;
+      unsigned int  _pid;
+
+   public:
+      JsonWriter( std::ostream &o, unsigned int pid ) : _o( o ), _first( true ), _pid( pid ) {}
+
+      std::ostream &begin( const char *ph, std::string const &name, std::string const &cat, unsigned int tid, uint64_t ns )
+      {
+         _o << ( _first ? "\n" : ",\n" );
+         _first = false;
+         _o << "{\"ph\":\"" << ph << "\",\"name\":" << jsonString( name ) << ",\"cat\":" << jsonString( cat )
+            << ",\"pid\":" << _pid << ",\"tid\":" << tid << ",\"ts\":" << jsonTime( ns );
+         return _o;
+      }
+
+      void complete( std::string const &name, std::string const &cat, unsigned int tid, uint64_t start, uint64_t end )
+      {
+         begin( "X", name, cat, tid, start ) << ",\"dur\":" << jsonTime( end - start ) << "}";
+      }
+
+      void threadName( unsigned int tid )
+      {
+         _o << ( _first ? "\n" : ",\n" );
+         _first = false;
+         _o << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << _pid << ",\"tid\":" << tid
+            << ",\"args\":{\"name\":\"Thread " << tid << "\"}}";
+      }
+};
+
+struct OpenBurst {
+   uint64_t start;
+   int64_t  value;
+   OpenBurst( uint64_t s, int64_t v ) : start( s ), value( v ) {}
+};
+
+bool writeJson( Trace const &trace, std::string const &prefix )
+{
+   std::string jsonName = prefix + ".json";
+   std::ofstream json( jsonName.c_str() );
+   if ( !json ) {
+      std::cerr << "Could not create " << jsonName << std::endl;
+      return false;
+   }
+
+   const uint32_t stateKey = 0xFFFFFFFF;
+   const uint32_t subStateKey = 0xFFFFFFFE;
+   typedef std::map< std::pair< unsigned int, uint32_t >, std::vector< OpenBurst > > OpenBursts;
+   OpenBursts open;
+
+   json << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << trace.header.droppedRecords << "},\"traceEvents\":[";
+   JsonWriter w( json, trace.header.node );
+   for ( unsigned int t = 0; t < trace.header.numThreads; t++ ) w.threadName( t );
+
+   for ( std::vector< Record >::const_iterator it = trace.records.begin(); it != trace.records.end(); it++ ) {
+      uint64_t t = trace.toNs( it->time );
+      switch ( it->type ) {
+         case NANOS_STATE_START:
+         case NANOS_SUBSTATE_START:
+            open[ std::make_pair( (unsigned int) it->thread, it->type == NANOS_STATE_START ? stateKey : subStateKey ) ].push_back( OpenBurst( t, it->value ) );
+            break;
+         case NANOS_BURST_START:
+            if ( it->key == 0 ) break;
+            open[ std::make_pair( (unsigned int) it->thread, it->key ) ].push_back( OpenBurst( t, it->value ) );
+            break;
+         case NANOS_STATE_END:
+         case NANOS_SUBSTATE_END:
+         case NANOS_BURST_END: {
+            uint32_t key = it->type == NANOS_STATE_END ? stateKey : ( it->type == NANOS_SUBSTATE_END ? subStateKey : it->key );
+            if ( key == 0 ) break;
+            std::vector< OpenBurst > &stack = open[ std::make_pair( (unsigned int) it->thread, key ) ];
+            if ( stack.empty() ) break;
+            OpenBurst b = stack.back();
+            stack.pop_back();
+            if ( key == stateKey || key == subStateKey ) {
+               w.complete( stateName( b.value ), key == stateKey ? "state" : "sub-state", it->thread, b.start, t );
+            } else {
+               w.complete( trace.getValueName( key, b.value ), trace.getKeyName( key ), it->thread, b.start, t );
+            }
+            break;
+         }
+         case NANOS_POINT:
+            if ( it->key == 0 ) break;
+            w.begin( "i", trace.getKeyDescription( it->key ), trace.getKeyName( it->key ), it->thread, t )
+               << ",\"s\":\"t\",\"args\":{\"value\":" << it->value << "}}";
+            break;
+         case NANOS_PTP_START:
+         case NANOS_PTP_END:
+            w.begin( it->type == NANOS_PTP_START ? "s" : "f", it->key != 0 ? trace.getKeyName( it->key ) : "ptp", "ptp", it->thread, t )
+               << ",\"id\":\"" << (unsigned int) it->domain << ":" << it->id << "\""
+               << ( it->type == NANOS_PTP_END ? ",\"bp\":\"e\"}" : "}" );
+            break;
+         default:
+            break;
+      }
+   }
+
+   /* close whatever is still open at the end of the trace */
+   uint64_t endTime = trace.records.empty() ? 0 : trace.toNs( trace.records.back().time );
+   for ( OpenBursts::const_iterator it = open.begin(); it != open.end(); it++ ) {
+      for ( std::vector< OpenBurst >::const_iterator b = it->second.begin(); b != it->second.end(); b++ ) {
+         uint32_t key = it->first.second;
+         if ( key == stateKey || key == subStateKey ) {
+            w.complete( stateName( b->value ), key == stateKey ? "state" : "sub-state", it->first.first, b->start, endTime );
+         } else {
+            w.complete( trace.getValueName( key, b->value ), trace.getKeyName( key ), it->first.first, b->start, endTime );
+         }
+      }
+   }
+   json << "\n]}\n";
+
+   std::cout << "Wrote " << jsonName << std::endl;
+   return true;
+}
+
+void usage( const char *program )
+{
+   std::cerr << "Usage: " << program << " [options] <trace.nxr>" << std::endl
+             << "  -p, --paraver     write <prefix>.prv, <prefix>.pcf and <prefix>.row" << std::endl
+             << "  -j, --json        write <prefix>.json (Chrome tracing / Perfetto)" << std::endl
+             << "  -o <prefix>       output prefix (default: input name without extension)" << std::endl
+             << "Without -p or -j both formats are written." << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char **argv )
+{
+   bool paraver = false, json = false;
+   std::string prefix;
+   const char *input = NULL;
+
+   for ( int i = 1; i < argc; i++ ) {
+      std::string arg( argv[i] );
+      if ( arg == "-p" || arg == "--paraver" ) {
+         paraver = true;
+      } else if ( arg == "-j" || arg == "--json" ) {
+         json = true;
+      } else if ( arg == "-o" && i + 1 < argc ) {
+         prefix = argv[++i];
+      } else if ( arg == "-h" || arg == "--help" ) {
+         usage( argv[0] );
+         return EXIT_SUCCESS;
+      } else if ( input == NULL && arg[0] != '-' ) {
+         input = argv[i];
+      } else {
+         usage( argv[0] );
+         return EXIT_FAILURE;
+      }
+   }
+   if ( input == NULL ) {
+      usage( argv[0] );
+      return EXIT_FAILURE;
+   }
+   if ( !paraver && !json ) paraver = json = true;
+   if ( prefix.empty() ) {
+      prefix = input;
+      std::string::size_type dot = prefix.rfind( '.' );
+      if ( dot != std::string::npos && prefix.find( '/', dot ) == std::string::npos ) prefix.erase( dot );
+   }
+
+   Trace trace;
+   if ( !readTrace( input, trace ) ) return EXIT_FAILURE;
+   if ( trace.header.droppedRecords > 0 ) {
+      std::cerr << "Warning: " << trace.header.droppedRecords << " events were dropped while tracing" << std::endl;
+   }
+
+   bool ok = true;
+   if ( paraver ) ok = writeParaver( trace, prefix ) && ok;
+   if ( json ) ok = writeJson( trace, prefix ) && ok;
+   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
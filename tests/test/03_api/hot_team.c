@@ -0,0 +1,166 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-omp-generator -m performance -c 4 -a \"--hot-teams|--no-hot-teams|--barrier=hierarchical\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nanos.h"
+#include "nanos_omp.h"
+#include "omp.h"
+
+#define MAX_THREADS 64
+#define REGIONS     100
+#define N           100
+
+/* Repeated parallel regions reuse the team of the previous one when they
+ * have the same number of threads. A reused team must behave as a new one:
+ * team ids, single guards, worksharings and barriers start over. */
+
+static nanos_ws_t ws;
+static int seen[MAX_THREADS];
+static int singles;
+static int iterations;
+static int errors;
+
+static void body ( int id, int nthreads )
+{
+   nanos_ws_desc_t *wsd;
+   nanos_ws_info_loop_t info = { 0, N - 1, 1, 1 };
+   nanos_ws_item_loop_t item;
+   bool single_guard;
+
+   __sync_fetch_and_add( &seen[id], 1 );
+
+   NANOS_SAFE( nanos_single_guard( &single_guard ) );
+   if ( single_guard ) __sync_fetch_and_add( &singles, 1 );
+
+   NANOS_SAFE( nanos_worksharing_create( &wsd, ws, (void **) &info, &single_guard ) );
+   NANOS_SAFE( nanos_worksharing_next_item( wsd, (void **) &item ) );
+   while ( item.execute ) {
+      __sync_fetch_and_add( &iterations, item.upper - item.lower + 1 );
+      NANOS_SAFE( nanos_worksharing_next_item( wsd, (void **) &item ) );
+   }
+}
+
+typedef struct { int id; int nthreads; } team_args_t;
+
+static void team_member ( void *args )
+{
+   team_args_t *a = (team_args_t *) args;
+   NANOS_SAFE( nanos_omp_set_implicit( nanos_current_wd() ) );
+   NANOS_SAFE( nanos_enter_team() );
+   body( a->id, a->nthreads );
+   NANOS_SAFE( nanos_team_barrier() );
+   NANOS_SAFE( nanos_leave_team() );
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t team_member_args = { team_member };
+static wd_def_t team_member_def = { { { .mandatory_creation = 1, .tied = 1 }, __alignof__(team_args_t), 0, 1, 0, "team" },
+                                    { { nanos_smp_factory, &team_member_args } } };
+
+/* Runs a parallel region and returns its team, threads gets the team members */
+static nanos_team_t parallel ( unsigned int nthreads, nanos_thread_t *threads )
+{
+   nanos_team_t team = NULL;
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   team_args_t master_args;
+   unsigned int i;
+
+   NANOS_SAFE( nanos_create_team( &team, NULL, &nthreads, NULL, true, threads, NULL ) );
+
+   for ( i = 1; i < nthreads; i++ ) {
+      nanos_wd_t wd = NULL;
+      team_args_t *args = NULL;
+      dyn_props.tie_to = threads[i];
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &team_member_def.base, &dyn_props, sizeof(team_args_t),
+                                           (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->id = i;
+      args->nthreads = nthreads;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+
+   dyn_props.tie_to = threads[0];
+   master_args.id = 0;
+   master_args.nthreads = nthreads;
+   NANOS_SAFE( nanos_create_wd_and_run_compact( &team_member_def.base, &dyn_props, sizeof(team_args_t), &master_args,
+                                                0, NULL, NULL, NULL, NULL ) );
+   NANOS_SAFE( nanos_end_team( team ) );
+
+   for ( i = 0; i < nthreads; i++ ) {
+      if ( seen[i] != 1 ) {
+         fprintf( stderr, "Team of %u threads: id %u seen %d times\n", nthreads, i, seen[i] );
+         errors++;
+      }
+      seen[i] = 0;
+   }
+   if ( singles != 1 || iterations != N ) {
+      fprintf( stderr, "Team of %u threads: %d singles and %d iterations\n", nthreads, singles, iterations );
+      errors++;
+   }
+   singles = 0;
+   iterations = 0;
+
+   return team;
+}
+
+int main ( int argc, char **argv )
+{
+   unsigned int nthreads = nanos_omp_get_num_threads_next_parallel( 0 ), i;
+   nanos_thread_t threads[MAX_THREADS], previous[MAX_THREADS];
+   const char *nx_args = getenv( "NX_ARGS" );
+   bool hot = nx_args == NULL || strstr( nx_args, "--no-hot-teams" ) == NULL;
+   nanos_team_t team, previous_team = NULL;
+   int r;
+
+   ws = nanos_find_worksharing( "dynamic_for" );
+   if ( nthreads > MAX_THREADS ) nthreads = MAX_THREADS;
+
+   for ( r = 0; r < REGIONS; r++ ) {
+      // Every few regions a smaller team replaces the kept one
+      unsigned int n = ( r % 10 == 9 && nthreads > 1 ) ? nthreads - 1 : nthreads;
+      bool alike = r > 0 && r % 10 != 9 && r % 10 != 0;
+
+      team = parallel( n, threads );
+
+      if ( hot && alike ) {
+         if ( team != previous_team ) {
+            fprintf( stderr, "Region %d: team has not been reused\n", r );
+            errors++;
+         }
+         for ( i = 0; i < n; i++ ) {
+            if ( threads[i] != previous[i] ) {
+               fprintf( stderr, "Region %d: thread %u of the team has changed\n", r, i );
+               errors++;
+            }
+         }
+      }
+      previous_team = team;
+      for ( i = 0; i < n; i++ ) previous[i] = threads[i];
+   }
+
+   return errors != 0;
+}
@@ -0,0 +1,170 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-omp-generator -m performance -c 4 -a \"--thread-budget=8|--thread-budget=2|--thread-budget=16 --no-hot-teams\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nanos.h"
+#include "nanos_omp.h"
+#include "omp.h"
+
+#define MAX_THREADS 64
+#define INNER       3
+#define ROUNDS      20
+
+/* Every member of a parallel region opens nested ones. Nested teams only get
+ * the threads left in the thread budget, down to their creator alone, so the
+ * threads running parallel regions at once never exceed it. */
+
+static int active;
+static int max_active;
+static int errors;
+
+typedef struct { int id; int level; int *seen; } team_args_t;
+
+static nanos_team_t parallel ( unsigned int *nthreads, int level, int *seen );
+
+static void start ( void )
+{
+   int now = __sync_add_and_fetch( &active, 1 );
+   int max = max_active;
+   while ( now > max && !__sync_bool_compare_and_swap( &max_active, max, now ) ) max = max_active;
+}
+
+static void body ( int id, int level )
+{
+   int r, seen[MAX_THREADS];
+
+   if ( level > 0 ) {
+      volatile int i;
+      for ( i = 0; i < 10000; i++ );
+      return;
+   }
+
+   for ( r = 0; r < ROUNDS; r++ ) {
+      unsigned int nthreads = INNER, i;
+
+      memset( seen, 0, sizeof( seen ) );
+      parallel( &nthreads, level + 1, seen );
+
+      if ( nthreads < 1 || nthreads > INNER ) {
+         fprintf( stderr, "Thread %d, round %d: nested team of %u threads\n", id, r, nthreads );
+         __sync_fetch_and_add( &errors, 1 );
+      }
+      for ( i = 0; i < nthreads; i++ ) {
+         if ( seen[i] != 1 ) {
+            fprintf( stderr, "Thread %d, round %d: nested id %u seen %d times\n", id, r, i, seen[i] );
+            __sync_fetch_and_add( &errors, 1 );
+         }
+      }
+   }
+}
+
+static void team_member ( void *args )
+{
+   team_args_t *a = (team_args_t *) args;
+   // Creators of nested teams are already counted by the enclosing one
+   bool counted = a->level == 0 || a->id != 0;
+
+   NANOS_SAFE( nanos_omp_set_implicit( nanos_current_wd() ) );
+   NANOS_SAFE( nanos_enter_team() );
+   if ( counted ) start();
+   __sync_fetch_and_add( &a->seen[a->id], 1 );
+   body( a->id, a->level );
+   if ( counted ) __sync_fetch_and_sub( &active, 1 );
+   NANOS_SAFE( nanos_team_barrier() );
+   NANOS_SAFE( nanos_leave_team() );
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t team_member_args = { team_member };
+static wd_def_t team_member_def = { { { .mandatory_creation = 1, .tied = 1 }, __alignof__(team_args_t), 0, 1, 0, "team" },
+                                    { { nanos_smp_factory, &team_member_args } } };
+
+/* Runs a parallel region, nthreads gets the size of its team */
+static nanos_team_t parallel ( unsigned int *nthreads, int level, int *seen )
+{
+   nanos_team_t team = NULL;
+   nanos_thread_t threads[MAX_THREADS];
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   team_args_t master_args;
+   unsigned int i;
+
+   NANOS_SAFE( nanos_create_team( &team, NULL, nthreads, NULL, true, threads, NULL ) );
+
+   for ( i = 1; i < *nthreads; i++ ) {
+      nanos_wd_t wd = NULL;
+      team_args_t *args = NULL;
+      dyn_props.tie_to = threads[i];
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &team_member_def.base, &dyn_props, sizeof(team_args_t),
+                                           (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->id = i;
+      args->level = level;
+      args->seen = seen;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+
+   dyn_props.tie_to = threads[0];
+   master_args.id = 0;
+   master_args.level = level;
+   master_args.seen = seen;
+   NANOS_SAFE( nanos_create_wd_and_run_compact( &team_member_def.base, &dyn_props, sizeof(team_args_t), &master_args,
+                                                0, NULL, NULL, NULL, NULL ) );
+   NANOS_SAFE( nanos_end_team( team ) );
+
+   return team;
+}
+
+int main ( int argc, char **argv )
+{
+   unsigned int nthreads = nanos_omp_get_num_threads_next_parallel( 0 ), i;
+   const char *nx_args = getenv( "NX_ARGS" );
+   const char *budget_arg = nx_args != NULL ? strstr( nx_args, "--thread-budget=" ) : NULL;
+   int seen[MAX_THREADS];
+
+   if ( nthreads > MAX_THREADS ) nthreads = MAX_THREADS;
+   memset( seen, 0, sizeof( seen ) );
+   parallel( &nthreads, 0, seen );
+
+   for ( i = 0; i < nthreads; i++ ) {
+      if ( seen[i] != 1 ) {
+         fprintf( stderr, "Outer id %u seen %d times\n", i, seen[i] );
+         errors++;
+      }
+   }
+
+   // The outer team always gets its threads, nested ones share what is left of the budget
+   if ( budget_arg != NULL ) {
+      int budget = atoi( budget_arg + strlen( "--thread-budget=" ) );
+      if ( budget < (int) nthreads ) budget = nthreads;
+      if ( max_active > budget ) {
+         fprintf( stderr, "%d threads ran parallel regions at once, the budget was %d\n", max_active, budget );
+         errors++;
+      }
+   }
+
+   return errors != 0;
+}
@@ -0,0 +1,128 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-generator -a \"--smp-workers=1|--smp-workers=4|--smp-workers=4 --enable-lazy-privatization=1\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <float.h>
+#include "nanos.h"
+
+#define N       100000
+#define TASKS   16
+#define ROUNDS  4
+
+/* Task reductions over large arrays: built-in reducers combine whole arrays
+ * and idle threads help to combine them, other reducers are still applied
+ * one element at a time. */
+
+static int sums[N];
+static double maxs[N];
+static long products[N];
+
+static void init_zero_int ( void *priv, void *orig ) { *(int *) priv = 0; }
+static void init_lowest_double ( void *priv, void *orig ) { *(double *) priv = -DBL_MAX; }
+static void init_one_long ( void *priv, void *orig ) { *(long *) priv = 1; }
+static void mul_long ( void *out, void *in ) { *(long *) out *= *(long *) in; }
+
+typedef struct { int task; } task_args_t;
+
+static void task_body ( void *args )
+{
+   int task = ( (task_args_t *) args )->task, i;
+   int *sum;
+   double *max;
+   long *product;
+
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( sums, (void **) &sum ) );
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( maxs, (void **) &max ) );
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( products, (void **) &product ) );
+
+   for ( i = 0; i < N; i++ ) {
+      sum[i] += task + i % 7;
+      if ( (double) ( task * i % 13 ) > max[i] ) max[i] = (double) ( task * i % 13 );
+      if ( ( i + task ) % TASKS == 0 ) product[i] *= 2;
+   }
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t task_body_args = { task_body };
+static wd_def_t task_def = { { { .mandatory_creation = 1, .tied = 0 }, __alignof__(task_args_t), 0, 1, 0, "reduce" },
+                             { { nanos_smp_factory, &task_body_args } } };
+
+static void spawn ( int task )
+{
+   static nanos_region_dimension_t sums_dim[1] = { { sizeof(sums), 0, sizeof(sums) } };
+   static nanos_region_dimension_t maxs_dim[1] = { { sizeof(maxs), 0, sizeof(maxs) } };
+   static nanos_region_dimension_t products_dim[1] = { { sizeof(products), 0, sizeof(products) } };
+   static const nanos_access_type_internal_t concurrent = { 1, 1, 0, 1, 0 };
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   nanos_data_access_t deps[3] = { { sums, concurrent, 1, sums_dim, 0 }, { maxs, concurrent, 1, maxs_dim, 0 },
+                                   { products, concurrent, 1, products_dim, 0 } };
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+
+   NANOS_SAFE( nanos_task_reduction_register( sums, sizeof(sums), sizeof(int), init_zero_int,
+                                              nanos_task_reduction_add_int ) );
+   NANOS_SAFE( nanos_task_reduction_register( maxs, sizeof(maxs), sizeof(double), init_lowest_double,
+                                              nanos_task_reduction_max_double ) );
+   NANOS_SAFE( nanos_task_reduction_register( products, sizeof(products), sizeof(long), init_one_long, mul_long ) );
+
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &task_def.base, &dyn_props, sizeof(task_args_t), (void **) &args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->task = task;
+   NANOS_SAFE( nanos_submit( wd, 3, deps, NULL ) );
+}
+
+int main ( int argc, char **argv )
+{
+   int r, t, i, errors = 0;
+
+   for ( i = 0; i < N; i++ ) {
+      sums[i] = i;
+      maxs[i] = 5.5;
+      products[i] = 3;
+   }
+
+   for ( r = 1; r <= ROUNDS; r++ ) {
+      for ( t = 0; t < TASKS; t++ ) spawn( t );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+      for ( i = 0; i < N; i++ ) {
+         int expected_sum = i + r * ( TASKS * ( TASKS - 1 ) / 2 + TASKS * ( i % 7 ) );
+         double expected_max = 5.5;
+         long expected_product = 3L << r;
+         for ( t = 0; t < TASKS; t++ ) {
+            if ( (double) ( t * i % 13 ) > expected_max ) expected_max = (double) ( t * i % 13 );
+         }
+         if ( sums[i] != expected_sum || maxs[i] != expected_max || products[i] != expected_product ) {
+            if ( errors++ < 10 ) {
+               fprintf( stderr, "Round %d, element %d: sum %d (expected %d), max %f (expected %f), product %ld (expected %ld)\n",
+                        r, i, sums[i], expected_sum, maxs[i], expected_max, products[i], expected_product );
+            }
+         }
+      }
+   }
+
+   return errors != 0;
+}
@@ -0,0 +1,131 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+exec_versions="task_stats"
+
+declare test_ENV_task_stats="NX_TASK_STATS=yes"
+
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <nanos.h>
+
+#define NUM_TASKS 16
+#define TASK_US   500
+
+// compiler: outlined function arguments
+typedef struct {
+   int *value;
+} main__task_1_data_t;
+
+// compiler: outlined function
+void main__task_1 ( void *args );
+void main__task_1 ( void *args )
+{
+   main__task_1_data_t *hargs = (main__task_1_data_t * ) args;
+   usleep ( TASK_US );
+   (*hargs->value)++;
+}
+
+// compiler: smp device for main__task_1 function
+nanos_smp_args_t main__task_1_device_args = { main__task_1 };
+
+/* ************** CONSTANT PARAMETERS IN WD CREATION ******************** */
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data1 = 
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( main__task_1_data_t), 0, 1, 0, "stats task"
+   },
+   {
+      { nanos_smp_factory, &main__task_1_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int main ( int argc, char **argv )
+{
+   int i, value = 0;
+
+   // Every task depends on the previous one
+   for ( i = 0; i < NUM_TASKS; i++ ) {
+      nanos_wd_t wd = NULL;
+      main__task_1_data_t *task_data = NULL;
+
+      NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data1.base, &dyn_props, sizeof( main__task_1_data_t ),
+                                    (void **) &task_data, nanos_current_wd(), NULL, NULL ));
+      task_data->value = &value;
+
+      nanos_region_dimension_t dim[1] = {{ sizeof(int), 0, sizeof(int) }};
+      nanos_data_access_t deps[1] = {{ (void *) &value, {1,1,0,0,0}, 1, dim, 0 }};
+      NANOS_SAFE( nanos_submit( wd, 1, deps, 0 ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   if ( value != NUM_TASKS ) return 1;
+
+   const char *types[8];
+   unsigned int num_types = 8;
+   NANOS_SAFE( nanos_get_task_types( &num_types, types ) );
+
+   bool found = false;
+   for ( i = 0; i < (int) num_types && i < 8; i++ ) {
+      if ( strcmp( types[i], "stats task" ) == 0 ) found = true;
+   }
+   if ( !found ) {
+      fprintf( stderr, "Task type not found\n" );
+      return 1;
+   }
+
+   nanos_task_type_stats_t stats;
+   NANOS_SAFE( nanos_get_task_type_stats( "stats task", &stats ) );
+
+   unsigned long long buckets = 0;
+   for ( i = 0; i < NANOS_TASK_STATS_BUCKETS; i++ ) buckets += stats.execution.histogram[i];
+
+   fprintf( stdout, "%llu tasks, execution min %llu ns, max %llu ns, dependence wait max %llu ns\n",
+            stats.count, stats.execution.min_ns, stats.execution.max_ns, stats.dependence_wait.max_ns );
+
+   if ( stats.count != NUM_TASKS || buckets != NUM_TASKS ) return 1;
+   if ( stats.execution.min_ns < TASK_US * 1000ULL || stats.execution.min_ns > stats.execution.max_ns ) return 1;
+   if ( stats.execution.total_ns < NUM_TASKS * TASK_US * 1000ULL ) return 1;
+
+   // The chain forces all tasks but the first one to wait for their predecessor
+   if ( stats.dependence_wait.max_ns < TASK_US * 1000ULL ) return 1;
+
+   nanos_task_type_stats_t unknown;
+   NANOS_SAFE( nanos_get_task_type_stats( "unknown task", &unknown ) );
+   if ( unknown.count != 0 ) return 1;
+
+   return 0; 
+}
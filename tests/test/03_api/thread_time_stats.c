@@ -0,0 +1,119 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+exec_versions="thread_times"
+
+declare test_ENV_thread_times="NX_THREAD_TIMES=yes"
+
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <nanos.h>
+
+#define NUM_TASKS 32
+#define TASK_US   500
+
+// compiler: outlined function arguments
+typedef struct {
+   int *value;
+} main__task_1_data_t;
+
+// compiler: outlined function
+void main__task_1 ( void *args );
+void main__task_1 ( void *args )
+{
+   main__task_1_data_t *hargs = (main__task_1_data_t * ) args;
+   usleep ( TASK_US );
+   __sync_fetch_and_add( hargs->value, 1 );
+}
+
+// compiler: smp device for main__task_1 function
+nanos_smp_args_t main__task_1_device_args = { main__task_1 };
+
+/* ************** CONSTANT PARAMETERS IN WD CREATION ******************** */
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data1 = 
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( main__task_1_data_t), 0, 1, 0, "thread times task"
+   },
+   {
+      { nanos_smp_factory, &main__task_1_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int main ( int argc, char **argv )
+{
+   int i, value = 0;
+
+   // Independent tasks, so every thread may find work
+   for ( i = 0; i < NUM_TASKS; i++ ) {
+      nanos_wd_t wd = NULL;
+      main__task_1_data_t *task_data = NULL;
+
+      NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data1.base, &dyn_props, sizeof( main__task_1_data_t ),
+                                    (void **) &task_data, nanos_current_wd(), NULL, NULL ));
+      task_data->value = &value;
+
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, 0 ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   if ( value != NUM_TASKS ) return 1;
+
+   nanos_thread_time_stats_t all;
+   NANOS_SAFE( nanos_get_thread_time_stats( -1, &all ) );
+
+   unsigned long long buckets = 0;
+   for ( i = 0; i < NANOS_FIND_WORK_BUCKETS; i++ ) buckets += all.find_work_histogram[i];
+
+   fprintf( stdout, "executing %llu ns, scheduling %llu ns, spinning %llu ns, blocked %llu ns, found work %llu times\n",
+            all.time_ns[NANOS_THREAD_EXECUTING], all.time_ns[NANOS_THREAD_SCHEDULING],
+            all.time_ns[NANOS_THREAD_SPINNING], all.time_ns[NANOS_THREAD_BLOCKED], all.find_work_count );
+
+   // Tasks run in some thread, either from the idle loop or from the taskwait
+   if ( all.time_ns[NANOS_THREAD_EXECUTING] < NUM_TASKS * TASK_US * 1000ULL ) return 1;
+   if ( buckets != all.find_work_count ) return 1;
+   if ( all.find_work_count > 0 && all.find_work_total_ns < all.find_work_max_ns ) return 1;
+
+   // The main thread is always worker 0 and it has been executing main
+   nanos_thread_time_stats_t main_thread;
+   NANOS_SAFE( nanos_get_thread_time_stats( 0, &main_thread ) );
+   if ( main_thread.time_ns[NANOS_THREAD_EXECUTING] == 0 ) return 1;
+
+   nanos_thread_time_stats_t none;
+   if ( nanos_get_thread_time_stats( 1 << 20, &none ) != NANOS_INVALID_PARAM ) return 1;
+
+   return 0; 
+}
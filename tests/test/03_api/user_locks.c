@@ -0,0 +1,201 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-omp-generator -m performance -c 4 -a \"--user-locks=default|--user-locks=ticket|--user-locks=mcs|--user-locks=task|--user-locks=task --sync-wait=block\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include "nanos.h"
+#include "nanos_omp.h"
+#include "omp.h"
+
+#define MAX_THREADS 64
+#define ITERATIONS  1000
+#define TASKS       64
+
+/* Every kind of user lock must keep the updates of the team members
+ * mutually exclusive, whatever the lock implementation selected, and so
+ * must they keep the ones of tasks, that may leave their threads while
+ * they wait with task-aware locks. Each counter is protected by a different
+ * lock. Locks initialised busy are held until their first release. */
+
+static nanos_lock_t *lock;
+static nanos_lock_t busy_lock = NANOS_INIT_LOCK_BUSY;
+static omp_lock_t omp_lock;
+static omp_nest_lock_t omp_nest_lock;
+static volatile long counters[3];
+static int errors;
+
+static void increment ( int c )
+{
+   long value = counters[c];
+   sched_yield();
+   counters[c] = value + 1;
+}
+
+static void body ( void )
+{
+   int i;
+
+   for ( i = 0; i < ITERATIONS; i++ ) {
+      NANOS_SAFE( nanos_set_lock( lock ) );
+      increment( 0 );
+      NANOS_SAFE( nanos_unset_lock( lock ) );
+
+      omp_set_lock( &omp_lock );
+      increment( 1 );
+      omp_unset_lock( &omp_lock );
+
+      omp_set_nest_lock( &omp_nest_lock );
+      omp_set_nest_lock( &omp_nest_lock );
+      increment( 2 );
+      omp_unset_nest_lock( &omp_nest_lock );
+      omp_unset_nest_lock( &omp_nest_lock );
+
+      while ( !omp_test_lock( &omp_lock ) );
+      increment( 1 );
+      omp_unset_lock( &omp_lock );
+   }
+}
+
+static void team_member ( void *args )
+{
+   NANOS_SAFE( nanos_omp_set_implicit( nanos_current_wd() ) );
+   NANOS_SAFE( nanos_enter_team() );
+   body();
+   NANOS_SAFE( nanos_team_barrier() );
+   NANOS_SAFE( nanos_leave_team() );
+}
+
+static void task_body ( void *args )
+{
+   int i;
+
+   for ( i = 0; i < ITERATIONS / TASKS; i++ ) {
+      NANOS_SAFE( nanos_set_lock( lock ) );
+      increment( 0 );
+      NANOS_SAFE( nanos_unset_lock( lock ) );
+
+      omp_set_lock( &omp_lock );
+      increment( 1 );
+      increment( 1 );
+      omp_unset_lock( &omp_lock );
+   }
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t team_member_args = { team_member };
+static wd_def_t team_member_def = { { { .mandatory_creation = 1, .tied = 1 }, __alignof__(int), 0, 1, 0, "team" },
+                                    { { nanos_smp_factory, &team_member_args } } };
+
+static nanos_smp_args_t task_body_args = { task_body };
+static wd_def_t task_def = { { { .mandatory_creation = 1, .tied = 0 }, __alignof__(int), 0, 1, 0, "task" },
+                             { { nanos_smp_factory, &task_body_args } } };
+
+static void check_busy_lock ( void )
+{
+   bool acquired;
+
+   NANOS_SAFE( nanos_try_lock( &busy_lock, &acquired ) );
+   if ( acquired ) {
+      fprintf( stderr, "Lock initialised busy could be acquired\n" );
+      errors++;
+      return;
+   }
+
+   NANOS_SAFE( nanos_unset_lock( &busy_lock ) );
+   NANOS_SAFE( nanos_try_lock( &busy_lock, &acquired ) );
+   if ( !acquired ) {
+      fprintf( stderr, "Lock initialised busy is not free after its release\n" );
+      errors++;
+      return;
+   }
+   NANOS_SAFE( nanos_unset_lock( &busy_lock ) );
+
+   NANOS_SAFE( nanos_set_lock( &busy_lock ) );
+   NANOS_SAFE( nanos_try_lock( &busy_lock, &acquired ) );
+   if ( acquired ) {
+      fprintf( stderr, "Lock initialised busy could be acquired twice\n" );
+      errors++;
+   }
+   NANOS_SAFE( nanos_unset_lock( &busy_lock ) );
+}
+
+int main ( int argc, char **argv )
+{
+   unsigned int nthreads = nanos_omp_get_num_threads_next_parallel( 0 ), i;
+   nanos_team_t team = NULL;
+   nanos_thread_t threads[MAX_THREADS];
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   int master_id = 0;
+
+   check_busy_lock();
+
+   NANOS_SAFE( nanos_init_lock( &lock ) );
+   omp_init_lock( &omp_lock );
+   omp_init_nest_lock( &omp_nest_lock );
+
+   if ( nthreads > MAX_THREADS ) nthreads = MAX_THREADS;
+   NANOS_SAFE( nanos_create_team( &team, NULL, &nthreads, NULL, true, threads, NULL ) );
+
+   for ( i = 1; i < nthreads; i++ ) {
+      nanos_wd_t wd = NULL;
+      int *id = NULL;
+      dyn_props.tie_to = threads[i];
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &team_member_def.base, &dyn_props, sizeof(int),
+                                           (void **) &id, nanos_current_wd(), NULL, NULL ) );
+      *id = i;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+
+   dyn_props.tie_to = threads[0];
+   NANOS_SAFE( nanos_create_wd_and_run_compact( &team_member_def.base, &dyn_props, sizeof(int), &master_id,
+                                                0, NULL, NULL, NULL, NULL ) );
+   NANOS_SAFE( nanos_end_team( team ) );
+
+   for ( i = 0; i < TASKS; i++ ) {
+      nanos_wd_t wd = NULL;
+      int *arg = NULL;
+      dyn_props.tie_to = NULL;
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &task_def.base, &dyn_props, sizeof(int), (void **) &arg,
+                                           nanos_current_wd(), NULL, NULL ) );
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   long task_iterations = (long) ( ITERATIONS / TASKS ) * TASKS;
+   if ( counters[0] != (long) ITERATIONS * nthreads + task_iterations ||
+        counters[1] != 2L * ITERATIONS * nthreads + 2 * task_iterations ||
+        counters[2] != (long) ITERATIONS * nthreads ) {
+      fprintf( stderr, "Counters are %ld, %ld and %ld for %u threads\n", counters[0], counters[1], counters[2], nthreads );
+      errors++;
+   }
+
+   omp_destroy_nest_lock( &omp_nest_lock );
+   omp_destroy_lock( &omp_lock );
+   NANOS_SAFE( nanos_destroy_lock( lock ) );
+
+   return errors != 0;
+}
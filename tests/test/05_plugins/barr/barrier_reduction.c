@@ -0,0 +1,171 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-omp-generator -m performance -c 4 -a \"--barrier=centralized|--barrier=hierarchical|--barrier=hierarchical --cpus-per-socket=2\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "nanos.h"
+#include "nanos_omp.h"
+#include "omp.h"
+
+#define MAX_THREADS 64
+#define ROUNDS      50
+
+/* Team reductions registered with nanos_register_reduction are computed by
+ * the team barrier: scalar ones through bop, that barriers may apply to the
+ * private copies in parallel, and vector ones through vop. */
+
+static long sum;
+static long max;
+static int errors;
+
+static void sum_bop ( void *out, void *in, int num_scalars )
+{
+   *(long *) out += *(long *) in;
+}
+
+static void max_vop ( int n, void *out, void *in )
+{
+   long *privates = (long *) in;
+   int i;
+   for ( i = 0; i < n; i++ ) {
+      if ( privates[i] > *(long *) out ) *(long *) out = privates[i];
+   }
+}
+
+static void cleanup ( void *privates )
+{
+   NANOS_SAFE( nanos_free( privates ) );
+}
+
+static void register_reduction ( void *original, int nthreads, void (*bop)( void *, void *, int ),
+                                 void (*vop)( int, void *, void * ) )
+{
+   nanos_reduction_t *red;
+   long *privates;
+   int i;
+
+   NANOS_SAFE( nanos_malloc( (void **) &red, sizeof( nanos_reduction_t ), __FILE__, __LINE__ ) );
+   NANOS_SAFE( nanos_malloc( (void **) &privates, nthreads * sizeof( long ), __FILE__, __LINE__ ) );
+   for ( i = 0; i < nthreads; i++ ) privates[i] = 0;
+
+   red->original = original;
+   red->privates = privates;
+   red->element_size = sizeof( long );
+   red->num_scalars = 1;
+   red->descriptor = privates;
+   red->bop = bop;
+   red->vop = vop;
+   red->cleanup = cleanup;
+   NANOS_SAFE( nanos_register_reduction( red ) );
+}
+
+static void body ( int id, int nthreads )
+{
+   int r;
+
+   for ( r = 0; r < ROUNDS; r++ ) {
+      long *my_sum, *my_max;
+      bool first;
+
+      // One thread registers the reductions for the whole team, as compiled code does
+      NANOS_SAFE( nanos_enter_sync_init( &first ) );
+      if ( first ) {
+         sum = 0;
+         max = 0;
+         register_reduction( &sum, nthreads, sum_bop, NULL );
+         register_reduction( &max, nthreads, NULL, max_vop );
+         NANOS_SAFE( nanos_release_sync_init() );
+      } else {
+         NANOS_SAFE( nanos_wait_sync_init() );
+      }
+
+      NANOS_SAFE( nanos_reduction_get_private_data( (void **) &my_sum, &sum ) );
+      NANOS_SAFE( nanos_reduction_get_private_data( (void **) &my_max, &max ) );
+      my_sum[id] = id + r + 1;
+      my_max[id] = id * r;
+
+      // Computes the reductions
+      NANOS_SAFE( nanos_team_barrier() );
+
+      long expected_sum = (long) nthreads * ( nthreads + 1 ) / 2 + (long) nthreads * r;
+      long expected_max = (long) ( nthreads - 1 ) * r;
+      if ( sum != expected_sum || max != expected_max ) {
+         fprintf( stderr, "Round %d, thread %d: sum %ld (expected %ld), max %ld (expected %ld)\n",
+                  r, id, sum, expected_sum, max, expected_max );
+         __sync_fetch_and_add( &errors, 1 );
+      }
+      NANOS_SAFE( nanos_team_barrier() );
+   }
+}
+
+typedef struct { int id; int nthreads; } team_args_t;
+
+static void team_member ( void *args )
+{
+   team_args_t *a = (team_args_t *) args;
+   NANOS_SAFE( nanos_omp_set_implicit( nanos_current_wd() ) );
+   NANOS_SAFE( nanos_enter_team() );
+   body( a->id, a->nthreads );
+   NANOS_SAFE( nanos_team_barrier() );
+   NANOS_SAFE( nanos_leave_team() );
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t team_member_args = { team_member };
+static wd_def_t team_member_def = { { { .mandatory_creation = 1, .tied = 1 }, __alignof__(team_args_t), 0, 1, 0, "team" },
+                                    { { nanos_smp_factory, &team_member_args } } };
+
+int main ( int argc, char **argv )
+{
+   unsigned int nthreads = nanos_omp_get_num_threads_next_parallel( 0 ), i;
+   nanos_team_t team = NULL;
+   nanos_thread_t threads[MAX_THREADS];
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   team_args_t master_args;
+
+   if ( nthreads > MAX_THREADS ) nthreads = MAX_THREADS;
+   NANOS_SAFE( nanos_create_team( &team, NULL, &nthreads, NULL, true, threads, NULL ) );
+
+   for ( i = 1; i < nthreads; i++ ) {
+      nanos_wd_t wd = NULL;
+      team_args_t *args = NULL;
+      dyn_props.tie_to = threads[i];
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &team_member_def.base, &dyn_props, sizeof(team_args_t),
+                                           (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->id = i;
+      args->nthreads = nthreads;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+
+   dyn_props.tie_to = threads[0];
+   master_args.id = 0;
+   master_args.nthreads = nthreads;
+   NANOS_SAFE( nanos_create_wd_and_run_compact( &team_member_def.base, &dyn_props, sizeof(team_args_t), &master_args,
+                                                0, NULL, NULL, NULL, NULL ) );
+   NANOS_SAFE( nanos_end_team( team ) );
+
+   return errors != 0;
+}
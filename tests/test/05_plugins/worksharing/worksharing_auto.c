@@ -0,0 +1,158 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-omp-generator -m performance -c 4 -a \"--summary\""
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "nanos.h"
+#include "nanos_omp.h"
+#include "omp.h"
+
+#define MAX_THREADS 64
+#define ROUNDS      20
+#define N           1000
+
+/* The auto worksharing changes the schedule of a loop site between its
+ * executions, every execution must still run each iteration exactly once. */
+
+static nanos_ws_t ws;
+static int hits[N];
+static int lasts;
+static int errors;
+
+static void spin ( int n )
+{
+   volatile int i;
+   for ( i = 0; i < n; i++ );
+}
+
+/* Runs the loop and marks the iterations executed, growing costs make static imbalanced */
+static void loop ( int lower, int upper, int step, int cost )
+{
+   nanos_ws_desc_t *wsd;
+   nanos_ws_info_loop_t info = { lower, upper, step, 0 };
+   nanos_ws_item_loop_t item;
+   bool single_guard;
+
+   NANOS_SAFE( nanos_worksharing_create( &wsd, ws, (void **) &info, &single_guard ) );
+   NANOS_SAFE( nanos_worksharing_next_item( wsd, (void **) &item ) );
+   while ( item.execute ) {
+      int i;
+      for ( i = item.lower; step > 0 ? i <= item.upper : i >= item.upper; i += step ) {
+         __sync_fetch_and_add( &hits[i], 1 );
+         spin( cost * i );
+      }
+      if ( item.last ) __sync_fetch_and_add( &lasts, 1 );
+      NANOS_SAFE( nanos_worksharing_next_item( wsd, (void **) &item ) );
+   }
+   NANOS_SAFE( nanos_team_barrier() );
+}
+
+static void check ( int id, int round, const char *name, int lower, int upper, int step )
+{
+   int i;
+
+   if ( id == 0 ) {
+      int expected_lasts = ( step > 0 ? lower <= upper : lower >= upper ) ? 1 : 0;
+      for ( i = 0; i < N; i++ ) {
+         int inside = step > 0 ? i >= lower && i <= upper && ( i - lower ) % step == 0
+                               : i <= lower && i >= upper && ( lower - i ) % -step == 0;
+         if ( hits[i] != inside ) {
+            fprintf( stderr, "Round %d, %s loop: iteration %d executed %d times\n", round, name, i, hits[i] );
+            errors++;
+         }
+         hits[i] = 0;
+      }
+      if ( lasts != expected_lasts ) {
+         fprintf( stderr, "Round %d, %s loop: %d last items\n", round, name, lasts );
+         errors++;
+      }
+      lasts = 0;
+   }
+   NANOS_SAFE( nanos_team_barrier() );
+}
+
+static void body ( int id )
+{
+   int r;
+
+   for ( r = 0; r < ROUNDS; r++ ) {
+      loop( 0, N - 1, 1, 10 );
+      check( id, r, "imbalanced", 0, N - 1, 1 );
+      loop( N - 1, 1, -3, 0 );
+      check( id, r, "backwards", N - 1, 1, -3 );
+      loop( 1, 0, 1, 0 );
+      check( id, r, "empty", 1, 0, 1 );
+   }
+}
+
+static void team_member ( void *args )
+{
+   NANOS_SAFE( nanos_omp_set_implicit( nanos_current_wd() ) );
+   NANOS_SAFE( nanos_enter_team() );
+   body( *(int *) args );
+   NANOS_SAFE( nanos_team_barrier() );
+   NANOS_SAFE( nanos_leave_team() );
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t team_member_args = { team_member };
+static wd_def_t team_member_def = { { { .mandatory_creation = 1, .tied = 1 }, __alignof__(int), 0, 1, 0, "team" },
+                                    { { nanos_smp_factory, &team_member_args } } };
+
+int main ( int argc, char **argv )
+{
+   unsigned int nthreads = nanos_omp_get_num_threads_next_parallel( 0 ), i;
+   nanos_team_t team = NULL;
+   nanos_thread_t threads[MAX_THREADS];
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   int master_id = 0;
+
+   ws = nanos_find_worksharing( "auto_for" );
+   if ( ws == NULL ) {
+      fprintf( stderr, "Could not find the auto_for worksharing\n" );
+      return 1;
+   }
+
+   if ( nthreads > MAX_THREADS ) nthreads = MAX_THREADS;
+   NANOS_SAFE( nanos_create_team( &team, NULL, &nthreads, NULL, true, threads, NULL ) );
+
+   for ( i = 1; i < nthreads; i++ ) {
+      nanos_wd_t wd = NULL;
+      int *id = NULL;
+      dyn_props.tie_to = threads[i];
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &team_member_def.base, &dyn_props, sizeof(int),
+                                           (void **) &id, nanos_current_wd(), NULL, NULL ) );
+      *id = i;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+
+   dyn_props.tie_to = threads[0];
+   NANOS_SAFE( nanos_create_wd_and_run_compact( &team_member_def.base, &dyn_props, sizeof(int), &master_id,
+                                                0, NULL, NULL, NULL, NULL ) );
+   NANOS_SAFE( nanos_end_team( team ) );
+
+   return errors != 0;
+}
@@ -0,0 +1,779 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-omp-generator
+test_generator_ENV=( "NX_TEST_MODE=performance" )
+</testinfo>
+*/
+
+/*
+ * Runtime primitives microbenchmarks.
+ *
+ * Every benchmark measures a batch of operations per sample and reports the
+ * cost of one operation (microseconds) as JSON, to stdout or to the file given
+ * with -o. The runtime configuration (threads, scheduler, dependences and
+ * barrier plugins...) is taken from NX_ARGS, see scripts/nanox-bench-run.sh
+ * to sweep configurations and scripts/nanox-bench-compare.py to compare
+ * results. Each benchmark also checks its result so it doubles as a test.
+ *
+ * usage: microbench [-s samples] [-n operations] [-t team operations] [-f filter] [-o file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nanos.h"
+#include "nanos_omp.h"
+#include "omp.h"
+
+#define MAX_SAMPLES 1000
+#define MAX_THREADS 256
+
+static int num_samples = 5;
+static int num_ops = 500;
+static int num_team_ops = 100; /* Barriers, worksharings and contended locks */
+static const char *filter = NULL;
+static FILE *out = NULL;
+static int num_results = 0;
+static int num_errors = 0;
+
+/* Timing and statistics ***********************************************************************/
+
+static double get_usecs ( void )
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return ts.tv_sec * 1.0e6 + ts.tv_nsec * 1.0e-3;
+}
+
+static int compare_doubles ( const void *a, const void *b )
+{
+   double x = *(const double *) a, y = *(const double *) b;
+   return x < y ? -1 : ( x > y ? 1 : 0 );
+}
+
+static double percentile ( double *sorted, int n, double p )
+{
+   double pos = p * ( n - 1 );
+   int i = (int) pos;
+   if ( i + 1 >= n ) return sorted[n-1];
+   return sorted[i] + ( pos - i ) * ( sorted[i+1] - sorted[i] );
+}
+
+/* Reports one benchmark, values holds the cost of one operation for each sample */
+static void report ( const char *name, const char *variant, double *values, int n, int ops )
+{
+   double mean = 0.0;
+   int i;
+
+   qsort( values, n, sizeof(double), compare_doubles );
+   for ( i = 0; i < n; i++ ) mean += values[i];
+   mean /= n;
+
+   fprintf( out, "%s    { \"name\": \"%s%s%s\", \"unit\": \"us\", \"samples\": %d, \"ops\": %d, "
+                 "\"min\": %.4f, \"p25\": %.4f, \"median\": %.4f, \"p75\": %.4f, \"max\": %.4f, \"mean\": %.4f }",
+            num_results > 0 ? ",\n" : "", name, variant ? "/" : "", variant ? variant : "", n, ops,
+            values[0], percentile( values, n, 0.25 ), percentile( values, n, 0.5 ),
+            percentile( values, n, 0.75 ), values[n-1], mean );
+   num_results++;
+}
+
+static void check ( const char *name, long expected, long value )
+{
+   if ( expected != value ) {
+      fprintf( stderr, "microbench: %s computed %ld instead of %ld\n", name, value, expected );
+      num_errors++;
+   }
+}
+
+static int selected ( const char *name )
+{
+   return filter == NULL || strstr( name, filter ) != NULL;
+}
+
+/* Task helpers ********************************************************************************/
+
+typedef struct { int *target; } task_args_t;
+
+static void task_empty ( void *args ) { }
+static void task_increment ( void *args ) { ( *( (task_args_t *) args )->target )++; }
+static void task_reduce ( void *args )
+{
+   int *storage = NULL;
+   int *target = ( (task_args_t *) args )->target;
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( target, (void **) &storage ) );
+   if ( storage == NULL ) storage = target;
+   ( *storage )++;
+}
+
+#define REDUCTION_ARRAY_SIZE  ( 256 * 1024 )
+#define REDUCTION_ARRAY_TASKS 16
+
+static int reduction_array[REDUCTION_ARRAY_SIZE];
+
+static void task_reduce_array ( void *args )
+{
+   int *storage = NULL, i;
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( reduction_array, (void **) &storage ) );
+   for ( i = 0; i < REDUCTION_ARRAY_SIZE; i++ ) storage[i]++;
+}
+
+typedef struct { nanos_const_wd_definition_t base; nanos_device_t devices[1]; } wd_def_t;
+
+static nanos_smp_args_t task_empty_args = { task_empty };
+static nanos_smp_args_t task_increment_args = { task_increment };
+static nanos_smp_args_t task_reduce_args = { task_reduce };
+static nanos_smp_args_t task_reduce_array_args = { task_reduce_array };
+
+static wd_def_t task_empty_def = { { { .mandatory_creation = 1, .tied = 0 }, __alignof__(task_args_t), 0, 1, 0, "empty" },
+                                   { { nanos_smp_factory, &task_empty_args } } };
+static wd_def_t task_increment_def = { { { .mandatory_creation = 1, .tied = 0 }, __alignof__(task_args_t), 0, 1, 0, "increment" },
+                                       { { nanos_smp_factory, &task_increment_args } } };
+static wd_def_t task_reduce_def = { { { .mandatory_creation = 1, .tied = 0 }, __alignof__(task_args_t), 0, 1, 0, "reduce" },
+                                    { { nanos_smp_factory, &task_reduce_args } } };
+static wd_def_t task_reduce_array_def = { { { .mandatory_creation = 1, .tied = 0 }, __alignof__(task_args_t), 0, 1, 0, "reduce_array" },
+                                          { { nanos_smp_factory, &task_reduce_array_args } } };
+
+static const nanos_access_type_internal_t ACCESS_IN = { 1, 0, 0, 0, 0 };
+static const nanos_access_type_internal_t ACCESS_OUT = { 0, 1, 0, 0, 0 };
+static const nanos_access_type_internal_t ACCESS_INOUT = { 1, 1, 0, 0, 0 };
+static const nanos_access_type_internal_t ACCESS_CONCURRENT = { 1, 1, 0, 1, 0 };
+static const nanos_access_type_internal_t ACCESS_COMMUTATIVE = { 1, 1, 0, 0, 1 };
+
+static nanos_region_dimension_t int_dimension[1] = { { sizeof(int), 0, sizeof(int) } };
+
+static void spawn ( wd_def_t *def, int *target, const nanos_access_type_internal_t *access )
+{
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+   nanos_data_access_t deps[1];
+
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &def->base, &dyn_props, sizeof(task_args_t), (void **) &args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->target = target;
+   if ( access != NULL ) {
+      deps[0].address = target;
+      deps[0].flags = *access;
+      deps[0].dimension_count = 1;
+      deps[0].dimensions = int_dimension;
+      deps[0].offset = 0;
+   }
+   NANOS_SAFE( nanos_submit( wd, access != NULL ? 1 : 0, deps, NULL ) );
+}
+
+static void taskwait ( void )
+{
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+}
+
+/* Team helpers ********************************************************************************/
+
+typedef void (*team_body_t) ( int id, int nthreads, void *arg );
+typedef struct { team_body_t body; void *arg; int id; int nthreads; } team_args_t;
+
+static void team_member ( void *args )
+{
+   team_args_t *a = (team_args_t *) args;
+   NANOS_SAFE( nanos_omp_set_implicit( nanos_current_wd() ) );
+   NANOS_SAFE( nanos_enter_team() );
+   a->body( a->id, a->nthreads, a->arg );
+   NANOS_SAFE( nanos_team_barrier() );
+   NANOS_SAFE( nanos_leave_team() );
+}
+
+static nanos_smp_args_t team_member_args = { team_member };
+static wd_def_t team_member_def = { { { .mandatory_creation = 1, .tied = 1 }, __alignof__(team_args_t), 0, 1, 0, "team" },
+                                    { { nanos_smp_factory, &team_member_args } } };
+
+/* Runs body in every thread of a new team, like a parallel region */
+static void run_team ( team_body_t body, void *arg )
+{
+   unsigned int nthreads = nanos_omp_get_num_threads_next_parallel( 0 ), i;
+   nanos_team_t team = NULL;
+   nanos_thread_t threads[MAX_THREADS];
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   team_args_t master_args;
+
+   if ( nthreads > MAX_THREADS ) nthreads = MAX_THREADS;
+   NANOS_SAFE( nanos_create_team( &team, NULL, &nthreads, NULL, true, threads, NULL ) );
+
+   for ( i = 1; i < nthreads; i++ ) {
+      nanos_wd_t wd = NULL;
+      team_args_t *args = NULL;
+      dyn_props.tie_to = threads[i];
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &team_member_def.base, &dyn_props, sizeof(team_args_t),
+                                           (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->body = body;
+      args->arg = arg;
+      args->id = i;
+      args->nthreads = nthreads;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+
+   dyn_props.tie_to = threads[0];
+   master_args.body = body;
+   master_args.arg = arg;
+   master_args.id = 0;
+   master_args.nthreads = nthreads;
+   NANOS_SAFE( nanos_create_wd_and_run_compact( &team_member_def.base, &dyn_props, sizeof(team_args_t), &master_args,
+                                                0, NULL, NULL, NULL, NULL ) );
+   NANOS_SAFE( nanos_end_team( team ) );
+}
+
+/* Benchmarks **********************************************************************************/
+
+static void bench_task_create ( void )
+{
+   double times[MAX_SAMPLES];
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) spawn( &task_empty_def, NULL, NULL );
+      times[s] = ( get_usecs() - t ) / num_ops;
+      taskwait();
+   }
+   report( "task_create_submit", NULL, times, num_samples, num_ops );
+}
+
+static void bench_task_execute ( void )
+{
+   double times[MAX_SAMPLES];
+   int s, i, counter = 0;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) spawn( &task_empty_def, NULL, NULL );
+      taskwait();
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   report( "task_throughput", NULL, times, num_samples, num_ops );
+
+   /* Round trip of a single task: create, submit, execute and wait */
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) {
+         spawn( &task_increment_def, &counter, NULL );
+         taskwait();
+      }
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   check( "task_roundtrip", (long) num_samples * num_ops, counter );
+   report( "task_roundtrip", NULL, times, num_samples, num_ops );
+}
+
+static void bench_taskwait ( void )
+{
+   double times[MAX_SAMPLES];
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) taskwait();
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   report( "taskwait_empty", NULL, times, num_samples, num_ops );
+}
+
+static void bench_deps_chain ( const char *variant, const nanos_access_type_internal_t *access )
+{
+   double times[MAX_SAMPLES];
+   int s, i, counter = 0;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) spawn( &task_increment_def, &counter, access );
+      taskwait();
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   check( "deps_chain", (long) num_samples * num_ops, counter );
+   report( "deps_chain", variant, times, num_samples, num_ops );
+}
+
+/* One producer (out), num_ops - 2 readers (in) and one consumer (inout) */
+static void bench_deps_fan ( void )
+{
+   double times[MAX_SAMPLES];
+   int s, i, value = 0;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      spawn( &task_empty_def, &value, &ACCESS_OUT );
+      for ( i = 2; i < num_ops; i++ ) spawn( &task_empty_def, &value, &ACCESS_IN );
+      spawn( &task_increment_def, &value, &ACCESS_INOUT );
+      taskwait();
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   check( "deps_fan", num_samples, value );
+   report( "deps_fan", "out-in-inout", times, num_samples, num_ops );
+}
+
+static void reduction_init ( void *priv, void *orig ) { *(int *) priv = 0; }
+static void reduction_combine ( void *dest, void *priv ) { *(int *) dest += *(int *) priv; }
+
+static void bench_reduction ( void )
+{
+   double times[MAX_SAMPLES];
+   int s, i, sum = 0;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) {
+         NANOS_SAFE( nanos_task_reduction_register( &sum, sizeof(int), sizeof(int), reduction_init, reduction_combine ) );
+         spawn( &task_reduce_def, &sum, &ACCESS_CONCURRENT );
+      }
+      taskwait();
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   check( "task_reduction", (long) num_samples * num_ops, sum );
+   report( "task_reduction", NULL, times, num_samples, num_ops );
+}
+
+/* Large array reductions, combined with the built-in reducer */
+static void bench_reduction_array ( void )
+{
+   double times[MAX_SAMPLES];
+   const int rounds = 10;
+   int s, r, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( r = 0; r < rounds; r++ ) {
+         for ( i = 0; i < REDUCTION_ARRAY_TASKS; i++ ) {
+            NANOS_SAFE( nanos_task_reduction_register( reduction_array, sizeof(reduction_array), sizeof(int),
+                                                       reduction_init, nanos_task_reduction_add_int ) );
+            spawn( &task_reduce_array_def, reduction_array, &ACCESS_CONCURRENT );
+         }
+         taskwait();
+      }
+      times[s] = ( get_usecs() - t ) / rounds;
+   }
+   check( "task_reduction/array", (long) num_samples * rounds * REDUCTION_ARRAY_TASKS,
+          reduction_array[REDUCTION_ARRAY_SIZE - 1] );
+   report( "task_reduction", "array", times, num_samples, rounds );
+}
+
+static void bench_lock_uncontended ( void )
+{
+   double times[MAX_SAMPLES];
+   nanos_lock_t *lock;
+   int s, i;
+
+   NANOS_SAFE( nanos_init_lock( &lock ) );
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_ops; i++ ) {
+         NANOS_SAFE( nanos_set_lock( lock ) );
+         NANOS_SAFE( nanos_unset_lock( lock ) );
+      }
+      times[s] = ( get_usecs() - t ) / num_ops;
+   }
+   NANOS_SAFE( nanos_destroy_lock( lock ) );
+   report( "lock", "uncontended", times, num_samples, num_ops );
+}
+
+/* Parallel regions with nothing to do: team creation, start, join and end */
+static void team_empty_body ( int id, int nthreads, void *arg )
+{
+}
+
+static void bench_fork_join ( void )
+{
+   double times[MAX_SAMPLES];
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) run_team( team_empty_body, NULL );
+      times[s] = ( get_usecs() - t ) / num_team_ops;
+   }
+   report( "team_fork_join", NULL, times, num_samples, num_team_ops );
+}
+
+typedef struct {
+   double times[MAX_SAMPLES];
+   nanos_lock_t *lock;
+   omp_lock_t omp_lock;
+   long counter;
+   int nthreads;
+   nanos_ws_t ws;
+} team_bench_t;
+
+static void team_barrier_body ( int id, int nthreads, void *arg )
+{
+   team_bench_t *b = (team_bench_t *) arg;
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t;
+      NANOS_SAFE( nanos_team_barrier() );
+      t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) NANOS_SAFE( nanos_team_barrier() );
+      if ( id == 0 ) b->times[s] = ( get_usecs() - t ) / num_team_ops;
+   }
+}
+
+static void bench_barrier ( void )
+{
+   team_bench_t b;
+   run_team( team_barrier_body, &b );
+   report( "team_barrier", NULL, b.times, num_samples, num_team_ops );
+}
+
+/* Barrier phases with some work, imbalanced among threads: the cost of the
+ * early arrivers waiting shows when the team oversubscribes the CPUs, see
+ * --sync-wait in scripts/nanox-bench-run.sh */
+#define PHASE_WORK 20000
+
+static long phase_work ( int iterations )
+{
+   volatile long x = 0;
+   int i;
+   for ( i = 0; i < iterations; i++ ) x += i;
+   return x;
+}
+
+static void team_phases_body ( int id, int nthreads, void *arg )
+{
+   team_bench_t *b = (team_bench_t *) arg;
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t;
+      NANOS_SAFE( nanos_team_barrier() );
+      t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) {
+         long x = phase_work( PHASE_WORK * ( 1 + ( id + i ) % 2 ) );
+         __sync_fetch_and_add( &b->counter, x != 0 );
+         NANOS_SAFE( nanos_team_barrier() );
+      }
+      if ( id == 0 ) b->times[s] = ( get_usecs() - t ) / num_team_ops;
+   }
+   if ( id == 0 ) b->nthreads = nthreads;
+}
+
+static void bench_barrier_phases ( void )
+{
+   team_bench_t b;
+   b.counter = 0;
+   run_team( team_phases_body, &b );
+   check( "team_barrier/phases", (long) num_samples * num_team_ops * b.nthreads, b.counter );
+   report( "team_barrier", "phases", b.times, num_samples, num_team_ops );
+}
+
+/* A team reduction, registered as compiled code does and computed by the barrier */
+static long team_sum;
+
+static void team_sum_bop ( void *out, void *in, int num_scalars )
+{
+   *(long *) out += *(long *) in;
+}
+
+static void team_sum_cleanup ( void *privates )
+{
+   NANOS_SAFE( nanos_free( privates ) );
+}
+
+static void team_reduction_body ( int id, int nthreads, void *arg )
+{
+   team_bench_t *b = (team_bench_t *) arg;
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t;
+      NANOS_SAFE( nanos_team_barrier() );
+      t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) {
+         long *privates;
+         bool first;
+         NANOS_SAFE( nanos_enter_sync_init( &first ) );
+         if ( first ) {
+            nanos_reduction_t *red;
+            NANOS_SAFE( nanos_malloc( (void **) &red, sizeof( nanos_reduction_t ), __FILE__, __LINE__ ) );
+            NANOS_SAFE( nanos_malloc( (void **) &privates, nthreads * sizeof( long ), __FILE__, __LINE__ ) );
+            memset( privates, 0, nthreads * sizeof( long ) );
+            red->original = &team_sum;
+            red->privates = privates;
+            red->element_size = sizeof( long );
+            red->num_scalars = 1;
+            red->descriptor = privates;
+            red->bop = team_sum_bop;
+            red->vop = NULL;
+            red->cleanup = team_sum_cleanup;
+            NANOS_SAFE( nanos_register_reduction( red ) );
+            NANOS_SAFE( nanos_release_sync_init() );
+         } else {
+            NANOS_SAFE( nanos_wait_sync_init() );
+         }
+         NANOS_SAFE( nanos_reduction_get_private_data( (void **) &privates, &team_sum ) );
+         privates[id] = 1;
+         NANOS_SAFE( nanos_team_barrier() );
+      }
+      if ( id == 0 ) b->times[s] = ( get_usecs() - t ) / num_team_ops;
+   }
+   if ( id == 0 ) b->nthreads = nthreads;
+}
+
+static void bench_barrier_reduction ( void )
+{
+   team_bench_t b;
+   team_sum = 0;
+   run_team( team_reduction_body, &b );
+   check( "team_barrier/reduction", (long) num_samples * num_team_ops * b.nthreads, team_sum );
+   report( "team_barrier", "reduction", b.times, num_samples, num_team_ops );
+}
+
+static void team_lock_body ( int id, int nthreads, void *arg )
+{
+   team_bench_t *b = (team_bench_t *) arg;
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t;
+      NANOS_SAFE( nanos_team_barrier() );
+      t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) {
+         NANOS_SAFE( nanos_set_lock( b->lock ) );
+         b->counter++;
+         NANOS_SAFE( nanos_unset_lock( b->lock ) );
+      }
+      NANOS_SAFE( nanos_team_barrier() );
+      if ( id == 0 ) b->times[s] = ( get_usecs() - t ) / ( (double) num_team_ops * nthreads );
+   }
+   if ( id == 0 ) b->nthreads = nthreads;
+}
+
+static void bench_lock_contended ( void )
+{
+   team_bench_t b;
+   b.counter = 0;
+   NANOS_SAFE( nanos_init_lock( &b.lock ) );
+   run_team( team_lock_body, &b );
+   NANOS_SAFE( nanos_destroy_lock( b.lock ) );
+   check( "lock/contended", (long) num_samples * num_team_ops * b.nthreads, b.counter );
+   report( "lock", "contended", b.times, num_samples, num_team_ops );
+}
+
+static void team_omp_lock_body ( int id, int nthreads, void *arg )
+{
+   team_bench_t *b = (team_bench_t *) arg;
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t;
+      NANOS_SAFE( nanos_team_barrier() );
+      t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) {
+         omp_set_lock( &b->omp_lock );
+         b->counter++;
+         omp_unset_lock( &b->omp_lock );
+      }
+      NANOS_SAFE( nanos_team_barrier() );
+      if ( id == 0 ) b->times[s] = ( get_usecs() - t ) / ( (double) num_team_ops * nthreads );
+   }
+   if ( id == 0 ) b->nthreads = nthreads;
+}
+
+static void bench_lock_contended_omp ( void )
+{
+   team_bench_t b;
+   b.counter = 0;
+   omp_init_lock( &b.omp_lock );
+   run_team( team_omp_lock_body, &b );
+   omp_destroy_lock( &b.omp_lock );
+   check( "lock/contended_omp", (long) num_samples * num_team_ops * b.nthreads, b.counter );
+   report( "lock", "contended_omp", b.times, num_samples, num_team_ops );
+}
+
+#define WS_ITERATIONS 1024
+
+static void team_worksharing_body ( int id, int nthreads, void *arg )
+{
+   team_bench_t *b = (team_bench_t *) arg;
+   int s, i;
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t;
+      long done = 0;
+      NANOS_SAFE( nanos_team_barrier() );
+      t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) {
+         nanos_ws_desc_t *wsd;
+         nanos_ws_info_loop_t info = { 0, WS_ITERATIONS - 1, 1, 0 };
+         nanos_ws_item_loop_t item;
+         bool single_guard;
+         NANOS_SAFE( nanos_worksharing_create( &wsd, b->ws, (void **) &info, &single_guard ) );
+         NANOS_SAFE( nanos_worksharing_next_item( wsd, (void **) &item ) );
+         while ( item.execute ) {
+            done += item.upper - item.lower + 1;
+            NANOS_SAFE( nanos_worksharing_next_item( wsd, (void **) &item ) );
+         }
+         NANOS_SAFE( nanos_team_barrier() );
+      }
+      if ( id == 0 ) b->times[s] = ( get_usecs() - t ) / num_team_ops;
+      __sync_fetch_and_add( &b->counter, done );
+   }
+}
+
+static void bench_worksharing ( const char *label )
+{
+   team_bench_t b;
+   b.counter = 0;
+   b.ws = nanos_find_worksharing( label );
+   if ( b.ws == NULL ) {
+      fprintf( stderr, "microbench: worksharing %s not available\n", label );
+      num_errors++;
+      return;
+   }
+   run_team( team_worksharing_body, &b );
+   check( "worksharing", (long) num_samples * num_team_ops * WS_ITERATIONS, b.counter );
+   report( "worksharing", label, b.times, num_samples, num_team_ops );
+}
+
+/* Sliced loops sweeping the same array over and over, as iterative solvers do */
+#define SLICER_ITERATIONS 65536
+
+typedef struct {
+   nanos_loop_info_t loop_info;
+   double *array;
+} slicer_loop_args_t;
+
+static void slicer_loop_body ( void *args )
+{
+   slicer_loop_args_t *a = (slicer_loop_args_t *) args;
+   int i;
+   for ( i = a->loop_info.lower; i <= a->loop_info.upper; i += a->loop_info.step ) a->array[i] += 1.0;
+}
+
+static nanos_smp_args_t slicer_loop_args = { slicer_loop_body };
+
+static void bench_slicer ( const char *label )
+{
+   double times[MAX_SAMPLES];
+   double *array = (double *) calloc( SLICER_ITERATIONS, sizeof( double ) );
+   nanos_slicer_t slicer = nanos_find_slicer( label );
+   nanos_wd_props_t props = { .mandatory_creation = true, .tied = false };
+   nanos_wd_dyn_props_t dyn_props = { 0 };
+   int s, i;
+
+   if ( slicer == NULL ) {
+      fprintf( stderr, "microbench: slicer %s not available\n", label );
+      num_errors++;
+      free( array );
+      return;
+   }
+
+   for ( s = 0; s < num_samples; s++ ) {
+      double t = get_usecs();
+      for ( i = 0; i < num_team_ops; i++ ) {
+         nanos_wd_t wd = NULL;
+         nanos_device_t device[1] = { NANOS_SMP_DESC( slicer_loop_args ) };
+         slicer_loop_args_t *args = NULL;
+         NANOS_SAFE( nanos_create_sliced_wd( &wd, 1, device, sizeof( slicer_loop_args_t ), __alignof__( slicer_loop_args_t ),
+                                             (void **) &args, nanos_current_wd(), slicer, &props, &dyn_props,
+                                             0, NULL, 0, NULL ) );
+         args->loop_info.lower = 0;
+         args->loop_info.upper = SLICER_ITERATIONS - 1;
+         args->loop_info.step = 1;
+         args->loop_info.chunk = 0;
+         args->array = array;
+         NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+         taskwait();
+      }
+      times[s] = ( get_usecs() - t ) / num_team_ops;
+   }
+   check( "slicer", (long) num_samples * num_team_ops, (long) array[SLICER_ITERATIONS - 1] );
+   free( array );
+   report( "slicer", label, times, num_samples, num_team_ops );
+}
+
+/* Driver **************************************************************************************/
+
+static void usage ( const char *program )
+{
+   fprintf( stderr, "usage: %s [-s samples] [-n operations] [-t team operations] [-f filter] [-o file]\n", program );
+   exit( 1 );
+}
+
+int main ( int argc, char **argv )
+{
+   const char *nx_args = getenv( "NX_ARGS" );
+   const char *output = NULL;
+   int i;
+
+   for ( i = 1; i < argc; i++ ) {
+      if ( strcmp( argv[i], "-s" ) == 0 && i + 1 < argc ) num_samples = atoi( argv[++i] );
+      else if ( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc ) num_ops = atoi( argv[++i] );
+      else if ( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc ) num_team_ops = atoi( argv[++i] );
+      else if ( strcmp( argv[i], "-f" ) == 0 && i + 1 < argc ) filter = argv[++i];
+      else if ( strcmp( argv[i], "-o" ) == 0 && i + 1 < argc ) output = argv[++i];
+      else usage( argv[0] );
+   }
+   if ( num_samples < 1 || num_samples > MAX_SAMPLES || num_ops < 2 || num_team_ops < 1 ) usage( argv[0] );
+
+   out = output ? fopen( output, "w" ) : stdout;
+   if ( out == NULL ) {
+      perror( output );
+      return 1;
+   }
+
+   /* Warm up: thread creation, allocators and plugins loaded on demand */
+   for ( i = 0; i < num_ops; i++ ) spawn( &task_empty_def, NULL, NULL );
+   taskwait();
+
+   fprintf( out, "{\n  \"benchmark\": \"nanox-microbench\",\n" );
+   fprintf( out, "  \"config\": { \"threads\": %d, \"scheduler\": \"%s\", \"pm\": \"%s\", \"mode\": \"%s\", \"nx_args\": \"",
+            omp_get_max_threads(), nanos_get_default_scheduler(), nanos_get_pm(), nanos_get_mode() );
+   for ( i = 0; nx_args && nx_args[i]; i++ ) {
+      if ( nx_args[i] == '"' || nx_args[i] == '\\' ) fputc( '\\', out );
+      fputc( nx_args[i], out );
+   }
+   fprintf( out, "\" },\n  \"results\": [\n" );
+
+   if ( selected( "task_create_submit" ) ) bench_task_create();
+   if ( selected( "task_throughput" ) || selected( "task_roundtrip" ) ) bench_task_execute();
+   if ( selected( "taskwait_empty" ) ) bench_taskwait();
+   if ( selected( "deps_chain/inout" ) ) bench_deps_chain( "inout", &ACCESS_INOUT );
+   if ( selected( "deps_chain/commutative" ) ) bench_deps_chain( "commutative", &ACCESS_COMMUTATIVE );
+   if ( selected( "deps_fan" ) ) bench_deps_fan();
+   if ( selected( "task_reduction" ) ) bench_reduction();
+   if ( selected( "task_reduction/array" ) ) bench_reduction_array();
+   if ( selected( "team_fork_join" ) ) bench_fork_join();
+   if ( selected( "team_barrier" ) ) bench_barrier();
+   if ( selected( "team_barrier/reduction" ) ) bench_barrier_reduction();
+   if ( selected( "team_barrier/phases" ) ) bench_barrier_phases();
+   if ( selected( "worksharing/static_for" ) ) bench_worksharing( "static_for" );
+   if ( selected( "worksharing/dynamic_for" ) ) bench_worksharing( "dynamic_for" );
+   if ( selected( "worksharing/guided_for" ) ) bench_worksharing( "guided_for" );
+   if ( selected( "worksharing/steal_for" ) ) bench_worksharing( "steal_for" );
+   if ( selected( "worksharing/auto_for" ) ) bench_worksharing( "auto_for" );
+   if ( selected( "slicer/static_for" ) ) bench_slicer( "static_for" );
+   if ( selected( "lock/uncontended" ) ) bench_lock_uncontended();
+   if ( selected( "lock/contended" ) ) bench_lock_contended();
+   if ( selected( "lock/contended_omp" ) ) bench_lock_contended_omp();
+
+   fprintf( out, "\n  ]\n}\n" );
+   if ( output ) fclose( out );
+
+   return num_errors == 0 ? 0 : 1;
+}